@@ -19,6 +19,11 @@
 #include <map>
 #include <fstream>
 #include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <type_traits>
+#include <stdexcept>
 
 #include <OpenCLTypes.hpp>
 #include <Kernel.hpp>
@@ -27,11 +32,34 @@
 #include <utils.hpp>
 #include <Statistics.hpp>
 
+#ifdef __SSE__
+#include <immintrin.h>
+#endif
+
 #pragma once
 
 namespace SNR
 {
 
+/**
+ ** @brief Algorithm used to select the median of every step.
+ */
+enum MedianStrategy
+{
+    OddEvenSort,
+    SortingNetwork,
+    RadixSelect
+};
+/**
+ ** @brief Largest step of the SortingNetwork median, and largest number of samples that every work-item keeps in registers (step times nrItemsD0).
+ */
+const unsigned int maxSortingNetworkStep = 64;
+const unsigned int maxSortingNetworkSamples = 256;
+/**
+ ** @brief Size, in bytes, of the local memory that every OpenCL device provides.
+ */
+const unsigned int minLocalMemorySize = 32768;
+
 /**
  ** @brief Configuration class.
  */
@@ -42,13 +70,25 @@ class snrConf : public isa::OpenCL::KernelConf
     ~snrConf();
     // Get
     bool getSubbandDedispersion() const;
+    bool getSubgroupReduction() const;
+    unsigned int getVectorWidth() const;
+    unsigned int getNrWorkGroups() const;
+    MedianStrategy getMedianStrategy() const;
     // Set
     void setSubbandDedispersion(bool subband);
+    void setSubgroupReduction(bool subgroup);
+    void setVectorWidth(unsigned int width);
+    void setNrWorkGroups(unsigned int workGroups);
+    void setMedianStrategy(MedianStrategy strategy);
     // utils
     std::string print() const;
 
   private:
     bool subbandDedispersion;
+    bool subgroupReduction;
+    unsigned int vectorWidth;
+    unsigned int nrWorkGroups;
+    MedianStrategy medianStrategy;
 };
 typedef std::map<std::string, std::map<unsigned int, std::map<unsigned int, SNR::snrConf *> *> *> tunedSNRConf;
 
@@ -72,7 +112,71 @@ enum Kernel
     MaxStdSigmaCut,
     MedianOfMedians,
     MedianOfMediansAbsoluteDeviation,
-    AbsoluteDeviation
+    AbsoluteDeviation,
+    Transpose,
+    SNRMedianOfMediansAbsoluteDeviation,
+    SNRBoxcar,
+    SNRDownsampling,
+    SNRTopK,
+    SNRCandidates,
+    SNRBeamMax,
+    MedianOfMediansTwoLevel,
+    StreamingMedianAbsoluteDeviation,
+    SNRRunningStatistics
+};
+
+/**
+ ** @brief Options of the kernel to test or tune that are not part of its configuration.
+ ** Every kernel only reads its own options, the others keep their default values.
+ */
+struct KernelOptions
+{
+    // Median of medians kernels
+    unsigned int medianStep = 0;
+    // Sigma cut and candidates kernels
+    float nSigma = 3.0f;
+    unsigned int maxIterations = 0;
+    // Boxcar kernel
+    std::vector<unsigned int> widths;
+    // Downsampling kernel
+    unsigned int nrLevels = 1;
+    // Top-k kernel
+    unsigned int nrPeaks = 1;
+    // Streaming median absolute deviation kernel
+    unsigned int nrBins = 2;
+    float smoothing = 1.0f;
+    // Running statistics kernel
+    float decay = 1.0f;
+    // Streaming kernels, number of consecutive batches
+    unsigned int nrBatches = 1;
+};
+
+/**
+ ** @brief Statistics of a time series, as computed by the CPU versions of the kernels.
+ ** The variance field contains the sum of squared differences from the mean, like in the OpenCL kernels.
+ */
+template <typename DataType>
+struct TimeSeriesStatistics
+{
+    float counter;
+    float mean;
+    float variance;
+    DataType max;
+    unsigned int maxSample;
+};
+
+/**
+ ** @brief A detection in DM, sample and width space, or the brightest member of a cluster of detections.
+ ** The nrMembers field contains the number of detections that are part of the cluster, and is 1 for a single detection.
+ */
+struct Candidate
+{
+    unsigned int beam;
+    unsigned int dm;
+    unsigned int sample;
+    unsigned int width;
+    float snr;
+    unsigned int nrMembers;
 };
 
 /**
@@ -81,8 +185,16 @@ enum Kernel
  */
 template <typename DataType>
 std::string *getMaxOpenCL(const snrConf &conf, const DataOrdering ordering, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding);
+/**
+ ** @brief Generate OpenCL code for the "max" kernel, for data in DMs-samples order.
+ ** With a vector width larger than one, every item is a vector of contiguous samples; the number of samples must be a multiple of the width.
+ ** With more than one thread along D1, every work-group processes nrThreadsD1 DMs; the number of DMs must be a multiple of it, and sub-group reductions are not supported.
+ ** With nrWorkGroups larger than zero, the kernel is persistent, see replaceRowLoopDMsSamplesOpenCL.
+ */
 template <typename DataType>
 std::string *getMaxDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding);
+template <typename DataType>
+std::string *getMaxSamplesDMsOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding);
 /**
  ** @brief Generate OpenCL code for the max and standard deviation using a "sigma cut" kernel.
  */
@@ -90,23 +202,117 @@ template <typename DataType>
 std::string *getMaxStdSigmaCutOpenCL(const snrConf &conf, const DataOrdering ordering, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding, const float nSigma);
 template <typename DataType>
 std::string *getMaxStdSigmaCutDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding, const float nSigma);
+template <typename DataType>
+std::string *getMaxStdSigmaCutSamplesDMsOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding, const float nSigma);
 /**
  ** @brief CPU version of max and standard deviation using a "sigma cut" kernel.
  */
 template <typename DataType>
 void stdSigmaCut(const std::vector<DataType> &timeSeries, std::vector<DataType> &standardDeviations, const AstroData::Observation &observation, const unsigned int padding, const float nSigma);
+/**
+ ** @brief Multi-threaded CPU version of the max and standard deviation using a "sigma cut" kernel.
+ ** Both passes are done on one time series before moving to the next, and the outputs have the same layout as the outputs of getMaxStdSigmaCutDMsSamplesOpenCL.
+ */
+template <typename DataType>
+void maxStdSigmaCutCPU(const std::vector<DataType> &timeSeries, std::vector<DataType> &maxValues, std::vector<unsigned int> &maxIndices, std::vector<DataType> &standardDeviations, const AstroData::Observation &observation, const unsigned int padding, const float nSigma);
+/**
+ ** @brief Generate OpenCL code for the max and standard deviation using an iterative "sigma cut" kernel.
+ ** The kernel is the one of getIterativeSigmaCutDMsSamplesOpenCL, with the outputs of getMaxStdSigmaCutDMsSamplesOpenCL.
+ */
+template <typename DataType>
+std::string *getMaxStdIterativeSigmaCutDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding, const float nSigma, const unsigned int maxIterations);
+/**
+ ** @brief CPU version of the standard deviation using an iterative "sigma cut" kernel.
+ */
+template <typename DataType>
+void stdIterativeSigmaCut(const std::vector<DataType> &timeSeries, std::vector<DataType> &standardDeviations, const AstroData::Observation &observation, const unsigned int padding, const float nSigma, const unsigned int maxIterations);
+/**
+ ** @brief Multi-threaded CPU version of the max and standard deviation using an iterative "sigma cut" kernel.
+ */
+template <typename DataType>
+void maxStdIterativeSigmaCutCPU(const std::vector<DataType> &timeSeries, std::vector<DataType> &maxValues, std::vector<unsigned int> &maxIndices, std::vector<DataType> &standardDeviations, const AstroData::Observation &observation, const unsigned int padding, const float nSigma, const unsigned int maxIterations);
 /**
  ** @brief Generate OpenCL code for the median of medians kernel.
  */
 template <typename DataType>
 std::string *getMedianOfMediansOpenCL(const snrConf &conf, const DataOrdering ordering, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int stepSize, const unsigned int padding);
+/**
+ ** @brief Generate OpenCL code for the median of medians kernel, for data in DMs-samples order.
+ ** The median of every step is selected with the algorithm in conf.getMedianStrategy():
+ **  - OddEvenSort, one work-group per step sorting the step in local memory;
+ **  - SortingNetwork, one work-item per step and nrItemsD0 steps per work-item, sorting the step in registers (see maxSortingNetworkStep and maxSortingNetworkSamples);
+ **  - RadixSelect, one work-group per step selecting the median with eight bits per pass (32 bits data types only).
+ */
 template <typename DataType>
 std::string *getMedianOfMediansDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int stepSize, const unsigned int padding);
+template <typename DataType>
+std::string *getMedianOfMediansSortingNetworkDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const unsigned int nrDMs, const unsigned int nrSamples, const unsigned int stepSize, const unsigned int padding);
+template <typename DataType>
+std::string *getMedianOfMediansSamplesDMsOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int stepSize, const unsigned int padding);
+/**
+ ** @brief Generate OpenCL code for the two-level median of medians kernel.
+ ** Every work-group computes the medians of all the steps of one time series, nrItemsD0 steps at a time, and then the median of those medians, without storing the medians of the steps in global memory; the last group of steps is guarded when the number of steps is not a multiple of nrItemsD0.
+ ** The output has the same layout as the output of getMedianOfMediansDMsSamplesOpenCL with stepSize equal to the number of samples.
+ ** Throws std::invalid_argument if stepSize is zero or larger than the number of samples.
+ */
+template <typename DataType>
+std::string *getMedianOfMediansTwoLevelDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int stepSize, const unsigned int padding);
+/**
+ ** @brief CPU version of the two-level median of medians.
+ ** Throws std::invalid_argument if stepSize is zero or larger than the number of samples.
+ */
+template <typename DataType>
+void medianOfMediansTwoLevel(const unsigned int stepSize, const std::vector<DataType> &timeSeries, std::vector<DataType> &medians, const AstroData::Observation &observation, const unsigned int padding);
+/**
+ ** @brief Multi-threaded CPU version of the two-level median of medians.
+ ** Every thread keeps the medians of the steps of one time series in its own buffer; the output has the same layout as medianOfMediansTwoLevel.
+ ** Throws std::invalid_argument if stepSize is zero or larger than the number of samples.
+ */
+template <typename DataType>
+void medianOfMediansTwoLevelCPU(const unsigned int stepSize, const std::vector<DataType> &timeSeries, std::vector<DataType> &medians, const AstroData::Observation &observation, const unsigned int padding);
+/**
+ ** @brief Generate OpenCL code for the streaming median absolute deviation kernel.
+ ** The per-DM baseline (median) and median absolute deviation are estimated from histograms of the current batch, without sorting, and merged into the state carried between batches.
+ ** The histograms cover plus or minus four median absolute deviations around the baseline of the state; when the state is empty, or the baseline drifted out of this window, they cover the range of the batch and the state is reset.
+ **
+ ** @param conf The kernel configuration.
+ ** @param dataName A string representing the data type used in the kernel.
+ ** @param observation The object representing the observation.
+ ** @param downsampling The downsampling factor of the time series.
+ ** @param nrBins The number of bins of the histograms.
+ ** @param smoothing The weight of the current batch when it is merged into the state, between 0 and 1.
+ ** @param padding The padding in memory.
+ */
+template <typename DataType>
+std::string *getStreamingMedianAbsoluteDeviationDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int nrBins, const float smoothing, const unsigned int padding);
+/**
+ ** @brief CPU version of the streaming median absolute deviation, with exact medians computed by sorting.
+ ** The state update is the same as in the approximated versions, so this is the reference for their accuracy.
+ */
+template <typename DataType>
+void streamingMedianAbsoluteDeviation(const float smoothing, const std::vector<DataType> &timeSeries, std::vector<float> &baselines, std::vector<float> &mads, const AstroData::Observation &observation, const unsigned int padding);
+/**
+ ** @brief Multi-threaded CPU version of the streaming median absolute deviation, with the same histograms as the OpenCL kernel.
+ */
+template <typename DataType>
+void streamingMedianAbsoluteDeviationCPU(const unsigned int nrBins, const float smoothing, const std::vector<DataType> &timeSeries, std::vector<float> &baselines, std::vector<float> &mads, const AstroData::Observation &observation, const unsigned int padding);
+/**
+ ** @brief Compare-and-swap operations of a sorting network that places the median of stepSize elements at index stepSize / 2.
+ ** The network is Batcher's odd-even merge sort, without the comparators that do not contribute to the median.
+ ** Throws std::invalid_argument if stepSize is zero.
+ */
+std::vector<std::pair<unsigned int, unsigned int>> getMedianSortingNetwork(const unsigned int stepSize);
 /**
  ** @brief CPU version of median of medians.
  */
 template <typename DataType>
 void medianOfMedians(const unsigned int stepSize, const std::vector<DataType> &timeSeries, std::vector<DataType> &medians, const AstroData::Observation &observation, const unsigned int padding);
+/**
+ ** @brief Multi-threaded CPU version of median of medians.
+ ** Every thread selects the medians in its own scratch buffer, without sorting the whole step; the output has the same layout as medianOfMedians.
+ */
+template <typename DataType>
+void medianOfMediansCPU(const unsigned int stepSize, const std::vector<DataType> &timeSeries, std::vector<DataType> &medians, const AstroData::Observation &observation, const unsigned int padding);
 /**
  ** @brief Generate OpenCL code for the median of medians absolute deviation kernel.
  */
@@ -114,11 +320,19 @@ template <typename DataType>
 std::string *getMedianOfMediansAbsoluteDeviationOpenCL(const snrConf &conf, const DataOrdering ordering, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int stepSize, const unsigned int padding);
 template <typename DataType>
 std::string *getMedianOfMediansAbsoluteDeviationDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int stepSize, const unsigned int padding);
+template <typename DataType>
+std::string *getMedianOfMediansAbsoluteDeviationSamplesDMsOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int stepSize, const unsigned int padding);
 /**
  ** @brief CPU version of median of medians absolute deviation.
  */
 template <typename DataType>
 void medianOfMediansAbsoluteDeviation(const unsigned int stepSize, const std::vector<DataType> &baselines, const std::vector<DataType> &timeSeries, std::vector<DataType> &medians, const AstroData::Observation &observation, const unsigned int padding);
+/**
+ ** @brief Multi-threaded CPU version of median of medians absolute deviation.
+ ** The absolute deviations of every step are computed in a per-thread buffer, and the median is selected in place; the output has the same layout as medianOfMediansAbsoluteDeviation.
+ */
+template <typename DataType>
+void medianOfMediansAbsoluteDeviationCPU(const unsigned int stepSize, const std::vector<DataType> &baselines, const std::vector<DataType> &timeSeries, std::vector<DataType> &medians, const AstroData::Observation &observation, const unsigned int padding);
 /**
  ** @brief Generate OpenCL code for for the absolute deviation kernel.
  */
@@ -126,16 +340,110 @@ template <typename DataType>
 std::string * getAbsoluteDeviationOpenCL(const snrConf &conf, const DataOrdering ordering, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding);
 template <typename DataType>
 std::string * getAbsoluteDeviationDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding);
+template <typename DataType>
+std::string * getAbsoluteDeviationSamplesDMsOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding);
 /**
  ** @brief CPU version of absolute deviation.
  */
 template <typename DataType>
-void absoluteDeviation(const DataType baseline, const std::vector<DataType> &timeSeries, std::vector<DataType> &absoluteDeviations, const AstroData::Observation &observation, const unsigned int padding);
+void absoluteDeviation(const std::vector<DataType> &baselines, const std::vector<DataType> &timeSeries, std::vector<DataType> &absoluteDeviations, const AstroData::Observation &observation, const unsigned int padding);
+/**
+ ** @brief Compute the absolute deviation of a contiguous time series from its baseline.
+ ** The input and output pointers can be the same; non-temporal stores are used, when available, if requested.
+ */
+template <typename DataType>
+void absoluteDeviationTimeSeries(const DataType baseline, const DataType *timeSeries, DataType *absoluteDeviations, const unsigned int nrSamples, const bool nonTemporal);
+/**
+ ** @brief Multi-threaded CPU version of absolute deviation.
+ ** The output has the same layout as absoluteDeviation; large outputs are written with non-temporal stores.
+ */
+template <typename DataType>
+void absoluteDeviationCPU(const std::vector<DataType> &baselines, const std::vector<DataType> &timeSeries, std::vector<DataType> &absoluteDeviations, const AstroData::Observation &observation, const unsigned int padding);
+/**
+ ** @brief Multi-threaded CPU version of absolute deviation, overwriting the input with the output.
+ */
+template <typename DataType>
+void absoluteDeviationCPU(const std::vector<DataType> &baselines, std::vector<DataType> &timeSeries, const AstroData::Observation &observation, const unsigned int padding);
 // OpenCL SNR
+/**
+ ** @brief Generate OpenCL code for the SNR kernel, for data in DMs-samples order.
+ ** With a vector width larger than one, every item is a vector of contiguous samples; nrSamples must be a multiple of the width.
+ ** With more than one thread along D1, every work-group processes nrThreadsD1 DMs; the number of DMs must be a multiple of it, and sub-group reductions are not supported.
+ ** With nrWorkGroups larger than zero, the kernel is persistent, see replaceRowLoopDMsSamplesOpenCL.
+ */
 template <typename T>
 std::string *getSNRDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int padding);
+/**
+ ** @brief Generate OpenCL code for the SNR kernel, for data in samples-DMs order.
+ ** With more than one thread along D1, the samples are split among the nrThreadsD1 rows of the work-group, and the partial statistics are merged in local memory.
+ */
 template <typename T>
 std::string *getSNRSamplesDMsOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int padding);
+/**
+ ** @brief Compute the statistics of a contiguous time series on the CPU.
+ ** The time series is processed in independent SIMD lanes that are merged at the end, the same way the OpenCL kernels merge their items.
+ **
+ ** @param timeSeries Pointer to the first sample of the time series.
+ ** @param nrSamples The number of samples in the time series; an empty time series has all fields set to zero.
+ */
+template <typename DataType>
+TimeSeriesStatistics<DataType> timeSeriesStatistics(const DataType *timeSeries, const unsigned int nrSamples);
+/**
+ ** @brief Merge two partial statistics, using the same formula as the reduce phase of the OpenCL kernels.
+ */
+template <typename DataType>
+void mergeStatistics(TimeSeriesStatistics<DataType> &statistics, const TimeSeriesStatistics<DataType> &other);
+/**
+ ** @brief Multi-threaded CPU version of the SNR kernel, for data in DMs-samples order.
+ ** The output has the same layout, padding included, as the output of getSNRDMsSamplesOpenCL.
+ **
+ ** @param input The input data in beam-DM-time order.
+ ** @param outputSNR SNR of the highest peak per DM.
+ ** @param outputSample Position of the highest peak per DM.
+ ** @param observation The object representing the observation.
+ ** @param nrSamples The number of samples per time series.
+ ** @param padding The padding in memory.
+ */
+template <typename DataType>
+void snrDMsSamplesCPU(const std::vector<DataType> &input, std::vector<float> &outputSNR, std::vector<unsigned int> &outputSample, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int padding);
+/**
+ ** @brief Generate OpenCL code for the SNR with running statistics.
+ ** Every (beam, DM) has a persistent state made of a counter, a mean and a sum of squared differences, and every batch is merged into it with the same formula as the reduce phase of the kernels.
+ ** The peak of the batch is then compared with the mean and standard deviation of the state, so that the noise is estimated over many batches while the latency is still of one batch.
+ ** Before merging a batch, the counter and the sum of squared differences of the state are multiplied by the decay; a decay of one gives the statistics of all batches, a smaller decay exponentially weighted statistics that follow a slowly changing noise.
+ ** The state has the same layout as outputSNR, is read and written by the kernel, and must be set to zero before the first batch.
+ ** The number of work-items must be a power of two.
+ **
+ ** @param conf The kernel configuration.
+ ** @param dataName A string representing the data type used in the kernel.
+ ** @param observation The object representing the observation.
+ ** @param nrSamples The number of samples per time series.
+ ** @param decay The weight of the state when merging a new batch, between zero and one.
+ ** @param padding The padding in memory.
+ */
+template <typename T>
+std::string *getSNRRunningStatisticsDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int nrSamples, const float decay, const unsigned int padding);
+/**
+ ** @brief CPU version of the SNR with running statistics.
+ ** The statistics of every batch are computed in double precision, and merged into the state like in getSNRRunningStatisticsDMsSamplesOpenCL.
+ **
+ ** @param decay The weight of the state when merging a new batch.
+ ** @param input The input data in beam-DM-time order.
+ ** @param counters The counters of the state.
+ ** @param means The means of the state.
+ ** @param variances The sums of squared differences of the state.
+ ** @param snr SNR of the highest peak per DM.
+ ** @param observation The object representing the observation.
+ ** @param padding The padding in memory.
+ */
+template <typename DataType>
+void snrRunningStatistics(const float decay, const std::vector<DataType> &input, std::vector<float> &counters, std::vector<float> &means, std::vector<float> &variances, std::vector<float> &snr, const AstroData::Observation &observation, const unsigned int padding);
+/**
+ ** @brief Multi-threaded CPU version of the SNR with running statistics, for data in DMs-samples order.
+ ** The statistics of the batch are computed with timeSeriesStatistics, and merged into the state with mergeStatistics; the outputs and the state have the same layout as the ones of getSNRRunningStatisticsDMsSamplesOpenCL.
+ */
+template <typename DataType>
+void snrRunningStatisticsDMsSamplesCPU(const std::vector<DataType> &input, std::vector<float> &counters, std::vector<float> &means, std::vector<float> &variances, std::vector<float> &outputSNR, std::vector<unsigned int> &outputSample, const AstroData::Observation &observation, const unsigned int nrSamples, const float decay, const unsigned int padding);
 /**
  ** @brief Compute the Signal-to-Noise ratio with a sigma cut.
  ** All elements whose value is farther than a given number of standard deviations from the mean are excluded from computing the SNR.
@@ -150,6 +458,8 @@ std::string *getSNRSamplesDMsOpenCL(const snrConf &conf, const std::string &data
  */
 template <typename T>
 std::string *getSNRSigmaCutDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int padding, const float nSigma, const float correctionFactor = 1.0f);
+template <typename T>
+std::string *getSNRSigmaCutSamplesDMsOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int padding, const float nSigma, const float correctionFactor = 1.0f);
 /**
  ** @brief CPU control version of the SNR with sigma cut.
  **
@@ -162,163 +472,457 @@ std::string *getSNRSigmaCutDMsSamplesOpenCL(const snrConf &conf, const std::stri
  */
 template<typename NumericType>
 void snrSigmaCut(const std::vector<NumericType> & timeSeries, std::vector<NumericType> & snr, const AstroData::Observation & observation, const unsigned int padding, const float nSigma, const float correctionFactor = 1.0f);
-// Read configuration files
-void readTunedSNRConf(tunedSNRConf &tunedSNR, const std::string &snrFilename);
-
-// Implementations
-inline bool snrConf::getSubbandDedispersion() const
-{
-    return subbandDedispersion;
-}
-
-inline void snrConf::setSubbandDedispersion(bool subband)
-{
-    subbandDedispersion = subband;
-}
-
+/**
+ ** @brief Compute the statistics of a contiguous time series on the CPU, excluding the samples farther than a threshold from a given mean.
+ ** Only the counter, mean and variance fields of the result are meaningful.
+ **
+ ** @param timeSeries Pointer to the first sample of the time series.
+ ** @param nrSamples The number of samples in the time series.
+ ** @param mean The mean used to compute the distance of every sample.
+ ** @param sigmaThreshold Samples whose distance from the mean is not smaller than this value are excluded.
+ */
 template <typename DataType>
-std::string *getMaxOpenCL(const snrConf &conf, const DataOrdering ordering, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding)
-{
-    std::string *code = 0;
-
-    if (ordering == DataOrdering::DMsSamples)
-    {
-        code = getMaxDMsSamplesOpenCL<DataType>(conf, dataName, observation, downsampling, padding);
-    }
-    return code;
-}
-
+TimeSeriesStatistics<DataType> sigmaCutStatistics(const DataType *timeSeries, const unsigned int nrSamples, const float mean, const float sigmaThreshold);
+/**
+ ** @brief Multi-threaded CPU version of the SNR with sigma cut, for data in DMs-samples order.
+ ** The output has the same layout, padding included, as the output of getSNRSigmaCutDMsSamplesOpenCL.
+ **
+ ** @param input The input data in beam-DM-time order.
+ ** @param outputSNR SNR of the highest peak per DM.
+ ** @param outputSample Position of the highest peak per DM.
+ ** @param observation The object representing the observation.
+ ** @param nrSamples The number of samples per time series.
+ ** @param padding The padding in memory.
+ ** @param nSigma The number of standard deviations difference for the sigma cut.
+ ** @param correctionFactor The correction factor for the clipped standard deviation (optional).
+ */
 template <typename DataType>
-std::string *getMaxDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding)
-{
-    std::string *code = new std::string();
-    unsigned int nrSamples = 0;
-    unsigned int nrDMs = 0;
-
-    if (conf.getSubbandDedispersion())
-    {
-        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
-    }
-    else
-    {
-        nrDMs = observation.getNrDMs();
-    }
-    nrSamples = observation.getNrSamplesPerBatch() / downsampling;
-    // Generate source code
-    *code = "__kernel void max_DMsSamples_" + std::to_string(nrSamples) + "(__global const " + dataName + " * const restrict time_series, __global " + dataName + " * const restrict max_values, __global unsigned int * const restrict max_indices) {\n"
-        "<%LOCAL_VARIABLES%>"
-        "__local " + dataName + " reduction_value[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
-        "__local unsigned int reduction_index[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
-        "\n"
-        "for ( unsigned int value_id = get_local_id(0) + " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + "; value_id < " + std::to_string(nrSamples) + "; value_id += " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + " ) {\n"
-        + dataName + " value;\n"
-        "\n"
-        "<%LOCAL_COMPUTE%>"
-        "}\n"
-        "<%LOCAL_REDUCE%>"
-        "reduction_value[get_local_id(0)] = value_0;\n"
-        "reduction_index[get_local_id(0)] = index_0;\n"
-        "barrier(CLK_LOCAL_MEM_FENCE);\n"
-        "unsigned int threshold = " + std::to_string(conf.getNrThreadsD0() / 2) + ";\n"
-        "for ( unsigned int value_id = get_local_id(0); threshold > 0; threshold /= 2 ) {\n"
-        "if ( (value_id < threshold) && (reduction_value[value_id + threshold] > value_0) ) {\n"
-        "value_0 = reduction_value[value_id + threshold];\n"
-        "reduction_value[value_id] = value_0;\n"
-        "index_0 = reduction_index[value_id + threshold];\n"
-        "reduction_index[value_id] = index_0;\n"
-        "}\n"
-        "barrier(CLK_LOCAL_MEM_FENCE);\n"
-        "}\n"
-        "if ( get_local_id(0) == 0 ) {\n"
-        "max_values[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + get_group_id(1)] = value_0;\n"
-        "max_indices[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + ") + get_group_id(1)] = index_0;\n"
-        "}\n"
-        "}\n";
-    std::string localVariablesTemplate = dataName + " value_<%ITEM_NUMBER%> = time_series[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + get_local_id(0) + <%ITEM_OFFSET%>];\n"
-        "unsigned int index_<%ITEM_NUMBER%> = get_local_id(0) + <%ITEM_OFFSET%>;\n";
-    std::string localComputeNoCheckTemplate = "value = time_series[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + value_id + <%ITEM_OFFSET%>];\n"
-        "if ( value > value_<%ITEM_NUMBER%> ) {\n"
-        "value_<%ITEM_NUMBER%> = value;\n"
-        "index_<%ITEM_NUMBER%> = value_id + <%ITEM_OFFSET%>;\n"
-        "}\n";
-    std::string localComputeCheckTemplate = "if ( value_id + <%ITEM_OFFSET%> < " + std::to_string(nrSamples) + " ) {\n"
-        "value = time_series[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + value_id + <%ITEM_OFFSET%>];\n"
-        "if ( value > value_<%ITEM_NUMBER%> ) {\n"
-        "value_<%ITEM_NUMBER%> = value;\n"
-        "index_<%ITEM_NUMBER%> = value_id + <%ITEM_OFFSET%>;\n"
-        "}\n"
-        "}\n";
-    std::string localReduceTemplate = "if ( value_<%ITEM_NUMBER%> > value_0 ) {\n"
-        "value_0 = value_<%ITEM_NUMBER%>;\n"
-        "index_0 = index_<%ITEM_NUMBER%>;\n"
-        "}\n";
-    std::string localVariables;
-    std::string localCompute;
-    std::string localReduce;
-    for (unsigned int item = 0; item < conf.getNrItemsD0(); item++)
-    {
-        std::string *temp;
-        std::string itemString = std::to_string(item);
-        std::string itemOffsetString = std::to_string(item * conf.getNrThreadsD0());
-        temp = isa::utils::replace(&localVariablesTemplate, "<%ITEM_NUMBER%>", itemString);
-        if (item == 0)
-        {
-            temp = isa::utils::replace(temp, " + <%ITEM_OFFSET%>", std::string(), true);
-        }
-        else
-        {
-            temp = isa::utils::replace(temp, "<%ITEM_OFFSET%>", itemOffsetString, true);
-        }
-        localVariables.append(*temp);
-        delete temp;
-        if ((nrSamples % (conf.getNrThreadsD0() * conf.getNrItemsD0())) == 0)
-        {
-            temp = isa::utils::replace(&localComputeNoCheckTemplate, "<%ITEM_NUMBER%>", itemString);
-        }
-        else
-        {
-            temp = isa::utils::replace(&localComputeCheckTemplate, "<%ITEM_NUMBER%>", itemString);
-        }
-        if (item == 0)
-        {
-            temp = isa::utils::replace(temp, " + <%ITEM_OFFSET%>", std::string(), true);
-        }
-        else
-        {
-            temp = isa::utils::replace(temp, "<%ITEM_OFFSET%>", itemOffsetString, true);
-        }
-        localCompute.append(*temp);
-        delete temp;
-        if (item > 0)
-        {
-            temp = isa::utils::replace(&localReduceTemplate, "<%ITEM_NUMBER%>", itemString);
-            localReduce.append(*temp);
-            delete temp;
-        }
-    }
-    code = isa::utils::replace(code, "<%LOCAL_VARIABLES%>", localVariables, true);
-    code = isa::utils::replace(code, "<%LOCAL_COMPUTE%>", localCompute, true);
-    code = isa::utils::replace(code, "<%LOCAL_REDUCE%>", localReduce, true);
-    return code;
+void snrSigmaCutCPU(const std::vector<DataType> &input, std::vector<float> &outputSNR, std::vector<unsigned int> &outputSample, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int padding, const float nSigma, const float correctionFactor = 1.0f);
+/**
+ ** @brief Generate OpenCL code for the SNR with iterative sigma cut, for data in DMs-samples order.
+ ** The sigma cut is repeated with the mean and standard deviation of the samples kept by the previous cut, until the number of kept samples does not change or maxIterations cuts are done.
+ ** When the time series and the reduction buffers fit in 32 KB, the minimum local memory size of OpenCL devices, the time series is read from global memory once and kept in local memory for all cuts.
+ ** With maxIterations equal to one, the result is the same as the one of getSNRSigmaCutDMsSamplesOpenCL.
+ **
+ ** @param conf The kernel configuration.
+ ** @param dataName A string representing the data type used in the kernel.
+ ** @param observation The object representing the observation.
+ ** @param nrSamples The number of samples per time series.
+ ** @param padding The padding in memory.
+ ** @param nSigma The number of standard deviations difference for the sigma cut.
+ ** @param maxIterations The maximum number of sigma cuts.
+ ** @param correctionFactor The correction factor for the clipped standard deviation (optional).
+ */
+template <typename T>
+std::string *getSNRIterativeSigmaCutDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int padding, const float nSigma, const unsigned int maxIterations, const float correctionFactor = 1.0f);
+/**
+ ** @brief Generate the body of the iterative "sigma cut" kernels, shared by the SNR and max and standard deviation variants.
+ ** The code contains the <%NAME%> prefix of the kernel name, the <%OUTPUT_ARGS%> output arguments, and the <%STORE%> code executed by the first work-item with max0, maxSample0, mean, cut_counter and cut_variance; every variant replaces them.
+ */
+template <typename T>
+std::string *getIterativeSigmaCutDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int padding, const float nSigma, const unsigned int maxIterations);
+/**
+ ** @brief CPU control version of the SNR with iterative sigma cut.
+ **
+ ** @param timeSeries The input data in DM-time order.
+ ** @param snr SNR of the highest peak per DM.
+ ** @param observation The object representing the observation.
+ ** @param padding The padding in memory.
+ ** @param nSigma The number of standard deviations difference for the sigma cut.
+ ** @param maxIterations The maximum number of sigma cuts.
+ ** @param correctionFactor The correction factor for the clipped standard deviation (optional).
+ */
+template <typename NumericType>
+void snrIterativeSigmaCut(const std::vector<NumericType> &timeSeries, std::vector<NumericType> &snr, const AstroData::Observation &observation, const unsigned int padding, const float nSigma, const unsigned int maxIterations, const float correctionFactor = 1.0f);
+/**
+ ** @brief Compute the statistics of a contiguous time series on the CPU, repeating the sigma cut until the number of kept samples does not change or maxIterations cuts are done.
+ ** Only the counter, mean and variance fields of the result are meaningful.
+ **
+ ** @param timeSeries Pointer to the first sample of the time series.
+ ** @param nrSamples The number of samples in the time series.
+ ** @param statistics The statistics of the complete time series.
+ ** @param nSigma The number of standard deviations difference for the sigma cut.
+ ** @param maxIterations The maximum number of sigma cuts.
+ */
+template <typename DataType>
+TimeSeriesStatistics<DataType> iterativeSigmaCutStatistics(const DataType *timeSeries, const unsigned int nrSamples, const TimeSeriesStatistics<DataType> &statistics, const float nSigma, const unsigned int maxIterations);
+/**
+ ** @brief Multi-threaded CPU version of the SNR with iterative sigma cut, for data in DMs-samples order.
+ ** The output has the same layout, padding included, as the output of getSNRIterativeSigmaCutDMsSamplesOpenCL.
+ */
+template <typename DataType>
+void snrIterativeSigmaCutCPU(const std::vector<DataType> &input, std::vector<float> &outputSNR, std::vector<unsigned int> &outputSample, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int padding, const float nSigma, const unsigned int maxIterations, const float correctionFactor = 1.0f);
+/**
+ ** @brief Generate OpenCL code for the SNR computed with median of medians and median of medians absolute deviation.
+ ** One work-group reads a whole time series in local memory, and computes the maximum, the median of medians used as baseline, and the median of medians absolute deviation used as standard deviation, without writing intermediate data to global memory.
+ ** The time series must fit in local memory: throws std::invalid_argument if getSNRMedianOfMediansAbsoluteDeviationLocalMemory is larger than minLocalMemorySize, in which case the median of medians and median of medians absolute deviation kernels have to be used instead.
+ **
+ ** @param conf The kernel configuration.
+ ** @param dataName A string representing the data type used in the kernel.
+ ** @param observation The object representing the observation.
+ ** @param nrSamples The number of samples per time series.
+ ** @param stepSize The number of samples of every step of the median of medians.
+ ** @param padding The padding in memory.
+ ** @param correctionFactor The factor to scale the median absolute deviation to a standard deviation (optional).
+ */
+template <typename T>
+std::string *getSNRMedianOfMediansAbsoluteDeviationDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int stepSize, const unsigned int padding, const float correctionFactor = 1.4826f);
+/**
+ ** @brief Local memory, in bytes, used by the kernel of getSNRMedianOfMediansAbsoluteDeviationDMsSamplesOpenCL.
+ */
+template <typename T>
+uint64_t getSNRMedianOfMediansAbsoluteDeviationLocalMemory(const snrConf &conf, const unsigned int nrSamples, const unsigned int stepSize);
+/**
+ ** @brief Multi-threaded CPU version of the SNR computed with median of medians and median of medians absolute deviation, for data in DMs-samples order.
+ ** The output has the same layout, padding included, as the output of getSNRMedianOfMediansAbsoluteDeviationDMsSamplesOpenCL.
+ **
+ ** @param stepSize The number of samples of every step of the median of medians.
+ ** @param input The input data in beam-DM-time order.
+ ** @param outputSNR SNR of the highest peak per DM.
+ ** @param outputSample Position of the highest peak per DM.
+ ** @param observation The object representing the observation.
+ ** @param nrSamples The number of samples per time series.
+ ** @param padding The padding in memory.
+ ** @param correctionFactor The factor to scale the median absolute deviation to a standard deviation (optional).
+ */
+template <typename DataType>
+void snrMedianOfMediansAbsoluteDeviationCPU(const unsigned int stepSize, const std::vector<DataType> &input, std::vector<float> &outputSNR, std::vector<unsigned int> &outputSample, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int padding, const float correctionFactor = 1.4826f);
+/**
+ ** @brief Generate OpenCL code for the multi-width boxcar SNR.
+ ** One work-group stores the prefix sum of a whole time series, with the mean removed, in local memory, and uses it to compute the SNR of every boxcar of the given widths in one pass.
+ ** The outputs are the highest SNR, the width of the boxcar, and the first sample of the boxcar, per DM.
+ ** The number of work-items must be a power of two.
+ ** The time series must fit in local memory: throws std::invalid_argument if getSNRBoxcarLocalMemory is larger than minLocalMemorySize.
+ **
+ ** @param conf The kernel configuration.
+ ** @param dataName A string representing the data type used in the kernel.
+ ** @param observation The object representing the observation.
+ ** @param nrSamples The number of samples per time series.
+ ** @param widths The widths, in samples, of the boxcars.
+ ** @param padding The padding in memory.
+ */
+template <typename T>
+std::string *getSNRBoxcarDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int nrSamples, const std::vector<unsigned int> &widths, const unsigned int padding);
+/**
+ ** @brief Local memory, in bytes, used by the kernel of getSNRBoxcarDMsSamplesOpenCL.
+ */
+template <typename T>
+uint64_t getSNRBoxcarLocalMemory(const snrConf &conf, const unsigned int nrSamples);
+/**
+ ** @brief Multi-threaded CPU version of the multi-width boxcar SNR, for data in DMs-samples order.
+ ** The outputs have the same layout, padding included, as the outputs of getSNRBoxcarDMsSamplesOpenCL.
+ **
+ ** @param input The input data in beam-DM-time order.
+ ** @param outputSNR Highest boxcar SNR per DM.
+ ** @param outputWidth Width of the boxcar with the highest SNR per DM.
+ ** @param outputSample First sample of the boxcar with the highest SNR per DM.
+ ** @param observation The object representing the observation.
+ ** @param nrSamples The number of samples per time series.
+ ** @param widths The widths, in samples, of the boxcars.
+ ** @param padding The padding in memory.
+ */
+template <typename DataType>
+void snrBoxcarCPU(const std::vector<DataType> &input, std::vector<float> &outputSNR, std::vector<unsigned int> &outputWidth, std::vector<unsigned int> &outputSample, const AstroData::Observation &observation, const unsigned int nrSamples, const std::vector<unsigned int> &widths, const unsigned int padding);
+/**
+ ** @brief Generate OpenCL code for one level of the downsampling tree.
+ ** The kernel computes the SNR of every time series of the level, and writes the series downsampled by a factor 2 (sum of every two samples), that is the input of the next level.
+ ** Launching the kernel for downsampling 1, 2, 4, ..., each time on the output of the previous level, reads about twice the input cube in total.
+ ** The first level (downsampling 1) initializes the outputs, the following levels only replace them if their SNR is higher; the sample is expressed in samples of the first level.
+ ** The number of work-items must be a power of two, and not larger than half the number of samples, because every work-item starts from its own pair of samples: throws std::invalid_argument otherwise.
+ **
+ ** @param conf The kernel configuration.
+ ** @param dataName A string representing the data type used in the kernel.
+ ** @param observation The object representing the observation.
+ ** @param nrSamples The number of samples per time series, at this level.
+ ** @param downsampling The downsampling factor of this level.
+ ** @param padding The padding in memory.
+ */
+template <typename T>
+std::string *getSNRDownsamplingDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int downsampling, const unsigned int padding);
+/**
+ ** @brief Multi-threaded CPU version of the downsampling tree, for data in DMs-samples order.
+ ** All levels of a time series are computed, in a per-thread buffer, before moving to the next time series; the outputs have the same layout, padding included, as the outputs of getSNRDownsamplingDMsSamplesOpenCL.
+ **
+ ** @param input The input data in beam-DM-time order.
+ ** @param outputSNR Highest SNR of all levels per DM.
+ ** @param outputSample Position, in input samples, of the highest peak per DM.
+ ** @param outputDownsampling Downsampling factor of the level with the highest SNR per DM.
+ ** @param observation The object representing the observation.
+ ** @param nrSamples The number of samples per time series.
+ ** @param nrLevels The number of levels, the last level having downsampling 2^(nrLevels - 1).
+ ** @param padding The padding in memory.
+ */
+template <typename DataType>
+void snrDownsamplingCPU(const std::vector<DataType> &input, std::vector<float> &outputSNR, std::vector<unsigned int> &outputSample, std::vector<unsigned int> &outputDownsampling, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int nrLevels, const unsigned int padding);
+/**
+ ** @brief Generate OpenCL code for the top-K SNR.
+ ** Like getSNRDMsSamplesOpenCL, but instead of only the highest peak, the kernel keeps the nrPeaks highest samples of every time series, so that a bright spike does not hide a weaker pulse in the same batch.
+ ** Every work-item keeps its own sorted list of peaks in registers, and the lists are merged in local memory during the reduction.
+ ** The outputs contain nrPeaks consecutive elements per DM, sorted by decreasing SNR.
+ ** The number of work-items must be a power of two, and nrPeaks must not be larger than the number of samples.
+ **
+ ** @param conf The kernel configuration.
+ ** @param dataName A string representing the data type used in the kernel.
+ ** @param observation The object representing the observation.
+ ** @param nrSamples The number of samples per time series.
+ ** @param nrPeaks The number of peaks to keep per time series.
+ ** @param padding The padding in memory.
+ */
+template <typename T>
+std::string *getSNRTopKDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int nrPeaks, const unsigned int padding);
+/**
+ ** @brief Multi-threaded CPU version of the top-K SNR, for data in DMs-samples order.
+ ** The outputs have the same layout, padding included, as the outputs of getSNRTopKDMsSamplesOpenCL.
+ **
+ ** @param input The input data in beam-DM-time order.
+ ** @param outputSNR SNR of the nrPeaks highest peaks per DM.
+ ** @param outputSample Position of the nrPeaks highest peaks per DM.
+ ** @param observation The object representing the observation.
+ ** @param nrSamples The number of samples per time series.
+ ** @param nrPeaks The number of peaks to keep per time series.
+ ** @param padding The padding in memory.
+ */
+template <typename DataType>
+void snrTopKCPU(const std::vector<DataType> &input, std::vector<float> &outputSNR, std::vector<unsigned int> &outputSample, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int nrPeaks, const unsigned int padding);
+/**
+ ** @brief Generate OpenCL code for the sparse candidates SNR.
+ ** The kernel computes the SNR like getSNRDMsSamplesOpenCL, but instead of the dense per DM outputs it appends only the DMs with an SNR not lower than the threshold to a compact list, using an atomic counter.
+ ** Every candidate is stored as its SNR in candidateSNR, and as the triple (beam, DM, sample) in candidates.
+ ** The counter must be set to zero before launching the kernel; after the kernel it contains the number of candidates found, that can be larger than maxCandidates, in which case only maxCandidates are stored.
+ ** The number of work-items must be a power of two.
+ **
+ ** @param conf The kernel configuration.
+ ** @param dataName A string representing the data type used in the kernel.
+ ** @param observation The object representing the observation.
+ ** @param nrSamples The number of samples per time series.
+ ** @param threshold The minimum SNR of a candidate.
+ ** @param maxCandidates The maximum number of candidates that can be stored.
+ ** @param padding The padding in memory.
+ */
+template <typename T>
+std::string *getSNRCandidatesDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int nrSamples, const float threshold, const unsigned int maxCandidates, const unsigned int padding);
+/**
+ ** @brief Multi-threaded CPU version of the sparse candidates SNR, for data in DMs-samples order.
+ ** The candidates have the same format as the candidates of getSNRCandidatesDMsSamplesOpenCL, and are sorted by beam and DM.
+ **
+ ** @param input The input data in beam-DM-time order.
+ ** @param candidateSNR SNR of every candidate.
+ ** @param candidates Beam, DM and sample of every candidate.
+ ** @param observation The object representing the observation.
+ ** @param nrSamples The number of samples per time series.
+ ** @param threshold The minimum SNR of a candidate.
+ ** @param padding The padding in memory.
+ */
+template <typename DataType>
+void snrCandidatesCPU(const std::vector<DataType> &input, std::vector<float> &candidateSNR, std::vector<unsigned int> &candidates, const AstroData::Observation &observation, const unsigned int nrSamples, const float threshold, const unsigned int padding);
+/**
+ ** @brief Collect the candidates from the per-DM output of the SNR kernels.
+ ** Only the DMs with an SNR equal or higher than the threshold are selected, and the candidates are sorted by beam and DM.
+ **
+ ** @param outputSNR The SNR of every DM.
+ ** @param outputSample The sample of every DM.
+ ** @param outputWidth The width of every DM (e.g. boxcar width or downsampling factor), or an empty vector if all widths are 1.
+ ** @param candidates The selected candidates.
+ ** @param observation The object representing the observation.
+ ** @param threshold The minimum SNR of a candidate.
+ ** @param padding The padding in memory.
+ */
+void selectCandidates(const std::vector<float> &outputSNR, const std::vector<unsigned int> &outputSample, const std::vector<unsigned int> &outputWidth, std::vector<Candidate> &candidates, const AstroData::Observation &observation, const float threshold, const unsigned int padding);
+/**
+ ** @brief Collect the candidates from the output of the sparse candidates SNR kernel.
+ ** The width of all candidates is 1.
+ **
+ ** @param candidateSNR SNR of every candidate.
+ ** @param candidateIndices Beam, DM and sample of every candidate.
+ ** @param candidates The selected candidates.
+ */
+void selectCandidates(const std::vector<float> &candidateSNR, const std::vector<unsigned int> &candidateIndices, std::vector<Candidate> &candidates);
+/**
+ ** @brief Group candidates in DM, sample and width space using friends-of-friends.
+ ** Two candidates of the same beam are friends if their DM, sample and width differ by no more than the given distances, and every cluster contains all the friends of its members.
+ ** The candidates of each beam are hashed on a grid of cells as large as the DM and sample distances, so that friends are only searched in the neighbouring cells and the expected running time is linear in the number of candidates.
+ ** Beams are clustered in parallel; each cluster is represented by its brightest member, and clusters are sorted by beam and then by the position of their first member in the input.
+ ** Throws std::out_of_range, before clustering, if a candidate belongs to a beam that is not part of the observation.
+ **
+ ** @param candidates The candidates to cluster.
+ ** @param clusters The clusters.
+ ** @param observation The object representing the observation.
+ ** @param dmDistance The maximum DM distance between friends.
+ ** @param sampleDistance The maximum sample distance between friends.
+ ** @param widthDistance The maximum width distance between friends.
+ */
+void clusterCandidates(const std::vector<Candidate> &candidates, std::vector<Candidate> &clusters, const AstroData::Observation &observation, const unsigned int dmDistance, const unsigned int sampleDistance, const unsigned int widthDistance);
+/**
+ ** @brief Generate OpenCL code for the cross-beam max kernel.
+ ** The kernel reduces the beam-DM map of SNRs, as produced by the SNR kernels, to the DM with highest SNR for every beam and to the beam with highest SNR for every DM, in a single launch.
+ ** Every work-group reads a tile of nrThreadsD0 * nrItemsD0 DMs for all beams, so that the per-DM maxima are computed in registers; the per-beam maxima of every tile are stored in partialSNR and partialDM, and merged by the last work-group to finish.
+ ** The partial buffers must contain beams * tiles elements, where tiles is the number of DMs divided by nrThreadsD0 * nrItemsD0 and rounded up, and the counter must be zero before the first launch; the kernel resets it before terminating.
+ ** Ties are broken in favour of the lowest DM, or of the lowest beam.
+ **
+ ** @param conf The kernel configuration.
+ ** @param dataName A string representing the data type of the SNRs.
+ ** @param observation The object representing the observation.
+ ** @param padding The padding in memory.
+ */
+template <typename T>
+std::string *getSNRBeamMaxOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int padding);
+/**
+ ** @brief Multi-threaded CPU version of the cross-beam max.
+ **
+ ** @param snr The SNR of every DM, in beam-DM order.
+ ** @param beamSNR The highest SNR of every beam.
+ ** @param beamDM The DM with highest SNR of every beam.
+ ** @param dmSNR The highest SNR of every DM.
+ ** @param dmBeam The beam with highest SNR of every DM.
+ ** @param observation The object representing the observation.
+ ** @param padding The padding in memory.
+ */
+void snrBeamMaxCPU(const std::vector<float> &snr, std::vector<float> &beamSNR, std::vector<unsigned int> &beamDM, std::vector<float> &dmSNR, std::vector<unsigned int> &dmBeam, const AstroData::Observation &observation, const unsigned int padding);
+/**
+ ** @brief Generate OpenCL code for the transpose kernel.
+ ** The kernel converts the beam-DM-time cube to beam-time-DM order, or the other way around, moving square tiles of nrThreadsD0 elements per side through local memory, so that both reads and writes are coalesced.
+ ** Every work-item moves nrItemsD1 rows of the tile, so nrThreadsD1 * nrItemsD1 must be equal to nrThreadsD0.
+ **
+ ** @param ordering The ordering of the input data.
+ */
+template <typename DataType>
+std::string *getTransposeOpenCL(const snrConf &conf, const DataOrdering ordering, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding);
+template <typename DataType>
+std::string *getTransposeDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding);
+template <typename DataType>
+std::string *getTransposeSamplesDMsOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding);
+/**
+ ** @brief Multi-threaded CPU version of the transpose.
+ ** The output is resized to hold the transposed cube, with the same padding rules as the OpenCL kernels.
+ **
+ ** @param input The input data.
+ ** @param output The transposed data.
+ ** @param ordering The ordering of the input data.
+ ** @param nrBeams The number of beams.
+ ** @param nrDMs The total number of DMs.
+ ** @param nrSamples The number of samples per time series.
+ ** @param padding The padding in memory.
+ */
+template <typename DataType>
+void transpose(const std::vector<DataType> &input, std::vector<DataType> &output, const DataOrdering ordering, const unsigned int nrBeams, const unsigned int nrDMs, const unsigned int nrSamples, const unsigned int padding);
+/**
+ ** @brief Replace the row loop placeholders of a DMsSamples kernel.
+ ** <%BEGIN_ROW_LOOP%>, after the local memory declarations, defines the beam and dm of the row of the work-item, and <%END_ROW_LOOP%>, before the end of the kernel, closes the loop over the rows.
+ ** Every work-group processes the nrThreadsD1 rows of its IDs along D1 and D2 or, with nrWorkGroups larger than zero, a fixed number of work-groups along D1 loop over the (beam, DM) rows with a static stride.
+ **
+ ** @param conf The kernel configuration.
+ ** @param code The code of the kernel.
+ ** @param nrBeams The number of beams.
+ ** @param nrDMs The number of DMs.
+ */
+inline std::string *replaceRowLoopDMsSamplesOpenCL(const snrConf &conf, std::string *code, const unsigned int nrBeams, const unsigned int nrDMs);
+// Read configuration files
+void readTunedSNRConf(tunedSNRConf &tunedSNR, const std::string &snrFilename);
+
+// Implementations
+inline bool snrConf::getSubbandDedispersion() const
+{
+    return subbandDedispersion;
+}
+
+inline bool snrConf::getSubgroupReduction() const
+{
+    return subgroupReduction;
+}
+
+inline unsigned int snrConf::getVectorWidth() const
+{
+    return vectorWidth;
+}
+
+inline unsigned int snrConf::getNrWorkGroups() const
+{
+    return nrWorkGroups;
+}
+
+inline MedianStrategy snrConf::getMedianStrategy() const
+{
+    return medianStrategy;
+}
+
+inline void snrConf::setSubbandDedispersion(bool subband)
+{
+    subbandDedispersion = subband;
+}
+
+inline void snrConf::setSubgroupReduction(bool subgroup)
+{
+    subgroupReduction = subgroup;
+}
+
+inline void snrConf::setVectorWidth(unsigned int width)
+{
+    vectorWidth = width;
+}
+
+inline void snrConf::setNrWorkGroups(unsigned int workGroups)
+{
+    nrWorkGroups = workGroups;
+}
+
+inline void snrConf::setMedianStrategy(MedianStrategy strategy)
+{
+    medianStrategy = strategy;
 }
 
 template <typename DataType>
-std::string *getMaxStdSigmaCutOpenCL(const snrConf &conf, const DataOrdering ordering, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding, const float nSigma)
+std::string *getMaxOpenCL(const snrConf &conf, const DataOrdering ordering, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding)
 {
     std::string *code = 0;
 
     if (ordering == DataOrdering::DMsSamples)
     {
-        code = getMaxStdSigmaCutDMsSamplesOpenCL<DataType>(conf, dataName, observation, downsampling, padding, nSigma);
+        code = getMaxDMsSamplesOpenCL<DataType>(conf, dataName, observation, downsampling, padding);
+    }
+    else if (ordering == DataOrdering::SamplesDMs)
+    {
+        code = getMaxSamplesDMsOpenCL<DataType>(conf, dataName, observation, downsampling, padding);
+    }
+    return code;
+}
+
+inline std::string *replaceRowLoopDMsSamplesOpenCL(const snrConf &conf, std::string *code, const unsigned int nrBeams, const unsigned int nrDMs)
+{
+    std::string beginRowLoop_s;
+    std::string endRowLoop_s;
+    std::string dm_s = "dmGroup";
+
+    if (conf.getNrThreadsD1() > 1)
+    {
+        // Every row of the work-group processes a different DM
+        dm_s = "(dmGroup * " + std::to_string(conf.getNrThreadsD1()) + ") + get_local_id(1)";
     }
+    if (conf.getNrWorkGroups() > 0)
+    {
+        // Static work queue: every work-group processes the row groups whose index is congruent to its ID
+        beginRowLoop_s = "for ( unsigned int rowGroup = get_group_id(1); rowGroup < " + std::to_string((nrBeams * nrDMs) / conf.getNrThreadsD1()) + "; rowGroup += get_num_groups(1) ) {\n"
+            "const unsigned int beam = rowGroup / " + std::to_string(nrDMs / conf.getNrThreadsD1()) + ";\n"
+            "const unsigned int dmGroup = rowGroup % " + std::to_string(nrDMs / conf.getNrThreadsD1()) + ";\n";
+        endRowLoop_s = "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "}\n";
+    }
+    else
+    {
+        beginRowLoop_s = "const unsigned int beam = get_group_id(2);\n"
+            "const unsigned int dmGroup = get_group_id(1);\n";
+    }
+    beginRowLoop_s += "const unsigned int dm = " + dm_s + ";\n";
+    code = isa::utils::replace(code, "<%BEGIN_ROW_LOOP%>", beginRowLoop_s, true);
+    code = isa::utils::replace(code, "<%END_ROW_LOOP%>", endRowLoop_s, true);
     return code;
 }
 
 template <typename DataType>
-std::string *getMaxStdSigmaCutDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding, const float nSigma)
+std::string *getMaxDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding)
 {
     std::string *code = new std::string();
     unsigned int nrSamples = 0;
+    unsigned int nrVectors = 0;
     unsigned int nrDMs = 0;
 
     if (conf.getSubbandDedispersion())
@@ -330,169 +934,221 @@ std::string *getMaxStdSigmaCutDMsSamplesOpenCL(const snrConf &conf, const std::s
         nrDMs = observation.getNrDMs();
     }
     nrSamples = observation.getNrSamplesPerBatch() / downsampling;
-
+    nrVectors = nrSamples / conf.getVectorWidth();
     // Generate source code
-    *code = "__kernel void maxStdSigmaCut_DMsSamples_" + std::to_string(nrSamples) + "(__global const " + dataName + " * const restrict time_series, __global " + dataName + " * const restrict max_values, __global unsigned int * const restrict max_indices, __global " + dataName + " * const restrict stdevs) {\n"
-    "<%LOCAL_VARIABLES%>"
-    "\n"
-    "unsigned int threshold = 0;\n"
-    "float delta = 0.0f;\n"
-    "float mean_step1 = 0.0f;\n"
-    "float threshold_step2 = 0.0f;\n"
-    "__local " + dataName + " reduction_value[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
-    "__local unsigned int reduction_index[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
-    "__local float reductionCOU[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
-    "__local float reductionMEA[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
-    "__local float reductionVAR[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
-    "\n"
-    "// First pass through the data\n"
-    "for ( unsigned int value_id = get_local_id(0) + " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + "; value_id < " + std::to_string(nrSamples) + "; value_id += " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + " ) "
-    "{\n"
-    + dataName + " value;\n"
-    "<%LOCAL_COMPUTE%>"
-    "}\n"
-    "// Local reduction (if necessary)\n"
-    "<%LOCAL_REDUCE%>"
-    "reduction_value[get_local_id(0)] = value_0;\n"
-    "reduction_index[get_local_id(0)] = index_0;\n"
-    "reductionCOU[get_local_id(0)] = counter_0;\n"
-    "reductionMEA[get_local_id(0)] = mean_0;\n"
-    "reductionVAR[get_local_id(0)] = variance_0;\n"
-    "barrier(CLK_LOCAL_MEM_FENCE);\n"
-    "// Global reduction\n"
-    "threshold = " + std::to_string(conf.getNrThreadsD0() / 2) + ";\n"
-    "for ( unsigned int value_id = get_local_id(0); threshold > 0; threshold /= 2 ) {\n"
-    "if ( (value_id < threshold)) {\n"
-    "delta = reductionMEA[value_id + threshold] - mean_0;\n"
-    "counter_0 += reductionCOU[value_id + threshold];\n"
-    "mean_0 = ((reductionCOU[value_id] * mean_0) + (reductionCOU[value_id + threshold] * reductionMEA[value_id + threshold])) / counter_0;\n"
-    "variance_0 += reductionVAR[value_id + threshold] + ((delta * delta) * ((reductionCOU[value_id] * reductionCOU[value_id + threshold]) / counter_0));\n"
-    "if (reduction_value[value_id + threshold] > value_0) {\n"
-    "value_0 = reduction_value[value_id + threshold];\n"
-    "index_0 = reduction_index[value_id + threshold];\n"
-    "}\n"
-    "reductionCOU[value_id] = counter_0;\n"
-    "reduction_value[value_id] = value_0;\n"
-    "reduction_index[value_id] = index_0;\n"
-    "reductionMEA[value_id] = mean_0;\n"
-    "reductionVAR[value_id] = variance_0;\n"
-    "}\n"
-    "barrier(CLK_LOCAL_MEM_FENCE);\n"
-    "}\n"
-    "mean_step1 = reductionMEA[0];\n"
-    "threshold_step2 = (" + std::to_string(nSigma) + " * native_sqrt(reductionVAR[0] * " + std::to_string(1.0f/(nrSamples - 1)) + "f));\n"
-    "<%LOCAL_VARIABLES_2%>"
-    "// Second pass through the data\n"
-    "for ( unsigned int value_id = get_local_id(0) + " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + "; value_id < " + std::to_string(nrSamples) + "; value_id += " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + " ) "
-    "{\n"
-    + dataName + " value;\n"
-    "<%LOCAL_COMPUTE_2%>"
-    "}\n"
-    "// Local reduction (if necessary)\n"
-    "<%LOCAL_REDUCE_2%>"
-    "reductionCOU[get_local_id(0)] = counter_0;\n"
-    "reductionMEA[get_local_id(0)] = mean_0;\n"
-    "reductionVAR[get_local_id(0)] = variance_0;\n"
-    "barrier(CLK_LOCAL_MEM_FENCE);\n"
-    "// Global reduction\n"
-    "threshold = " + std::to_string(conf.getNrThreadsD0() / 2) + ";\n"
-    "for ( unsigned int value_id = get_local_id(0); threshold > 0; threshold /= 2 ) {\n"
-    "if ( (value_id < threshold)) {\n"
-    "delta = reductionMEA[value_id + threshold] - mean_0;\n"
-    "counter_0 += reductionCOU[value_id + threshold];\n"
-    "mean_0 = ((reductionCOU[value_id] * mean_0) + (reductionCOU[value_id + threshold] * reductionMEA[value_id + threshold])) / counter_0;\n"
-    "variance_0 += reductionVAR[value_id + threshold] + ((delta * delta) * ((reductionCOU[value_id] * reductionCOU[value_id + threshold]) / counter_0));\n"
-    "reductionCOU[value_id] = counter_0;\n"
-    "reductionMEA[value_id] = mean_0;\n"
-    "reductionVAR[value_id] = variance_0;\n"
-    "}\n"
-    "barrier(CLK_LOCAL_MEM_FENCE);\n"
-    "}\n"
-    "// Store\n"
-    "if ( get_local_id(0) == 0 ) {\n"
-    "max_values[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + ") + get_group_id(1)] = reduction_value[0];\n"
-    "max_indices[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + ") + get_group_id(1)] = reduction_index[0];\n"
-    "stdevs[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + get_group_id(1)] = native_sqrt(reductionVAR[0] * 1.0f/(reductionCOU[0] - 1.0f));\n"
-    "}\n"
-    "}\n";
-    // Variables declaration
-    std::string localVariablesTemplate = dataName + " value_<%ITEM_NUMBER%> = time_series[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + get_local_id(0) + <%ITEM_OFFSET%>];\n"
-    "unsigned int index_<%ITEM_NUMBER%> = get_local_id(0) + <%ITEM_OFFSET%>;\n"
-    "float counter_<%ITEM_NUMBER%> = 1.0f;\n"
-    "float variance_<%ITEM_NUMBER%> = 0.0f;\n"
-    "float mean_<%ITEM_NUMBER%> = value_<%ITEM_NUMBER%>;\n";
-    // LOCAL COMPUTE
-    // if time_series requested range is less than available values, no index check is required.
-    std::string localComputeNoCheckTemplate = "value = time_series[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + value_id + <%ITEM_OFFSET%>];\n"
-    "counter_<%ITEM_NUMBER%> += 1.0f;\n"
-    "delta = value - mean_<%ITEM_NUMBER%>;\n"
-    "mean_<%ITEM_NUMBER%> += delta / counter_<%ITEM_NUMBER%>;\n"
-    "variance_<%ITEM_NUMBER%> += delta * (value - mean_<%ITEM_NUMBER%>);\n"
-    "if ( value > value_<%ITEM_NUMBER%> ) {\n"
-    "value_<%ITEM_NUMBER%> = value;\n"
-    "index_<%ITEM_NUMBER%> = value_id + <%ITEM_OFFSET%>;\n"
-    "}\n";
-    // if time_series requested range is larger than remaining values available, index check is required.
+    *code = "__kernel void max_DMsSamples_" + std::to_string(nrSamples) + "(__global const " + dataName + " * const restrict time_series, __global " + dataName + " * const restrict max_values, __global unsigned int * const restrict max_indices) {\n"
+        "__local " + dataName + " reduction_value[" + std::to_string(conf.getNrThreadsD0() * conf.getNrThreadsD1()) + "];\n"
+        "__local unsigned int reduction_index[" + std::to_string(conf.getNrThreadsD0() * conf.getNrThreadsD1()) + "];\n"
+        "<%BEGIN_ROW_LOOP%>"
+        "<%LOCAL_VARIABLES%>"
+        "\n"
+        "for ( unsigned int value_id = get_local_id(0) + " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + "; value_id < " + std::to_string(nrVectors) + "; value_id += " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + " ) {\n"
+        + dataName + " value;\n"
+        "\n"
+        "<%LOCAL_COMPUTE%>"
+        "}\n"
+        "<%LOCAL_REDUCE%>"
+        "<%GLOBAL_REDUCE%>"
+        "if ( get_local_id(0) == 0 ) {\n"
+        "max_values[(beam * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + dm] = value_0;\n"
+        "max_indices[(beam * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + ") + dm] = index_0;\n"
+        "}\n"
+        "<%END_ROW_LOOP%>"
+        "}\n";
+    std::string globalReduce;
+    if (conf.getSubgroupReduction())
+    {
+        globalReduce = "index_0 = sub_group_reduce_min((value_0 == sub_group_reduce_max(value_0)) ? index_0 : UINT_MAX);\n"
+            "value_0 = sub_group_reduce_max(value_0);\n"
+            "if ( get_sub_group_local_id() == 0 ) {\n"
+            "reduction_value[get_sub_group_id()] = value_0;\n"
+            "reduction_index[get_sub_group_id()] = index_0;\n"
+            "}\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "if ( get_sub_group_id() == 0 ) {\n"
+            "for ( unsigned int value_id = get_sub_group_local_id(); value_id < get_num_sub_groups(); value_id += get_sub_group_size() ) {\n"
+            "if ( reduction_value[value_id] > value_0 ) {\n"
+            "value_0 = reduction_value[value_id];\n"
+            "index_0 = reduction_index[value_id];\n"
+            "}\n"
+            "}\n"
+            "index_0 = sub_group_reduce_min((value_0 == sub_group_reduce_max(value_0)) ? index_0 : UINT_MAX);\n"
+            "value_0 = sub_group_reduce_max(value_0);\n"
+            "}\n";
+    }
+    else
+    {
+        globalReduce = "reduction_value[get_local_id(0)] = value_0;\n"
+            "reduction_index[get_local_id(0)] = index_0;\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "unsigned int threshold = " + std::to_string(conf.getNrThreadsD0() / 2) + ";\n"
+            "for ( unsigned int value_id = get_local_id(0); threshold > 0; threshold /= 2 ) {\n"
+            "if ( (value_id < threshold) && (reduction_value[value_id + threshold] > value_0) ) {\n"
+            "value_0 = reduction_value[value_id + threshold];\n"
+            "reduction_value[value_id] = value_0;\n"
+            "index_0 = reduction_index[value_id + threshold];\n"
+            "reduction_index[value_id] = index_0;\n"
+            "}\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "}\n";
+        if (conf.getNrThreadsD1() > 1)
+        {
+            // Every row of the work-group reduces its own slice of the local memory
+            std::string rowOffset = "(get_local_id(1) * " + std::to_string(conf.getNrThreadsD0()) + ") + ";
+
+            for (auto array : {"reduction_value[", "reduction_index["})
+            {
+                std::string *temp = isa::utils::replace(&globalReduce, array, array + rowOffset);
+                globalReduce = *temp;
+                delete temp;
+            }
+        }
+    }
+    std::string localVariablesTemplate = dataName + " value_<%ITEM_NUMBER%> = time_series[(beam * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (dm * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + get_local_id(0) + <%ITEM_OFFSET%>];\n"
+        "unsigned int index_<%ITEM_NUMBER%> = get_local_id(0) + <%ITEM_OFFSET%>;\n";
+    std::string localComputeNoCheckTemplate = "value = time_series[(beam * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (dm * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + value_id + <%ITEM_OFFSET%>];\n"
+        "if ( value > value_<%ITEM_NUMBER%> ) {\n"
+        "value_<%ITEM_NUMBER%> = value;\n"
+        "index_<%ITEM_NUMBER%> = value_id + <%ITEM_OFFSET%>;\n"
+        "}\n";
     std::string localComputeCheckTemplate = "if ( value_id + <%ITEM_OFFSET%> < " + std::to_string(nrSamples) + " ) {\n"
-    "value = time_series[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + value_id + <%ITEM_OFFSET%>];\n"
-    "counter_<%ITEM_NUMBER%> += 1.0f;\n"
-    "delta = value - mean_<%ITEM_NUMBER%>;\n"
-    "mean_<%ITEM_NUMBER%> += delta / counter_<%ITEM_NUMBER%>;\n"
-    "variance_<%ITEM_NUMBER%> += delta * (value - mean_<%ITEM_NUMBER%>);\n"
-    "if ( value > value_<%ITEM_NUMBER%> ) {\n"
-    "value_<%ITEM_NUMBER%> = value;\n"
-    "index_<%ITEM_NUMBER%> = value_id + <%ITEM_OFFSET%>;\n"
-    "}\n"
-    "}\n";
-    // LOCAL REDUCE
-    std::string localReduceTemplate = "delta = mean_<%ITEM_NUMBER%> - mean_0;\n"
-    "counter_0 += counter_<%ITEM_NUMBER%>;\n"
-    "mean_0 = (((counter_0 - counter_<%ITEM_NUMBER%>) * mean_0) + (counter_<%ITEM_NUMBER%> * mean_<%ITEM_NUMBER%>)) / counter_0;\n"
-    "variance_0 += variance_<%ITEM_NUMBER%> + ((delta * delta) * (((counter_0 - counter_<%ITEM_NUMBER%>) * counter_<%ITEM_NUMBER%>) / counter_0));\n"
-    "if ( value_<%ITEM_NUMBER%> > value_0 ) {\n"
-    "value_0 = value_<%ITEM_NUMBER%>;\n"
-    "index_0 = index_<%ITEM_NUMBER%>;\n"
-    "}\n";
-    // Variables declaration
-    std::string localVariablesTemplate_2 = "value_<%ITEM_NUMBER%> = time_series[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + get_local_id(0) + <%ITEM_OFFSET%>];\n"
-    "variance_<%ITEM_NUMBER%> = 0.0f;\n"
-    "if ( fabs(value_<%ITEM_NUMBER%> - mean_step1) < threshold_step2 ) {\n"
-    "mean_<%ITEM_NUMBER%> = value_<%ITEM_NUMBER%>;\n"
-    "counter_<%ITEM_NUMBER%> = 1.0f;\n"
-    "} else {\n"
-    "mean_<%ITEM_NUMBER%> = 0.0f;\n"
-    "counter_<%ITEM_NUMBER%> = 0.0f;\n"
-    "}\n";
-    // LOCAL COMPUTE
-    // if time_series requested range is less than available values, no index check is required.
-    std::string localComputeNoCheckTemplate_2 = "value = time_series[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + value_id + <%ITEM_OFFSET%>];\n"
-    "if ( fabs(value - mean_step1) < threshold_step2 ) {\n"
-    "counter_<%ITEM_NUMBER%> += 1.0f;\n"
-    "delta = value - mean_<%ITEM_NUMBER%>;\n"
-    "mean_<%ITEM_NUMBER%> += delta / counter_<%ITEM_NUMBER%>;\n"
-    "variance_<%ITEM_NUMBER%> += delta * (value - mean_<%ITEM_NUMBER%>);\n"
-    "}\n";
-    // if time_series requested range is larger than remaining values available, index check is required.
-    std::string localComputeCheckTemplate_2 = "if ( value_id + <%ITEM_OFFSET%> < " + std::to_string(nrSamples) + " ) {\n"
-    "value = time_series[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + value_id + <%ITEM_OFFSET%>];\n"
-    "if ( fabs(value - mean_step1) < threshold_step2 ) {\n"
-    "counter_<%ITEM_NUMBER%> += 1.0f;\n"
-    "delta = value - mean_<%ITEM_NUMBER%>;\n"
-    "mean_<%ITEM_NUMBER%> += delta / counter_<%ITEM_NUMBER%>;\n"
-    "variance_<%ITEM_NUMBER%> += delta * (value - mean_<%ITEM_NUMBER%>);\n"
-    "}\n"
-    "}\n";
-    // LOCAL REDUCE
-    std::string localReduceTemplate_2 =
-    "delta = mean_<%ITEM_NUMBER%> - mean_0;\n"
-    "counter_0 += counter_<%ITEM_NUMBER%>;\n"
-    "mean_0 = (((counter_0 - counter_<%ITEM_NUMBER%>) * mean_0) + (counter_<%ITEM_NUMBER%> * mean_<%ITEM_NUMBER%>)) / counter_0;\n"
-    "variance_0 += variance_<%ITEM_NUMBER%> + ((delta * delta) * (((counter_0 - counter_<%ITEM_NUMBER%>) * counter_<%ITEM_NUMBER%>) / counter_0));\n";
+        "value = time_series[(beam * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (dm * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + value_id + <%ITEM_OFFSET%>];\n"
+        "if ( value > value_<%ITEM_NUMBER%> ) {\n"
+        "value_<%ITEM_NUMBER%> = value;\n"
+        "index_<%ITEM_NUMBER%> = value_id + <%ITEM_OFFSET%>;\n"
+        "}\n"
+        "}\n";
+    if (conf.getVectorWidth() > 1)
+    {
+        // Every item is a vector of contiguous samples, loaded at once and reduced in registers
+        std::string vectorWidth = std::to_string(conf.getVectorWidth());
+        std::string componentTemplate = "if ( vector_<%ITEM_NUMBER%>.s<%COMPONENT%> > value_<%ITEM_NUMBER%> ) {\n"
+            "value_<%ITEM_NUMBER%> = vector_<%ITEM_NUMBER%>.s<%COMPONENT%>;\n"
+            "index_<%ITEM_NUMBER%> = (<%VECTOR%> * " + vectorWidth + ") + <%COMPONENT_OFFSET%>;\n"
+            "}\n";
+        std::string localComputeVector = "vector_<%ITEM_NUMBER%> = vload" + vectorWidth + "(value_id + <%ITEM_OFFSET%>, time_series + (beam * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (dm * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + "));\n";
 
+        localVariablesTemplate = dataName + vectorWidth + " vector_<%ITEM_NUMBER%> = vload" + vectorWidth + "(get_local_id(0) + <%ITEM_OFFSET%>, time_series + (beam * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (dm * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + "));\n"
+            + dataName + " value_<%ITEM_NUMBER%> = vector_<%ITEM_NUMBER%>.s0;\n"
+            "unsigned int index_<%ITEM_NUMBER%> = (get_local_id(0) + <%ITEM_OFFSET%>) * " + vectorWidth + ";\n";
+        for (unsigned int component = 0; component < conf.getVectorWidth(); component++)
+        {
+            std::string *temp;
+            temp = isa::utils::replace(&componentTemplate, "<%COMPONENT%>", std::string(1, "0123456789abcdef"[component]));
+            temp = isa::utils::replace(temp, "<%COMPONENT_OFFSET%>", std::to_string(component), true);
+            if (component > 0)
+            {
+                std::string *variablesTemp = isa::utils::replace(temp, "<%VECTOR%>", "(get_local_id(0) + <%ITEM_OFFSET%>)");
+                localVariablesTemplate.append(*variablesTemp);
+                delete variablesTemp;
+            }
+            temp = isa::utils::replace(temp, "<%VECTOR%>", "(value_id + <%ITEM_OFFSET%>)", true);
+            localComputeVector.append(*temp);
+            delete temp;
+        }
+        localComputeNoCheckTemplate = localComputeVector;
+        localComputeCheckTemplate = "if ( value_id + <%ITEM_OFFSET%> < " + std::to_string(nrVectors) + " ) {\n" + localComputeVector + "}\n";
+    }
+    std::string localReduceTemplate = "if ( value_<%ITEM_NUMBER%> > value_0 ) {\n"
+        "value_0 = value_<%ITEM_NUMBER%>;\n"
+        "index_0 = index_<%ITEM_NUMBER%>;\n"
+        "}\n";
     std::string localVariables;
     std::string localCompute;
     std::string localReduce;
+    for (unsigned int item = 0; item < conf.getNrItemsD0(); item++)
+    {
+        std::string *temp;
+        std::string itemString = std::to_string(item);
+        std::string itemOffsetString = std::to_string(item * conf.getNrThreadsD0());
+        temp = isa::utils::replace(&localVariablesTemplate, "<%ITEM_NUMBER%>", itemString);
+        if (item == 0)
+        {
+            temp = isa::utils::replace(temp, " + <%ITEM_OFFSET%>", std::string(), true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%ITEM_OFFSET%>", itemOffsetString, true);
+        }
+        localVariables.append(*temp);
+        delete temp;
+        if ((nrVectors % (conf.getNrThreadsD0() * conf.getNrItemsD0())) == 0)
+        {
+            temp = isa::utils::replace(&localComputeNoCheckTemplate, "<%ITEM_NUMBER%>", itemString);
+        }
+        else
+        {
+            temp = isa::utils::replace(&localComputeCheckTemplate, "<%ITEM_NUMBER%>", itemString);
+        }
+        if (item == 0)
+        {
+            temp = isa::utils::replace(temp, " + <%ITEM_OFFSET%>", std::string(), true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%ITEM_OFFSET%>", itemOffsetString, true);
+        }
+        localCompute.append(*temp);
+        delete temp;
+        if (item > 0)
+        {
+            temp = isa::utils::replace(&localReduceTemplate, "<%ITEM_NUMBER%>", itemString);
+            localReduce.append(*temp);
+            delete temp;
+        }
+    }
+    code = isa::utils::replace(code, "<%LOCAL_VARIABLES%>", localVariables, true);
+    code = isa::utils::replace(code, "<%LOCAL_COMPUTE%>", localCompute, true);
+    code = isa::utils::replace(code, "<%LOCAL_REDUCE%>", localReduce, true);
+    code = isa::utils::replace(code, "<%GLOBAL_REDUCE%>", globalReduce, true);
+    code = replaceRowLoopDMsSamplesOpenCL(conf, code, observation.getNrSynthesizedBeams(), nrDMs);
+    if (conf.getSubgroupReduction())
+    {
+        code->insert(0, "#pragma OPENCL EXTENSION cl_khr_subgroups : enable\n");
+    }
+    return code;
+}
+
+template <typename DataType>
+std::string *getMaxSamplesDMsOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding)
+{
+    std::string *code = new std::string();
+    unsigned int nrSamples = 0;
+    unsigned int nrDMs = 0;
 
+    if (conf.getSubbandDedispersion())
+    {
+        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    }
+    else
+    {
+        nrDMs = observation.getNrDMs();
+    }
+    nrSamples = observation.getNrSamplesPerBatch() / downsampling;
+    // Generate source code
+    *code = "__kernel void max_SamplesDMs_" + std::to_string(nrDMs) + "(__global const " + dataName + " * const restrict time_series, __global " + dataName + " * const restrict max_values, __global unsigned int * const restrict max_indices) {\n"
+        "unsigned int dm = (get_group_id(0) * " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + ") + get_local_id(0);\n"
+        "<%LOCAL_VARIABLES%>"
+        "\n"
+        "for ( unsigned int sample = 1; sample < " + std::to_string(nrSamples) + "; sample++ ) {\n"
+        + dataName + " value;\n"
+        "\n"
+        "<%LOCAL_COMPUTE%>"
+        "}\n"
+        "<%STORE%>"
+        "}\n";
+    std::string localVariablesTemplate = dataName + " value_<%ITEM_NUMBER%> = time_series[(get_group_id(1) * " + std::to_string(nrSamples * isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + dm + <%ITEM_OFFSET%>];\n"
+        "unsigned int index_<%ITEM_NUMBER%> = 0;\n";
+    std::string localComputeTemplate = "value = time_series[(get_group_id(1) * " + std::to_string(nrSamples * isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + (sample * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + dm + <%ITEM_OFFSET%>];\n"
+        "if ( value > value_<%ITEM_NUMBER%> ) {\n"
+        "value_<%ITEM_NUMBER%> = value;\n"
+        "index_<%ITEM_NUMBER%> = sample;\n"
+        "}\n";
+    std::string storeTemplate = "max_values[(get_group_id(1) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + dm + <%ITEM_OFFSET%>] = value_<%ITEM_NUMBER%>;\n"
+        "max_indices[(get_group_id(1) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + ") + dm + <%ITEM_OFFSET%>] = index_<%ITEM_NUMBER%>;\n";
+    std::string localVariables;
+    std::string localCompute;
+    std::string store;
     for (unsigned int item = 0; item < conf.getNrItemsD0(); item++)
     {
         std::string *temp;
@@ -501,145 +1157,3924 @@ std::string *getMaxStdSigmaCutDMsSamplesOpenCL(const snrConf &conf, const std::s
         temp = isa::utils::replace(&localVariablesTemplate, "<%ITEM_NUMBER%>", itemString);
         if (item == 0)
         {
-            temp = isa::utils::replace(temp, " + <%ITEM_OFFSET%>", std::string(), true);
+            temp = isa::utils::replace(temp, " + <%ITEM_OFFSET%>", std::string(), true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%ITEM_OFFSET%>", itemOffsetString, true);
+        }
+        localVariables.append(*temp);
+        delete temp;
+        temp = isa::utils::replace(&localComputeTemplate, "<%ITEM_NUMBER%>", itemString);
+        if (item == 0)
+        {
+            temp = isa::utils::replace(temp, " + <%ITEM_OFFSET%>", std::string(), true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%ITEM_OFFSET%>", itemOffsetString, true);
+        }
+        localCompute.append(*temp);
+        delete temp;
+        temp = isa::utils::replace(&storeTemplate, "<%ITEM_NUMBER%>", itemString);
+        if (item == 0)
+        {
+            temp = isa::utils::replace(temp, " + <%ITEM_OFFSET%>", std::string(), true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%ITEM_OFFSET%>", itemOffsetString, true);
+        }
+        store.append(*temp);
+        delete temp;
+    }
+    code = isa::utils::replace(code, "<%LOCAL_VARIABLES%>", localVariables, true);
+    code = isa::utils::replace(code, "<%LOCAL_COMPUTE%>", localCompute, true);
+    code = isa::utils::replace(code, "<%STORE%>", store, true);
+    return code;
+}
+
+template <typename DataType>
+std::string *getMaxStdSigmaCutOpenCL(const snrConf &conf, const DataOrdering ordering, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding, const float nSigma)
+{
+    std::string *code = 0;
+
+    if (ordering == DataOrdering::DMsSamples)
+    {
+        code = getMaxStdSigmaCutDMsSamplesOpenCL<DataType>(conf, dataName, observation, downsampling, padding, nSigma);
+    }
+    else if (ordering == DataOrdering::SamplesDMs)
+    {
+        code = getMaxStdSigmaCutSamplesDMsOpenCL<DataType>(conf, dataName, observation, downsampling, padding, nSigma);
+    }
+    return code;
+}
+
+template <typename DataType>
+std::string *getMaxStdSigmaCutDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding, const float nSigma)
+{
+    std::string *code = new std::string();
+    unsigned int nrSamples = 0;
+    unsigned int nrDMs = 0;
+
+    if (conf.getSubbandDedispersion())
+    {
+        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    }
+    else
+    {
+        nrDMs = observation.getNrDMs();
+    }
+    nrSamples = observation.getNrSamplesPerBatch() / downsampling;
+
+    // Generate source code
+    *code = "__kernel void maxStdSigmaCut_DMsSamples_" + std::to_string(nrSamples) + "(__global const " + dataName + " * const restrict time_series, __global " + dataName + " * const restrict max_values, __global unsigned int * const restrict max_indices, __global " + dataName + " * const restrict stdevs) {\n"
+    "<%LOCAL_VARIABLES%>"
+    "\n"
+    "unsigned int threshold = 0;\n"
+    "float delta = 0.0f;\n"
+    "float mean_step1 = 0.0f;\n"
+    "float threshold_step2 = 0.0f;\n"
+    "__local " + dataName + " reduction_value[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+    "__local unsigned int reduction_index[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+    "__local float reductionCOU[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+    "__local float reductionMEA[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+    "__local float reductionVAR[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+    "\n"
+    "// First pass through the data\n"
+    "for ( unsigned int value_id = get_local_id(0) + " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + "; value_id < " + std::to_string(nrSamples) + "; value_id += " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + " ) "
+    "{\n"
+    + dataName + " value;\n"
+    "<%LOCAL_COMPUTE%>"
+    "}\n"
+    "// Local reduction (if necessary)\n"
+    "<%LOCAL_REDUCE%>"
+    "<%GLOBAL_REDUCE%>"
+    "mean_step1 = reductionMEA[0];\n"
+    "threshold_step2 = (" + std::to_string(nSigma) + " * native_sqrt(reductionVAR[0] * " + std::to_string(1.0f/(nrSamples - 1)) + "f));\n"
+    "<%LOCAL_VARIABLES_2%>"
+    "// Second pass through the data\n"
+    "for ( unsigned int value_id = get_local_id(0) + " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + "; value_id < " + std::to_string(nrSamples) + "; value_id += " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + " ) "
+    "{\n"
+    + dataName + " value;\n"
+    "<%LOCAL_COMPUTE_2%>"
+    "}\n"
+    "// Local reduction (if necessary)\n"
+    "<%LOCAL_REDUCE_2%>"
+    "<%GLOBAL_REDUCE_2%>"
+    "// Store\n"
+    "if ( get_local_id(0) == 0 ) {\n"
+    "max_values[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + ") + get_group_id(1)] = reduction_value[0];\n"
+    "max_indices[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + ") + get_group_id(1)] = reduction_index[0];\n"
+    "stdevs[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + get_group_id(1)] = native_sqrt(reductionVAR[0] * 1.0f/(reductionCOU[0] - 1.0f));\n"
+    "}\n"
+    "}\n";
+    std::string globalReduce;
+    if (conf.getSubgroupReduction())
+    {
+        globalReduce = "delta = sub_group_reduce_add(counter_0 * mean_0) / sub_group_reduce_add(counter_0);\n"
+            "variance_0 = sub_group_reduce_add(variance_0 + ((counter_0 * (mean_0 - delta)) * (mean_0 - delta)));\n"
+            "counter_0 = sub_group_reduce_add(counter_0);\n"
+            "mean_0 = delta;\n"
+            "index_0 = sub_group_reduce_min((value_0 == sub_group_reduce_max(value_0)) ? index_0 : UINT_MAX);\n"
+            "value_0 = sub_group_reduce_max(value_0);\n"
+            "if ( get_sub_group_local_id() == 0 ) {\n"
+            "reduction_value[get_sub_group_id()] = value_0;\n"
+            "reduction_index[get_sub_group_id()] = index_0;\n"
+            "reductionCOU[get_sub_group_id()] = counter_0;\n"
+            "reductionMEA[get_sub_group_id()] = mean_0;\n"
+            "reductionVAR[get_sub_group_id()] = variance_0;\n"
+            "}\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "// Global reduction\n"
+            "if ( get_sub_group_id() == 0 ) {\n"
+            "counter_0 = 0.0f;\n"
+            "mean_0 = 0.0f;\n"
+            "variance_0 = 0.0f;\n"
+            "for ( unsigned int value_id = get_sub_group_local_id(); value_id < get_num_sub_groups(); value_id += get_sub_group_size() ) {\n"
+            "delta = reductionMEA[value_id] - mean_0;\n"
+            "counter_0 += reductionCOU[value_id];\n"
+            "mean_0 = (((counter_0 - reductionCOU[value_id]) * mean_0) + (reductionCOU[value_id] * reductionMEA[value_id])) / counter_0;\n"
+            "variance_0 += reductionVAR[value_id] + ((delta * delta) * (((counter_0 - reductionCOU[value_id]) * reductionCOU[value_id]) / counter_0));\n"
+            "if (reduction_value[value_id] > value_0) {\n"
+            "value_0 = reduction_value[value_id];\n"
+            "index_0 = reduction_index[value_id];\n"
+            "}\n"
+            "}\n"
+            "delta = sub_group_reduce_add(counter_0 * mean_0) / sub_group_reduce_add(counter_0);\n"
+            "variance_0 = sub_group_reduce_add(variance_0 + ((counter_0 * (mean_0 - delta)) * (mean_0 - delta)));\n"
+            "counter_0 = sub_group_reduce_add(counter_0);\n"
+            "mean_0 = delta;\n"
+            "index_0 = sub_group_reduce_min((value_0 == sub_group_reduce_max(value_0)) ? index_0 : UINT_MAX);\n"
+            "value_0 = sub_group_reduce_max(value_0);\n"
+            "}\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "if ( get_local_id(0) == 0 ) {\n"
+            "reduction_value[0] = value_0;\n"
+            "reduction_index[0] = index_0;\n"
+            "reductionCOU[0] = counter_0;\n"
+            "reductionMEA[0] = mean_0;\n"
+            "reductionVAR[0] = variance_0;\n"
+            "}\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n";
+    }
+    else
+    {
+        globalReduce = "reduction_value[get_local_id(0)] = value_0;\n"
+            "reduction_index[get_local_id(0)] = index_0;\n"
+            "reductionCOU[get_local_id(0)] = counter_0;\n"
+            "reductionMEA[get_local_id(0)] = mean_0;\n"
+            "reductionVAR[get_local_id(0)] = variance_0;\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "// Global reduction\n"
+            "threshold = " + std::to_string(conf.getNrThreadsD0() / 2) + ";\n"
+            "for ( unsigned int value_id = get_local_id(0); threshold > 0; threshold /= 2 ) {\n"
+            "if ( (value_id < threshold)) {\n"
+            "delta = reductionMEA[value_id + threshold] - mean_0;\n"
+            "counter_0 += reductionCOU[value_id + threshold];\n"
+            "mean_0 = ((reductionCOU[value_id] * mean_0) + (reductionCOU[value_id + threshold] * reductionMEA[value_id + threshold])) / counter_0;\n"
+            "variance_0 += reductionVAR[value_id + threshold] + ((delta * delta) * ((reductionCOU[value_id] * reductionCOU[value_id + threshold]) / counter_0));\n"
+            "if (reduction_value[value_id + threshold] > value_0) {\n"
+            "value_0 = reduction_value[value_id + threshold];\n"
+            "index_0 = reduction_index[value_id + threshold];\n"
+            "}\n"
+            "reductionCOU[value_id] = counter_0;\n"
+            "reduction_value[value_id] = value_0;\n"
+            "reduction_index[value_id] = index_0;\n"
+            "reductionMEA[value_id] = mean_0;\n"
+            "reductionVAR[value_id] = variance_0;\n"
+            "}\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "}\n";
+    }
+    std::string globalReduce_2;
+    if (conf.getSubgroupReduction())
+    {
+        globalReduce_2 = "delta = sub_group_reduce_add(counter_0 * mean_0) / sub_group_reduce_add(counter_0);\n"
+            "variance_0 = sub_group_reduce_add(variance_0 + ((counter_0 * (mean_0 - delta)) * (mean_0 - delta)));\n"
+            "counter_0 = sub_group_reduce_add(counter_0);\n"
+            "mean_0 = delta;\n"
+            "if ( get_sub_group_local_id() == 0 ) {\n"
+            "reductionCOU[get_sub_group_id()] = counter_0;\n"
+            "reductionMEA[get_sub_group_id()] = mean_0;\n"
+            "reductionVAR[get_sub_group_id()] = variance_0;\n"
+            "}\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "// Global reduction\n"
+            "if ( get_sub_group_id() == 0 ) {\n"
+            "counter_0 = 0.0f;\n"
+            "mean_0 = 0.0f;\n"
+            "variance_0 = 0.0f;\n"
+            "for ( unsigned int value_id = get_sub_group_local_id(); value_id < get_num_sub_groups(); value_id += get_sub_group_size() ) {\n"
+            "delta = reductionMEA[value_id] - mean_0;\n"
+            "counter_0 += reductionCOU[value_id];\n"
+            "mean_0 = (((counter_0 - reductionCOU[value_id]) * mean_0) + (reductionCOU[value_id] * reductionMEA[value_id])) / counter_0;\n"
+            "variance_0 += reductionVAR[value_id] + ((delta * delta) * (((counter_0 - reductionCOU[value_id]) * reductionCOU[value_id]) / counter_0));\n"
+            "}\n"
+            "delta = sub_group_reduce_add(counter_0 * mean_0) / sub_group_reduce_add(counter_0);\n"
+            "variance_0 = sub_group_reduce_add(variance_0 + ((counter_0 * (mean_0 - delta)) * (mean_0 - delta)));\n"
+            "counter_0 = sub_group_reduce_add(counter_0);\n"
+            "mean_0 = delta;\n"
+            "}\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "if ( get_local_id(0) == 0 ) {\n"
+            "reductionCOU[0] = counter_0;\n"
+            "reductionMEA[0] = mean_0;\n"
+            "reductionVAR[0] = variance_0;\n"
+            "}\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n";
+    }
+    else
+    {
+        globalReduce_2 = "reductionCOU[get_local_id(0)] = counter_0;\n"
+            "reductionMEA[get_local_id(0)] = mean_0;\n"
+            "reductionVAR[get_local_id(0)] = variance_0;\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "// Global reduction\n"
+            "threshold = " + std::to_string(conf.getNrThreadsD0() / 2) + ";\n"
+            "for ( unsigned int value_id = get_local_id(0); threshold > 0; threshold /= 2 ) {\n"
+            "if ( (value_id < threshold)) {\n"
+            "delta = reductionMEA[value_id + threshold] - mean_0;\n"
+            "counter_0 += reductionCOU[value_id + threshold];\n"
+            "mean_0 = ((reductionCOU[value_id] * mean_0) + (reductionCOU[value_id + threshold] * reductionMEA[value_id + threshold])) / counter_0;\n"
+            "variance_0 += reductionVAR[value_id + threshold] + ((delta * delta) * ((reductionCOU[value_id] * reductionCOU[value_id + threshold]) / counter_0));\n"
+            "reductionCOU[value_id] = counter_0;\n"
+            "reductionMEA[value_id] = mean_0;\n"
+            "reductionVAR[value_id] = variance_0;\n"
+            "}\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "}\n";
+    }
+    // Variables declaration
+    std::string localVariablesTemplate = dataName + " value_<%ITEM_NUMBER%> = time_series[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + get_local_id(0) + <%ITEM_OFFSET%>];\n"
+    "unsigned int index_<%ITEM_NUMBER%> = get_local_id(0) + <%ITEM_OFFSET%>;\n"
+    "float counter_<%ITEM_NUMBER%> = 1.0f;\n"
+    "float variance_<%ITEM_NUMBER%> = 0.0f;\n"
+    "float mean_<%ITEM_NUMBER%> = value_<%ITEM_NUMBER%>;\n";
+    // LOCAL COMPUTE
+    // if time_series requested range is less than available values, no index check is required.
+    std::string localComputeNoCheckTemplate = "value = time_series[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + value_id + <%ITEM_OFFSET%>];\n"
+    "counter_<%ITEM_NUMBER%> += 1.0f;\n"
+    "delta = value - mean_<%ITEM_NUMBER%>;\n"
+    "mean_<%ITEM_NUMBER%> += delta / counter_<%ITEM_NUMBER%>;\n"
+    "variance_<%ITEM_NUMBER%> += delta * (value - mean_<%ITEM_NUMBER%>);\n"
+    "if ( value > value_<%ITEM_NUMBER%> ) {\n"
+    "value_<%ITEM_NUMBER%> = value;\n"
+    "index_<%ITEM_NUMBER%> = value_id + <%ITEM_OFFSET%>;\n"
+    "}\n";
+    // if time_series requested range is larger than remaining values available, index check is required.
+    std::string localComputeCheckTemplate = "if ( value_id + <%ITEM_OFFSET%> < " + std::to_string(nrSamples) + " ) {\n"
+    "value = time_series[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + value_id + <%ITEM_OFFSET%>];\n"
+    "counter_<%ITEM_NUMBER%> += 1.0f;\n"
+    "delta = value - mean_<%ITEM_NUMBER%>;\n"
+    "mean_<%ITEM_NUMBER%> += delta / counter_<%ITEM_NUMBER%>;\n"
+    "variance_<%ITEM_NUMBER%> += delta * (value - mean_<%ITEM_NUMBER%>);\n"
+    "if ( value > value_<%ITEM_NUMBER%> ) {\n"
+    "value_<%ITEM_NUMBER%> = value;\n"
+    "index_<%ITEM_NUMBER%> = value_id + <%ITEM_OFFSET%>;\n"
+    "}\n"
+    "}\n";
+    // LOCAL REDUCE
+    std::string localReduceTemplate = "delta = mean_<%ITEM_NUMBER%> - mean_0;\n"
+    "counter_0 += counter_<%ITEM_NUMBER%>;\n"
+    "mean_0 = (((counter_0 - counter_<%ITEM_NUMBER%>) * mean_0) + (counter_<%ITEM_NUMBER%> * mean_<%ITEM_NUMBER%>)) / counter_0;\n"
+    "variance_0 += variance_<%ITEM_NUMBER%> + ((delta * delta) * (((counter_0 - counter_<%ITEM_NUMBER%>) * counter_<%ITEM_NUMBER%>) / counter_0));\n"
+    "if ( value_<%ITEM_NUMBER%> > value_0 ) {\n"
+    "value_0 = value_<%ITEM_NUMBER%>;\n"
+    "index_0 = index_<%ITEM_NUMBER%>;\n"
+    "}\n";
+    // Variables declaration
+    std::string localVariablesTemplate_2 = "value_<%ITEM_NUMBER%> = time_series[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + get_local_id(0) + <%ITEM_OFFSET%>];\n"
+    "variance_<%ITEM_NUMBER%> = 0.0f;\n"
+    "if ( fabs(value_<%ITEM_NUMBER%> - mean_step1) < threshold_step2 ) {\n"
+    "mean_<%ITEM_NUMBER%> = value_<%ITEM_NUMBER%>;\n"
+    "counter_<%ITEM_NUMBER%> = 1.0f;\n"
+    "} else {\n"
+    "mean_<%ITEM_NUMBER%> = 0.0f;\n"
+    "counter_<%ITEM_NUMBER%> = 0.0f;\n"
+    "}\n";
+    // LOCAL COMPUTE
+    // if time_series requested range is less than available values, no index check is required.
+    std::string localComputeNoCheckTemplate_2 = "value = time_series[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + value_id + <%ITEM_OFFSET%>];\n"
+    "if ( fabs(value - mean_step1) < threshold_step2 ) {\n"
+    "counter_<%ITEM_NUMBER%> += 1.0f;\n"
+    "delta = value - mean_<%ITEM_NUMBER%>;\n"
+    "mean_<%ITEM_NUMBER%> += delta / counter_<%ITEM_NUMBER%>;\n"
+    "variance_<%ITEM_NUMBER%> += delta * (value - mean_<%ITEM_NUMBER%>);\n"
+    "}\n";
+    // if time_series requested range is larger than remaining values available, index check is required.
+    std::string localComputeCheckTemplate_2 = "if ( value_id + <%ITEM_OFFSET%> < " + std::to_string(nrSamples) + " ) {\n"
+    "value = time_series[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + value_id + <%ITEM_OFFSET%>];\n"
+    "if ( fabs(value - mean_step1) < threshold_step2 ) {\n"
+    "counter_<%ITEM_NUMBER%> += 1.0f;\n"
+    "delta = value - mean_<%ITEM_NUMBER%>;\n"
+    "mean_<%ITEM_NUMBER%> += delta / counter_<%ITEM_NUMBER%>;\n"
+    "variance_<%ITEM_NUMBER%> += delta * (value - mean_<%ITEM_NUMBER%>);\n"
+    "}\n"
+    "}\n";
+    // LOCAL REDUCE
+    std::string localReduceTemplate_2 =
+    "delta = mean_<%ITEM_NUMBER%> - mean_0;\n"
+    "counter_0 += counter_<%ITEM_NUMBER%>;\n"
+    "mean_0 = (((counter_0 - counter_<%ITEM_NUMBER%>) * mean_0) + (counter_<%ITEM_NUMBER%> * mean_<%ITEM_NUMBER%>)) / counter_0;\n"
+    "variance_0 += variance_<%ITEM_NUMBER%> + ((delta * delta) * (((counter_0 - counter_<%ITEM_NUMBER%>) * counter_<%ITEM_NUMBER%>) / counter_0));\n";
+
+    std::string localVariables;
+    std::string localCompute;
+    std::string localReduce;
+
+    for (unsigned int item = 0; item < conf.getNrItemsD0(); item++)
+    {
+        std::string *temp;
+        std::string itemString = std::to_string(item);
+        std::string itemOffsetString = std::to_string(item * conf.getNrThreadsD0());
+        temp = isa::utils::replace(&localVariablesTemplate, "<%ITEM_NUMBER%>", itemString);
+        if (item == 0)
+        {
+            temp = isa::utils::replace(temp, " + <%ITEM_OFFSET%>", std::string(), true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%ITEM_OFFSET%>", itemOffsetString, true);
+        }
+        localVariables.append(*temp);
+        delete temp;
+        if ((nrSamples % (conf.getNrThreadsD0() * conf.getNrItemsD0())) == 0)
+        {
+            temp = isa::utils::replace(&localComputeNoCheckTemplate, "<%ITEM_NUMBER%>", itemString);
+        }
+        else
+        {
+            temp = isa::utils::replace(&localComputeCheckTemplate, "<%ITEM_NUMBER%>", itemString);
+        }
+        if (item == 0)
+        {
+            temp = isa::utils::replace(temp, " + <%ITEM_OFFSET%>", std::string(), true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%ITEM_OFFSET%>", itemOffsetString, true);
+        }
+        localCompute.append(*temp);
+        delete temp;
+        if (item > 0)
+        {
+            temp = isa::utils::replace(&localReduceTemplate, "<%ITEM_NUMBER%>", itemString);
+            localReduce.append(*temp);
+            delete temp;
+        }
+    }
+    code = isa::utils::replace(code, "<%LOCAL_VARIABLES%>", localVariables, true);
+    code = isa::utils::replace(code, "<%LOCAL_COMPUTE%>", localCompute, true);
+    code = isa::utils::replace(code, "<%LOCAL_REDUCE%>", localReduce, true);
+    code = isa::utils::replace(code, "<%GLOBAL_REDUCE%>", globalReduce, true);
+
+    std::string localVariables_2;
+    std::string localCompute_2;
+    std::string localReduce_2;
+
+    for (unsigned int item = 0; item < conf.getNrItemsD0(); item++)
+    {
+        std::string *temp;
+        std::string itemString = std::to_string(item);
+        std::string itemOffsetString = std::to_string(item * conf.getNrThreadsD0());
+        temp = isa::utils::replace(&localVariablesTemplate_2, "<%ITEM_NUMBER%>", itemString);
+        if (item == 0)
+        {
+            temp = isa::utils::replace(temp, " + <%ITEM_OFFSET%>", std::string(), true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%ITEM_OFFSET%>", itemOffsetString, true);
+        }
+        localVariables_2.append(*temp);
+        delete temp;
+        if ((nrSamples % (conf.getNrThreadsD0() * conf.getNrItemsD0())) == 0)
+        {
+            temp = isa::utils::replace(&localComputeNoCheckTemplate_2, "<%ITEM_NUMBER%>", itemString);
+        }
+        else
+        {
+            temp = isa::utils::replace(&localComputeCheckTemplate_2, "<%ITEM_NUMBER%>", itemString);
+        }
+        if (item == 0)
+        {
+            temp = isa::utils::replace(temp, " + <%ITEM_OFFSET%>", std::string(), true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%ITEM_OFFSET%>", itemOffsetString, true);
+        }
+        localCompute_2.append(*temp);
+        delete temp;
+        if (item > 0)
+        {
+            temp = isa::utils::replace(&localReduceTemplate_2, "<%ITEM_NUMBER%>", itemString);
+            localReduce_2.append(*temp);
+            delete temp;
+        }
+    }
+    code = isa::utils::replace(code, "<%LOCAL_VARIABLES_2%>", localVariables_2, true);
+    code = isa::utils::replace(code, "<%LOCAL_COMPUTE_2%>", localCompute_2, true);
+    code = isa::utils::replace(code, "<%LOCAL_REDUCE_2%>", localReduce_2, true);
+    code = isa::utils::replace(code, "<%GLOBAL_REDUCE_2%>", globalReduce_2, true);
+    if (conf.getSubgroupReduction())
+    {
+        code->insert(0, "#pragma OPENCL EXTENSION cl_khr_subgroups : enable\n");
+    }
+
+    return code;
+}
+
+template <typename DataType>
+std::string *getMaxStdSigmaCutSamplesDMsOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding, const float nSigma)
+{
+    std::string *code = new std::string();
+    unsigned int nrSamples = 0;
+    unsigned int nrDMs = 0;
+
+    if (conf.getSubbandDedispersion())
+    {
+        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    }
+    else
+    {
+        nrDMs = observation.getNrDMs();
+    }
+    nrSamples = observation.getNrSamplesPerBatch() / downsampling;
+
+    // Generate source code
+    *code = "__kernel void maxStdSigmaCut_SamplesDMs_" + std::to_string(nrDMs) + "(__global const " + dataName + " * const restrict time_series, __global " + dataName + " * const restrict max_values, __global unsigned int * const restrict max_indices, __global " + dataName + " * const restrict stdevs) {\n"
+    "unsigned int dm = (get_group_id(0) * " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + ") + get_local_id(0);\n"
+    "float delta = 0.0f;\n"
+    + dataName + " value;\n"
+    "<%LOCAL_VARIABLES%>"
+    "\n"
+    "// First pass through the data\n"
+    "for ( unsigned int sample = 1; sample < " + std::to_string(nrSamples) + "; sample++ ) {\n"
+    "<%LOCAL_COMPUTE%>"
+    "}\n"
+    "<%LOCAL_VARIABLES_2%>"
+    "// Second pass through the data\n"
+    "for ( unsigned int sample = 0; sample < " + std::to_string(nrSamples) + "; sample++ ) {\n"
+    "<%LOCAL_COMPUTE_2%>"
+    "}\n"
+    "// Store\n"
+    "<%STORE%>"
+    "}\n";
+    // Variables declaration
+    std::string localVariablesTemplate = dataName + " value_<%ITEM_NUMBER%> = time_series[(get_group_id(1) * " + std::to_string(nrSamples * isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + dm + <%ITEM_OFFSET%>];\n"
+    "unsigned int index_<%ITEM_NUMBER%> = 0;\n"
+    "float counter_<%ITEM_NUMBER%> = 1.0f;\n"
+    "float variance_<%ITEM_NUMBER%> = 0.0f;\n"
+    "float mean_<%ITEM_NUMBER%> = value_<%ITEM_NUMBER%>;\n";
+    // LOCAL COMPUTE
+    std::string localComputeTemplate = "value = time_series[(get_group_id(1) * " + std::to_string(nrSamples * isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + (sample * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + dm + <%ITEM_OFFSET%>];\n"
+    "counter_<%ITEM_NUMBER%> += 1.0f;\n"
+    "delta = value - mean_<%ITEM_NUMBER%>;\n"
+    "mean_<%ITEM_NUMBER%> += delta / counter_<%ITEM_NUMBER%>;\n"
+    "variance_<%ITEM_NUMBER%> += delta * (value - mean_<%ITEM_NUMBER%>);\n"
+    "if ( value > value_<%ITEM_NUMBER%> ) {\n"
+    "value_<%ITEM_NUMBER%> = value;\n"
+    "index_<%ITEM_NUMBER%> = sample;\n"
+    "}\n";
+    // Variables declaration
+    std::string localVariablesTemplate_2 = "float mean_step1_<%ITEM_NUMBER%> = mean_<%ITEM_NUMBER%>;\n"
+    "float threshold_step2_<%ITEM_NUMBER%> = (" + std::to_string(nSigma) + " * native_sqrt(variance_<%ITEM_NUMBER%> * " + std::to_string(1.0f/(nrSamples - 1)) + "f));\n"
+    "counter_<%ITEM_NUMBER%> = 0.0f;\n"
+    "mean_<%ITEM_NUMBER%> = 0.0f;\n"
+    "variance_<%ITEM_NUMBER%> = 0.0f;\n";
+    // LOCAL COMPUTE
+    std::string localComputeTemplate_2 = "value = time_series[(get_group_id(1) * " + std::to_string(nrSamples * isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + (sample * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + dm + <%ITEM_OFFSET%>];\n"
+    "if ( fabs(value - mean_step1_<%ITEM_NUMBER%>) < threshold_step2_<%ITEM_NUMBER%> ) {\n"
+    "counter_<%ITEM_NUMBER%> += 1.0f;\n"
+    "delta = value - mean_<%ITEM_NUMBER%>;\n"
+    "mean_<%ITEM_NUMBER%> += delta / counter_<%ITEM_NUMBER%>;\n"
+    "variance_<%ITEM_NUMBER%> += delta * (value - mean_<%ITEM_NUMBER%>);\n"
+    "}\n";
+    // STORE
+    std::string storeTemplate = "max_values[(get_group_id(1) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + dm + <%ITEM_OFFSET%>] = value_<%ITEM_NUMBER%>;\n"
+    "max_indices[(get_group_id(1) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + ") + dm + <%ITEM_OFFSET%>] = index_<%ITEM_NUMBER%>;\n"
+    "stdevs[(get_group_id(1) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + dm + <%ITEM_OFFSET%>] = native_sqrt(variance_<%ITEM_NUMBER%> * 1.0f/(counter_<%ITEM_NUMBER%> - 1.0f));\n";
+
+    std::string localVariables;
+    std::string localCompute;
+    std::string localVariables_2;
+    std::string localCompute_2;
+    std::string store;
+
+    for (unsigned int item = 0; item < conf.getNrItemsD0(); item++)
+    {
+        std::string *temp;
+        std::string itemString = std::to_string(item);
+        std::string itemOffsetString = std::to_string(item * conf.getNrThreadsD0());
+        temp = isa::utils::replace(&localVariablesTemplate, "<%ITEM_NUMBER%>", itemString);
+        if (item == 0)
+        {
+            temp = isa::utils::replace(temp, " + <%ITEM_OFFSET%>", std::string(), true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%ITEM_OFFSET%>", itemOffsetString, true);
+        }
+        localVariables.append(*temp);
+        delete temp;
+        temp = isa::utils::replace(&localComputeTemplate, "<%ITEM_NUMBER%>", itemString);
+        if (item == 0)
+        {
+            temp = isa::utils::replace(temp, " + <%ITEM_OFFSET%>", std::string(), true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%ITEM_OFFSET%>", itemOffsetString, true);
+        }
+        localCompute.append(*temp);
+        delete temp;
+        temp = isa::utils::replace(&localVariablesTemplate_2, "<%ITEM_NUMBER%>", itemString);
+        if (item == 0)
+        {
+            temp = isa::utils::replace(temp, " + <%ITEM_OFFSET%>", std::string(), true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%ITEM_OFFSET%>", itemOffsetString, true);
+        }
+        localVariables_2.append(*temp);
+        delete temp;
+        temp = isa::utils::replace(&localComputeTemplate_2, "<%ITEM_NUMBER%>", itemString);
+        if (item == 0)
+        {
+            temp = isa::utils::replace(temp, " + <%ITEM_OFFSET%>", std::string(), true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%ITEM_OFFSET%>", itemOffsetString, true);
+        }
+        localCompute_2.append(*temp);
+        delete temp;
+        temp = isa::utils::replace(&storeTemplate, "<%ITEM_NUMBER%>", itemString);
+        if (item == 0)
+        {
+            temp = isa::utils::replace(temp, " + <%ITEM_OFFSET%>", std::string(), true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%ITEM_OFFSET%>", itemOffsetString, true);
+        }
+        store.append(*temp);
+        delete temp;
+    }
+    code = isa::utils::replace(code, "<%LOCAL_VARIABLES%>", localVariables, true);
+    code = isa::utils::replace(code, "<%LOCAL_COMPUTE%>", localCompute, true);
+    code = isa::utils::replace(code, "<%LOCAL_VARIABLES_2%>", localVariables_2, true);
+    code = isa::utils::replace(code, "<%LOCAL_COMPUTE_2%>", localCompute_2, true);
+    code = isa::utils::replace(code, "<%STORE%>", store, true);
+
+    return code;
+}
+
+template <typename DataType>
+void stdSigmaCut(const std::vector<DataType> &timeSeries, std::vector<DataType> &standardDeviations, const AstroData::Observation &observation, const unsigned int padding, const float nSigma)
+{
+    for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+    {
+        for (unsigned int subbandingDM = 0; subbandingDM < observation.getNrDMs(true); subbandingDM++)
+        {
+            for (unsigned int dm = 0; dm < observation.getNrDMs(); dm++)
+            {
+                // Step 1
+                isa::utils::Statistics<DataType> completeStats;
+                for (unsigned int sample = 0; sample < observation.getNrSamplesPerBatch() / observation.getDownsampling(); sample++)
+                {
+                    completeStats.addElement(timeSeries.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + sample));
+                }
+                // Step 2
+                isa::utils::Statistics<DataType> sigmacutStats;
+                for (unsigned int sample = 0; sample < observation.getNrSamplesPerBatch() / observation.getDownsampling(); sample++)
+                {
+                    float value = timeSeries.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + sample);
+
+                    if (std::fabs(value - completeStats.getMean()) < (nSigma*completeStats.getStandardDeviation()))
+                    {
+                        sigmacutStats.addElement(value);
+                    }
+                }
+                standardDeviations.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs()) + dm) = sigmacutStats.getStandardDeviation();
+            }
+        }
+    }
+}
+
+template <typename DataType>
+void maxStdSigmaCutCPU(const std::vector<DataType> &timeSeries, std::vector<DataType> &maxValues, std::vector<unsigned int> &maxIndices, std::vector<DataType> &standardDeviations, const AstroData::Observation &observation, const unsigned int padding, const float nSigma)
+{
+    const unsigned int nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    const unsigned int nrSamples = observation.getNrSamplesPerBatch() / observation.getDownsampling();
+    const uint64_t nrSamplesPadded = isa::utils::pad(nrSamples, padding / sizeof(DataType));
+
+#pragma omp parallel for collapse(2) schedule(static)
+    for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+    {
+        for (unsigned int dm = 0; dm < nrDMs; dm++)
+        {
+            const DataType *items = timeSeries.data() + (((beam * nrDMs) + dm) * nrSamplesPadded);
+            // Step 1
+            TimeSeriesStatistics<DataType> completeStats = timeSeriesStatistics(items, nrSamples);
+            // Step 2
+            TimeSeriesStatistics<DataType> sigmacutStats = sigmaCutStatistics(items, nrSamples, completeStats.mean, nSigma * std::sqrt(completeStats.variance / (nrSamples - 1)));
+
+            maxValues[(beam * isa::utils::pad(nrDMs, padding / sizeof(DataType))) + dm] = completeStats.max;
+            maxIndices[(beam * isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + dm] = completeStats.maxSample;
+            standardDeviations[(beam * isa::utils::pad(nrDMs, padding / sizeof(DataType))) + dm] = std::sqrt(sigmacutStats.variance / (sigmacutStats.counter - 1));
+        }
+    }
+}
+
+template <typename DataType>
+std::string *getMaxStdIterativeSigmaCutDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding, const float nSigma, const unsigned int maxIterations)
+{
+    std::string *code = 0;
+    unsigned int nrSamples = observation.getNrSamplesPerBatch() / downsampling;
+    unsigned int nrDMs = 0;
+
+    if (conf.getSubbandDedispersion())
+    {
+        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    }
+    else
+    {
+        nrDMs = observation.getNrDMs();
+    }
+    // Same kernel, with the name and the outputs of maxStdSigmaCut_DMsSamples
+    code = getIterativeSigmaCutDMsSamplesOpenCL<DataType>(conf, dataName, observation, nrSamples, padding, nSigma, maxIterations);
+    code = isa::utils::replace(code, "<%NAME%>", "maxStdIterativeSigmaCut_DMsSamples_", true);
+    code = isa::utils::replace(code, "<%OUTPUT_ARGS%>", "__global " + dataName + " * const restrict max_values, __global unsigned int * const restrict max_indices, __global " + dataName + " * const restrict stdevs", true);
+    code = isa::utils::replace(code, "<%STORE%>", "max_values[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + get_group_id(1)] = max0;\n"
+        "max_indices[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + ") + get_group_id(1)] = maxSample0;\n"
+        "stdevs[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + get_group_id(1)] = native_sqrt(cut_variance / (cut_counter - 1.0f));\n", true);
+
+    return code;
+}
+
+template <typename DataType>
+void stdIterativeSigmaCut(const std::vector<DataType> &timeSeries, std::vector<DataType> &standardDeviations, const AstroData::Observation &observation, const unsigned int padding, const float nSigma, const unsigned int maxIterations)
+{
+    const unsigned int nrSamples = observation.getNrSamplesPerBatch() / observation.getDownsampling();
+    const uint64_t nrSamplesPadded = isa::utils::pad(nrSamples, padding / sizeof(DataType));
+
+    for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+    {
+        for (unsigned int subbandingDM = 0; subbandingDM < observation.getNrDMs(true); subbandingDM++)
+        {
+            for (unsigned int dm = 0; dm < observation.getNrDMs(); dm++)
+            {
+                const uint64_t offset = ((beam * observation.getNrDMs(true) * observation.getNrDMs()) + (subbandingDM * observation.getNrDMs()) + dm) * nrSamplesPadded;
+                // Step 1
+                isa::utils::Statistics<DataType> completeStats;
+                for (unsigned int sample = 0; sample < nrSamples; sample++)
+                {
+                    completeStats.addElement(timeSeries.at(offset + sample));
+                }
+                // Step 2, repeated until the number of kept samples does not change
+                unsigned int counter = nrSamples;
+                float mean = completeStats.getMean();
+                float standardDeviation = completeStats.getStandardDeviation();
+                for (unsigned int iteration = 0; iteration < maxIterations; iteration++)
+                {
+                    isa::utils::Statistics<DataType> sigmacutStats;
+                    unsigned int sigmacutCounter = 0;
+                    for (unsigned int sample = 0; sample < nrSamples; sample++)
+                    {
+                        float value = timeSeries.at(offset + sample);
+
+                        if (std::fabs(value - mean) < (nSigma * standardDeviation))
+                        {
+                            sigmacutStats.addElement(value);
+                            sigmacutCounter++;
+                        }
+                    }
+                    mean = sigmacutStats.getMean();
+                    standardDeviation = sigmacutStats.getStandardDeviation();
+                    if (sigmacutCounter == counter)
+                    {
+                        break;
+                    }
+                    counter = sigmacutCounter;
+                }
+                standardDeviations.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs()) + dm) = standardDeviation;
+            }
+        }
+    }
+}
+
+template <typename DataType>
+void maxStdIterativeSigmaCutCPU(const std::vector<DataType> &timeSeries, std::vector<DataType> &maxValues, std::vector<unsigned int> &maxIndices, std::vector<DataType> &standardDeviations, const AstroData::Observation &observation, const unsigned int padding, const float nSigma, const unsigned int maxIterations)
+{
+    const unsigned int nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    const unsigned int nrSamples = observation.getNrSamplesPerBatch() / observation.getDownsampling();
+    const uint64_t nrSamplesPadded = isa::utils::pad(nrSamples, padding / sizeof(DataType));
+
+#pragma omp parallel for collapse(2) schedule(static)
+    for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+    {
+        for (unsigned int dm = 0; dm < nrDMs; dm++)
+        {
+            const DataType *items = timeSeries.data() + (((beam * nrDMs) + dm) * nrSamplesPadded);
+            TimeSeriesStatistics<DataType> completeStats = timeSeriesStatistics(items, nrSamples);
+            TimeSeriesStatistics<DataType> sigmacutStats = iterativeSigmaCutStatistics(items, nrSamples, completeStats, nSigma, maxIterations);
+
+            maxValues[(beam * isa::utils::pad(nrDMs, padding / sizeof(DataType))) + dm] = completeStats.max;
+            maxIndices[(beam * isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + dm] = completeStats.maxSample;
+            standardDeviations[(beam * isa::utils::pad(nrDMs, padding / sizeof(DataType))) + dm] = std::sqrt(sigmacutStats.variance / (sigmacutStats.counter - 1));
+        }
+    }
+}
+
+template <typename DataType>
+std::string *getMedianOfMediansOpenCL(const snrConf &conf, const DataOrdering ordering, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int stepSize, const unsigned int padding)
+{
+    std::string *code = 0;
+
+    if (ordering == DataOrdering::DMsSamples)
+    {
+        code = getMedianOfMediansDMsSamplesOpenCL<DataType>(conf, dataName, observation, downsampling, stepSize, padding);
+    }
+    else if (ordering == DataOrdering::SamplesDMs)
+    {
+        code = getMedianOfMediansSamplesDMsOpenCL<DataType>(conf, dataName, observation, downsampling, stepSize, padding);
+    }
+    return code;
+}
+
+template <typename DataType>
+std::string *getMedianOfMediansDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int stepSize, const unsigned int padding)
+{
+    std::string *code = new std::string();
+    unsigned int nrSamples = 0;
+    unsigned int nrDMs = 0;
+
+    if (conf.getSubbandDedispersion())
+    {
+        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    }
+    else
+    {
+        nrDMs = observation.getNrDMs();
+    }
+    nrSamples = observation.getNrSamplesPerBatch() / downsampling;
+    if (conf.getMedianStrategy() == MedianStrategy::SortingNetwork)
+    {
+        delete code;
+        return getMedianOfMediansSortingNetworkDMsSamplesOpenCL<DataType>(conf, dataName, nrDMs, nrSamples, stepSize, padding);
+    }
+    // Generate source code
+    *code = "__kernel void medianOfMedians_DMsSamples_" + std::to_string(stepSize) + "(__global const " + dataName + " * const restrict time_series, __global " + dataName + " * const restrict medians) {\n"
+        "__local " + dataName + " local_data[" + std::to_string(stepSize) + "];\n"
+        "\n"
+        "// Load data in shared memory\n"
+        "for ( unsigned int item = get_local_id(0); item < " + std::to_string(stepSize) + "; item += " + std::to_string(conf.getNrThreadsD0()) + " ) {\n"
+        "local_data[item] = time_series[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(0) * " + std::to_string(stepSize) + ") + item];\n"
+        "}\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "<%SELECT%>"
+        "// Store median\n"
+        "if ( get_local_id(0) == 0 ) {\n"
+        "<%STORE%>"
+        "}\n"
+        "}\n";
+    std::string sortTemplate = "// Odd-Even Sort\n"
+        "for ( unsigned int merge_step = " + std::to_string(static_cast<unsigned int>(std::pow(2, std::ceil(std::log2(stepSize)) - 1))) + "; merge_step > 0; merge_step /= 2 ) {\n"
+        "for ( unsigned int other_index = merge_step, sort_step = " + std::to_string(static_cast<unsigned int>(pow(2, std::ceil(std::log2(stepSize)) - 1))) + ", turn  = 0; other_index > 0; other_index = sort_step - merge_step, sort_step /= 2, turn = merge_step ) {\n"
+        "for ( unsigned int index = get_local_id(0); index < " + std::to_string(stepSize) + " - other_index; index += " + std::to_string(conf.getNrThreadsD0()) + " ) {\n"
+        "if ( ((index & merge_step) == turn) && (local_data[index] > local_data[index + other_index]) ) {\n"
+        + dataName + " temp = local_data[index];\n"
+        "local_data[index] = local_data[index + other_index];\n"
+        "local_data[index + other_index] = temp;\n"
+        "}\n"
+        "}\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "}\n"
+        "}\n";
+    // The bits of the keys are ordered like the values they represent
+    std::string keyTemplate;
+    std::string valueTemplate;
+    if (std::is_floating_point<DataType>::value)
+    {
+        keyTemplate = "key = as_uint(<%VALUE%>);\n"
+        "key = (key & 0x80000000) ? ~key : (key | 0x80000000);\n";
+        valueTemplate = "<%VALUE%> = as_" + dataName + "((prefix & 0x80000000) ? (prefix & 0x7fffffff) : ~prefix);\n";
+    }
+    else if (std::is_signed<DataType>::value)
+    {
+        keyTemplate = "key = as_uint(<%VALUE%>) ^ 0x80000000;\n";
+        valueTemplate = "<%VALUE%> = as_" + dataName + "(prefix ^ 0x80000000);\n";
+    }
+    else
+    {
+        keyTemplate = "key = as_uint(<%VALUE%>);\n";
+        valueTemplate = "<%VALUE%> = as_" + dataName + "(prefix);\n";
+    }
+    std::string selectTemplate = "// Radix select\n"
+        "__local unsigned int histogram[256];\n"
+        "__local unsigned int selection[2];\n"
+        "unsigned int key = 0;\n"
+        "unsigned int mask = 0;\n"
+        "unsigned int prefix = 0;\n"
+        "unsigned int rank = " + std::to_string(stepSize / 2) + ";\n"
+        "for ( int shift = 24; shift >= 0; shift -= 8 ) {\n"
+        "for ( unsigned int bin = get_local_id(0); bin < 256; bin += " + std::to_string(conf.getNrThreadsD0()) + " ) {\n"
+        "histogram[bin] = 0;\n"
+        "}\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "for ( unsigned int item = get_local_id(0); item < " + std::to_string(stepSize) + "; item += " + std::to_string(conf.getNrThreadsD0()) + " ) {\n"
+        "<%KEY%>"
+        "if ( (key & mask) == prefix ) {\n"
+        "atomic_inc(&histogram[(key >> shift) & 255]);\n"
+        "}\n"
+        "}\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "// The first work-item finds the bin containing the median\n"
+        "if ( get_local_id(0) == 0 ) {\n"
+        "unsigned int bin = 0;\n"
+        "while ( histogram[bin] <= rank ) {\n"
+        "rank -= histogram[bin];\n"
+        "bin++;\n"
+        "}\n"
+        "selection[0] = prefix | (bin << shift);\n"
+        "selection[1] = rank;\n"
+        "}\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "prefix = selection[0];\n"
+        "rank = selection[1];\n"
+        "mask |= 255u << shift;\n"
+        "}\n"
+        "<%VALUE%>";
+    std::string storeTemplateFirstStep = "medians[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples / stepSize, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples / stepSize, padding / sizeof(DataType))) + ") + get_group_id(0)] = local_data[" + std::to_string(stepSize / 2) + "];\n";
+    std::string storeTemplateSecondStep = "medians[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + get_group_id(1)] = local_data[" + std::to_string(stepSize / 2) + "];\n";
+    if (conf.getMedianStrategy() == MedianStrategy::RadixSelect)
+    {
+        // The median is rebuilt from its key, and stored by the first work-item where the sorted step would have it
+        std::string *key_s = isa::utils::replace(&keyTemplate, "<%VALUE%>", "local_data[item]");
+        std::string *value_s = isa::utils::replace(&valueTemplate, "<%VALUE%>", "local_data[" + std::to_string(stepSize / 2) + "]");
+
+        code = isa::utils::replace(code, "<%SELECT%>", selectTemplate, true);
+        code = isa::utils::replace(code, "<%KEY%>", *key_s, true);
+        code = isa::utils::replace(code, "<%VALUE%>", "if ( get_local_id(0) == 0 ) {\n" + *value_s + "}\n", true);
+        delete key_s;
+        delete value_s;
+    }
+    else
+    {
+        code = isa::utils::replace(code, "<%SELECT%>", sortTemplate, true);
+    }
+    if (nrSamples != stepSize)
+    {
+        code = isa::utils::replace(code, "<%STORE%>", storeTemplateFirstStep, true);
+    }
+    else
+    {
+        code = isa::utils::replace(code, "<%STORE%>", storeTemplateSecondStep, true);
+    }
+    return code;
+}
+
+template <typename DataType>
+std::string *getMedianOfMediansSortingNetworkDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const unsigned int nrDMs, const unsigned int nrSamples, const unsigned int stepSize, const unsigned int padding)
+{
+    std::string *code = new std::string();
+    std::vector<std::pair<unsigned int, unsigned int>> network = getMedianSortingNetwork(stepSize);
+
+    // Generate source code
+    *code = "__kernel void medianOfMedians_DMsSamples_" + std::to_string(stepSize) + "(__global const " + dataName + " * const restrict time_series, __global " + dataName + " * const restrict medians) {\n"
+        + dataName + " temp;\n"
+        "<%LOAD%>"
+        "\n"
+        "// Sorting network\n"
+        "<%NETWORK%>"
+        "// Store median\n"
+        "<%STORE%>"
+        "}\n";
+    std::string loadTemplate = "unsigned int step<%NUM%> = (get_group_id(0) * " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + ") + get_local_id(0) + <%OFFSET%>;\n";
+    std::string loadItemTemplate = dataName + " value<%NUM%>_<%ITEM%> = time_series[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (step<%NUM%> * " + std::to_string(stepSize) + ") + <%ITEM%>];\n";
+    std::string compareTemplate = "temp = min(value<%NUM%>_<%FIRST%>, value<%NUM%>_<%SECOND%>);\n"
+        "value<%NUM%>_<%SECOND%> = max(value<%NUM%>_<%FIRST%>, value<%NUM%>_<%SECOND%>);\n"
+        "value<%NUM%>_<%FIRST%> = temp;\n";
+    std::string storeTemplate;
+    if (nrSamples != stepSize)
+    {
+        storeTemplate = "medians[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples / stepSize, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples / stepSize, padding / sizeof(DataType))) + ") + step<%NUM%>] = value<%NUM%>_" + std::to_string(stepSize / 2) + ";\n";
+    }
+    else
+    {
+        storeTemplate = "medians[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + get_group_id(1)] = value<%NUM%>_" + std::to_string(stepSize / 2) + ";\n";
+    }
+    std::string *load_s = new std::string();
+    std::string *network_s = new std::string();
+    std::string *store_s = new std::string();
+
+    for (unsigned int step = 0; step < conf.getNrItemsD0(); step++)
+    {
+        std::string step_s = std::to_string(step);
+        std::string offset_s = std::to_string(step * conf.getNrThreadsD0());
+        std::string *temp = 0;
+
+        temp = isa::utils::replace(&loadTemplate, "<%NUM%>", step_s);
+        if (step == 0)
+        {
+            std::string empty_s("");
+            temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
+        }
+        load_s->append(*temp);
+        delete temp;
+        for (unsigned int item = 0; item < stepSize; item++)
+        {
+            temp = isa::utils::replace(&loadItemTemplate, "<%NUM%>", step_s);
+            temp = isa::utils::replace(temp, "<%ITEM%>", std::to_string(item), true);
+            load_s->append(*temp);
+            delete temp;
+        }
+        for (auto comparator : network)
+        {
+            temp = isa::utils::replace(&compareTemplate, "<%NUM%>", step_s);
+            temp = isa::utils::replace(temp, "<%FIRST%>", std::to_string(comparator.first), true);
+            temp = isa::utils::replace(temp, "<%SECOND%>", std::to_string(comparator.second), true);
+            network_s->append(*temp);
+            delete temp;
+        }
+        temp = isa::utils::replace(&storeTemplate, "<%NUM%>", step_s);
+        store_s->append(*temp);
+        delete temp;
+    }
+    code = isa::utils::replace(code, "<%LOAD%>", *load_s, true);
+    code = isa::utils::replace(code, "<%NETWORK%>", *network_s, true);
+    code = isa::utils::replace(code, "<%STORE%>", *store_s, true);
+    delete load_s;
+    delete network_s;
+    delete store_s;
+
+    return code;
+}
+
+template <typename DataType>
+std::string *getMedianOfMediansSamplesDMsOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int stepSize, const unsigned int padding)
+{
+    std::string *code = new std::string();
+    unsigned int nrSamples = 0;
+    unsigned int nrDMs = 0;
+
+    if (conf.getSubbandDedispersion())
+    {
+        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    }
+    else
+    {
+        nrDMs = observation.getNrDMs();
+    }
+    nrSamples = observation.getNrSamplesPerBatch() / downsampling;
+    // Generate source code
+    *code = "__kernel void medianOfMedians_SamplesDMs_" + std::to_string(stepSize) + "(__global const " + dataName + " * const restrict time_series, __global " + dataName + " * const restrict medians) {\n"
+        "unsigned int dm = (get_group_id(0) * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(0);\n"
+        "int left = 0;\n"
+        "int right = " + std::to_string(stepSize - 1) + ";\n"
+        + dataName + " pivot;\n"
+        + dataName + " temp;\n"
+        "__local " + dataName + " local_data[" + std::to_string(stepSize * conf.getNrThreadsD0()) + "];\n"
+        "\n"
+        "// Load data in shared memory, one column per DM\n"
+        "for ( unsigned int item = 0; item < " + std::to_string(stepSize) + "; item++ ) {\n"
+        "local_data[(item * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(0)] = time_series[(get_group_id(2) * " + std::to_string(nrSamples * isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + (((get_group_id(1) * " + std::to_string(stepSize) + ") + item) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + dm];\n"
+        "}\n"
+        "// Selection of the median, every work-item works on its own column\n"
+        "while ( left < right ) {\n"
+        "int first = left;\n"
+        "int last = right;\n"
+        "pivot = local_data[(" + std::to_string(stepSize / 2) + " * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(0)];\n"
+        "do {\n"
+        "while ( local_data[(first * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(0)] < pivot ) {\n"
+        "first++;\n"
+        "}\n"
+        "while ( pivot < local_data[(last * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(0)] ) {\n"
+        "last--;\n"
+        "}\n"
+        "if ( first <= last ) {\n"
+        "temp = local_data[(first * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(0)];\n"
+        "local_data[(first * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(0)] = local_data[(last * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(0)];\n"
+        "local_data[(last * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(0)] = temp;\n"
+        "first++;\n"
+        "last--;\n"
+        "}\n"
+        "} while ( first <= last );\n"
+        "if ( last < " + std::to_string(stepSize / 2) + " ) {\n"
+        "left = first;\n"
+        "}\n"
+        "if ( " + std::to_string(stepSize / 2) + " < first ) {\n"
+        "right = last;\n"
+        "}\n"
+        "}\n"
+        "// Store median\n"
+        "medians[(get_group_id(2) * " + std::to_string((nrSamples / stepSize) * isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + dm] = local_data[(" + std::to_string(stepSize / 2) + " * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(0)];\n"
+        "}\n";
+    return code;
+}
+
+template <typename DataType>
+void medianOfMedians(const unsigned int stepSize, const std::vector<DataType> &timeSeries, std::vector<DataType> &medians, const AstroData::Observation &observation, const unsigned int padding)
+{
+    for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+    {
+        for (unsigned int subbandingDM = 0; subbandingDM < observation.getNrDMs(true); subbandingDM++)
+        {
+            for (unsigned int dm = 0; dm < observation.getNrDMs(); dm++)
+            {
+                for (unsigned int step = 0; step < observation.getNrSamplesPerBatch() / observation.getDownsampling() / stepSize; step++)
+                {
+                    std::vector<DataType> localArray;
+
+                    for (unsigned int sample = 0; sample < stepSize; sample++)
+                    {
+                        localArray.push_back(timeSeries.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (step * stepSize) + sample));
+                    }
+                    std::sort(localArray.begin(), localArray.end());
+                    if (stepSize == observation.getNrSamplesPerBatch())
+                    {
+                        medians.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs()) + dm) = localArray.at(stepSize / 2);
+                    }
+                    else
+                    {
+                        medians.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling() / stepSize, padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling() / stepSize, padding / sizeof(DataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling() / stepSize, padding / sizeof(DataType))) + step) = localArray.at(stepSize / 2);
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <typename DataType>
+void medianOfMediansCPU(const unsigned int stepSize, const std::vector<DataType> &timeSeries, std::vector<DataType> &medians, const AstroData::Observation &observation, const unsigned int padding)
+{
+    const unsigned int nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    const unsigned int nrSamples = observation.getNrSamplesPerBatch() / observation.getDownsampling();
+    const uint64_t nrSamplesPadded = isa::utils::pad(nrSamples, padding / sizeof(DataType));
+    const uint64_t nrStepsPadded = isa::utils::pad(nrSamples / stepSize, padding / sizeof(DataType));
+
+#pragma omp parallel
+    {
+        std::vector<DataType> localArray(stepSize);
+
+#pragma omp for collapse(2) schedule(static)
+        for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+        {
+            for (unsigned int dm = 0; dm < nrDMs; dm++)
+            {
+                const DataType *items = timeSeries.data() + (((beam * nrDMs) + dm) * nrSamplesPadded);
+
+                for (unsigned int step = 0; step < nrSamples / stepSize; step++)
+                {
+                    std::copy(items + (step * stepSize), items + ((step + 1) * stepSize), localArray.begin());
+                    std::nth_element(localArray.begin(), localArray.begin() + (stepSize / 2), localArray.end());
+                    if (stepSize == nrSamples)
+                    {
+                        medians[(beam * isa::utils::pad(nrDMs, padding / sizeof(DataType))) + dm] = localArray[stepSize / 2];
+                    }
+                    else
+                    {
+                        medians[(((beam * nrDMs) + dm) * nrStepsPadded) + step] = localArray[stepSize / 2];
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <typename DataType>
+std::string *getMedianOfMediansTwoLevelDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int stepSize, const unsigned int padding)
+{
+    std::string *code = new std::string();
+    unsigned int nrSamples = 0;
+    unsigned int nrDMs = 0;
+    unsigned int nrSteps = 0;
+
+    if (conf.getSubbandDedispersion())
+    {
+        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    }
+    else
+    {
+        nrDMs = observation.getNrDMs();
+    }
+    nrSamples = observation.getNrSamplesPerBatch() / downsampling;
+    if ((stepSize == 0) || (stepSize > nrSamples))
+    {
+        throw std::invalid_argument("The median step must be larger than zero and not larger than the number of samples.");
+    }
+    nrSteps = nrSamples / stepSize;
+    // The last chunk is only partially filled when nrSteps is not a multiple of itemsD0
+    std::string loadGuard_s;
+    std::string storeGuard_s;
+    if ((nrSteps % conf.getNrItemsD0()) != 0)
+    {
+        loadGuard_s = "if ( ((first_step * " + std::to_string(stepSize) + ") + item) < " + std::to_string(nrSteps * stepSize) + " ) ";
+        storeGuard_s = "if ( (first_step + step) < " + std::to_string(nrSteps) + " ) ";
+    }
+    // Generate source code
+    *code = "__kernel void medianOfMediansTwoLevel_DMsSamples_" + std::to_string(stepSize) + "(__global const " + dataName + " * const restrict time_series, __global " + dataName + " * const restrict medians) {\n"
+        "__local " + dataName + " local_data[" + std::to_string(stepSize * conf.getNrItemsD0()) + "];\n"
+        "__local " + dataName + " local_medians[" + std::to_string(nrSteps) + "];\n"
+        "\n"
+        "// First level, " + std::to_string(conf.getNrItemsD0()) + " steps at a time\n"
+        "for ( unsigned int first_step = 0; first_step < " + std::to_string(nrSteps) + "; first_step += " + std::to_string(conf.getNrItemsD0()) + " ) {\n"
+        "for ( unsigned int item = get_local_id(0); item < " + std::to_string(stepSize * conf.getNrItemsD0()) + "; item += " + std::to_string(conf.getNrThreadsD0()) + " ) {\n"
+        + loadGuard_s + "local_data[item] = time_series[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (first_step * " + std::to_string(stepSize) + ") + item];\n"
+        "}\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "<%SORT_STEPS%>"
+        "for ( unsigned int step = get_local_id(0); step < " + std::to_string(conf.getNrItemsD0()) + "; step += " + std::to_string(conf.getNrThreadsD0()) + " ) {\n"
+        + storeGuard_s + "local_medians[first_step + step] = local_data[(step * " + std::to_string(stepSize) + ") + " + std::to_string(stepSize / 2) + "];\n"
+        "}\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "}\n"
+        "// Second level\n"
+        "<%SORT_MEDIANS%>"
+        "// Store median\n"
+        "if ( get_local_id(0) == 0 ) {\n"
+        "medians[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + get_group_id(1)] = local_medians[" + std::to_string(nrSteps / 2) + "];\n"
+        "}\n"
+        "}\n";
+    // Odd-even sort of consecutive segments of the same size
+    std::string sortTemplate = "for ( unsigned int merge_step = <%MERGE_STEP%>; merge_step > 0; merge_step /= 2 ) {\n"
+        "for ( unsigned int other_index = merge_step, sort_step = <%MERGE_STEP%>, turn  = 0; other_index > 0; other_index = sort_step - merge_step, sort_step /= 2, turn = merge_step ) {\n"
+        "for ( unsigned int item = get_local_id(0); item < <%SIZE%>; item += " + std::to_string(conf.getNrThreadsD0()) + " ) {\n"
+        "unsigned int index = item % <%SEGMENT%>;\n"
+        "if ( (index < <%SEGMENT%> - other_index) && ((index & merge_step) == turn) && (<%DATA%>[item] > <%DATA%>[item + other_index]) ) {\n"
+        + dataName + " temp = <%DATA%>[item];\n"
+        "<%DATA%>[item] = <%DATA%>[item + other_index];\n"
+        "<%DATA%>[item + other_index] = temp;\n"
+        "}\n"
+        "}\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "}\n"
+        "}\n";
+    std::string *sortSteps_s = isa::utils::replace(&sortTemplate, "<%DATA%>", "local_data");
+    sortSteps_s = isa::utils::replace(sortSteps_s, "<%SIZE%>", std::to_string(stepSize * conf.getNrItemsD0()), true);
+    sortSteps_s = isa::utils::replace(sortSteps_s, "<%SEGMENT%>", std::to_string(stepSize), true);
+    sortSteps_s = isa::utils::replace(sortSteps_s, "<%MERGE_STEP%>", std::to_string(static_cast<unsigned int>(std::pow(2, std::ceil(std::log2(stepSize)) - 1))), true);
+    std::string *sortMedians_s = isa::utils::replace(&sortTemplate, "<%DATA%>", "local_medians");
+    sortMedians_s = isa::utils::replace(sortMedians_s, "<%SIZE%>", std::to_string(nrSteps), true);
+    sortMedians_s = isa::utils::replace(sortMedians_s, "<%SEGMENT%>", std::to_string(nrSteps), true);
+    sortMedians_s = isa::utils::replace(sortMedians_s, "<%MERGE_STEP%>", std::to_string(static_cast<unsigned int>(std::pow(2, std::ceil(std::log2(nrSteps)) - 1))), true);
+    code = isa::utils::replace(code, "<%SORT_STEPS%>", *sortSteps_s, true);
+    code = isa::utils::replace(code, "<%SORT_MEDIANS%>", *sortMedians_s, true);
+    delete sortSteps_s;
+    delete sortMedians_s;
+
+    return code;
+}
+
+template <typename DataType>
+void medianOfMediansTwoLevel(const unsigned int stepSize, const std::vector<DataType> &timeSeries, std::vector<DataType> &medians, const AstroData::Observation &observation, const unsigned int padding)
+{
+    if ((stepSize == 0) || (stepSize > (observation.getNrSamplesPerBatch() / observation.getDownsampling())))
+    {
+        throw std::invalid_argument("The median step must be larger than zero and not larger than the number of samples.");
+    }
+    for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+    {
+        for (unsigned int subbandingDM = 0; subbandingDM < observation.getNrDMs(true); subbandingDM++)
+        {
+            for (unsigned int dm = 0; dm < observation.getNrDMs(); dm++)
+            {
+                std::vector<DataType> stepMedians;
+
+                for (unsigned int step = 0; step < observation.getNrSamplesPerBatch() / observation.getDownsampling() / stepSize; step++)
+                {
+                    std::vector<DataType> localArray;
+
+                    for (unsigned int sample = 0; sample < stepSize; sample++)
+                    {
+                        localArray.push_back(timeSeries.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (step * stepSize) + sample));
+                    }
+                    std::sort(localArray.begin(), localArray.end());
+                    stepMedians.push_back(localArray.at(stepSize / 2));
+                }
+                std::sort(stepMedians.begin(), stepMedians.end());
+                medians.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs()) + dm) = stepMedians.at(stepMedians.size() / 2);
+            }
+        }
+    }
+}
+
+template <typename DataType>
+void medianOfMediansTwoLevelCPU(const unsigned int stepSize, const std::vector<DataType> &timeSeries, std::vector<DataType> &medians, const AstroData::Observation &observation, const unsigned int padding)
+{
+    const unsigned int nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    const unsigned int nrSamples = observation.getNrSamplesPerBatch() / observation.getDownsampling();
+    const unsigned int nrSteps = nrSamples / stepSize;
+    const uint64_t nrSamplesPadded = isa::utils::pad(nrSamples, padding / sizeof(DataType));
+
+    if ((stepSize == 0) || (stepSize > nrSamples))
+    {
+        throw std::invalid_argument("The median step must be larger than zero and not larger than the number of samples.");
+    }
+#pragma omp parallel
+    {
+        std::vector<DataType> localArray(stepSize);
+        std::vector<DataType> stepMedians(nrSteps);
+
+#pragma omp for collapse(2) schedule(static)
+        for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+        {
+            for (unsigned int dm = 0; dm < nrDMs; dm++)
+            {
+                const DataType *items = timeSeries.data() + (((beam * nrDMs) + dm) * nrSamplesPadded);
+
+                for (unsigned int step = 0; step < nrSteps; step++)
+                {
+                    std::copy(items + (step * stepSize), items + ((step + 1) * stepSize), localArray.begin());
+                    std::nth_element(localArray.begin(), localArray.begin() + (stepSize / 2), localArray.end());
+                    stepMedians[step] = localArray[stepSize / 2];
+                }
+                std::nth_element(stepMedians.begin(), stepMedians.begin() + (nrSteps / 2), stepMedians.end());
+                medians[(beam * isa::utils::pad(nrDMs, padding / sizeof(DataType))) + dm] = stepMedians[nrSteps / 2];
+            }
+        }
+    }
+}
+
+template <typename DataType>
+std::string *getStreamingMedianAbsoluteDeviationDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int nrBins, const float smoothing, const unsigned int padding)
+{
+    std::string *code = new std::string();
+    unsigned int nrSamples = 0;
+    unsigned int nrDMs = 0;
+
+    if (conf.getSubbandDedispersion())
+    {
+        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    }
+    else
+    {
+        nrDMs = observation.getNrDMs();
+    }
+    nrSamples = observation.getNrSamplesPerBatch() / downsampling;
+    // Generate source code
+    *code = "__kernel void streamingMedianAbsoluteDeviation_DMsSamples_" + std::to_string(nrBins) + "(__global const " + dataName + " * const restrict time_series, __global float * const restrict baselines, __global float * const restrict mads) {\n"
+        "__local unsigned int histogram[" + std::to_string(nrBins + 2) + "];\n"
+        "__local float reduction_min[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "__local float reduction_max[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "__local float local_median;\n"
+        "__local unsigned int local_found;\n"
+        "const unsigned int state = (get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(float))) + ") + get_group_id(1);\n"
+        "const unsigned int first_sample = (get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ");\n"
+        "float baseline = baselines[state];\n"
+        "float mad = mads[state];\n"
+        "float low = baseline - (4.0f * mad);\n"
+        "float width = (8.0f * mad) / " + std::to_string(nrBins) + ".0f;\n"
+        "float median = 0.0f;\n"
+        "unsigned int attempt = 0;\n"
+        "\n"
+        "// Baseline\n"
+        "for ( attempt = (mad > 0.0f) ? 0 : 1; attempt < 2; attempt++ ) {\n"
+        "if ( attempt == 1 ) {\n"
+        "// Window covering the range of the batch\n"
+        "float item_min = time_series[first_sample + get_local_id(0)];\n"
+        "float item_max = item_min;\n"
+        "for ( unsigned int sample = get_local_id(0) + " + std::to_string(conf.getNrThreadsD0()) + "; sample < " + std::to_string(nrSamples) + "; sample += " + std::to_string(conf.getNrThreadsD0()) + " ) {\n"
+        "float item = time_series[first_sample + sample];\n"
+        "item_min = fmin(item_min, item);\n"
+        "item_max = fmax(item_max, item);\n"
+        "}\n"
+        "reduction_min[get_local_id(0)] = item_min;\n"
+        "reduction_max[get_local_id(0)] = item_max;\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "for ( unsigned int threshold = " + std::to_string(conf.getNrThreadsD0() / 2) + "; threshold > 0; threshold /= 2 ) {\n"
+        "if ( get_local_id(0) < threshold ) {\n"
+        "reduction_min[get_local_id(0)] = fmin(reduction_min[get_local_id(0)], reduction_min[get_local_id(0) + threshold]);\n"
+        "reduction_max[get_local_id(0)] = fmax(reduction_max[get_local_id(0)], reduction_max[get_local_id(0) + threshold]);\n"
+        "}\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "}\n"
+        "low = reduction_min[0];\n"
+        "width = fmax((reduction_max[0] - low) / " + std::to_string(nrBins - 1) + ".0f, FLT_MIN);\n"
+        "}\n"
+        "<%HISTOGRAM%>"
+        "if ( get_local_id(0) == 0 ) {\n"
+        "<%SCAN%>"
+        "local_median = low + (width * ((bin - 1) + ((" + std::to_string(nrSamples / 2) + " - counter + 0.5f) / histogram[bin])));\n"
+        "local_found = (histogram[0] <= " + std::to_string(nrSamples / 2) + ") && (bin <= " + std::to_string(nrBins) + ");\n"
+        "}\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "median = local_median;\n"
+        "if ( local_found ) {\n"
+        "break;\n"
+        "}\n"
+        "}\n"
+        "// Median absolute deviation, with the same bin width\n"
+        "low = 0.0f;\n"
+        "<%HISTOGRAM_DEVIATION%>"
+        "if ( get_local_id(0) == 0 ) {\n"
+        "<%SCAN%>"
+        "float deviation = width * " + std::to_string(nrBins) + ".0f;\n"
+        "if ( bin <= " + std::to_string(nrBins) + " ) {\n"
+        "deviation = width * ((bin - 1) + ((" + std::to_string(nrSamples / 2) + " - counter + 0.5f) / histogram[bin]));\n"
+        "}\n"
+        "if ( attempt == 0 ) {\n"
+        "baselines[state] = baseline + (" + std::to_string(smoothing) + "f * (median - baseline));\n"
+        "mads[state] = mad + (" + std::to_string(smoothing) + "f * (deviation - mad));\n"
+        "} else {\n"
+        "baselines[state] = median;\n"
+        "mads[state] = deviation;\n"
+        "}\n"
+        "}\n"
+        "}\n";
+    std::string histogramTemplate = "for ( unsigned int bin = get_local_id(0); bin < " + std::to_string(nrBins + 2) + "; bin += " + std::to_string(conf.getNrThreadsD0()) + " ) {\n"
+        "histogram[bin] = 0;\n"
+        "}\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "for ( unsigned int sample = get_local_id(0); sample < " + std::to_string(nrSamples) + "; sample += " + std::to_string(conf.getNrThreadsD0()) + " ) {\n"
+        "float position = (<%VALUE%> - low) / width;\n"
+        "if ( position < 0.0f ) {\n"
+        "atomic_inc(&(histogram[0]));\n"
+        "} else if ( position >= " + std::to_string(nrBins) + ".0f ) {\n"
+        "atomic_inc(&(histogram[" + std::to_string(nrBins + 1) + "]));\n"
+        "} else {\n"
+        "atomic_inc(&(histogram[1 + convert_uint(position)]));\n"
+        "}\n"
+        "}\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n";
+    std::string scan_s = "unsigned int counter = histogram[0];\n"
+        "unsigned int bin = 1;\n"
+        "while ( (bin <= " + std::to_string(nrBins) + ") && ((counter + histogram[bin]) <= " + std::to_string(nrSamples / 2) + ") ) {\n"
+        "counter += histogram[bin];\n"
+        "bin++;\n"
+        "}\n";
+    std::string *histogram_s = isa::utils::replace(&histogramTemplate, "<%VALUE%>", "time_series[first_sample + sample]");
+    code = isa::utils::replace(code, "<%HISTOGRAM%>", *histogram_s, true);
+    delete histogram_s;
+    histogram_s = isa::utils::replace(&histogramTemplate, "<%VALUE%>", "fabs(time_series[first_sample + sample] - median)");
+    code = isa::utils::replace(code, "<%HISTOGRAM_DEVIATION%>", *histogram_s, true);
+    delete histogram_s;
+    code = isa::utils::replace(code, "<%SCAN%>", scan_s, true);
+
+    return code;
+}
+
+template <typename DataType>
+void streamingMedianAbsoluteDeviation(const float smoothing, const std::vector<DataType> &timeSeries, std::vector<float> &baselines, std::vector<float> &mads, const AstroData::Observation &observation, const unsigned int padding)
+{
+    for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+    {
+        for (unsigned int subbandingDM = 0; subbandingDM < observation.getNrDMs(true); subbandingDM++)
+        {
+            for (unsigned int dm = 0; dm < observation.getNrDMs(); dm++)
+            {
+                const unsigned int state = (beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float))) + (subbandingDM * observation.getNrDMs()) + dm;
+                std::vector<float> localArray;
+                float median = 0.0f;
+
+                for (unsigned int sample = 0; sample < observation.getNrSamplesPerBatch() / observation.getDownsampling(); sample++)
+                {
+                    localArray.push_back(timeSeries.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + sample));
+                }
+                std::sort(localArray.begin(), localArray.end());
+                median = localArray.at(localArray.size() / 2);
+                for (auto item = localArray.begin(); item != localArray.end(); ++item)
+                {
+                    *item = std::abs(*item - median);
+                }
+                std::sort(localArray.begin(), localArray.end());
+                // The state is reset when it is empty, or when the baseline drifted out of the window of the histograms
+                if ((mads.at(state) > 0.0f) && (std::abs(median - baselines.at(state)) < (4.0f * mads.at(state))))
+                {
+                    baselines.at(state) += smoothing * (median - baselines.at(state));
+                    mads.at(state) += smoothing * (localArray.at(localArray.size() / 2) - mads.at(state));
+                }
+                else
+                {
+                    baselines.at(state) = median;
+                    mads.at(state) = localArray.at(localArray.size() / 2);
+                }
+            }
+        }
+    }
+}
+
+template <typename DataType>
+void streamingMedianAbsoluteDeviationCPU(const unsigned int nrBins, const float smoothing, const std::vector<DataType> &timeSeries, std::vector<float> &baselines, std::vector<float> &mads, const AstroData::Observation &observation, const unsigned int padding)
+{
+    const unsigned int nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    const unsigned int nrSamples = observation.getNrSamplesPerBatch() / observation.getDownsampling();
+    const uint64_t nrSamplesPadded = isa::utils::pad(nrSamples, padding / sizeof(DataType));
+
+#pragma omp parallel
+    {
+        std::vector<unsigned int> histogram(nrBins + 2);
+
+#pragma omp for collapse(2) schedule(static)
+        for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+        {
+            for (unsigned int dm = 0; dm < nrDMs; dm++)
+            {
+                const DataType *items = timeSeries.data() + (((beam * nrDMs) + dm) * nrSamplesPadded);
+                const unsigned int state = (beam * isa::utils::pad(nrDMs, padding / sizeof(float))) + dm;
+                float low = baselines[state] - (4.0f * mads[state]);
+                float width = (8.0f * mads[state]) / nrBins;
+                float median = 0.0f;
+                float deviation = 0.0f;
+                unsigned int attempt = 0;
+                unsigned int counter = 0;
+                unsigned int bin = 0;
+                // Histogram of the samples, or of their distance from the median, with underflow and overflow bins, and bin containing the element of rank nrSamples / 2
+                auto histogramRank = [&](const bool absoluteDeviation) {
+                    std::fill(histogram.begin(), histogram.end(), 0);
+                    for (unsigned int sample = 0; sample < nrSamples; sample++)
+                    {
+                        float position = ((absoluteDeviation ? std::abs(items[sample] - median) : static_cast<float>(items[sample])) - low) / width;
+
+                        if (position < 0.0f)
+                        {
+                            histogram[0]++;
+                        }
+                        else if (position >= nrBins)
+                        {
+                            histogram[nrBins + 1]++;
+                        }
+                        else
+                        {
+                            histogram[1 + static_cast<unsigned int>(position)]++;
+                        }
+                    }
+                    counter = histogram[0];
+                    bin = 1;
+                    while ((bin <= nrBins) && ((counter + histogram[bin]) <= (nrSamples / 2)))
+                    {
+                        counter += histogram[bin];
+                        bin++;
+                    }
+                };
+
+                for (attempt = (mads[state] > 0.0f) ? 0 : 1; attempt < 2; attempt++)
+                {
+                    if (attempt == 1)
+                    {
+                        const auto range = std::minmax_element(items, items + nrSamples);
+
+                        low = *(range.first);
+                        width = std::max((*(range.second) - low) / (nrBins - 1), std::numeric_limits<float>::min());
+                    }
+                    histogramRank(false);
+                    median = low + (width * ((bin - 1) + (((nrSamples / 2) - counter + 0.5f) / histogram[bin])));
+                    if ((histogram[0] <= (nrSamples / 2)) && (bin <= nrBins))
+                    {
+                        break;
+                    }
+                }
+                low = 0.0f;
+                histogramRank(true);
+                deviation = width * nrBins;
+                if (bin <= nrBins)
+                {
+                    deviation = width * ((bin - 1) + (((nrSamples / 2) - counter + 0.5f) / histogram[bin]));
+                }
+                if (attempt == 0)
+                {
+                    baselines[state] += smoothing * (median - baselines[state]);
+                    mads[state] += smoothing * (deviation - mads[state]);
+                }
+                else
+                {
+                    baselines[state] = median;
+                    mads[state] = deviation;
+                }
+            }
+        }
+    }
+}
+
+template <typename DataType>
+std::string *getMedianOfMediansAbsoluteDeviationOpenCL(const snrConf &conf, const DataOrdering ordering, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int stepSize, const unsigned int padding)
+{
+    std::string *code = 0;
+
+    if (ordering == DataOrdering::DMsSamples)
+    {
+        code = getMedianOfMediansAbsoluteDeviationDMsSamplesOpenCL<DataType>(conf, dataName, observation, downsampling, stepSize, padding);
+    }
+    else if (ordering == DataOrdering::SamplesDMs)
+    {
+        code = getMedianOfMediansAbsoluteDeviationSamplesDMsOpenCL<DataType>(conf, dataName, observation, downsampling, stepSize, padding);
+    }
+    return code;
+}
+
+template <typename DataType>
+std::string *getMedianOfMediansAbsoluteDeviationDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int stepSize, const unsigned int padding)
+{
+    std::string *code = new std::string();
+    unsigned int nrSamples = 0;
+    unsigned int nrDMs = 0;
+
+    if (conf.getSubbandDedispersion())
+    {
+        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    }
+    else
+    {
+        nrDMs = observation.getNrDMs();
+    }
+    nrSamples = observation.getNrSamplesPerBatch() / downsampling;
+    // Generate source code
+    *code = "__kernel void medianOfMediansAbsoluteDeviation_DMsSamples_" + std::to_string(stepSize) + "(__global const " + dataName + " * const restrict baselines, __global const " + dataName + " * const restrict time_series, __global " + dataName + " * const restrict medians) {\n"
+        "__local " + dataName + " local_data[" + std::to_string(stepSize) + "];\n"
+        + dataName + " baseline = baselines[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + get_group_id(1)];\n"
+        "\n"
+        "// Load data in shared memory\n"
+        "for ( unsigned int item = get_local_id(0); item < " + std::to_string(stepSize) + "; item += " + std::to_string(conf.getNrThreadsD0()) + " ) {\n"
+        "local_data[item] = fabs(time_series[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(0) * " + std::to_string(stepSize) + ") + item] - baseline);\n"
+        "}\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "// Odd-Even Sort\n"
+        "for ( unsigned int merge_step = " + std::to_string(static_cast<unsigned int>(std::pow(2, std::ceil(std::log2(stepSize)) - 1))) + "; merge_step > 0; merge_step /= 2 ) {\n"
+        "for ( unsigned int other_index = merge_step, sort_step = " + std::to_string(static_cast<unsigned int>(pow(2, std::ceil(std::log2(stepSize)) - 1))) + ", turn  = 0; other_index > 0; other_index = sort_step - merge_step, sort_step /= 2, turn = merge_step ) {\n"
+        "for ( unsigned int index = get_local_id(0); index < " + std::to_string(stepSize) + " - other_index; index += " + std::to_string(conf.getNrThreadsD0()) + " ) {\n"
+        "if ( ((index & merge_step) == turn) && (local_data[index] > local_data[index + other_index]) ) {\n"
+        + dataName + " temp = local_data[index];\n"
+        "local_data[index] = local_data[index + other_index];\n"
+        "local_data[index + other_index] = temp;\n"
+        "}\n"
+        "}\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "}\n"
+        "}\n"
+        "// Store median\n"
+        "if ( get_local_id(0) == 0 ) {\n"
+        "medians[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples / stepSize, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples / stepSize, padding / sizeof(DataType))) + ") + get_group_id(0)] = local_data[" + std::to_string(stepSize / 2) + "];\n"
+        "}\n"
+        "}\n";
+    return code;
+}
+
+template <typename DataType>
+std::string *getMedianOfMediansAbsoluteDeviationSamplesDMsOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int stepSize, const unsigned int padding)
+{
+    std::string *code = new std::string();
+    unsigned int nrSamples = 0;
+    unsigned int nrDMs = 0;
+
+    if (conf.getSubbandDedispersion())
+    {
+        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    }
+    else
+    {
+        nrDMs = observation.getNrDMs();
+    }
+    nrSamples = observation.getNrSamplesPerBatch() / downsampling;
+    // Generate source code
+    *code = "__kernel void medianOfMediansAbsoluteDeviation_SamplesDMs_" + std::to_string(stepSize) + "(__global const " + dataName + " * const restrict baselines, __global const " + dataName + " * const restrict time_series, __global " + dataName + " * const restrict medians) {\n"
+        "unsigned int dm = (get_group_id(0) * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(0);\n"
+        "int left = 0;\n"
+        "int right = " + std::to_string(stepSize - 1) + ";\n"
+        + dataName + " pivot;\n"
+        + dataName + " temp;\n"
+        + dataName + " baseline = baselines[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + dm];\n"
+        "__local " + dataName + " local_data[" + std::to_string(stepSize * conf.getNrThreadsD0()) + "];\n"
+        "\n"
+        "// Load data in shared memory, one column per DM\n"
+        "for ( unsigned int item = 0; item < " + std::to_string(stepSize) + "; item++ ) {\n"
+        "local_data[(item * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(0)] = fabs(time_series[(get_group_id(2) * " + std::to_string(nrSamples * isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + (((get_group_id(1) * " + std::to_string(stepSize) + ") + item) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + dm] - baseline);\n"
+        "}\n"
+        "// Selection of the median, every work-item works on its own column\n"
+        "while ( left < right ) {\n"
+        "int first = left;\n"
+        "int last = right;\n"
+        "pivot = local_data[(" + std::to_string(stepSize / 2) + " * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(0)];\n"
+        "do {\n"
+        "while ( local_data[(first * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(0)] < pivot ) {\n"
+        "first++;\n"
+        "}\n"
+        "while ( pivot < local_data[(last * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(0)] ) {\n"
+        "last--;\n"
+        "}\n"
+        "if ( first <= last ) {\n"
+        "temp = local_data[(first * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(0)];\n"
+        "local_data[(first * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(0)] = local_data[(last * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(0)];\n"
+        "local_data[(last * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(0)] = temp;\n"
+        "first++;\n"
+        "last--;\n"
+        "}\n"
+        "} while ( first <= last );\n"
+        "if ( last < " + std::to_string(stepSize / 2) + " ) {\n"
+        "left = first;\n"
+        "}\n"
+        "if ( " + std::to_string(stepSize / 2) + " < first ) {\n"
+        "right = last;\n"
+        "}\n"
+        "}\n"
+        "// Store median\n"
+        "medians[(get_group_id(2) * " + std::to_string((nrSamples / stepSize) * isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + dm] = local_data[(" + std::to_string(stepSize / 2) + " * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(0)];\n"
+        "}\n";
+    return code;
+}
+
+template <typename DataType>
+void medianOfMediansAbsoluteDeviation(const unsigned int stepSize, const std::vector<DataType> &baselines, const std::vector<DataType> &timeSeries, std::vector<DataType> &medians, const AstroData::Observation &observation, const unsigned int padding)
+{
+    for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+    {
+        for (unsigned int subbandingDM = 0; subbandingDM < observation.getNrDMs(true); subbandingDM++)
+        {
+            for (unsigned int dm = 0; dm < observation.getNrDMs(); dm++)
+            {
+                for (unsigned int step = 0; step < observation.getNrSamplesPerBatch() / observation.getDownsampling() / stepSize; step++)
+                {
+                    std::vector<DataType> localArray;
+
+                    for (unsigned int sample = 0; sample < stepSize; sample++)
+                    {
+                        localArray.push_back(std::abs(timeSeries.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (step * stepSize) + sample) - baselines.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs()) + dm)));
+                    }
+                    std::sort(localArray.begin(), localArray.end());
+                    medians.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling() / stepSize, padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling() / stepSize, padding / sizeof(DataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling() / stepSize, padding / sizeof(DataType))) + step) = localArray.at(stepSize / 2);
+                }
+            }
+        }
+    }
+}
+
+template <typename DataType>
+void medianOfMediansAbsoluteDeviationCPU(const unsigned int stepSize, const std::vector<DataType> &baselines, const std::vector<DataType> &timeSeries, std::vector<DataType> &medians, const AstroData::Observation &observation, const unsigned int padding)
+{
+    const unsigned int nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    const unsigned int nrSamples = observation.getNrSamplesPerBatch() / observation.getDownsampling();
+    const uint64_t nrSamplesPadded = isa::utils::pad(nrSamples, padding / sizeof(DataType));
+    const uint64_t nrStepsPadded = isa::utils::pad(nrSamples / stepSize, padding / sizeof(DataType));
+
+#pragma omp parallel
+    {
+        std::vector<DataType> localArray(stepSize);
+
+#pragma omp for collapse(2) schedule(static)
+        for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+        {
+            for (unsigned int dm = 0; dm < nrDMs; dm++)
+            {
+                const DataType baseline = baselines[(beam * isa::utils::pad(nrDMs, padding / sizeof(DataType))) + dm];
+                const DataType *items = timeSeries.data() + (((beam * nrDMs) + dm) * nrSamplesPadded);
+                DataType *deviations = localArray.data();
+
+                for (unsigned int step = 0; step < nrSamples / stepSize; step++)
+                {
+#pragma omp simd
+                    for (unsigned int sample = 0; sample < stepSize; sample++)
+                    {
+                        deviations[sample] = std::abs(items[(step * stepSize) + sample] - baseline);
+                    }
+                    std::nth_element(localArray.begin(), localArray.begin() + (stepSize / 2), localArray.end());
+                    medians[(((beam * nrDMs) + dm) * nrStepsPadded) + step] = localArray[stepSize / 2];
+                }
+            }
+        }
+    }
+}
+
+template <typename DataType>
+std::string * getAbsoluteDeviationOpenCL(const snrConf &conf, const DataOrdering ordering, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding)
+{
+    std::string *code = 0;
+
+    if (ordering == DataOrdering::DMsSamples)
+    {
+        code = getAbsoluteDeviationDMsSamplesOpenCL<DataType>(conf, dataName, observation, downsampling, padding);
+    }
+    else if (ordering == DataOrdering::SamplesDMs)
+    {
+        code = getAbsoluteDeviationSamplesDMsOpenCL<DataType>(conf, dataName, observation, downsampling, padding);
+    }
+    return code;
+}
+
+template <typename DataType>
+std::string * getAbsoluteDeviationDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding)
+{
+    std::string *code = new std::string();
+    unsigned int nrSamples = 0;
+    unsigned int nrDMs = 0;
+
+    if (conf.getSubbandDedispersion())
+    {
+        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    }
+    else
+    {
+        nrDMs = observation.getNrDMs();
+    }
+    nrSamples = observation.getNrSamplesPerBatch() / downsampling;
+    // Generate source code
+    *code = "__kernel void absolute_deviation_DMsSamples_" + std::to_string(nrSamples) + "(__global const " + dataName + " * const restrict baselines, __global const " + dataName + " * const restrict input_data, __global " + dataName + " * const restrict output_data) {\n"
+        "unsigned int item = (get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(0) * " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + ") + get_local_id(0);\n"
+        "<%COMPUTE_STORE%>"
+        "}\n";
+    std::string computeStoreTemplate = "output_data[item + <%ITEM_OFFSET%>] = fabs(input_data[item + <%ITEM_OFFSET%>] - baselines[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + get_group_id(1)]);\n";
+    std::string computeStore;
+    for (unsigned int item = 0; item < conf.getNrItemsD0(); item++)
+    {
+        std::string *temp;
+        std::string itemOffsetString = std::to_string(item * conf.getNrThreadsD0());
+        if (item == 0)
+        {
+            temp = isa::utils::replace(&computeStoreTemplate, " + <%ITEM_OFFSET%>", std::string());
+        }
+        else
+        {
+            temp = isa::utils::replace(&computeStoreTemplate, "<%ITEM_OFFSET%>", itemOffsetString);
+        }
+        computeStore.append(*temp);
+        delete temp;
+    }
+    code = isa::utils::replace(code, "<%COMPUTE_STORE%>", computeStore, true);
+    return code;
+}
+
+template <typename DataType>
+std::string * getAbsoluteDeviationSamplesDMsOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding)
+{
+    std::string *code = new std::string();
+    unsigned int nrSamples = 0;
+    unsigned int nrDMs = 0;
+
+    if (conf.getSubbandDedispersion())
+    {
+        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    }
+    else
+    {
+        nrDMs = observation.getNrDMs();
+    }
+    nrSamples = observation.getNrSamplesPerBatch() / downsampling;
+    // Generate source code
+    *code = "__kernel void absolute_deviation_SamplesDMs_" + std::to_string(nrDMs) + "(__global const " + dataName + " * const restrict baselines, __global const " + dataName + " * const restrict input_data, __global " + dataName + " * const restrict output_data) {\n"
+        "unsigned int dm = (get_group_id(0) * " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + ") + get_local_id(0);\n"
+        "unsigned int item = (get_group_id(2) * " + std::to_string(nrSamples * isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + dm;\n"
+        "<%COMPUTE_STORE%>"
+        "}\n";
+    std::string computeStoreTemplate = "output_data[item + <%ITEM_OFFSET%>] = fabs(input_data[item + <%ITEM_OFFSET%>] - baselines[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + dm + <%ITEM_OFFSET%>]);\n";
+    std::string computeStore;
+    for (unsigned int item = 0; item < conf.getNrItemsD0(); item++)
+    {
+        std::string *temp;
+        std::string itemOffsetString = std::to_string(item * conf.getNrThreadsD0());
+        if (item == 0)
+        {
+            temp = isa::utils::replace(&computeStoreTemplate, " + <%ITEM_OFFSET%>", std::string());
+        }
+        else
+        {
+            temp = isa::utils::replace(&computeStoreTemplate, "<%ITEM_OFFSET%>", itemOffsetString);
+        }
+        computeStore.append(*temp);
+        delete temp;
+    }
+    code = isa::utils::replace(code, "<%COMPUTE_STORE%>", computeStore, true);
+    return code;
+}
+
+template <typename DataType>
+void absoluteDeviation(const std::vector<DataType> &baselines, const std::vector<DataType> &timeSeries, std::vector<DataType> &absoluteDeviations, const AstroData::Observation &observation, const unsigned int padding)
+{
+    for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+    {
+        for (unsigned int subbandingDM = 0; subbandingDM < observation.getNrDMs(true); subbandingDM++)
+        {
+            for (unsigned int dm = 0; dm < observation.getNrDMs(); dm++)
+            {
+                for (unsigned int sample = 0; sample < observation.getNrSamplesPerBatch() / observation.getDownsampling(); sample++)
+                {
+                    absoluteDeviations.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + sample) = std::abs(timeSeries.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + sample) - baselines.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs()) + dm));
+                }
+            }
+        }
+    }
+}
+
+template <typename DataType>
+void absoluteDeviationTimeSeries(const DataType baseline, const DataType *timeSeries, DataType *absoluteDeviations, const unsigned int nrSamples, const bool nonTemporal)
+{
+#pragma omp simd
+    for (unsigned int sample = 0; sample < nrSamples; sample++)
+    {
+        absoluteDeviations[sample] = std::abs(timeSeries[sample] - baseline);
+    }
+}
+
+#ifdef __SSE__
+template <>
+inline void absoluteDeviationTimeSeries<float>(const float baseline, const float *timeSeries, float *absoluteDeviations, const unsigned int nrSamples, const bool nonTemporal)
+{
+    unsigned int sample = 0;
+
+    if (nonTemporal)
+    {
+        const __m128 baselines = _mm_set1_ps(baseline);
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+
+        // Non-temporal stores need aligned addresses
+        for (; (sample < nrSamples) && ((reinterpret_cast<uintptr_t>(absoluteDeviations + sample) % sizeof(__m128)) != 0); sample++)
+        {
+            absoluteDeviations[sample] = std::abs(timeSeries[sample] - baseline);
+        }
+        for (; sample + 4 <= nrSamples; sample += 4)
+        {
+            _mm_stream_ps(absoluteDeviations + sample, _mm_andnot_ps(signMask, _mm_sub_ps(_mm_loadu_ps(timeSeries + sample), baselines)));
+        }
+        _mm_sfence();
+    }
+#pragma omp simd
+    for (unsigned int item = sample; item < nrSamples; item++)
+    {
+        absoluteDeviations[item] = std::abs(timeSeries[item] - baseline);
+    }
+}
+#endif
+
+template <typename DataType>
+void absoluteDeviationCPU(const std::vector<DataType> &baselines, const std::vector<DataType> &timeSeries, std::vector<DataType> &absoluteDeviations, const AstroData::Observation &observation, const unsigned int padding)
+{
+    // Outputs that do not fit in the last level cache would only pollute it
+    const uint64_t nonTemporalThreshold = 32 * 1024 * 1024;
+    const unsigned int nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    const unsigned int nrSamples = observation.getNrSamplesPerBatch() / observation.getDownsampling();
+    const uint64_t nrSamplesPadded = isa::utils::pad(nrSamples, padding / sizeof(DataType));
+    const bool nonTemporal = (observation.getNrSynthesizedBeams() * nrDMs * nrSamplesPadded * sizeof(DataType)) > nonTemporalThreshold;
+
+#pragma omp parallel for collapse(2) schedule(static)
+    for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+    {
+        for (unsigned int dm = 0; dm < nrDMs; dm++)
+        {
+            const uint64_t offset = ((beam * nrDMs) + dm) * nrSamplesPadded;
+
+            absoluteDeviationTimeSeries(baselines[(beam * isa::utils::pad(nrDMs, padding / sizeof(DataType))) + dm], timeSeries.data() + offset, absoluteDeviations.data() + offset, nrSamples, nonTemporal);
+        }
+    }
+}
+
+template <typename DataType>
+void absoluteDeviationCPU(const std::vector<DataType> &baselines, std::vector<DataType> &timeSeries, const AstroData::Observation &observation, const unsigned int padding)
+{
+    absoluteDeviationCPU(baselines, timeSeries, timeSeries, observation, padding);
+}
+
+template <typename T>
+std::string *getSNRDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int padding)
+{
+    std::string *code = new std::string();
+    unsigned int nrDMs = 0;
+    unsigned int nrVectors = nrSamples / conf.getVectorWidth();
+
+    if (conf.getSubbandDedispersion())
+    {
+        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    }
+    else
+    {
+        nrDMs = observation.getNrDMs();
+    }
+    *code = "__kernel void snrDMsSamples" + std::to_string(nrSamples) + "(__global const " + dataName + " * const restrict input, __global float * const restrict outputSNR, __global unsigned int * const restrict outputSample) {\n"
+        "__local float reductionCOU[" + std::to_string(conf.getNrThreadsD0() * conf.getNrThreadsD1()) + "];\n"
+        "__local " + dataName + " reductionMAX[" + std::to_string(conf.getNrThreadsD0() * conf.getNrThreadsD1()) + "];\n"
+        "__local unsigned int reductionSAM[" + std::to_string(conf.getNrThreadsD0() * conf.getNrThreadsD1()) + "];\n"
+        "__local float reductionMEA[" + std::to_string(conf.getNrThreadsD0() * conf.getNrThreadsD1()) + "];\n"
+        "__local float reductionVAR[" + std::to_string(conf.getNrThreadsD0() * conf.getNrThreadsD1()) + "];\n"
+        "<%BEGIN_ROW_LOOP%>"
+        "float delta = 0.0f;\n"
+        "<%DEF%>"
+        "\n"
+        "// Compute phase\n"
+        "for ( unsigned int sample = get_local_id(0) + " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + "; sample < " + std::to_string(nrVectors) + "; sample += " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + " ) {\n"
+        + dataName + " item = 0;\n"
+        "<%COMPUTE%>"
+        "}\n"
+        "// In-thread reduce\n"
+        "<%REDUCE%>"
+        "<%REDUCE_PHASE%>"
+        "// Store\n"
+        "if ( get_local_id(0) == 0 ) {\n"
+        "outputSNR[(beam * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(float))) + ") + dm] = (max0 - mean0) / native_sqrt(variance0 * " + std::to_string(1.0f / (nrSamples - 1)) + "f);\n"
+        "outputSample[(beam * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + ") + dm] = maxSample0;\n"
+        "}\n"
+        "<%END_ROW_LOOP%>"
+        "}\n";
+    std::string reducePhase_s;
+    if (conf.getSubgroupReduction())
+    {
+        reducePhase_s = "// Sub-group reduce phase\n"
+            "delta = sub_group_reduce_add(counter0 * mean0) / sub_group_reduce_add(counter0);\n"
+            "variance0 = sub_group_reduce_add(variance0 + ((counter0 * (mean0 - delta)) * (mean0 - delta)));\n"
+            "counter0 = sub_group_reduce_add(counter0);\n"
+            "mean0 = delta;\n"
+            "maxSample0 = sub_group_reduce_min((max0 == sub_group_reduce_max(max0)) ? maxSample0 : UINT_MAX);\n"
+            "max0 = sub_group_reduce_max(max0);\n"
+            "// Local memory store\n"
+            "if ( get_sub_group_local_id() == 0 ) {\n"
+                "reductionCOU[get_sub_group_id()] = counter0;\n"
+                "reductionMAX[get_sub_group_id()] = max0;\n"
+                "reductionSAM[get_sub_group_id()] = maxSample0;\n"
+                "reductionMEA[get_sub_group_id()] = mean0;\n"
+                "reductionVAR[get_sub_group_id()] = variance0;\n"
+            "}\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "// Reduce phase\n"
+            "if ( get_sub_group_id() == 0 ) {\n"
+                "counter0 = 0.0f;\n"
+                "mean0 = 0.0f;\n"
+                "variance0 = 0.0f;\n"
+                "for ( unsigned int sample = get_sub_group_local_id(); sample < get_num_sub_groups(); sample += get_sub_group_size() ) {\n"
+                    "delta = reductionMEA[sample] - mean0;\n"
+                    "counter0 += reductionCOU[sample];\n"
+                    "mean0 = (((counter0 - reductionCOU[sample]) * mean0) + (reductionCOU[sample] * reductionMEA[sample])) / counter0;\n"
+                    "variance0 += reductionVAR[sample] + ((delta * delta) * (((counter0 - reductionCOU[sample]) * reductionCOU[sample]) / counter0));\n"
+                    "if ( reductionMAX[sample] > max0 ) {\n"
+                        "max0 = reductionMAX[sample];\n"
+                        "maxSample0 = reductionSAM[sample];\n"
+                    "}\n"
+                "}\n"
+                "delta = sub_group_reduce_add(counter0 * mean0) / sub_group_reduce_add(counter0);\n"
+                "variance0 = sub_group_reduce_add(variance0 + ((counter0 * (mean0 - delta)) * (mean0 - delta)));\n"
+                "counter0 = sub_group_reduce_add(counter0);\n"
+                "mean0 = delta;\n"
+                "maxSample0 = sub_group_reduce_min((max0 == sub_group_reduce_max(max0)) ? maxSample0 : UINT_MAX);\n"
+                "max0 = sub_group_reduce_max(max0);\n"
+            "}\n";
+    }
+    else
+    {
+        reducePhase_s = "// Local memory store\n"
+            "reductionCOU[get_local_id(0)] = counter0;\n"
+            "reductionMAX[get_local_id(0)] = max0;\n"
+            "reductionSAM[get_local_id(0)] = maxSample0;\n"
+            "reductionMEA[get_local_id(0)] = mean0;\n"
+            "reductionVAR[get_local_id(0)] = variance0;\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "// Reduce phase\n"
+            "unsigned int threshold = " + std::to_string(conf.getNrThreadsD0() / 2) + ";\n"
+            "for ( unsigned int sample = get_local_id(0); threshold > 0; threshold /= 2 ) {\n"
+                "if ( sample < threshold ) {\n"
+                    "delta = reductionMEA[sample + threshold] - mean0;\n"
+                    "counter0 += reductionCOU[sample + threshold];\n"
+                    "mean0 = ((reductionCOU[sample] * mean0) + (reductionCOU[sample + threshold] * reductionMEA[sample + threshold])) / counter0;\n"
+                    "variance0 += reductionVAR[sample + threshold] + ((delta * delta) * ((reductionCOU[sample] * reductionCOU[sample + threshold]) / counter0));\n"
+                    "if ( reductionMAX[sample + threshold] > max0 ) {\n"
+                        "max0 = reductionMAX[sample + threshold];\n"
+                        "maxSample0 = reductionSAM[sample + threshold];\n"
+                    "}\n"
+                    "reductionCOU[sample] = counter0;\n"
+                    "reductionMAX[sample] = max0;\n"
+                    "reductionSAM[sample] = maxSample0;\n"
+                    "reductionMEA[sample] = mean0;\n"
+                    "reductionVAR[sample] = variance0;\n"
+                "}\n"
+                "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "}\n";
+        if (conf.getNrThreadsD1() > 1)
+        {
+            // Every row of the work-group reduces its own slice of the local memory
+            std::string rowOffset_s = "(get_local_id(1) * " + std::to_string(conf.getNrThreadsD0()) + ") + ";
+
+            for (auto array : {"reductionCOU[", "reductionMAX[", "reductionSAM[", "reductionMEA[", "reductionVAR["})
+            {
+                std::string *temp = isa::utils::replace(&reducePhase_s, array, array + rowOffset_s);
+                reducePhase_s = *temp;
+                delete temp;
+            }
+        }
+    }
+    std::string def_sTemplate = dataName + " max<%NUM%> = input[(beam * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (dm * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (get_local_id(0) + <%OFFSET%>)];\n"
+        "unsigned int maxSample<%NUM%> = get_local_id(0) + <%OFFSET%>;\n"
+        "float counter<%NUM%> = 1.0f;\n"
+        "float variance<%NUM%> = 0.0f;\n"
+        "float mean<%NUM%> = max<%NUM%>;\n";
+    std::string compute_sTemplate;
+    if ((nrVectors % (conf.getNrThreadsD0() * conf.getNrItemsD0())) != 0)
+    {
+        compute_sTemplate += "if ( (sample + <%OFFSET%>) < " + std::to_string(nrVectors) + " ) {\n";
+    }
+    if (conf.getVectorWidth() > 1)
+    {
+        // Every item is a vector of contiguous samples, loaded at once and reduced in registers
+        std::string vectorWidth_s = std::to_string(conf.getVectorWidth());
+        std::string component_sTemplate = "counter<%NUM%> += 1.0f;\n"
+            "delta = vector<%NUM%>.s<%COMPONENT%> - mean<%NUM%>;\n"
+            "mean<%NUM%> += delta / counter<%NUM%>;\n"
+            "variance<%NUM%> += delta * (vector<%NUM%>.s<%COMPONENT%> - mean<%NUM%>);\n"
+            "if ( vector<%NUM%>.s<%COMPONENT%> > max<%NUM%> ) {\n"
+            "max<%NUM%> = vector<%NUM%>.s<%COMPONENT%>;\n"
+            "maxSample<%NUM%> = (<%VECTOR%> * " + vectorWidth_s + ") + <%COMPONENT_OFFSET%>;\n"
+            "}\n";
+
+        def_sTemplate = dataName + vectorWidth_s + " vector<%NUM%> = vload" + vectorWidth_s + "(get_local_id(0) + <%OFFSET%>, input + (beam * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (dm * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(T))) + "));\n"
+            + dataName + " max<%NUM%> = vector<%NUM%>.s0;\n"
+            "unsigned int maxSample<%NUM%> = (get_local_id(0) + <%OFFSET%>) * " + vectorWidth_s + ";\n"
+            "float counter<%NUM%> = 1.0f;\n"
+            "float variance<%NUM%> = 0.0f;\n"
+            "float mean<%NUM%> = max<%NUM%>;\n";
+        compute_sTemplate += "vector<%NUM%> = vload" + vectorWidth_s + "(sample + <%OFFSET%>, input + (beam * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (dm * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(T))) + "));\n";
+        for (unsigned int component = 0; component < conf.getVectorWidth(); component++)
+        {
+            std::string *temp = 0;
+
+            temp = isa::utils::replace(&component_sTemplate, "<%COMPONENT%>", std::string(1, "0123456789abcdef"[component]));
+            temp = isa::utils::replace(temp, "<%COMPONENT_OFFSET%>", std::to_string(component), true);
+            if (component > 0)
+            {
+                std::string *defTemp = isa::utils::replace(temp, "<%VECTOR%>", "(get_local_id(0) + <%OFFSET%>)");
+                def_sTemplate.append(*defTemp);
+                delete defTemp;
+            }
+            temp = isa::utils::replace(temp, "<%VECTOR%>", "(sample + <%OFFSET%>)", true);
+            compute_sTemplate.append(*temp);
+            delete temp;
+        }
+    }
+    else
+    {
+        compute_sTemplate += "item = input[(beam * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (dm * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (sample + <%OFFSET%>)];\n"
+            "counter<%NUM%> += 1.0f;\n"
+            "delta = item - mean<%NUM%>;\n"
+            "mean<%NUM%> += delta / counter<%NUM%>;\n"
+            "variance<%NUM%> += delta * (item - mean<%NUM%>);\n"
+            "if ( item > max<%NUM%> ) {\n"
+            "max<%NUM%> = item;\n"
+            "maxSample<%NUM%> = sample + <%OFFSET%>;\n"
+            "}\n";
+    }
+    if ((nrVectors % (conf.getNrThreadsD0() * conf.getNrItemsD0())) != 0)
+    {
+        compute_sTemplate += "}\n";
+    }
+    std::string reduce_sTemplate = "delta = mean<%NUM%> - mean0;\n"
+        "counter0 += counter<%NUM%>;\n"
+        "mean0 = (((counter0 - counter<%NUM%>) * mean0) + (counter<%NUM%> * mean<%NUM%>)) / counter0;\n"
+        "variance0 += variance<%NUM%> + ((delta * delta) * (((counter0 - counter<%NUM%>) * counter<%NUM%>) / counter0));\n"
+        "if ( max<%NUM%> > max0 ) {\n"
+        "max0 = max<%NUM%>;\n"
+        "maxSample0 = maxSample<%NUM%>;\n"
+        "}\n";
+
+    std::string *def_s = new std::string();
+    std::string *compute_s = new std::string();
+    std::string *reduce_s = new std::string();
+
+    for (unsigned int sample = 0; sample < conf.getNrItemsD0(); sample++)
+    {
+        std::string sample_s = std::to_string(sample);
+        std::string offset_s = std::to_string(conf.getNrThreadsD0() * sample);
+        std::string *temp = 0;
+
+        temp = isa::utils::replace(&def_sTemplate, "<%NUM%>", sample_s);
+        if (sample == 0)
+        {
+            std::string empty_s("");
+            temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
+        }
+        def_s->append(*temp);
+        delete temp;
+        temp = isa::utils::replace(&compute_sTemplate, "<%NUM%>", sample_s);
+        if (sample == 0)
+        {
+            std::string empty_s("");
+            temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
+        }
+        compute_s->append(*temp);
+        delete temp;
+        if (sample == 0)
+        {
+            continue;
+        }
+        temp = isa::utils::replace(&reduce_sTemplate, "<%NUM%>", sample_s);
+        reduce_s->append(*temp);
+        delete temp;
+    }
+
+    code = isa::utils::replace(code, "<%DEF%>", *def_s, true);
+    code = isa::utils::replace(code, "<%COMPUTE%>", *compute_s, true);
+    code = isa::utils::replace(code, "<%REDUCE%>", *reduce_s, true);
+    code = isa::utils::replace(code, "<%REDUCE_PHASE%>", reducePhase_s, true);
+    delete def_s;
+    delete compute_s;
+    delete reduce_s;
+    code = replaceRowLoopDMsSamplesOpenCL(conf, code, observation.getNrSynthesizedBeams(), nrDMs);
+    if (conf.getSubgroupReduction())
+    {
+        code->insert(0, "#pragma OPENCL EXTENSION cl_khr_subgroups : enable\n");
+    }
+
+    return code;
+}
+
+template <typename T>
+std::string *getSNRSamplesDMsOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int padding)
+{
+    unsigned int nrDMs = 0;
+    std::string *code = new std::string();
+
+    if (conf.getSubbandDedispersion())
+    {
+        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    }
+    else
+    {
+        nrDMs = observation.getNrDMs();
+    }
+    // Begin kernel's template
+    *code = "__kernel void snrSamplesDMs" + std::to_string(nrDMs) + "(__global const " + dataName + " * const restrict input, __global float * const restrict outputSNR, __global unsigned int * const restrict outputSample) {\n"
+        "unsigned int dm = (get_group_id(0) * " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + ") + get_local_id(0);\n"
+        "float delta = 0.0f;\n"
+        "<%DEF%>"
+        "\n"
+        "for ( unsigned int sample = 1; sample < " + std::to_string(nrSamples) + "; sample++ ) {\n"
+            + dataName + " item = 0;\n"
+            "<%COMPUTE%>"
+        "}\n"
+        "<%STORE%>"
+    "}\n";
+
+    std::string def_sTemplate = "float counter<%NUM%> = 1.0f;\n"
+    + dataName + " max<%NUM%> = input[(get_group_id(1) * " + std::to_string(nrSamples * isa::utils::pad(nrDMs, padding / sizeof(T))) + ") + (dm + <%OFFSET%>)];\n"
+    "unsigned int maxSample<%NUM%> = 0;\n"
+    "float variance<%NUM%> = 0.0f;\n"
+    "float mean<%NUM%> = max<%NUM%>;\n";
+
+    std::string compute_sTemplate = "item = input[(get_group_id(1) * " + std::to_string(nrSamples * isa::utils::pad(nrDMs, padding / sizeof(T))) + ") + (sample * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(T))) + ") + (dm + <%OFFSET%>)];\n"
+    "counter<%NUM%> += 1.0f;\n"
+    "delta = item - mean<%NUM%>;\n"
+    "mean<%NUM%> += delta / counter<%NUM%>;\n"
+    "variance<%NUM%> += delta * (item - mean<%NUM%>);\n"
+    "if ( item > max<%NUM%> ) {\n"
+        "max<%NUM%> = item;\n"
+        "maxSample<%NUM%> = sample;\n"
+    "}\n";
+
+    std::string store_sTemplate = "outputSNR[(get_group_id(1) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(float))) + ") + dm + <%OFFSET%>] = (max<%NUM%> - mean<%NUM%>) / native_sqrt(variance<%NUM%> * " + std::to_string(1.0f / (nrSamples - 1)) + "f);\n"
+    "outputSample[(get_group_id(1) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + ") + dm + <%OFFSET%>] = maxSample<%NUM%>;\n";
+    std::string localStore_sTemplate;
+    std::string merge_sTemplate;
+    if (conf.getNrThreadsD1() > 1)
+    {
+        // The samples are split among the rows of the work-group, and the first row merges the partial statistics
+        std::string nrThreads_s = std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0());
+        std::string nrRows_s = std::to_string(conf.getNrThreadsD1());
+        std::string localSize_s = std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0() * conf.getNrThreadsD1());
+
+        *code = "__kernel void snrSamplesDMs" + std::to_string(nrDMs) + "(__global const " + dataName + " * const restrict input, __global float * const restrict outputSNR, __global unsigned int * const restrict outputSample) {\n"
+            "unsigned int dm = (get_group_id(0) * " + nrThreads_s + ") + get_local_id(0);\n"
+            "float delta = 0.0f;\n"
+            "float counter = 0.0f;\n"
+            "<%DEF%>"
+            "__local float reductionCOU[" + localSize_s + "];\n"
+            "__local " + dataName + " reductionMAX[" + localSize_s + "];\n"
+            "__local unsigned int reductionSAM[" + localSize_s + "];\n"
+            "__local float reductionMEA[" + localSize_s + "];\n"
+            "__local float reductionVAR[" + localSize_s + "];\n"
+            "\n"
+            "for ( unsigned int sample = get_local_id(1) + " + nrRows_s + "; sample < " + std::to_string(nrSamples) + "; sample += " + nrRows_s + " ) {\n"
+                + dataName + " item = 0;\n"
+                "<%COMPUTE%>"
+            "}\n"
+            "<%LOCAL_STORE%>"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "if ( get_local_id(1) == 0 ) {\n"
+            "for ( unsigned int part = 1; part < " + nrRows_s + "; part++ ) {\n"
+                "<%MERGE%>"
+            "}\n"
+            "<%STORE%>"
+            "}\n"
+        "}\n";
+        def_sTemplate = "float counter<%NUM%> = 1.0f;\n"
+        + dataName + " max<%NUM%> = input[(get_group_id(1) * " + std::to_string(nrSamples * isa::utils::pad(nrDMs, padding / sizeof(T))) + ") + (get_local_id(1) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(T))) + ") + (dm + <%OFFSET%>)];\n"
+        "unsigned int maxSample<%NUM%> = get_local_id(1);\n"
+        "float variance<%NUM%> = 0.0f;\n"
+        "float mean<%NUM%> = max<%NUM%>;\n";
+        localStore_sTemplate = "reductionCOU[(get_local_id(1) * " + nrThreads_s + ") + get_local_id(0) + <%OFFSET%>] = counter<%NUM%>;\n"
+        "reductionMAX[(get_local_id(1) * " + nrThreads_s + ") + get_local_id(0) + <%OFFSET%>] = max<%NUM%>;\n"
+        "reductionSAM[(get_local_id(1) * " + nrThreads_s + ") + get_local_id(0) + <%OFFSET%>] = maxSample<%NUM%>;\n"
+        "reductionMEA[(get_local_id(1) * " + nrThreads_s + ") + get_local_id(0) + <%OFFSET%>] = mean<%NUM%>;\n"
+        "reductionVAR[(get_local_id(1) * " + nrThreads_s + ") + get_local_id(0) + <%OFFSET%>] = variance<%NUM%>;\n";
+        merge_sTemplate = "delta = reductionMEA[(part * " + nrThreads_s + ") + get_local_id(0) + <%OFFSET%>] - mean<%NUM%>;\n"
+        "counter = counter<%NUM%> + reductionCOU[(part * " + nrThreads_s + ") + get_local_id(0) + <%OFFSET%>];\n"
+        "mean<%NUM%> = ((counter<%NUM%> * mean<%NUM%>) + (reductionCOU[(part * " + nrThreads_s + ") + get_local_id(0) + <%OFFSET%>] * reductionMEA[(part * " + nrThreads_s + ") + get_local_id(0) + <%OFFSET%>])) / counter;\n"
+        "variance<%NUM%> += reductionVAR[(part * " + nrThreads_s + ") + get_local_id(0) + <%OFFSET%>] + ((delta * delta) * ((counter<%NUM%> * reductionCOU[(part * " + nrThreads_s + ") + get_local_id(0) + <%OFFSET%>]) / counter));\n"
+        "counter<%NUM%> = counter;\n"
+        "if ( (reductionMAX[(part * " + nrThreads_s + ") + get_local_id(0) + <%OFFSET%>] > max<%NUM%>) || ((reductionMAX[(part * " + nrThreads_s + ") + get_local_id(0) + <%OFFSET%>] == max<%NUM%>) && (reductionSAM[(part * " + nrThreads_s + ") + get_local_id(0) + <%OFFSET%>] < maxSample<%NUM%>)) ) {\n"
+            "max<%NUM%> = reductionMAX[(part * " + nrThreads_s + ") + get_local_id(0) + <%OFFSET%>];\n"
+            "maxSample<%NUM%> = reductionSAM[(part * " + nrThreads_s + ") + get_local_id(0) + <%OFFSET%>];\n"
+        "}\n";
+    }
+    // End kernel's template
+
+    std::string *def_s = new std::string();
+    std::string *compute_s = new std::string();
+    std::string *store_s = new std::string();
+    std::string *localStore_s = new std::string();
+    std::string *merge_s = new std::string();
+
+    for (unsigned int dm = 0; dm < conf.getNrItemsD0(); dm++)
+    {
+        std::string dm_s = std::to_string(dm);
+        std::string offset_s = std::to_string(conf.getNrThreadsD0() * dm);
+        std::string *temp = 0;
+
+        temp = isa::utils::replace(&def_sTemplate, "<%NUM%>", dm_s);
+        if (dm == 0)
+        {
+            std::string empty_s("");
+            temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
+        }
+        def_s->append(*temp);
+        delete temp;
+        temp = isa::utils::replace(&compute_sTemplate, "<%NUM%>", dm_s);
+        if (dm == 0)
+        {
+            std::string empty_s("");
+            temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
+        }
+        compute_s->append(*temp);
+        delete temp;
+        temp = isa::utils::replace(&store_sTemplate, "<%NUM%>", dm_s);
+        if (dm == 0)
+        {
+            std::string empty_s("");
+            temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
+        }
+        store_s->append(*temp);
+        delete temp;
+        if (conf.getNrThreadsD1() > 1)
+        {
+            temp = isa::utils::replace(&localStore_sTemplate, "<%NUM%>", dm_s);
+            if (dm == 0)
+            {
+                std::string empty_s("");
+                temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
+            }
+            else
+            {
+                temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
+            }
+            localStore_s->append(*temp);
+            delete temp;
+            temp = isa::utils::replace(&merge_sTemplate, "<%NUM%>", dm_s);
+            if (dm == 0)
+            {
+                std::string empty_s("");
+                temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
+            }
+            else
+            {
+                temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
+            }
+            merge_s->append(*temp);
+            delete temp;
+        }
+    }
+
+    code = isa::utils::replace(code, "<%DEF%>", *def_s, true);
+    code = isa::utils::replace(code, "<%COMPUTE%>", *compute_s, true);
+    code = isa::utils::replace(code, "<%STORE%>", *store_s, true);
+    if (conf.getNrThreadsD1() > 1)
+    {
+        code = isa::utils::replace(code, "<%LOCAL_STORE%>", *localStore_s, true);
+        code = isa::utils::replace(code, "<%MERGE%>", *merge_s, true);
+    }
+    delete def_s;
+    delete compute_s;
+    delete store_s;
+    delete localStore_s;
+    delete merge_s;
+
+    return code;
+}
+
+template <typename DataType>
+TimeSeriesStatistics<DataType> timeSeriesStatistics(const DataType *timeSeries, const unsigned int nrSamples)
+{
+    const unsigned int nrLanes = 16;
+    const unsigned int nrSteps = nrSamples / nrLanes;
+    TimeSeriesStatistics<DataType> statistics = {0.0f, 0.0f, 0.0f, static_cast<DataType>(0), 0};
+
+    if (nrSamples == 0)
+    {
+        return statistics;
+    }
+    statistics.max = timeSeries[0];
+    if (nrSteps > 0)
+    {
+        float mean[nrLanes];
+        float variance[nrLanes];
+        DataType max[nrLanes];
+        unsigned int maxSample[nrLanes];
+
+        for (unsigned int lane = 0; lane < nrLanes; lane++)
+        {
+            mean[lane] = timeSeries[lane];
+            variance[lane] = 0.0f;
+            max[lane] = timeSeries[lane];
+            maxSample[lane] = lane;
+        }
+        for (unsigned int step = 1; step < nrSteps; step++)
+        {
+            const DataType *items = timeSeries + (step * nrLanes);
+            const float inverseCounter = 1.0f / (step + 1);
+
+#pragma omp simd
+            for (unsigned int lane = 0; lane < nrLanes; lane++)
+            {
+                float delta = items[lane] - mean[lane];
+
+                mean[lane] += delta * inverseCounter;
+                variance[lane] += delta * (items[lane] - mean[lane]);
+                if (items[lane] > max[lane])
+                {
+                    max[lane] = items[lane];
+                    maxSample[lane] = (step * nrLanes) + lane;
+                }
+            }
+        }
+        statistics = {static_cast<float>(nrSteps), mean[0], variance[0], max[0], maxSample[0]};
+        for (unsigned int lane = 1; lane < nrLanes; lane++)
+        {
+            mergeStatistics(statistics, {static_cast<float>(nrSteps), mean[lane], variance[lane], max[lane], maxSample[lane]});
+        }
+    }
+    // Samples that do not fill all lanes
+    for (unsigned int sample = nrSteps * nrLanes; sample < nrSamples; sample++)
+    {
+        float delta = timeSeries[sample] - statistics.mean;
+
+        statistics.counter += 1.0f;
+        statistics.mean += delta / statistics.counter;
+        statistics.variance += delta * (timeSeries[sample] - statistics.mean);
+        if (timeSeries[sample] > statistics.max)
+        {
+            statistics.max = timeSeries[sample];
+            statistics.maxSample = sample;
+        }
+    }
+    return statistics;
+}
+
+template <typename DataType>
+void mergeStatistics(TimeSeriesStatistics<DataType> &statistics, const TimeSeriesStatistics<DataType> &other)
+{
+    if (other.counter > 0.0f)
+    {
+        float counter = statistics.counter + other.counter;
+        float delta = other.mean - statistics.mean;
+
+        statistics.mean = ((statistics.counter * statistics.mean) + (other.counter * other.mean)) / counter;
+        statistics.variance += other.variance + ((delta * delta) * ((statistics.counter * other.counter) / counter));
+        statistics.counter = counter;
+    }
+    if ((other.max > statistics.max) || ((other.max == statistics.max) && (other.maxSample < statistics.maxSample)))
+    {
+        statistics.max = other.max;
+        statistics.maxSample = other.maxSample;
+    }
+}
+
+template <typename DataType>
+void snrDMsSamplesCPU(const std::vector<DataType> &input, std::vector<float> &outputSNR, std::vector<unsigned int> &outputSample, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int padding)
+{
+    const unsigned int nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    const uint64_t nrSamplesPadded = isa::utils::pad(nrSamples, padding / sizeof(DataType));
+
+#pragma omp parallel for collapse(2) schedule(static)
+    for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+    {
+        for (unsigned int dm = 0; dm < nrDMs; dm++)
+        {
+            TimeSeriesStatistics<DataType> statistics = timeSeriesStatistics(input.data() + (((beam * nrDMs) + dm) * nrSamplesPadded), nrSamples);
+
+            outputSNR[(beam * isa::utils::pad(nrDMs, padding / sizeof(float))) + dm] = (statistics.max - statistics.mean) / std::sqrt(statistics.variance / (nrSamples - 1));
+            outputSample[(beam * isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + dm] = statistics.maxSample;
+        }
+    }
+}
+
+template <typename T>
+std::string *getSNRRunningStatisticsDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int nrSamples, const float decay, const unsigned int padding)
+{
+    std::string *code = new std::string();
+    unsigned int nrDMs = 0;
+
+    if (conf.getSubbandDedispersion())
+    {
+        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    }
+    else
+    {
+        nrDMs = observation.getNrDMs();
+    }
+    *code = "__kernel void snrRunningStatistics_DMsSamples_" + std::to_string(nrSamples) + "(__global const " + dataName + " * const restrict input, __global float * const restrict outputSNR, __global unsigned int * const restrict outputSample, __global float * const restrict counters, __global float * const restrict means, __global float * const restrict variances) {\n"
+        "float delta = 0.0f;\n"
+        "<%DEF%>"
+        "__local float reductionCOU[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "__local " + dataName + " reductionMAX[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "__local unsigned int reductionSAM[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "__local float reductionMEA[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "__local float reductionVAR[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "\n"
+        "// Compute phase\n"
+        "for ( unsigned int sample = get_local_id(0) + " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + "; sample < " + std::to_string(nrSamples) + "; sample += " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + " ) {\n"
+        + dataName + " item = 0;\n"
+        "<%COMPUTE%>"
+        "}\n"
+        "// In-thread reduce\n"
+        "<%REDUCE%>"
+        "// Local memory store\n"
+        "reductionCOU[get_local_id(0)] = counter0;\n"
+        "reductionMAX[get_local_id(0)] = max0;\n"
+        "reductionSAM[get_local_id(0)] = maxSample0;\n"
+        "reductionMEA[get_local_id(0)] = mean0;\n"
+        "reductionVAR[get_local_id(0)] = variance0;\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "// Reduce phase\n"
+        "unsigned int threshold = " + std::to_string(conf.getNrThreadsD0() / 2) + ";\n"
+        "for ( unsigned int sample = get_local_id(0); threshold > 0; threshold /= 2 ) {\n"
+            "if ( sample < threshold ) {\n"
+                "delta = reductionMEA[sample + threshold] - mean0;\n"
+                "counter0 += reductionCOU[sample + threshold];\n"
+                "mean0 = ((reductionCOU[sample] * mean0) + (reductionCOU[sample + threshold] * reductionMEA[sample + threshold])) / counter0;\n"
+                "variance0 += reductionVAR[sample + threshold] + ((delta * delta) * ((reductionCOU[sample] * reductionCOU[sample + threshold]) / counter0));\n"
+                "if ( reductionMAX[sample + threshold] > max0 ) {\n"
+                    "max0 = reductionMAX[sample + threshold];\n"
+                    "maxSample0 = reductionSAM[sample + threshold];\n"
+                "}\n"
+                "reductionCOU[sample] = counter0;\n"
+                "reductionMAX[sample] = max0;\n"
+                "reductionSAM[sample] = maxSample0;\n"
+                "reductionMEA[sample] = mean0;\n"
+                "reductionVAR[sample] = variance0;\n"
+            "}\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "}\n"
+        "// Merge the batch into the state, and store\n"
+        "if ( get_local_id(0) == 0 ) {\n"
+        "const unsigned int state = (get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(float))) + ") + get_group_id(1);\n"
+        "float stateCounter = counters[state] * " + std::to_string(decay) + "f;\n"
+        "delta = mean0 - means[state];\n"
+        "counter0 += stateCounter;\n"
+        "mean0 = ((stateCounter * means[state]) + ((counter0 - stateCounter) * mean0)) / counter0;\n"
+        "variance0 += (variances[state] * " + std::to_string(decay) + "f) + ((delta * delta) * ((stateCounter * (counter0 - stateCounter)) / counter0));\n"
+        "counters[state] = counter0;\n"
+        "means[state] = mean0;\n"
+        "variances[state] = variance0;\n"
+        "outputSNR[state] = (max0 - mean0) / native_sqrt(variance0 / (counter0 - 1.0f));\n"
+        "outputSample[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + ") + get_group_id(1)] = maxSample0;\n"
+        "}\n"
+        "}\n";
+    std::string def_sTemplate = dataName + " max<%NUM%> = input[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (get_local_id(0) + <%OFFSET%>)];\n"
+        "unsigned int maxSample<%NUM%> = get_local_id(0) + <%OFFSET%>;\n"
+        "float counter<%NUM%> = 1.0f;\n"
+        "float variance<%NUM%> = 0.0f;\n"
+        "float mean<%NUM%> = max<%NUM%>;\n";
+    std::string compute_sTemplate;
+    if ((nrSamples % (conf.getNrThreadsD0() * conf.getNrItemsD0())) != 0)
+    {
+        compute_sTemplate += "if ( (sample + <%OFFSET%>) < " + std::to_string(nrSamples) + " ) {\n";
+    }
+    compute_sTemplate += "item = input[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (sample + <%OFFSET%>)];\n"
+        "counter<%NUM%> += 1.0f;\n"
+        "delta = item - mean<%NUM%>;\n"
+        "mean<%NUM%> += delta / counter<%NUM%>;\n"
+        "variance<%NUM%> += delta * (item - mean<%NUM%>);\n"
+        "if ( item > max<%NUM%> ) {\n"
+        "max<%NUM%> = item;\n"
+        "maxSample<%NUM%> = sample + <%OFFSET%>;\n"
+        "}\n";
+    if ((nrSamples % (conf.getNrThreadsD0() * conf.getNrItemsD0())) != 0)
+    {
+        compute_sTemplate += "}\n";
+    }
+    std::string reduce_sTemplate = "delta = mean<%NUM%> - mean0;\n"
+        "counter0 += counter<%NUM%>;\n"
+        "mean0 = (((counter0 - counter<%NUM%>) * mean0) + (counter<%NUM%> * mean<%NUM%>)) / counter0;\n"
+        "variance0 += variance<%NUM%> + ((delta * delta) * (((counter0 - counter<%NUM%>) * counter<%NUM%>) / counter0));\n"
+        "if ( max<%NUM%> > max0 ) {\n"
+        "max0 = max<%NUM%>;\n"
+        "maxSample0 = maxSample<%NUM%>;\n"
+        "}\n";
+
+    std::string *def_s = new std::string();
+    std::string *compute_s = new std::string();
+    std::string *reduce_s = new std::string();
+
+    for (unsigned int sample = 0; sample < conf.getNrItemsD0(); sample++)
+    {
+        std::string sample_s = std::to_string(sample);
+        std::string offset_s = std::to_string(conf.getNrThreadsD0() * sample);
+        std::string *temp = 0;
+
+        temp = isa::utils::replace(&def_sTemplate, "<%NUM%>", sample_s);
+        if (sample == 0)
+        {
+            std::string empty_s("");
+            temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
+        }
+        def_s->append(*temp);
+        delete temp;
+        temp = isa::utils::replace(&compute_sTemplate, "<%NUM%>", sample_s);
+        if (sample == 0)
+        {
+            std::string empty_s("");
+            temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
+        }
+        compute_s->append(*temp);
+        delete temp;
+        if (sample == 0)
+        {
+            continue;
+        }
+        temp = isa::utils::replace(&reduce_sTemplate, "<%NUM%>", sample_s);
+        reduce_s->append(*temp);
+        delete temp;
+    }
+
+    code = isa::utils::replace(code, "<%DEF%>", *def_s, true);
+    code = isa::utils::replace(code, "<%COMPUTE%>", *compute_s, true);
+    code = isa::utils::replace(code, "<%REDUCE%>", *reduce_s, true);
+    delete def_s;
+    delete compute_s;
+    delete reduce_s;
+
+    return code;
+}
+
+template <typename DataType>
+void snrRunningStatistics(const float decay, const std::vector<DataType> &input, std::vector<float> &counters, std::vector<float> &means, std::vector<float> &variances, std::vector<float> &snr, const AstroData::Observation &observation, const unsigned int padding)
+{
+    for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+    {
+        for (unsigned int subbandingDM = 0; subbandingDM < observation.getNrDMs(true); subbandingDM++)
+        {
+            for (unsigned int dm = 0; dm < observation.getNrDMs(); dm++)
+            {
+                const unsigned int state = (beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float))) + (subbandingDM * observation.getNrDMs()) + dm;
+                const DataType *timeSeries = input.data() + (beam * observation.getNrDMs(true) * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(DataType))) + (dm * observation.getNrSamplesPerBatch(false, padding / sizeof(DataType)));
+                double counter = observation.getNrSamplesPerBatch();
+                double mean = 0.0;
+                double variance = 0.0;
+                double max = timeSeries[0];
+
+                for (unsigned int sample = 0; sample < observation.getNrSamplesPerBatch(); sample++)
+                {
+                    mean += timeSeries[sample];
+                    max = std::max(max, static_cast<double>(timeSeries[sample]));
+                }
+                mean /= counter;
+                for (unsigned int sample = 0; sample < observation.getNrSamplesPerBatch(); sample++)
+                {
+                    variance += (timeSeries[sample] - mean) * (timeSeries[sample] - mean);
+                }
+                // Merge the batch into the decayed state
+                double stateCounter = counters.at(state) * static_cast<double>(decay);
+                double delta = mean - means.at(state);
+
+                counter += stateCounter;
+                mean = ((stateCounter * means.at(state)) + ((counter - stateCounter) * mean)) / counter;
+                variance += (variances.at(state) * static_cast<double>(decay)) + ((delta * delta) * ((stateCounter * (counter - stateCounter)) / counter));
+                counters.at(state) = counter;
+                means.at(state) = mean;
+                variances.at(state) = variance;
+                snr.at(state) = (max - mean) / std::sqrt(variance / (counter - 1.0));
+            }
+        }
+    }
+}
+
+template <typename DataType>
+void snrRunningStatisticsDMsSamplesCPU(const std::vector<DataType> &input, std::vector<float> &counters, std::vector<float> &means, std::vector<float> &variances, std::vector<float> &outputSNR, std::vector<unsigned int> &outputSample, const AstroData::Observation &observation, const unsigned int nrSamples, const float decay, const unsigned int padding)
+{
+    const unsigned int nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    const uint64_t nrSamplesPadded = isa::utils::pad(nrSamples, padding / sizeof(DataType));
+
+#pragma omp parallel for collapse(2) schedule(static)
+    for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+    {
+        for (unsigned int dm = 0; dm < nrDMs; dm++)
+        {
+            const unsigned int state = (beam * isa::utils::pad(nrDMs, padding / sizeof(float))) + dm;
+            TimeSeriesStatistics<DataType> statistics = timeSeriesStatistics(input.data() + (((beam * nrDMs) + dm) * nrSamplesPadded), nrSamples);
+            TimeSeriesStatistics<DataType> stateStatistics = {counters[state] * decay, means[state], variances[state] * decay, statistics.max, statistics.maxSample};
+
+            mergeStatistics(stateStatistics, statistics);
+            counters[state] = stateStatistics.counter;
+            means[state] = stateStatistics.mean;
+            variances[state] = stateStatistics.variance;
+            outputSNR[state] = (statistics.max - stateStatistics.mean) / std::sqrt(stateStatistics.variance / (stateStatistics.counter - 1.0f));
+            outputSample[(beam * isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + dm] = statistics.maxSample;
+        }
+    }
+}
+
+template <typename T>
+std::string *getSNRSigmaCutDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int padding, const float nSigma, const float correctionFactor)
+{
+    std::string *code = new std::string();
+    unsigned int nrDMs = 0;
+
+    if (conf.getSubbandDedispersion())
+    {
+        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    }
+    else
+    {
+        nrDMs = observation.getNrDMs();
+    }
+    *code = "__kernel void snrSigmaCutDMsSamples" + std::to_string(nrSamples) + "(__global const " + dataName + " * const restrict input, __global float * const restrict outputSNR, __global unsigned int * const restrict outputSample) {\n"
+        "float delta = 0.0f;\n"
+        "float mean = 0.0f;\n"
+        "float sigma_threshold = 0.0f;\n"
+        "<%DEF%>"
+        "__local float reductionCOU[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "__local " + dataName + " reductionMAX[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "__local unsigned int reductionSAM[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "__local float reductionMEA[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "__local float reductionVAR[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "\n"
+        "// Compute statistics for sigma\n"
+        "// Compute phase\n"
+        "for ( unsigned int sample = get_local_id(0) + " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + "; sample < " + std::to_string(nrSamples) + "; sample += " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + " ) {\n"
+        + dataName + " item = 0;\n"
+        "<%COMPUTE%>"
+        "}\n"
+        "// In-thread reduce (optional)\n"
+        "<%REDUCE%>"
+        "<%REDUCE_PHASE%>"
+        "mean = reductionMEA[0];\n"
+        "sigma_threshold = (" + std::to_string(nSigma) + " * native_sqrt(reductionVAR[0] * " + std::to_string(1.0f/(nrSamples - 1)) + "f));\n"
+        "// Compute SNR with sigma cut\n"
+        "<%CLEAN%>"
+        "// Compute phase\n"
+        "for ( unsigned int sample = get_local_id(0); sample < " + std::to_string(nrSamples) + "; sample += " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + " ) {\n"
+        + dataName + " item = 0;\n"
+        "<%COMPUTE_CUT%>"
+        "}\n"
+        "// In-thread reduce (optional)\n"
+        "<%REDUCE%>"
+        "<%REDUCE_PHASE_CUT%>"
+        "// Store\n"
+        "if ( get_local_id(0) == 0 ) {\n"
+        "outputSNR[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(float))) + ") + get_group_id(1)] = (max0 - mean0) / (native_sqrt(variance0 / (counter0 - 1)) * " + std::to_string(correctionFactor) + ");\n"
+        "outputSample[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + ") + get_group_id(1)] = maxSample0;\n"
+        "}\n"
+        "}\n";
+    std::string reducePhase_s;
+    if (conf.getSubgroupReduction())
+    {
+        reducePhase_s = "// Sub-group reduce phase\n"
+            "delta = sub_group_reduce_add(counter0 * mean0) / sub_group_reduce_add(counter0);\n"
+            "variance0 = sub_group_reduce_add(variance0 + ((counter0 * (mean0 - delta)) * (mean0 - delta)));\n"
+            "counter0 = sub_group_reduce_add(counter0);\n"
+            "mean0 = delta;\n"
+            "maxSample0 = sub_group_reduce_min((max0 == sub_group_reduce_max(max0)) ? maxSample0 : UINT_MAX);\n"
+            "max0 = sub_group_reduce_max(max0);\n"
+            "// Local memory store\n"
+            "if ( get_sub_group_local_id() == 0 ) {\n"
+                "reductionCOU[get_sub_group_id()] = counter0;\n"
+                "reductionMAX[get_sub_group_id()] = max0;\n"
+                "reductionSAM[get_sub_group_id()] = maxSample0;\n"
+                "reductionMEA[get_sub_group_id()] = mean0;\n"
+                "reductionVAR[get_sub_group_id()] = variance0;\n"
+            "}\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "// Reduce phase\n"
+            "if ( get_sub_group_id() == 0 ) {\n"
+                "counter0 = 0.0f;\n"
+                "mean0 = 0.0f;\n"
+                "variance0 = 0.0f;\n"
+                "for ( unsigned int sample = get_sub_group_local_id(); sample < get_num_sub_groups(); sample += get_sub_group_size() ) {\n"
+                    "delta = reductionMEA[sample] - mean0;\n"
+                    "counter0 += reductionCOU[sample];\n"
+                    "mean0 = (((counter0 - reductionCOU[sample]) * mean0) + (reductionCOU[sample] * reductionMEA[sample])) / counter0;\n"
+                    "variance0 += reductionVAR[sample] + ((delta * delta) * (((counter0 - reductionCOU[sample]) * reductionCOU[sample]) / counter0));\n"
+                    "if ( reductionMAX[sample] > max0 ) {\n"
+                        "max0 = reductionMAX[sample];\n"
+                        "maxSample0 = reductionSAM[sample];\n"
+                    "}\n"
+                "}\n"
+                "delta = sub_group_reduce_add(counter0 * mean0) / sub_group_reduce_add(counter0);\n"
+                "variance0 = sub_group_reduce_add(variance0 + ((counter0 * (mean0 - delta)) * (mean0 - delta)));\n"
+                "counter0 = sub_group_reduce_add(counter0);\n"
+                "mean0 = delta;\n"
+                "maxSample0 = sub_group_reduce_min((max0 == sub_group_reduce_max(max0)) ? maxSample0 : UINT_MAX);\n"
+                "max0 = sub_group_reduce_max(max0);\n"
+            "}\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "if ( get_local_id(0) == 0 ) {\n"
+                "reductionMEA[0] = mean0;\n"
+                "reductionVAR[0] = variance0;\n"
+            "}\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n";
+    }
+    else
+    {
+        reducePhase_s = "// Local memory store\n"
+            "reductionCOU[get_local_id(0)] = counter0;\n"
+            "reductionMAX[get_local_id(0)] = max0;\n"
+            "reductionSAM[get_local_id(0)] = maxSample0;\n"
+            "reductionMEA[get_local_id(0)] = mean0;\n"
+            "reductionVAR[get_local_id(0)] = variance0;\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "// Reduce phase\n"
+            "unsigned int threshold = " + std::to_string(conf.getNrThreadsD0() / 2) + ";\n"
+            "for ( unsigned int sample = get_local_id(0); threshold > 0; threshold /= 2 ) {\n"
+                "if ( sample < threshold ) {\n"
+                    "delta = reductionMEA[sample + threshold] - mean0;\n"
+                    "counter0 += reductionCOU[sample + threshold];\n"
+                    "mean0 = ((reductionCOU[sample] * mean0) + (reductionCOU[sample + threshold] * reductionMEA[sample + threshold])) / counter0;\n"
+                    "variance0 += reductionVAR[sample + threshold] + ((delta * delta) * ((reductionCOU[sample] * reductionCOU[sample + threshold]) / counter0));\n"
+                    "if ( reductionMAX[sample + threshold] > max0 ) {\n"
+                        "max0 = reductionMAX[sample + threshold];\n"
+                        "maxSample0 = reductionSAM[sample + threshold];\n"
+                    "}\n"
+                    "reductionCOU[sample] = counter0;\n"
+                    "reductionMAX[sample] = max0;\n"
+                    "reductionSAM[sample] = maxSample0;\n"
+                    "reductionMEA[sample] = mean0;\n"
+                    "reductionVAR[sample] = variance0;\n"
+                "}\n"
+                "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "}\n";
+    }
+    std::string reducePhaseCut_s;
+    if (conf.getSubgroupReduction())
+    {
+        reducePhaseCut_s = "// Sub-group reduce phase\n"
+            "delta = sub_group_reduce_add(counter0 * mean0) / sub_group_reduce_add(counter0);\n"
+            "variance0 = sub_group_reduce_add(variance0 + ((counter0 * (mean0 - delta)) * (mean0 - delta)));\n"
+            "counter0 = sub_group_reduce_add(counter0);\n"
+            "mean0 = delta;\n"
+            "// Local memory store\n"
+            "if ( get_sub_group_local_id() == 0 ) {\n"
+                "reductionCOU[get_sub_group_id()] = counter0;\n"
+                "reductionMEA[get_sub_group_id()] = mean0;\n"
+                "reductionVAR[get_sub_group_id()] = variance0;\n"
+            "}\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "// Reduce phase\n"
+            "if ( get_sub_group_id() == 0 ) {\n"
+                "counter0 = 0.0f;\n"
+                "mean0 = 0.0f;\n"
+                "variance0 = 0.0f;\n"
+                "for ( unsigned int sample = get_sub_group_local_id(); sample < get_num_sub_groups(); sample += get_sub_group_size() ) {\n"
+                    "delta = reductionMEA[sample] - mean0;\n"
+                    "counter0 += reductionCOU[sample];\n"
+                    "mean0 = (((counter0 - reductionCOU[sample]) * mean0) + (reductionCOU[sample] * reductionMEA[sample])) / counter0;\n"
+                    "variance0 += reductionVAR[sample] + ((delta * delta) * (((counter0 - reductionCOU[sample]) * reductionCOU[sample]) / counter0));\n"
+                "}\n"
+                "delta = sub_group_reduce_add(counter0 * mean0) / sub_group_reduce_add(counter0);\n"
+                "variance0 = sub_group_reduce_add(variance0 + ((counter0 * (mean0 - delta)) * (mean0 - delta)));\n"
+                "counter0 = sub_group_reduce_add(counter0);\n"
+                "mean0 = delta;\n"
+            "}\n";
+    }
+    else
+    {
+        reducePhaseCut_s = "// Local memory store\n"
+            "reductionCOU[get_local_id(0)] = counter0;\n"
+            "reductionMEA[get_local_id(0)] = mean0;\n"
+            "reductionVAR[get_local_id(0)] = variance0;\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "// Reduce phase\n"
+            "threshold = " + std::to_string(conf.getNrThreadsD0() / 2) + ";\n"
+            "for ( unsigned int sample = get_local_id(0); threshold > 0; threshold /= 2 ) {\n"
+                "if ( sample < threshold ) {\n"
+                    "delta = reductionMEA[sample + threshold] - mean0;\n"
+                    "counter0 += reductionCOU[sample + threshold];\n"
+                    "mean0 = ((reductionCOU[sample] * mean0) + (reductionCOU[sample + threshold] * reductionMEA[sample + threshold])) / counter0;\n"
+                    "variance0 += reductionVAR[sample + threshold] + ((delta * delta) * ((reductionCOU[sample] * reductionCOU[sample + threshold]) / counter0));\n"
+                    "reductionCOU[sample] = counter0;\n"
+                    "reductionMEA[sample] = mean0;\n"
+                    "reductionVAR[sample] = variance0;\n"
+                "}\n"
+                "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "}\n";
+    }
+    std::string def_sTemplate = dataName + " max<%NUM%> = input[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (get_local_id(0) + <%OFFSET%>)];\n"
+        "unsigned int maxSample<%NUM%> = get_local_id(0) + <%OFFSET%>;\n"
+        "float counter<%NUM%> = 1.0f;\n"
+        "float variance<%NUM%> = 0.0f;\n"
+        "float mean<%NUM%> = max<%NUM%>;\n";
+    std::string clean_sTemplate = "counter<%NUM%> = 0.0f;\n"
+        "variance<%NUM%> = 0.0f;\n"
+        "mean<%NUM%> = 0.0f;\n";
+    std::string compute_sTemplate;
+    if ((nrSamples % (conf.getNrThreadsD0() * conf.getNrItemsD0())) != 0)
+    {
+        compute_sTemplate += "if ( (sample + <%OFFSET%>) < " + std::to_string(nrSamples) + " ) {\n";
+    }
+    compute_sTemplate += "item = input[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (sample + <%OFFSET%>)];\n"
+        "counter<%NUM%> += 1.0f;\n"
+        "delta = item - mean<%NUM%>;\n"
+        "mean<%NUM%> += delta / counter<%NUM%>;\n"
+        "variance<%NUM%> += delta * (item - mean<%NUM%>);\n"
+        "if ( item > max<%NUM%> ) {\n"
+        "max<%NUM%> = item;\n"
+        "maxSample<%NUM%> = sample + <%OFFSET%>;\n"
+        "}\n";
+    if ((nrSamples % (conf.getNrThreadsD0() * conf.getNrItemsD0())) != 0)
+    {
+        compute_sTemplate += "}\n";
+    }
+    std::string computeCut_sTemplate;
+    if ((nrSamples % (conf.getNrThreadsD0() * conf.getNrItemsD0())) != 0)
+    {
+        computeCut_sTemplate += "if ( (sample + <%OFFSET%>) < " + std::to_string(nrSamples) + " ) {\n";
+    }
+    computeCut_sTemplate += "item = input[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (sample + <%OFFSET%>)];\n"
+        "if ( fabs(item - mean) < sigma_threshold ) {\n"
+        "counter<%NUM%> += 1.0f;\n"
+        "delta = item - mean<%NUM%>;\n"
+        "mean<%NUM%> += delta / counter<%NUM%>;\n"
+        "variance<%NUM%> += delta * (item - mean<%NUM%>);\n"
+        "}\n";
+    if ((nrSamples % (conf.getNrThreadsD0() * conf.getNrItemsD0())) != 0)
+    {
+        computeCut_sTemplate += "}\n";
+    }
+    std::string reduce_sTemplate = "delta = mean<%NUM%> - mean0;\n"
+        "counter0 += counter<%NUM%>;\n"
+        "mean0 = (((counter0 - counter<%NUM%>) * mean0) + (counter<%NUM%> * mean<%NUM%>)) / counter0;\n"
+        "variance0 += variance<%NUM%> + ((delta * delta) * (((counter0 - counter<%NUM%>) * counter<%NUM%>) / counter0));\n"
+        "if ( max<%NUM%> > max0 ) {\n"
+        "max0 = max<%NUM%>;\n"
+        "maxSample0 = maxSample<%NUM%>;\n"
+        "}\n";
+
+    std::string * def_s = new std::string();
+    std::string * compute_s = new std::string();
+    std::string * clean_s = new std::string();
+    std::string * computeCut_s = new std::string();
+    std::string * reduce_s = new std::string();
+
+    for (unsigned int sample = 0; sample < conf.getNrItemsD0(); sample++)
+    {
+        std::string sample_s = std::to_string(sample);
+        std::string offset_s = std::to_string(conf.getNrThreadsD0() * sample);
+        std::string * temp = nullptr;
+
+        temp = isa::utils::replace(&def_sTemplate, "<%NUM%>", sample_s);
+        if (sample == 0)
+        {
+            std::string empty_s("");
+            temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
+        }
+        def_s->append(*temp);
+        delete temp;
+        temp = isa::utils::replace(&clean_sTemplate, "<%NUM%>", sample_s);
+        if (sample == 0)
+        {
+            std::string empty_s("");
+            temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
+        }
+        clean_s->append(*temp);
+        delete temp;
+        temp = isa::utils::replace(&compute_sTemplate, "<%NUM%>", sample_s);
+        if (sample == 0)
+        {
+            std::string empty_s("");
+            temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
+        }
+        compute_s->append(*temp);
+        delete temp;
+        temp = isa::utils::replace(&computeCut_sTemplate, "<%NUM%>", sample_s);
+        if (sample == 0)
+        {
+            std::string empty_s("");
+            temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
+        }
+        computeCut_s->append(*temp);
+        delete temp;
+        if (sample == 0)
+        {
+            continue;
+        }
+        temp = isa::utils::replace(&reduce_sTemplate, "<%NUM%>", sample_s);
+        reduce_s->append(*temp);
+        delete temp;
+    }
+
+    code = isa::utils::replace(code, "<%DEF%>", *def_s, true);
+    code = isa::utils::replace(code, "<%COMPUTE%>", *compute_s, true);
+    code = isa::utils::replace(code, "<%CLEAN%>", *clean_s, true);
+    code = isa::utils::replace(code, "<%COMPUTE_CUT%>", *computeCut_s, true);
+    code = isa::utils::replace(code, "<%REDUCE%>", *reduce_s, true);
+    code = isa::utils::replace(code, "<%REDUCE_PHASE%>", reducePhase_s, true);
+    code = isa::utils::replace(code, "<%REDUCE_PHASE_CUT%>", reducePhaseCut_s, true);
+    delete def_s;
+    delete compute_s;
+    delete clean_s;
+    delete reduce_s;
+    if (conf.getSubgroupReduction())
+    {
+        code->insert(0, "#pragma OPENCL EXTENSION cl_khr_subgroups : enable\n");
+    }
+
+    return code;
+}
+
+template <typename T>
+std::string *getIterativeSigmaCutDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int padding, const float nSigma, const unsigned int maxIterations)
+{
+    std::string *code = new std::string();
+    unsigned int nrDMs = 0;
+    // The time series is kept in local memory if it fits, together with the reduction buffers, in the 32 KB guaranteed by OpenCL
+    bool localTimeSeries = ((nrSamples * sizeof(T)) + (conf.getNrThreadsD0() * ((4 * sizeof(float)) + sizeof(T)))) <= minLocalMemorySize;
+
+    if (conf.getSubbandDedispersion())
+    {
+        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    }
+    else
+    {
+        nrDMs = observation.getNrDMs();
+    }
+    *code = "__kernel void <%NAME%>" + std::to_string(nrSamples) + "(__global const " + dataName + " * const restrict input, <%OUTPUT_ARGS%>) {\n"
+        "float delta = 0.0f;\n"
+        "float mean = 0.0f;\n"
+        "float cut_counter = 0.0f;\n"
+        "float cut_variance = 0.0f;\n"
+        "float previous_counter = 0.0f;\n"
+        "float sigma_threshold = 0.0f;\n"
+        "<%LOCAL_TIME_SERIES%>"
+        "__local float reductionCOU[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "__local " + dataName + " reductionMAX[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "__local unsigned int reductionSAM[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "__local float reductionMEA[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "__local float reductionVAR[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "<%DEF%>"
+        "\n"
+        "// Compute statistics for sigma\n"
+        "// Compute phase\n"
+        "for ( unsigned int sample = get_local_id(0) + " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + "; sample < " + std::to_string(nrSamples) + "; sample += " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + " ) {\n"
+        + dataName + " item = 0;\n"
+        "<%COMPUTE%>"
+        "}\n"
+        "// In-thread reduce (optional)\n"
+        "<%REDUCE%>"
+        "<%REDUCE_PHASE%>"
+        "cut_counter = " + std::to_string(nrSamples) + ".0f;\n"
+        "mean = reductionMEA[0];\n"
+        "cut_variance = reductionVAR[0];\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "// Repeat the sigma cut until the number of kept samples does not change\n"
+        "for ( unsigned int iteration = 0; iteration < " + std::to_string(maxIterations) + "; iteration++ ) {\n"
+        "sigma_threshold = (" + std::to_string(nSigma) + " * native_sqrt(cut_variance / (cut_counter - 1.0f)));\n"
+        "previous_counter = cut_counter;\n"
+        "<%CLEAN%>"
+        "// Compute phase\n"
+        "for ( unsigned int sample = get_local_id(0); sample < " + std::to_string(nrSamples) + "; sample += " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + " ) {\n"
+        + dataName + " item = 0;\n"
+        "<%COMPUTE_CUT%>"
+        "}\n"
+        "// In-thread reduce (optional)\n"
+        "<%REDUCE%>"
+        "<%REDUCE_PHASE_CUT%>"
+        "cut_counter = reductionCOU[0];\n"
+        "mean = reductionMEA[0];\n"
+        "cut_variance = reductionVAR[0];\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "if ( cut_counter == previous_counter ) {\n"
+        "break;\n"
+        "}\n"
+        "}\n"
+        "// Store\n"
+        "if ( get_local_id(0) == 0 ) {\n"
+        "<%STORE%>"
+        "}\n"
+        "}\n";
+    std::string reducePhase_s;
+    if (conf.getSubgroupReduction())
+    {
+        reducePhase_s = "// Sub-group reduce phase\n"
+            "delta = sub_group_reduce_add(counter0 * mean0) / sub_group_reduce_add(counter0);\n"
+            "variance0 = sub_group_reduce_add(variance0 + ((counter0 * (mean0 - delta)) * (mean0 - delta)));\n"
+            "counter0 = sub_group_reduce_add(counter0);\n"
+            "mean0 = delta;\n"
+            "maxSample0 = sub_group_reduce_min((max0 == sub_group_reduce_max(max0)) ? maxSample0 : UINT_MAX);\n"
+            "max0 = sub_group_reduce_max(max0);\n"
+            "// Local memory store\n"
+            "if ( get_sub_group_local_id() == 0 ) {\n"
+                "reductionCOU[get_sub_group_id()] = counter0;\n"
+                "reductionMAX[get_sub_group_id()] = max0;\n"
+                "reductionSAM[get_sub_group_id()] = maxSample0;\n"
+                "reductionMEA[get_sub_group_id()] = mean0;\n"
+                "reductionVAR[get_sub_group_id()] = variance0;\n"
+            "}\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "// Reduce phase\n"
+            "if ( get_sub_group_id() == 0 ) {\n"
+                "counter0 = 0.0f;\n"
+                "mean0 = 0.0f;\n"
+                "variance0 = 0.0f;\n"
+                "for ( unsigned int sample = get_sub_group_local_id(); sample < get_num_sub_groups(); sample += get_sub_group_size() ) {\n"
+                    "delta = reductionMEA[sample] - mean0;\n"
+                    "counter0 += reductionCOU[sample];\n"
+                    "mean0 = (((counter0 - reductionCOU[sample]) * mean0) + (reductionCOU[sample] * reductionMEA[sample])) / counter0;\n"
+                    "variance0 += reductionVAR[sample] + ((delta * delta) * (((counter0 - reductionCOU[sample]) * reductionCOU[sample]) / counter0));\n"
+                    "if ( reductionMAX[sample] > max0 ) {\n"
+                        "max0 = reductionMAX[sample];\n"
+                        "maxSample0 = reductionSAM[sample];\n"
+                    "}\n"
+                "}\n"
+                "delta = sub_group_reduce_add(counter0 * mean0) / sub_group_reduce_add(counter0);\n"
+                "variance0 = sub_group_reduce_add(variance0 + ((counter0 * (mean0 - delta)) * (mean0 - delta)));\n"
+                "counter0 = sub_group_reduce_add(counter0);\n"
+                "mean0 = delta;\n"
+                "maxSample0 = sub_group_reduce_min((max0 == sub_group_reduce_max(max0)) ? maxSample0 : UINT_MAX);\n"
+                "max0 = sub_group_reduce_max(max0);\n"
+            "}\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "if ( get_local_id(0) == 0 ) {\n"
+                "reductionMEA[0] = mean0;\n"
+                "reductionVAR[0] = variance0;\n"
+            "}\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n";
+    }
+    else
+    {
+        reducePhase_s = "// Local memory store\n"
+            "reductionCOU[get_local_id(0)] = counter0;\n"
+            "reductionMAX[get_local_id(0)] = max0;\n"
+            "reductionSAM[get_local_id(0)] = maxSample0;\n"
+            "reductionMEA[get_local_id(0)] = mean0;\n"
+            "reductionVAR[get_local_id(0)] = variance0;\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "// Reduce phase\n"
+            "unsigned int threshold = " + std::to_string(conf.getNrThreadsD0() / 2) + ";\n"
+            "for ( unsigned int sample = get_local_id(0); threshold > 0; threshold /= 2 ) {\n"
+                "if ( sample < threshold ) {\n"
+                    "delta = reductionMEA[sample + threshold] - mean0;\n"
+                    "counter0 += reductionCOU[sample + threshold];\n"
+                    "mean0 = ((reductionCOU[sample] * mean0) + (reductionCOU[sample + threshold] * reductionMEA[sample + threshold])) / counter0;\n"
+                    "variance0 += reductionVAR[sample + threshold] + ((delta * delta) * ((reductionCOU[sample] * reductionCOU[sample + threshold]) / counter0));\n"
+                    "if ( reductionMAX[sample + threshold] > max0 ) {\n"
+                        "max0 = reductionMAX[sample + threshold];\n"
+                        "maxSample0 = reductionSAM[sample + threshold];\n"
+                    "}\n"
+                    "reductionCOU[sample] = counter0;\n"
+                    "reductionMAX[sample] = max0;\n"
+                    "reductionSAM[sample] = maxSample0;\n"
+                    "reductionMEA[sample] = mean0;\n"
+                    "reductionVAR[sample] = variance0;\n"
+                "}\n"
+                "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "}\n";
+    }
+    // Every cut ends with the statistics of the kept samples in the first element of the reduction buffers
+    std::string reducePhaseCut_s;
+    if (conf.getSubgroupReduction())
+    {
+        reducePhaseCut_s = "// Sub-group reduce phase\n"
+            "delta = sub_group_reduce_add(counter0 * mean0) / sub_group_reduce_add(counter0);\n"
+            "variance0 = sub_group_reduce_add(variance0 + ((counter0 * (mean0 - delta)) * (mean0 - delta)));\n"
+            "counter0 = sub_group_reduce_add(counter0);\n"
+            "mean0 = delta;\n"
+            "// Local memory store\n"
+            "if ( get_sub_group_local_id() == 0 ) {\n"
+                "reductionCOU[get_sub_group_id()] = counter0;\n"
+                "reductionMEA[get_sub_group_id()] = mean0;\n"
+                "reductionVAR[get_sub_group_id()] = variance0;\n"
+            "}\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "// Reduce phase\n"
+            "if ( get_sub_group_id() == 0 ) {\n"
+                "counter0 = 0.0f;\n"
+                "mean0 = 0.0f;\n"
+                "variance0 = 0.0f;\n"
+                "for ( unsigned int sample = get_sub_group_local_id(); sample < get_num_sub_groups(); sample += get_sub_group_size() ) {\n"
+                    "delta = reductionMEA[sample] - mean0;\n"
+                    "counter0 += reductionCOU[sample];\n"
+                    "mean0 = (((counter0 - reductionCOU[sample]) * mean0) + (reductionCOU[sample] * reductionMEA[sample])) / counter0;\n"
+                    "variance0 += reductionVAR[sample] + ((delta * delta) * (((counter0 - reductionCOU[sample]) * reductionCOU[sample]) / counter0));\n"
+                "}\n"
+                "delta = sub_group_reduce_add(counter0 * mean0) / sub_group_reduce_add(counter0);\n"
+                "variance0 = sub_group_reduce_add(variance0 + ((counter0 * (mean0 - delta)) * (mean0 - delta)));\n"
+                "counter0 = sub_group_reduce_add(counter0);\n"
+                "mean0 = delta;\n"
+            "}\n"
+            "if ( get_local_id(0) == 0 ) {\n"
+                "reductionCOU[0] = counter0;\n"
+                "reductionMEA[0] = mean0;\n"
+                "reductionVAR[0] = variance0;\n"
+            "}\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n";
+    }
+    else
+    {
+        reducePhaseCut_s = "// Local memory store\n"
+            "reductionCOU[get_local_id(0)] = counter0;\n"
+            "reductionMEA[get_local_id(0)] = mean0;\n"
+            "reductionVAR[get_local_id(0)] = variance0;\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "// Reduce phase\n"
+            "threshold = " + std::to_string(conf.getNrThreadsD0() / 2) + ";\n"
+            "for ( unsigned int sample = get_local_id(0); threshold > 0; threshold /= 2 ) {\n"
+                "if ( sample < threshold ) {\n"
+                    "delta = reductionMEA[sample + threshold] - mean0;\n"
+                    "counter0 += reductionCOU[sample + threshold];\n"
+                    "mean0 = ((reductionCOU[sample] * mean0) + (reductionCOU[sample + threshold] * reductionMEA[sample + threshold])) / counter0;\n"
+                    "variance0 += reductionVAR[sample + threshold] + ((delta * delta) * ((reductionCOU[sample] * reductionCOU[sample + threshold]) / counter0));\n"
+                    "reductionCOU[sample] = counter0;\n"
+                    "reductionMEA[sample] = mean0;\n"
+                    "reductionVAR[sample] = variance0;\n"
+                "}\n"
+                "barrier(CLK_LOCAL_MEM_FENCE);\n"
+            "}\n";
+    }
+    std::string localTimeSeries_s;
+    std::string def_sTemplate = dataName + " max<%NUM%> = input[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (get_local_id(0) + <%OFFSET%>)];\n"
+        "unsigned int maxSample<%NUM%> = get_local_id(0) + <%OFFSET%>;\n"
+        "float counter<%NUM%> = 1.0f;\n"
+        "float variance<%NUM%> = 0.0f;\n"
+        "float mean<%NUM%> = max<%NUM%>;\n";
+    std::string clean_sTemplate = "counter<%NUM%> = 0.0f;\n"
+        "variance<%NUM%> = 0.0f;\n"
+        "mean<%NUM%> = 0.0f;\n";
+    std::string compute_sTemplate;
+    if ((nrSamples % (conf.getNrThreadsD0() * conf.getNrItemsD0())) != 0)
+    {
+        compute_sTemplate += "if ( (sample + <%OFFSET%>) < " + std::to_string(nrSamples) + " ) {\n";
+    }
+    compute_sTemplate += "item = input[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (sample + <%OFFSET%>)];\n";
+    if (localTimeSeries)
+    {
+        compute_sTemplate += "timeSeries[sample + <%OFFSET%>] = item;\n";
+    }
+    compute_sTemplate += "counter<%NUM%> += 1.0f;\n"
+        "delta = item - mean<%NUM%>;\n"
+        "mean<%NUM%> += delta / counter<%NUM%>;\n"
+        "variance<%NUM%> += delta * (item - mean<%NUM%>);\n"
+        "if ( item > max<%NUM%> ) {\n"
+        "max<%NUM%> = item;\n"
+        "maxSample<%NUM%> = sample + <%OFFSET%>;\n"
+        "}\n";
+    if ((nrSamples % (conf.getNrThreadsD0() * conf.getNrItemsD0())) != 0)
+    {
+        compute_sTemplate += "}\n";
+    }
+    std::string computeCut_sTemplate;
+    if ((nrSamples % (conf.getNrThreadsD0() * conf.getNrItemsD0())) != 0)
+    {
+        computeCut_sTemplate += "if ( (sample + <%OFFSET%>) < " + std::to_string(nrSamples) + " ) {\n";
+    }
+    if (localTimeSeries)
+    {
+        localTimeSeries_s = "__local " + dataName + " timeSeries[" + std::to_string(nrSamples) + "];\n";
+        def_sTemplate += "timeSeries[get_local_id(0) + <%OFFSET%>] = max<%NUM%>;\n";
+        computeCut_sTemplate += "item = timeSeries[sample + <%OFFSET%>];\n";
+    }
+    else
+    {
+        computeCut_sTemplate += "item = input[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (sample + <%OFFSET%>)];\n";
+    }
+    computeCut_sTemplate += "if ( fabs(item - mean) < sigma_threshold ) {\n"
+        "counter<%NUM%> += 1.0f;\n"
+        "delta = item - mean<%NUM%>;\n"
+        "mean<%NUM%> += delta / counter<%NUM%>;\n"
+        "variance<%NUM%> += delta * (item - mean<%NUM%>);\n"
+        "}\n";
+    if ((nrSamples % (conf.getNrThreadsD0() * conf.getNrItemsD0())) != 0)
+    {
+        computeCut_sTemplate += "}\n";
+    }
+    std::string reduce_sTemplate = "delta = mean<%NUM%> - mean0;\n"
+        "counter0 += counter<%NUM%>;\n"
+        "mean0 = (((counter0 - counter<%NUM%>) * mean0) + (counter<%NUM%> * mean<%NUM%>)) / counter0;\n"
+        "variance0 += variance<%NUM%> + ((delta * delta) * (((counter0 - counter<%NUM%>) * counter<%NUM%>) / counter0));\n"
+        "if ( max<%NUM%> > max0 ) {\n"
+        "max0 = max<%NUM%>;\n"
+        "maxSample0 = maxSample<%NUM%>;\n"
+        "}\n";
+
+    std::string * def_s = new std::string();
+    std::string * compute_s = new std::string();
+    std::string * clean_s = new std::string();
+    std::string * computeCut_s = new std::string();
+    std::string * reduce_s = new std::string();
+
+    for (unsigned int sample = 0; sample < conf.getNrItemsD0(); sample++)
+    {
+        std::string sample_s = std::to_string(sample);
+        std::string offset_s = std::to_string(conf.getNrThreadsD0() * sample);
+        std::string * temp = nullptr;
+
+        temp = isa::utils::replace(&def_sTemplate, "<%NUM%>", sample_s);
+        if (sample == 0)
+        {
+            std::string empty_s("");
+            temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
+        }
+        def_s->append(*temp);
+        delete temp;
+        temp = isa::utils::replace(&clean_sTemplate, "<%NUM%>", sample_s);
+        clean_s->append(*temp);
+        delete temp;
+        temp = isa::utils::replace(&compute_sTemplate, "<%NUM%>", sample_s);
+        if (sample == 0)
+        {
+            std::string empty_s("");
+            temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
+        }
+        compute_s->append(*temp);
+        delete temp;
+        temp = isa::utils::replace(&computeCut_sTemplate, "<%NUM%>", sample_s);
+        if (sample == 0)
+        {
+            std::string empty_s("");
+            temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
+        }
+        computeCut_s->append(*temp);
+        delete temp;
+        if (sample == 0)
+        {
+            continue;
+        }
+        temp = isa::utils::replace(&reduce_sTemplate, "<%NUM%>", sample_s);
+        reduce_s->append(*temp);
+        delete temp;
+    }
+
+    code = isa::utils::replace(code, "<%LOCAL_TIME_SERIES%>", localTimeSeries_s, true);
+    code = isa::utils::replace(code, "<%DEF%>", *def_s, true);
+    code = isa::utils::replace(code, "<%COMPUTE%>", *compute_s, true);
+    code = isa::utils::replace(code, "<%CLEAN%>", *clean_s, true);
+    code = isa::utils::replace(code, "<%COMPUTE_CUT%>", *computeCut_s, true);
+    code = isa::utils::replace(code, "<%REDUCE%>", *reduce_s, true);
+    code = isa::utils::replace(code, "<%REDUCE_PHASE%>", reducePhase_s, true);
+    code = isa::utils::replace(code, "<%REDUCE_PHASE_CUT%>", reducePhaseCut_s, true);
+    delete def_s;
+    delete compute_s;
+    delete clean_s;
+    delete computeCut_s;
+    delete reduce_s;
+    if (conf.getSubgroupReduction())
+    {
+        code->insert(0, "#pragma OPENCL EXTENSION cl_khr_subgroups : enable\n");
+    }
+
+    return code;
+}
+
+template <typename T>
+std::string *getSNRIterativeSigmaCutDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int padding, const float nSigma, const unsigned int maxIterations, const float correctionFactor)
+{
+    std::string *code = getIterativeSigmaCutDMsSamplesOpenCL<T>(conf, dataName, observation, nrSamples, padding, nSigma, maxIterations);
+    unsigned int nrDMs = 0;
+
+    if (conf.getSubbandDedispersion())
+    {
+        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    }
+    else
+    {
+        nrDMs = observation.getNrDMs();
+    }
+    code = isa::utils::replace(code, "<%NAME%>", "snrIterativeSigmaCut_DMsSamples_", true);
+    code = isa::utils::replace(code, "<%OUTPUT_ARGS%>", "__global float * const restrict outputSNR, __global unsigned int * const restrict outputSample", true);
+    code = isa::utils::replace(code, "<%STORE%>", "outputSNR[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(float))) + ") + get_group_id(1)] = (max0 - mean) / (native_sqrt(cut_variance / (cut_counter - 1.0f)) * " + std::to_string(correctionFactor) + ");\n"
+        "outputSample[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + ") + get_group_id(1)] = maxSample0;\n", true);
+
+    return code;
+}
+
+template <typename T>
+std::string *getSNRSigmaCutSamplesDMsOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int padding, const float nSigma, const float correctionFactor)
+{
+    unsigned int nrDMs = 0;
+    std::string *code = new std::string();
+
+    if (conf.getSubbandDedispersion())
+    {
+        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    }
+    else
+    {
+        nrDMs = observation.getNrDMs();
+    }
+    // Begin kernel's template
+    *code = "__kernel void snrSigmaCutSamplesDMs" + std::to_string(nrDMs) + "(__global const " + dataName + " * const restrict input, __global float * const restrict outputSNR, __global unsigned int * const restrict outputSample) {\n"
+        "unsigned int dm = (get_group_id(0) * " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + ") + get_local_id(0);\n"
+        "float delta = 0.0f;\n"
+        + dataName + " item = 0;\n"
+        "<%DEF%>"
+        "\n"
+        "// Compute statistics for sigma\n"
+        "for ( unsigned int sample = 1; sample < " + std::to_string(nrSamples) + "; sample++ ) {\n"
+            "<%COMPUTE%>"
+        "}\n"
+        "// Compute SNR with sigma cut\n"
+        "<%CLEAN%>"
+        "for ( unsigned int sample = 0; sample < " + std::to_string(nrSamples) + "; sample++ ) {\n"
+            "<%COMPUTE_CUT%>"
+        "}\n"
+        "<%STORE%>"
+    "}\n";
+
+    std::string def_sTemplate = "float counter<%NUM%> = 1.0f;\n"
+    + dataName + " max<%NUM%> = input[(get_group_id(1) * " + std::to_string(nrSamples * isa::utils::pad(nrDMs, padding / sizeof(T))) + ") + (dm + <%OFFSET%>)];\n"
+    "unsigned int maxSample<%NUM%> = 0;\n"
+    "float variance<%NUM%> = 0.0f;\n"
+    "float mean<%NUM%> = max<%NUM%>;\n";
+
+    std::string compute_sTemplate = "item = input[(get_group_id(1) * " + std::to_string(nrSamples * isa::utils::pad(nrDMs, padding / sizeof(T))) + ") + (sample * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(T))) + ") + (dm + <%OFFSET%>)];\n"
+    "counter<%NUM%> += 1.0f;\n"
+    "delta = item - mean<%NUM%>;\n"
+    "mean<%NUM%> += delta / counter<%NUM%>;\n"
+    "variance<%NUM%> += delta * (item - mean<%NUM%>);\n"
+    "if ( item > max<%NUM%> ) {\n"
+        "max<%NUM%> = item;\n"
+        "maxSample<%NUM%> = sample;\n"
+    "}\n";
+
+    std::string clean_sTemplate = "float mean_step1<%NUM%> = mean<%NUM%>;\n"
+    "float sigma_threshold<%NUM%> = (" + std::to_string(nSigma) + " * native_sqrt(variance<%NUM%> * " + std::to_string(1.0f / (nrSamples - 1)) + "f));\n"
+    "counter<%NUM%> = 0.0f;\n"
+    "variance<%NUM%> = 0.0f;\n"
+    "mean<%NUM%> = 0.0f;\n";
+
+    std::string computeCut_sTemplate = "item = input[(get_group_id(1) * " + std::to_string(nrSamples * isa::utils::pad(nrDMs, padding / sizeof(T))) + ") + (sample * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(T))) + ") + (dm + <%OFFSET%>)];\n"
+    "if ( fabs(item - mean_step1<%NUM%>) < sigma_threshold<%NUM%> ) {\n"
+        "counter<%NUM%> += 1.0f;\n"
+        "delta = item - mean<%NUM%>;\n"
+        "mean<%NUM%> += delta / counter<%NUM%>;\n"
+        "variance<%NUM%> += delta * (item - mean<%NUM%>);\n"
+    "}\n";
+
+    std::string store_sTemplate = "outputSNR[(get_group_id(1) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(float))) + ") + dm + <%OFFSET%>] = (max<%NUM%> - mean<%NUM%>) / (native_sqrt(variance<%NUM%> / (counter<%NUM%> - 1)) * " + std::to_string(correctionFactor) + ");\n"
+    "outputSample[(get_group_id(1) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + ") + dm + <%OFFSET%>] = maxSample<%NUM%>;\n";
+    // End kernel's template
+
+    std::string *def_s = new std::string();
+    std::string *compute_s = new std::string();
+    std::string *clean_s = new std::string();
+    std::string *computeCut_s = new std::string();
+    std::string *store_s = new std::string();
+
+    for (unsigned int dm = 0; dm < conf.getNrItemsD0(); dm++)
+    {
+        std::string dm_s = std::to_string(dm);
+        std::string offset_s = std::to_string(conf.getNrThreadsD0() * dm);
+        std::string *temp = 0;
+
+        temp = isa::utils::replace(&def_sTemplate, "<%NUM%>", dm_s);
+        if (dm == 0)
+        {
+            std::string empty_s("");
+            temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
         }
         else
         {
-            temp = isa::utils::replace(temp, "<%ITEM_OFFSET%>", itemOffsetString, true);
+            temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
         }
-        localVariables.append(*temp);
+        def_s->append(*temp);
         delete temp;
-        if ((nrSamples % (conf.getNrThreadsD0() * conf.getNrItemsD0())) == 0)
+        temp = isa::utils::replace(&compute_sTemplate, "<%NUM%>", dm_s);
+        if (dm == 0)
         {
-            temp = isa::utils::replace(&localComputeNoCheckTemplate, "<%ITEM_NUMBER%>", itemString);
+            std::string empty_s("");
+            temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
         }
         else
         {
-            temp = isa::utils::replace(&localComputeCheckTemplate, "<%ITEM_NUMBER%>", itemString);
+            temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
         }
-        if (item == 0)
+        compute_s->append(*temp);
+        delete temp;
+        temp = isa::utils::replace(&clean_sTemplate, "<%NUM%>", dm_s);
+        if (dm == 0)
         {
-            temp = isa::utils::replace(temp, " + <%ITEM_OFFSET%>", std::string(), true);
+            std::string empty_s("");
+            temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
         }
         else
         {
-            temp = isa::utils::replace(temp, "<%ITEM_OFFSET%>", itemOffsetString, true);
+            temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
         }
-        localCompute.append(*temp);
+        clean_s->append(*temp);
         delete temp;
-        if (item > 0)
+        temp = isa::utils::replace(&computeCut_sTemplate, "<%NUM%>", dm_s);
+        if (dm == 0)
         {
-            temp = isa::utils::replace(&localReduceTemplate, "<%ITEM_NUMBER%>", itemString);
-            localReduce.append(*temp);
-            delete temp;
+            std::string empty_s("");
+            temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
+        }
+        computeCut_s->append(*temp);
+        delete temp;
+        temp = isa::utils::replace(&store_sTemplate, "<%NUM%>", dm_s);
+        if (dm == 0)
+        {
+            std::string empty_s("");
+            temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
+        }
+        else
+        {
+            temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
         }
+        store_s->append(*temp);
+        delete temp;
     }
-    code = isa::utils::replace(code, "<%LOCAL_VARIABLES%>", localVariables, true);
-    code = isa::utils::replace(code, "<%LOCAL_COMPUTE%>", localCompute, true);
-    code = isa::utils::replace(code, "<%LOCAL_REDUCE%>", localReduce, true);
 
-    std::string localVariables_2;
-    std::string localCompute_2;
-    std::string localReduce_2;
+    code = isa::utils::replace(code, "<%DEF%>", *def_s, true);
+    code = isa::utils::replace(code, "<%COMPUTE%>", *compute_s, true);
+    code = isa::utils::replace(code, "<%CLEAN%>", *clean_s, true);
+    code = isa::utils::replace(code, "<%COMPUTE_CUT%>", *computeCut_s, true);
+    code = isa::utils::replace(code, "<%STORE%>", *store_s, true);
+    delete def_s;
+    delete compute_s;
+    delete clean_s;
+    delete computeCut_s;
+    delete store_s;
 
-    for (unsigned int item = 0; item < conf.getNrItemsD0(); item++)
+    return code;
+}
+
+template<typename NumericType>
+void snrSigmaCut(const std::vector<NumericType> & timeSeries, std::vector<NumericType> & snr, const AstroData::Observation & observation, const unsigned int padding, const float nSigma, const float correctionFactor)
+{
+    for ( unsigned int sBeam = 0; sBeam < observation.getNrSynthesizedBeams(); sBeam++ )
     {
-        std::string *temp;
-        std::string itemString = std::to_string(item);
-        std::string itemOffsetString = std::to_string(item * conf.getNrThreadsD0());
-        temp = isa::utils::replace(&localVariablesTemplate_2, "<%ITEM_NUMBER%>", itemString);
-        if (item == 0)
+        for ( unsigned int subbandingDM = 0; subbandingDM < observation.getNrDMs(true); subbandingDM++ )
         {
-            temp = isa::utils::replace(temp, " + <%ITEM_OFFSET%>", std::string(), true);
+            for ( unsigned int DM = 0; DM < observation.getNrDMs(); DM++ )
+            {
+                // Phase one, compute statistics to determine sigma cut
+                isa::utils::Statistics<float> statistics;
+                for ( unsigned int sample = 0; sample < observation.getNrSamplesPerBatch(); sample++ )
+                {
+                    statistics.addElement(timeSeries.at((sBeam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(NumericType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(NumericType))) + (DM * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(NumericType))) + sample));
+                }
+                // Phase two, compute SNR excluding outliers
+                isa::utils::Statistics<float> cleanStatistics;
+                for ( unsigned int sample = 0; sample < observation.getNrSamplesPerBatch(); sample++ )
+                {
+                    NumericType value = timeSeries.at((sBeam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(NumericType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(NumericType))) + (DM * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(NumericType))) + sample);
+
+                    if ( std::fabs(value - statistics.getMean()) < (nSigma * statistics.getStandardDeviation()) )
+                    {
+                        cleanStatistics.addElement(value);
+                    }
+                }
+                // Store results
+                snr.at((sBeam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float))) + (subbandingDM * observation.getNrDMs()) + DM) = (statistics.getMax() - cleanStatistics.getMean()) / (cleanStatistics.getStandardDeviation() * correctionFactor);
+            }
         }
-        else
+    }
+}
+
+template <typename DataType>
+TimeSeriesStatistics<DataType> sigmaCutStatistics(const DataType *timeSeries, const unsigned int nrSamples, const float mean, const float sigmaThreshold)
+{
+    const unsigned int nrLanes = 16;
+    const unsigned int nrSteps = nrSamples / nrLanes;
+    float laneCounter[nrLanes];
+    float laneMean[nrLanes];
+    float laneVariance[nrLanes];
+    TimeSeriesStatistics<DataType> statistics = {0.0f, 0.0f, 0.0f, static_cast<DataType>(0), 0};
+
+    for (unsigned int lane = 0; lane < nrLanes; lane++)
+    {
+        laneCounter[lane] = 0.0f;
+        laneMean[lane] = 0.0f;
+        laneVariance[lane] = 0.0f;
+    }
+    for (unsigned int step = 0; step < nrSteps; step++)
+    {
+        const DataType *items = timeSeries + (step * nrLanes);
+
+#pragma omp simd
+        for (unsigned int lane = 0; lane < nrLanes; lane++)
         {
-            temp = isa::utils::replace(temp, "<%ITEM_OFFSET%>", itemOffsetString, true);
+            if (std::fabs(items[lane] - mean) < sigmaThreshold)
+            {
+                float delta = items[lane] - laneMean[lane];
+
+                laneCounter[lane] += 1.0f;
+                laneMean[lane] += delta / laneCounter[lane];
+                laneVariance[lane] += delta * (items[lane] - laneMean[lane]);
+            }
         }
-        localVariables_2.append(*temp);
-        delete temp;
-        if ((nrSamples % (conf.getNrThreadsD0() * conf.getNrItemsD0())) == 0)
+    }
+    for (unsigned int lane = 0; lane < nrLanes; lane++)
+    {
+        mergeStatistics(statistics, {laneCounter[lane], laneMean[lane], laneVariance[lane], static_cast<DataType>(0), 0});
+    }
+    // Samples that do not fill all lanes
+    for (unsigned int sample = nrSteps * nrLanes; sample < nrSamples; sample++)
+    {
+        if (std::fabs(timeSeries[sample] - mean) < sigmaThreshold)
         {
-            temp = isa::utils::replace(&localComputeNoCheckTemplate_2, "<%ITEM_NUMBER%>", itemString);
+            float delta = timeSeries[sample] - statistics.mean;
+
+            statistics.counter += 1.0f;
+            statistics.mean += delta / statistics.counter;
+            statistics.variance += delta * (timeSeries[sample] - statistics.mean);
         }
-        else
+    }
+    return statistics;
+}
+
+template <typename DataType>
+void snrSigmaCutCPU(const std::vector<DataType> &input, std::vector<float> &outputSNR, std::vector<unsigned int> &outputSample, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int padding, const float nSigma, const float correctionFactor)
+{
+    const unsigned int nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    const uint64_t nrSamplesPadded = isa::utils::pad(nrSamples, padding / sizeof(DataType));
+
+#pragma omp parallel for collapse(2) schedule(static)
+    for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+    {
+        for (unsigned int dm = 0; dm < nrDMs; dm++)
         {
-            temp = isa::utils::replace(&localComputeCheckTemplate_2, "<%ITEM_NUMBER%>", itemString);
+            const DataType *timeSeries = input.data() + (((beam * nrDMs) + dm) * nrSamplesPadded);
+            // Phase one, compute statistics to determine sigma cut
+            TimeSeriesStatistics<DataType> statistics = timeSeriesStatistics(timeSeries, nrSamples);
+            // Phase two, compute statistics excluding outliers
+            TimeSeriesStatistics<DataType> cleanStatistics = sigmaCutStatistics(timeSeries, nrSamples, statistics.mean, nSigma * std::sqrt(statistics.variance / (nrSamples - 1)));
+
+            outputSNR[(beam * isa::utils::pad(nrDMs, padding / sizeof(float))) + dm] = (statistics.max - cleanStatistics.mean) / (std::sqrt(cleanStatistics.variance / (cleanStatistics.counter - 1)) * correctionFactor);
+            outputSample[(beam * isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + dm] = statistics.maxSample;
         }
-        if (item == 0)
+    }
+}
+
+template <typename NumericType>
+void snrIterativeSigmaCut(const std::vector<NumericType> &timeSeries, std::vector<NumericType> &snr, const AstroData::Observation &observation, const unsigned int padding, const float nSigma, const unsigned int maxIterations, const float correctionFactor)
+{
+    const unsigned int nrSamples = observation.getNrSamplesPerBatch();
+    const uint64_t nrSamplesPadded = isa::utils::pad(nrSamples, padding / sizeof(NumericType));
+
+    for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+    {
+        for (unsigned int subbandingDM = 0; subbandingDM < observation.getNrDMs(true); subbandingDM++)
         {
-            temp = isa::utils::replace(temp, " + <%ITEM_OFFSET%>", std::string(), true);
+            for (unsigned int dm = 0; dm < observation.getNrDMs(); dm++)
+            {
+                const uint64_t offset = ((beam * observation.getNrDMs(true) * observation.getNrDMs()) + (subbandingDM * observation.getNrDMs()) + dm) * nrSamplesPadded;
+                // Phase one, compute statistics to determine the first sigma cut
+                isa::utils::Statistics<float> statistics;
+                for (unsigned int sample = 0; sample < nrSamples; sample++)
+                {
+                    statistics.addElement(timeSeries.at(offset + sample));
+                }
+                // Phase two, repeat the sigma cut with the statistics of the kept samples
+                unsigned int counter = nrSamples;
+                float mean = statistics.getMean();
+                float standardDeviation = statistics.getStandardDeviation();
+                for (unsigned int iteration = 0; iteration < maxIterations; iteration++)
+                {
+                    isa::utils::Statistics<float> cleanStatistics;
+                    unsigned int cleanCounter = 0;
+                    for (unsigned int sample = 0; sample < nrSamples; sample++)
+                    {
+                        NumericType value = timeSeries.at(offset + sample);
+
+                        if (std::fabs(value - mean) < (nSigma * standardDeviation))
+                        {
+                            cleanStatistics.addElement(value);
+                            cleanCounter++;
+                        }
+                    }
+                    mean = cleanStatistics.getMean();
+                    standardDeviation = cleanStatistics.getStandardDeviation();
+                    if (cleanCounter == counter)
+                    {
+                        break;
+                    }
+                    counter = cleanCounter;
+                }
+                // Store results
+                snr.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float))) + (subbandingDM * observation.getNrDMs()) + dm) = (statistics.getMax() - mean) / (standardDeviation * correctionFactor);
+            }
         }
-        else
+    }
+}
+
+template <typename DataType>
+TimeSeriesStatistics<DataType> iterativeSigmaCutStatistics(const DataType *timeSeries, const unsigned int nrSamples, const TimeSeriesStatistics<DataType> &statistics, const float nSigma, const unsigned int maxIterations)
+{
+    TimeSeriesStatistics<DataType> cutStatistics = statistics;
+
+    for (unsigned int iteration = 0; iteration < maxIterations; iteration++)
+    {
+        TimeSeriesStatistics<DataType> cleanStatistics = sigmaCutStatistics(timeSeries, nrSamples, cutStatistics.mean, nSigma * std::sqrt(cutStatistics.variance / (cutStatistics.counter - 1)));
+        bool converged = cleanStatistics.counter == cutStatistics.counter;
+
+        cutStatistics = cleanStatistics;
+        if (converged)
         {
-            temp = isa::utils::replace(temp, "<%ITEM_OFFSET%>", itemOffsetString, true);
+            break;
         }
-        localCompute_2.append(*temp);
-        delete temp;
-        if (item > 0)
+    }
+    return cutStatistics;
+}
+
+template <typename DataType>
+void snrIterativeSigmaCutCPU(const std::vector<DataType> &input, std::vector<float> &outputSNR, std::vector<unsigned int> &outputSample, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int padding, const float nSigma, const unsigned int maxIterations, const float correctionFactor)
+{
+    const unsigned int nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    const uint64_t nrSamplesPadded = isa::utils::pad(nrSamples, padding / sizeof(DataType));
+
+#pragma omp parallel for collapse(2) schedule(static)
+    for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+    {
+        for (unsigned int dm = 0; dm < nrDMs; dm++)
         {
-            temp = isa::utils::replace(&localReduceTemplate_2, "<%ITEM_NUMBER%>", itemString);
-            localReduce_2.append(*temp);
-            delete temp;
+            const DataType *timeSeries = input.data() + (((beam * nrDMs) + dm) * nrSamplesPadded);
+            TimeSeriesStatistics<DataType> statistics = timeSeriesStatistics(timeSeries, nrSamples);
+            TimeSeriesStatistics<DataType> cleanStatistics = iterativeSigmaCutStatistics(timeSeries, nrSamples, statistics, nSigma, maxIterations);
+
+            outputSNR[(beam * isa::utils::pad(nrDMs, padding / sizeof(float))) + dm] = (statistics.max - cleanStatistics.mean) / (std::sqrt(cleanStatistics.variance / (cleanStatistics.counter - 1)) * correctionFactor);
+            outputSample[(beam * isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + dm] = statistics.maxSample;
         }
     }
-    code = isa::utils::replace(code, "<%LOCAL_VARIABLES_2%>", localVariables_2, true);
-    code = isa::utils::replace(code, "<%LOCAL_COMPUTE_2%>", localCompute_2, true);
-    code = isa::utils::replace(code, "<%LOCAL_REDUCE_2%>", localReduce_2, true);
+}
+
+template <typename T>
+uint64_t getSNRMedianOfMediansAbsoluteDeviationLocalMemory(const snrConf &conf, const unsigned int nrSamples, const unsigned int stepSize)
+{
+    // Time series, medians of the steps, baseline, and reduction buffers
+    return ((static_cast<uint64_t>(nrSamples) + (nrSamples / stepSize) + 1) * sizeof(T)) + (conf.getNrThreadsD0() * (sizeof(T) + sizeof(unsigned int)));
+}
+
+template <typename T>
+std::string *getSNRMedianOfMediansAbsoluteDeviationDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int stepSize, const unsigned int padding, const float correctionFactor)
+{
+    std::string *code = 0;
+    unsigned int nrDMs = 0;
+    unsigned int nrSteps = nrSamples / stepSize;
+
+    if (getSNRMedianOfMediansAbsoluteDeviationLocalMemory<T>(conf, nrSamples, stepSize) > minLocalMemorySize)
+    {
+        throw std::invalid_argument("The time series of the SNR median of medians absolute deviation kernel does not fit in local memory.");
+    }
+    code = new std::string();
+    if (conf.getSubbandDedispersion())
+    {
+        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    }
+    else
+    {
+        nrDMs = observation.getNrDMs();
+    }
+    *code = "__kernel void snrMedianOfMediansAbsoluteDeviation_DMsSamples_" + std::to_string(stepSize) + "(__global const " + dataName + " * const restrict time_series, __global float * const restrict outputSNR, __global unsigned int * const restrict outputSample) {\n"
+        + dataName + " max = time_series[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + get_local_id(0)];\n"
+        "unsigned int maxSample = get_local_id(0);\n"
+        + dataName + " pivot;\n"
+        + dataName + " temp;\n"
+        "__local " + dataName + " local_data[" + std::to_string(nrSamples) + "];\n"
+        "__local " + dataName + " medians[" + std::to_string(nrSteps) + "];\n"
+        "__local " + dataName + " baseline;\n"
+        "__local " + dataName + " reductionMAX[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "__local unsigned int reductionSAM[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "\n"
+        "// Load the time series in local memory, and find its maximum\n"
+        "for ( unsigned int sample = get_local_id(0); sample < " + std::to_string(nrSamples) + "; sample += " + std::to_string(conf.getNrThreadsD0()) + " ) {\n"
+        + dataName + " item = time_series[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + sample];\n"
+        "local_data[sample] = item;\n"
+        "if ( item > max ) {\n"
+        "max = item;\n"
+        "maxSample = sample;\n"
+        "}\n"
+        "}\n"
+        "reductionMAX[get_local_id(0)] = max;\n"
+        "reductionSAM[get_local_id(0)] = maxSample;\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "// Reduce phase\n"
+        "for ( unsigned int threshold = " + std::to_string(conf.getNrThreadsD0() / 2) + "; threshold > 0; threshold /= 2 ) {\n"
+        "if ( get_local_id(0) < threshold ) {\n"
+        "if ( reductionMAX[get_local_id(0) + threshold] > max ) {\n"
+        "max = reductionMAX[get_local_id(0) + threshold];\n"
+        "maxSample = reductionSAM[get_local_id(0) + threshold];\n"
+        "}\n"
+        "reductionMAX[get_local_id(0)] = max;\n"
+        "reductionSAM[get_local_id(0)] = maxSample;\n"
+        "}\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "}\n"
+        "// Median of every step, every work-item works on its own steps\n"
+        "for ( unsigned int step = get_local_id(0); step < " + std::to_string(nrSteps) + "; step += " + std::to_string(conf.getNrThreadsD0()) + " ) {\n"
+        "<%SELECT_STEP%>"
+        "medians[step] = local_data[(step * " + std::to_string(stepSize) + ") + " + std::to_string(stepSize / 2) + "];\n"
+        "}\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "// Median of medians\n"
+        "if ( get_local_id(0) == 0 ) {\n"
+        "<%SELECT_MEDIANS%>"
+        "baseline = medians[" + std::to_string(nrSteps / 2) + "];\n"
+        "}\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "// Median of the absolute deviations of every step\n"
+        "for ( unsigned int step = get_local_id(0); step < " + std::to_string(nrSteps) + "; step += " + std::to_string(conf.getNrThreadsD0()) + " ) {\n"
+        "for ( unsigned int sample = step * " + std::to_string(stepSize) + "; sample < (step + 1) * " + std::to_string(stepSize) + "; sample++ ) {\n"
+        "local_data[sample] = fabs(local_data[sample] - baseline);\n"
+        "}\n"
+        "<%SELECT_STEP%>"
+        "medians[step] = local_data[(step * " + std::to_string(stepSize) + ") + " + std::to_string(stepSize / 2) + "];\n"
+        "}\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "// Median of medians absolute deviation, and store\n"
+        "if ( get_local_id(0) == 0 ) {\n"
+        "<%SELECT_MEDIANS%>"
+        "outputSNR[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(float))) + ") + get_group_id(1)] = (max - baseline) / (medians[" + std::to_string(nrSteps / 2) + "] * " + std::to_string(correctionFactor) + "f);\n"
+        "outputSample[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + ") + get_group_id(1)] = maxSample;\n"
+        "}\n"
+        "}\n";
+    // Selection of the middle element, in place
+    std::string selectTemplate = "{\n"
+        "int left = 0;\n"
+        "int right = <%LAST%>;\n"
+        "while ( left < right ) {\n"
+        "int first = left;\n"
+        "int last = right;\n"
+        "pivot = <%ARRAY%>[<%BASE%><%MIDDLE%>];\n"
+        "do {\n"
+        "while ( <%ARRAY%>[<%BASE%>first] < pivot ) {\n"
+        "first++;\n"
+        "}\n"
+        "while ( pivot < <%ARRAY%>[<%BASE%>last] ) {\n"
+        "last--;\n"
+        "}\n"
+        "if ( first <= last ) {\n"
+        "temp = <%ARRAY%>[<%BASE%>first];\n"
+        "<%ARRAY%>[<%BASE%>first] = <%ARRAY%>[<%BASE%>last];\n"
+        "<%ARRAY%>[<%BASE%>last] = temp;\n"
+        "first++;\n"
+        "last--;\n"
+        "}\n"
+        "} while ( first <= last );\n"
+        "if ( last < <%MIDDLE%> ) {\n"
+        "left = first;\n"
+        "}\n"
+        "if ( <%MIDDLE%> < first ) {\n"
+        "right = last;\n"
+        "}\n"
+        "}\n"
+        "}\n";
+    std::string *temp = 0;
+    std::string step_s = "(step * " + std::to_string(stepSize) + ") + ";
+    std::string empty_s("");
 
+    temp = isa::utils::replace(&selectTemplate, "<%ARRAY%>", "local_data");
+    temp = isa::utils::replace(temp, "<%BASE%>", step_s, true);
+    temp = isa::utils::replace(temp, "<%LAST%>", std::to_string(stepSize - 1), true);
+    temp = isa::utils::replace(temp, "<%MIDDLE%>", std::to_string(stepSize / 2), true);
+    code = isa::utils::replace(code, "<%SELECT_STEP%>", *temp, true);
+    delete temp;
+    temp = isa::utils::replace(&selectTemplate, "<%ARRAY%>", "medians");
+    temp = isa::utils::replace(temp, "<%BASE%>", empty_s, true);
+    temp = isa::utils::replace(temp, "<%LAST%>", std::to_string(nrSteps - 1), true);
+    temp = isa::utils::replace(temp, "<%MIDDLE%>", std::to_string(nrSteps / 2), true);
+    code = isa::utils::replace(code, "<%SELECT_MEDIANS%>", *temp, true);
+    delete temp;
     return code;
 }
 
 template <typename DataType>
-void stdSigmaCut(const std::vector<DataType> &timeSeries, std::vector<DataType> &standardDeviations, const AstroData::Observation &observation, const unsigned int padding, const float nSigma)
+void snrMedianOfMediansAbsoluteDeviationCPU(const unsigned int stepSize, const std::vector<DataType> &input, std::vector<float> &outputSNR, std::vector<unsigned int> &outputSample, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int padding, const float correctionFactor)
 {
-    for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+    const unsigned int nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    const unsigned int nrSteps = nrSamples / stepSize;
+    const uint64_t nrSamplesPadded = isa::utils::pad(nrSamples, padding / sizeof(DataType));
+
+#pragma omp parallel
     {
-        for (unsigned int subbandingDM = 0; subbandingDM < observation.getNrDMs(true); subbandingDM++)
+        std::vector<DataType> localArray(nrSamples);
+        std::vector<DataType> medians(nrSteps);
+
+#pragma omp for collapse(2) schedule(static)
+        for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
         {
-            for (unsigned int dm = 0; dm < observation.getNrDMs(); dm++)
+            for (unsigned int dm = 0; dm < nrDMs; dm++)
             {
-                // Step 1
-                isa::utils::Statistics<DataType> completeStats;
-                for (unsigned int sample = 0; sample < observation.getNrSamplesPerBatch() / observation.getDownsampling(); sample++)
+                const DataType *items = input.data() + (((beam * nrDMs) + dm) * nrSamplesPadded);
+                DataType max = items[0];
+                unsigned int maxSample = 0;
+                DataType baseline = 0;
+
+                for (unsigned int sample = 1; sample < nrSamples; sample++)
+                {
+                    if (items[sample] > max)
+                    {
+                        max = items[sample];
+                        maxSample = sample;
+                    }
+                }
+                std::copy(items, items + nrSamples, localArray.begin());
+                for (unsigned int step = 0; step < nrSteps; step++)
                 {
-                    completeStats.addElement(timeSeries.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + sample));
+                    std::nth_element(localArray.begin() + (step * stepSize), localArray.begin() + (step * stepSize) + (stepSize / 2), localArray.begin() + ((step + 1) * stepSize));
+                    medians[step] = localArray[(step * stepSize) + (stepSize / 2)];
                 }
-                // Step 2
-                isa::utils::Statistics<DataType> sigmacutStats;
-                for (unsigned int sample = 0; sample < observation.getNrSamplesPerBatch() / observation.getDownsampling(); sample++)
+                std::nth_element(medians.begin(), medians.begin() + (nrSteps / 2), medians.end());
+                baseline = medians[nrSteps / 2];
+                // The steps are only permuted by the selection, so their absolute deviations can be computed in place
+                for (unsigned int step = 0; step < nrSteps; step++)
                 {
-                    float value = timeSeries.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + sample);
-
-                    if (std::fabs(value - completeStats.getMean()) < (nSigma*completeStats.getStandardDeviation()))
+                    for (unsigned int sample = step * stepSize; sample < (step + 1) * stepSize; sample++)
                     {
-                        sigmacutStats.addElement(value);
+                        localArray[sample] = std::abs(localArray[sample] - baseline);
                     }
+                    std::nth_element(localArray.begin() + (step * stepSize), localArray.begin() + (step * stepSize) + (stepSize / 2), localArray.begin() + ((step + 1) * stepSize));
+                    medians[step] = localArray[(step * stepSize) + (stepSize / 2)];
                 }
-                standardDeviations.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs()) + dm) = sigmacutStats.getStandardDeviation();
+                std::nth_element(medians.begin(), medians.begin() + (nrSteps / 2), medians.end());
+                outputSNR[(beam * isa::utils::pad(nrDMs, padding / sizeof(float))) + dm] = (max - baseline) / (medians[nrSteps / 2] * correctionFactor);
+                outputSample[(beam * isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + dm] = maxSample;
             }
         }
     }
 }
 
-template <typename DataType>
-std::string *getMedianOfMediansOpenCL(const snrConf &conf, const DataOrdering ordering, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int stepSize, const unsigned int padding)
+template <typename T>
+uint64_t getSNRBoxcarLocalMemory(const snrConf &conf, const unsigned int nrSamples)
 {
-    std::string *code = 0;
-
-    if (ordering == DataOrdering::DMsSamples)
-    {
-        code = getMedianOfMediansDMsSamplesOpenCL<DataType>(conf, dataName, observation, downsampling, stepSize, padding);
-    }
-    return code;
+    return ((nrSamples + 1) * sizeof(float)) + (conf.getNrThreadsD0() * ((2 * sizeof(float)) + (2 * sizeof(unsigned int))));
 }
 
-template <typename DataType>
-std::string *getMedianOfMediansDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int stepSize, const unsigned int padding)
+template <typename T>
+std::string *getSNRBoxcarDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int nrSamples, const std::vector<unsigned int> &widths, const unsigned int padding)
 {
+    if (getSNRBoxcarLocalMemory<T>(conf, nrSamples) > minLocalMemorySize)
+    {
+        throw std::invalid_argument("The time series of the boxcar SNR kernel does not fit in local memory.");
+    }
     std::string *code = new std::string();
-    unsigned int nrSamples = 0;
     unsigned int nrDMs = 0;
+    // Every work-item scans a contiguous chunk of the time series
+    unsigned int chunkSize = (nrSamples + conf.getNrThreadsD0() - 1) / conf.getNrThreadsD0();
 
     if (conf.getSubbandDedispersion())
     {
@@ -649,96 +5084,192 @@ std::string *getMedianOfMediansDMsSamplesOpenCL(const snrConf &conf, const std::
     {
         nrDMs = observation.getNrDMs();
     }
-    nrSamples = observation.getNrSamplesPerBatch() / downsampling;
-    // Generate source code
-    *code = "__kernel void medianOfMedians_DMsSamples_" + std::to_string(stepSize) + "(__global const " + dataName + " * const restrict time_series, __global " + dataName + " * const restrict medians) {\n"
-        "__local " + dataName + " local_data[" + std::to_string(stepSize) + "];\n"
+    *code = "__kernel void snrBoxcar_DMsSamples_" + std::to_string(nrSamples) + "(__global const " + dataName + " * const restrict time_series, __global float * const restrict outputSNR, __global unsigned int * const restrict outputWidth, __global unsigned int * const restrict outputSample) {\n"
+        "float sum = 0.0f;\n"
+        "float variance = 0.0f;\n"
+        "float mean = 0.0f;\n"
+        "float snr = 0.0f;\n"
+        "float maxSNR = -FLT_MAX;\n"
+        "unsigned int maxWidth = " + std::to_string(widths.at(0)) + ";\n"
+        "unsigned int maxSample = 0;\n"
+        "__local float prefix[" + std::to_string(nrSamples + 1) + "];\n"
+        "__local float reductionSUM[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "__local float reductionSNR[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "__local unsigned int reductionWID[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "__local unsigned int reductionSAM[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
         "\n"
-        "// Load data in shared memory\n"
-        "for ( unsigned int item = get_local_id(0); item < " + std::to_string(stepSize) + "; item += " + std::to_string(conf.getNrThreadsD0()) + " ) {\n"
-        "local_data[item] = time_series[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(0) * " + std::to_string(stepSize) + ") + item];\n"
+        "// Load the time series in local memory, and compute the mean\n"
+        "for ( unsigned int sample = get_local_id(0); sample < " + std::to_string(nrSamples) + "; sample += " + std::to_string(conf.getNrThreadsD0()) + " ) {\n"
+        "float item = (float)(time_series[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + sample]);\n"
+        "prefix[sample + 1] = item;\n"
+        "sum += item;\n"
+        "}\n"
+        "reductionSUM[get_local_id(0)] = sum;\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "for ( unsigned int threshold = " + std::to_string(conf.getNrThreadsD0() / 2) + "; threshold > 0; threshold /= 2 ) {\n"
+        "if ( get_local_id(0) < threshold ) {\n"
+        "sum += reductionSUM[get_local_id(0) + threshold];\n"
+        "reductionSUM[get_local_id(0)] = sum;\n"
         "}\n"
         "barrier(CLK_LOCAL_MEM_FENCE);\n"
-        "// Odd-Even Sort\n"
-        "for ( unsigned int merge_step = " + std::to_string(static_cast<unsigned int>(std::pow(2, std::ceil(std::log2(stepSize)) - 1))) + "; merge_step > 0; merge_step /= 2 ) {\n"
-        "for ( unsigned int other_index = merge_step, sort_step = " + std::to_string(static_cast<unsigned int>(pow(2, std::ceil(std::log2(stepSize)) - 1))) + ", turn  = 0; other_index > 0; other_index = sort_step - merge_step, sort_step /= 2, turn = merge_step ) {\n"
-        "for ( unsigned int index = get_local_id(0); index < " + std::to_string(stepSize) + " - other_index; index += " + std::to_string(conf.getNrThreadsD0()) + " ) {\n"
-        "if ( ((index & merge_step) == turn) && (local_data[index] > local_data[index + other_index]) ) {\n"
-        + dataName + " temp = local_data[index];\n"
-        "local_data[index] = local_data[index + other_index];\n"
-        "local_data[index + other_index] = temp;\n"
         "}\n"
+        "mean = reductionSUM[0] / " + std::to_string(nrSamples) + ".0f;\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "// Remove the mean, compute the variance, and scan the chunk of every work-item\n"
+        "sum = 0.0f;\n"
+        "for ( unsigned int sample = (get_local_id(0) * " + std::to_string(chunkSize) + ") + 1; (sample <= (get_local_id(0) + 1) * " + std::to_string(chunkSize) + ") && (sample <= " + std::to_string(nrSamples) + "); sample++ ) {\n"
+        "float item = prefix[sample] - mean;\n"
+        "variance += item * item;\n"
+        "sum += item;\n"
+        "prefix[sample] = sum;\n"
         "}\n"
+        "reductionSUM[get_local_id(0)] = sum;\n"
         "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "// Scan of the chunk sums\n"
+        "for ( unsigned int offset = 1; offset < " + std::to_string(conf.getNrThreadsD0()) + "; offset *= 2 ) {\n"
+        "float item = 0.0f;\n"
+        "if ( get_local_id(0) >= offset ) {\n"
+        "item = reductionSUM[get_local_id(0) - offset];\n"
         "}\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "reductionSUM[get_local_id(0)] += item;\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "}\n"
+        "sum = reductionSUM[get_local_id(0)] - sum;\n"
+        "for ( unsigned int sample = (get_local_id(0) * " + std::to_string(chunkSize) + ") + 1; (sample <= (get_local_id(0) + 1) * " + std::to_string(chunkSize) + ") && (sample <= " + std::to_string(nrSamples) + "); sample++ ) {\n"
+        "prefix[sample] += sum;\n"
         "}\n"
-        "// Store median\n"
         "if ( get_local_id(0) == 0 ) {\n"
-        "<%STORE%>"
+        "prefix[0] = 0.0f;\n"
+        "}\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "reductionSUM[get_local_id(0)] = variance;\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "for ( unsigned int threshold = " + std::to_string(conf.getNrThreadsD0() / 2) + "; threshold > 0; threshold /= 2 ) {\n"
+        "if ( get_local_id(0) < threshold ) {\n"
+        "variance += reductionSUM[get_local_id(0) + threshold];\n"
+        "reductionSUM[get_local_id(0)] = variance;\n"
+        "}\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "}\n"
+        "// Boxcars\n"
+        "<%BOXCARS%>"
+        "reductionSNR[get_local_id(0)] = maxSNR;\n"
+        "reductionWID[get_local_id(0)] = maxWidth;\n"
+        "reductionSAM[get_local_id(0)] = maxSample;\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "// Reduce phase\n"
+        "for ( unsigned int threshold = " + std::to_string(conf.getNrThreadsD0() / 2) + "; threshold > 0; threshold /= 2 ) {\n"
+        "if ( get_local_id(0) < threshold ) {\n"
+        "if ( reductionSNR[get_local_id(0) + threshold] > maxSNR ) {\n"
+        "maxSNR = reductionSNR[get_local_id(0) + threshold];\n"
+        "maxWidth = reductionWID[get_local_id(0) + threshold];\n"
+        "maxSample = reductionSAM[get_local_id(0) + threshold];\n"
+        "}\n"
+        "reductionSNR[get_local_id(0)] = maxSNR;\n"
+        "reductionWID[get_local_id(0)] = maxWidth;\n"
+        "reductionSAM[get_local_id(0)] = maxSample;\n"
+        "}\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "}\n"
+        "// Store\n"
+        "if ( get_local_id(0) == 0 ) {\n"
+        "outputSNR[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(float))) + ") + get_group_id(1)] = maxSNR / native_sqrt(reductionSUM[0] / " + std::to_string(nrSamples - 1) + ".0f);\n"
+        "outputWidth[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + ") + get_group_id(1)] = maxWidth;\n"
+        "outputSample[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + ") + get_group_id(1)] = maxSample;\n"
         "}\n"
         "}\n";
-    std::string storeTemplateFirstStep = "medians[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples / stepSize, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples / stepSize, padding / sizeof(DataType))) + ") + get_group_id(0)] = local_data[" + std::to_string(stepSize / 2) + "];\n";
-    std::string storeTemplateSecondStep = "medians[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + get_group_id(1)] = local_data[" + std::to_string(stepSize / 2) + "];\n";
-    if (nrSamples != stepSize)
-    {
-        code = isa::utils::replace(code, "<%STORE%>", storeTemplateFirstStep, true);
-    }
-    else
+    // The boxcar sums are scaled by the square root of the width, the division by the standard deviation is done at the end
+    std::string boxcarTemplate = "for ( unsigned int sample = get_local_id(0); sample + <%WIDTH%> <= " + std::to_string(nrSamples) + "; sample += " + std::to_string(conf.getNrThreadsD0()) + " ) {\n"
+        "snr = (prefix[sample + <%WIDTH%>] - prefix[sample]) * rsqrt(<%WIDTH%>.0f);\n"
+        "if ( snr > maxSNR ) {\n"
+        "maxSNR = snr;\n"
+        "maxWidth = <%WIDTH%>;\n"
+        "maxSample = sample;\n"
+        "}\n"
+        "}\n";
+    std::string boxcars_s;
+
+    for (auto width = widths.begin(); width != widths.end(); ++width)
     {
-        code = isa::utils::replace(code, "<%STORE%>", storeTemplateSecondStep, true);
+        std::string *temp = 0;
+        std::string width_s = std::to_string(*width);
+
+        temp = isa::utils::replace(&boxcarTemplate, "<%WIDTH%>", width_s);
+        boxcars_s.append(*temp);
+        delete temp;
     }
+    code = isa::utils::replace(code, "<%BOXCARS%>", boxcars_s, true);
     return code;
 }
 
 template <typename DataType>
-void medianOfMedians(const unsigned int stepSize, const std::vector<DataType> &timeSeries, std::vector<DataType> &medians, const AstroData::Observation &observation, const unsigned int padding)
+void snrBoxcarCPU(const std::vector<DataType> &input, std::vector<float> &outputSNR, std::vector<unsigned int> &outputWidth, std::vector<unsigned int> &outputSample, const AstroData::Observation &observation, const unsigned int nrSamples, const std::vector<unsigned int> &widths, const unsigned int padding)
 {
-    for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+    const unsigned int nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    const uint64_t nrSamplesPadded = isa::utils::pad(nrSamples, padding / sizeof(DataType));
+
+#pragma omp parallel
     {
-        for (unsigned int subbandingDM = 0; subbandingDM < observation.getNrDMs(true); subbandingDM++)
+        std::vector<float> prefix(nrSamples + 1);
+
+#pragma omp for collapse(2) schedule(static)
+        for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
         {
-            for (unsigned int dm = 0; dm < observation.getNrDMs(); dm++)
+            for (unsigned int dm = 0; dm < nrDMs; dm++)
             {
-                for (unsigned int step = 0; step < observation.getNrSamplesPerBatch() / observation.getDownsampling() / stepSize; step++)
+                const DataType *items = input.data() + (((beam * nrDMs) + dm) * nrSamplesPadded);
+                float mean = 0.0f;
+                float variance = 0.0f;
+                float maxSNR = -std::numeric_limits<float>::max();
+                unsigned int maxWidth = widths.at(0);
+                unsigned int maxSample = 0;
+
+                for (unsigned int sample = 0; sample < nrSamples; sample++)
                 {
-                    std::vector<DataType> localArray;
+                    mean += items[sample];
+                }
+                mean /= nrSamples;
+                prefix[0] = 0.0f;
+                for (unsigned int sample = 0; sample < nrSamples; sample++)
+                {
+                    float item = items[sample] - mean;
 
-                    for (unsigned int sample = 0; sample < stepSize; sample++)
-                    {
-                        localArray.push_back(timeSeries.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (step * stepSize) + sample));
-                    }
-                    std::sort(localArray.begin(), localArray.end());
-                    if (stepSize == observation.getNrSamplesPerBatch())
-                    {
-                        medians.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs()) + dm) = localArray.at(stepSize / 2);
-                    }
-                    else
+                    variance += item * item;
+                    prefix[sample + 1] = prefix[sample] + item;
+                }
+                for (auto width = widths.begin(); width != widths.end(); ++width)
+                {
+                    const float scale = 1.0f / std::sqrt(static_cast<float>(*width));
+
+                    for (unsigned int sample = 0; sample + *width <= nrSamples; sample++)
                     {
-                        medians.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling() / stepSize, padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling() / stepSize, padding / sizeof(DataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling() / stepSize, padding / sizeof(DataType))) + step) = localArray.at(stepSize / 2);
+                        float snr = (prefix[sample + *width] - prefix[sample]) * scale;
+
+                        if (snr > maxSNR)
+                        {
+                            maxSNR = snr;
+                            maxWidth = *width;
+                            maxSample = sample;
+                        }
                     }
                 }
+                outputSNR[(beam * isa::utils::pad(nrDMs, padding / sizeof(float))) + dm] = maxSNR / std::sqrt(variance / (nrSamples - 1));
+                outputWidth[(beam * isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + dm] = maxWidth;
+                outputSample[(beam * isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + dm] = maxSample;
             }
         }
     }
 }
 
-template <typename DataType>
-std::string *getMedianOfMediansAbsoluteDeviationOpenCL(const snrConf &conf, const DataOrdering ordering, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int stepSize, const unsigned int padding)
+template <typename T>
+std::string *getSNRDownsamplingDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int downsampling, const unsigned int padding)
 {
-    std::string *code = 0;
-
-    if (ordering == DataOrdering::DMsSamples)
+    if ((conf.getNrThreadsD0() * 2) > nrSamples)
     {
-        code = getMedianOfMediansAbsoluteDeviationDMsSamplesOpenCL<DataType>(conf, dataName, observation, downsampling, stepSize, padding);
+        throw std::invalid_argument("The number of work-items of the downsampling SNR kernel must not be larger than half the number of samples.");
     }
-    return code;
-}
-
-template <typename DataType>
-std::string *getMedianOfMediansAbsoluteDeviationDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int stepSize, const unsigned int padding)
-{
     std::string *code = new std::string();
-    unsigned int nrSamples = 0;
     unsigned int nrDMs = 0;
 
     if (conf.getSubbandDedispersion())
@@ -749,129 +5280,372 @@ std::string *getMedianOfMediansAbsoluteDeviationDMsSamplesOpenCL(const snrConf &
     {
         nrDMs = observation.getNrDMs();
     }
-    nrSamples = observation.getNrSamplesPerBatch() / downsampling;
-    // Generate source code
-    *code = "__kernel void medianOfMediansAbsoluteDeviation_DMsSamples_" + std::to_string(stepSize) + "(__global const " + dataName + " * const restrict baselines, __global const " + dataName + " * const restrict time_series, __global " + dataName + " * const restrict medians) {\n"
-        "__local " + dataName + " local_data[" + std::to_string(stepSize) + "];\n"
-        + dataName + " baseline = baselines[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + get_group_id(1)];\n"
+    *code = "__kernel void snrDownsampling_DMsSamples_" + std::to_string(downsampling) + "(__global const " + dataName + " * const restrict input, __global " + dataName + " * const restrict output, __global float * const restrict outputSNR, __global unsigned int * const restrict outputSample, __global unsigned int * const restrict outputDownsampling) {\n"
+        "float delta = 0.0f;\n"
+        "float counter0 = 0.0f;\n"
+        "float mean0 = 0.0f;\n"
+        "float variance0 = 0.0f;\n"
+        + dataName + " max0 = input[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (2 * get_local_id(0))];\n"
+        "unsigned int maxSample0 = 2 * get_local_id(0);\n"
+        + dataName + " itemA = 0;\n"
+        + dataName + " itemB = 0;\n"
+        "__local float reductionCOU[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "__local " + dataName + " reductionMAX[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "__local unsigned int reductionSAM[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "__local float reductionMEA[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "__local float reductionVAR[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
         "\n"
-        "// Load data in shared memory\n"
-        "for ( unsigned int item = get_local_id(0); item < " + std::to_string(stepSize) + "; item += " + std::to_string(conf.getNrThreadsD0()) + " ) {\n"
-        "local_data[item] = fabs(time_series[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(0) * " + std::to_string(stepSize) + ") + item] - baseline);\n"
-        "}\n"
-        "barrier(CLK_LOCAL_MEM_FENCE);\n"
-        "// Odd-Even Sort\n"
-        "for ( unsigned int merge_step = " + std::to_string(static_cast<unsigned int>(std::pow(2, std::ceil(std::log2(stepSize)) - 1))) + "; merge_step > 0; merge_step /= 2 ) {\n"
-        "for ( unsigned int other_index = merge_step, sort_step = " + std::to_string(static_cast<unsigned int>(pow(2, std::ceil(std::log2(stepSize)) - 1))) + ", turn  = 0; other_index > 0; other_index = sort_step - merge_step, sort_step /= 2, turn = merge_step ) {\n"
-        "for ( unsigned int index = get_local_id(0); index < " + std::to_string(stepSize) + " - other_index; index += " + std::to_string(conf.getNrThreadsD0()) + " ) {\n"
-        "if ( ((index & merge_step) == turn) && (local_data[index] > local_data[index + other_index]) ) {\n"
-        + dataName + " temp = local_data[index];\n"
-        "local_data[index] = local_data[index + other_index];\n"
-        "local_data[index + other_index] = temp;\n"
-        "}\n"
+        "// Compute phase, every pair of samples is also summed in the next level\n"
+        "for ( unsigned int sample = get_local_id(0); sample < " + std::to_string(nrSamples / 2) + "; sample += " + std::to_string(conf.getNrThreadsD0()) + " ) {\n"
+        "itemA = input[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (2 * sample)];\n"
+        "itemB = input[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (2 * sample) + 1];\n"
+        "output[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples / 2, padding / sizeof(T))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples / 2, padding / sizeof(T))) + ") + sample] = itemA + itemB;\n"
+        "<%COMPUTE_A%>"
+        "<%COMPUTE_B%>"
         "}\n"
+        "<%COMPUTE_LAST%>"
+        "// Local memory store\n"
+        "reductionCOU[get_local_id(0)] = counter0;\n"
+        "reductionMAX[get_local_id(0)] = max0;\n"
+        "reductionSAM[get_local_id(0)] = maxSample0;\n"
+        "reductionMEA[get_local_id(0)] = mean0;\n"
+        "reductionVAR[get_local_id(0)] = variance0;\n"
         "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "// Reduce phase\n"
+        "unsigned int threshold = " + std::to_string(conf.getNrThreadsD0() / 2) + ";\n"
+        "for ( unsigned int sample = get_local_id(0); threshold > 0; threshold /= 2 ) {\n"
+            "if ( sample < threshold ) {\n"
+                "delta = reductionMEA[sample + threshold] - mean0;\n"
+                "counter0 += reductionCOU[sample + threshold];\n"
+                "mean0 = ((reductionCOU[sample] * mean0) + (reductionCOU[sample + threshold] * reductionMEA[sample + threshold])) / counter0;\n"
+                "variance0 += reductionVAR[sample + threshold] + ((delta * delta) * ((reductionCOU[sample] * reductionCOU[sample + threshold]) / counter0));\n"
+                "if ( reductionMAX[sample + threshold] > max0 ) {\n"
+                    "max0 = reductionMAX[sample + threshold];\n"
+                    "maxSample0 = reductionSAM[sample + threshold];\n"
+                "}\n"
+                "reductionCOU[sample] = counter0;\n"
+                "reductionMAX[sample] = max0;\n"
+                "reductionSAM[sample] = maxSample0;\n"
+                "reductionMEA[sample] = mean0;\n"
+                "reductionVAR[sample] = variance0;\n"
+            "}\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n"
         "}\n"
-        "}\n"
-        "// Store median\n"
+        "// Store\n"
         "if ( get_local_id(0) == 0 ) {\n"
-        "medians[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples / stepSize, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples / stepSize, padding / sizeof(DataType))) + ") + get_group_id(0)] = local_data[" + std::to_string(stepSize / 2) + "];\n"
+        "float snr = (max0 - mean0) / native_sqrt(variance0 * " + std::to_string(1.0f / (nrSamples - 1)) + "f);\n"
+        "<%STORE%>"
         "}\n"
         "}\n";
+    std::string compute_sTemplate = "counter0 += 1.0f;\n"
+        "delta = <%ITEM%> - mean0;\n"
+        "mean0 += delta / counter0;\n"
+        "variance0 += delta * (<%ITEM%> - mean0);\n"
+        "if ( <%ITEM%> > max0 ) {\n"
+        "max0 = <%ITEM%>;\n"
+        "maxSample0 = <%SAMPLE%>;\n"
+        "}\n";
+    std::string store_s;
+    std::string *temp = 0;
+
+    temp = isa::utils::replace(&compute_sTemplate, "<%ITEM%>", "itemA");
+    temp = isa::utils::replace(temp, "<%SAMPLE%>", "2 * sample", true);
+    code = isa::utils::replace(code, "<%COMPUTE_A%>", *temp, true);
+    delete temp;
+    temp = isa::utils::replace(&compute_sTemplate, "<%ITEM%>", "itemB");
+    temp = isa::utils::replace(temp, "<%SAMPLE%>", "(2 * sample) + 1", true);
+    code = isa::utils::replace(code, "<%COMPUTE_B%>", *temp, true);
+    delete temp;
+    if ((nrSamples % 2) != 0)
+    {
+        // The last sample does not have a pair, so it is not part of the next level
+        std::string last_s = "if ( get_local_id(0) == 0 ) {\n"
+            "itemA = input[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + " + std::to_string(nrSamples - 1) + "];\n"
+            "<%COMPUTE%>"
+            "}\n";
+
+        std::string *compute_s = 0;
+
+        compute_s = isa::utils::replace(&compute_sTemplate, "<%ITEM%>", "itemA");
+        compute_s = isa::utils::replace(compute_s, "<%SAMPLE%>", std::to_string(nrSamples - 1), true);
+        temp = isa::utils::replace(&last_s, "<%COMPUTE%>", *compute_s);
+        code = isa::utils::replace(code, "<%COMPUTE_LAST%>", *temp, true);
+        delete compute_s;
+        delete temp;
+    }
+    else
+    {
+        std::string empty_s("");
+        code = isa::utils::replace(code, "<%COMPUTE_LAST%>", empty_s, true);
+    }
+    if (downsampling == 1)
+    {
+        store_s = "outputSNR[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(float))) + ") + get_group_id(1)] = snr;\n"
+            "outputSample[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + ") + get_group_id(1)] = maxSample0;\n"
+            "outputDownsampling[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + ") + get_group_id(1)] = 1;\n";
+    }
+    else
+    {
+        store_s = "if ( snr > outputSNR[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(float))) + ") + get_group_id(1)] ) {\n"
+            "outputSNR[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(float))) + ") + get_group_id(1)] = snr;\n"
+            "outputSample[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + ") + get_group_id(1)] = maxSample0 * " + std::to_string(downsampling) + ";\n"
+            "outputDownsampling[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + ") + get_group_id(1)] = " + std::to_string(downsampling) + ";\n"
+            "}\n";
+    }
+    code = isa::utils::replace(code, "<%STORE%>", store_s, true);
     return code;
 }
 
 template <typename DataType>
-void medianOfMediansAbsoluteDeviation(const unsigned int stepSize, const std::vector<DataType> &baselines, const std::vector<DataType> &timeSeries, std::vector<DataType> &medians, const AstroData::Observation &observation, const unsigned int padding)
+void snrDownsamplingCPU(const std::vector<DataType> &input, std::vector<float> &outputSNR, std::vector<unsigned int> &outputSample, std::vector<unsigned int> &outputDownsampling, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int nrLevels, const unsigned int padding)
 {
-    for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+    const unsigned int nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    const uint64_t nrSamplesPadded = isa::utils::pad(nrSamples, padding / sizeof(DataType));
+
+#pragma omp parallel
     {
-        for (unsigned int subbandingDM = 0; subbandingDM < observation.getNrDMs(true); subbandingDM++)
+        std::vector<DataType> level(nrSamples / 2);
+
+#pragma omp for collapse(2) schedule(static)
+        for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
         {
-            for (unsigned int dm = 0; dm < observation.getNrDMs(); dm++)
+            for (unsigned int dm = 0; dm < nrDMs; dm++)
             {
-                for (unsigned int step = 0; step < observation.getNrSamplesPerBatch() / observation.getDownsampling() / stepSize; step++)
-                {
-                    std::vector<DataType> localArray;
+                const DataType *items = input.data() + (((beam * nrDMs) + dm) * nrSamplesPadded);
+                unsigned int levelSamples = nrSamples;
+                TimeSeriesStatistics<DataType> statistics = timeSeriesStatistics(items, nrSamples);
+                float maxSNR = (statistics.max - statistics.mean) / std::sqrt(statistics.variance / (nrSamples - 1));
+                unsigned int maxSample = statistics.maxSample;
+                unsigned int maxDownsampling = 1;
 
-                    for (unsigned int sample = 0; sample < stepSize; sample++)
+                for (unsigned int downsampling = 2; downsampling < (1U << nrLevels); downsampling *= 2)
+                {
+                    // Every level is built in place from the previous one
+                    for (unsigned int sample = 0; sample < levelSamples / 2; sample++)
                     {
-                        localArray.push_back(std::abs(timeSeries.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (step * stepSize) + sample) - baselines.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs()) + dm)));
+                        level[sample] = items[2 * sample] + items[(2 * sample) + 1];
+                    }
+                    items = level.data();
+                    levelSamples /= 2;
+                    statistics = timeSeriesStatistics(items, levelSamples);
+                    float snr = (statistics.max - statistics.mean) / std::sqrt(statistics.variance / (levelSamples - 1));
+                    if (snr > maxSNR)
+                    {
+                        maxSNR = snr;
+                        maxSample = statistics.maxSample * downsampling;
+                        maxDownsampling = downsampling;
                     }
-                    std::sort(localArray.begin(), localArray.end());
-                    medians.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling() / stepSize, padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling() / stepSize, padding / sizeof(DataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling() / stepSize, padding / sizeof(DataType))) + step) = localArray.at(stepSize / 2);
                 }
+                outputSNR[(beam * isa::utils::pad(nrDMs, padding / sizeof(float))) + dm] = maxSNR;
+                outputSample[(beam * isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + dm] = maxSample;
+                outputDownsampling[(beam * isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + dm] = maxDownsampling;
             }
         }
     }
-}
-
-template <typename DataType>
-std::string * getAbsoluteDeviationOpenCL(const snrConf &conf, const DataOrdering ordering, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding)
-{
-    std::string *code = 0;
-
-    if (ordering == DataOrdering::DMsSamples)
+}
+
+template <typename T>
+std::string *getSNRTopKDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int nrPeaks, const unsigned int padding)
+{
+    std::string *code = new std::string();
+    unsigned int nrDMs = 0;
+
+    if (conf.getSubbandDedispersion())
+    {
+        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    }
+    else
+    {
+        nrDMs = observation.getNrDMs();
+    }
+    *code = "__kernel void snrTopK_DMsSamples_" + std::to_string(nrSamples) + "(__global const " + dataName + " * const restrict input, __global float * const restrict outputSNR, __global unsigned int * const restrict outputSample) {\n"
+        "float delta = 0.0f;\n"
+        "float counter0 = 0.0f;\n"
+        "float mean0 = 0.0f;\n"
+        "float variance0 = 0.0f;\n"
+        "float item = 0.0f;\n"
+        "float candidate = 0.0f;\n"
+        "unsigned int candidateSample = 0;\n"
+        "float swapValue = 0.0f;\n"
+        "unsigned int swapSample = 0;\n"
+        "<%DEF%>"
+        "__local float reductionCOU[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "__local float reductionMEA[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "__local float reductionVAR[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "__local float reductionTOP[" + std::to_string(conf.getNrThreadsD0() * nrPeaks) + "];\n"
+        "__local unsigned int reductionSAM[" + std::to_string(conf.getNrThreadsD0() * nrPeaks) + "];\n"
+        "\n"
+        "// Compute phase\n"
+        "for ( unsigned int sample = get_local_id(0); sample < " + std::to_string(nrSamples) + "; sample += " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + " ) {\n"
+        "<%COMPUTE%>"
+        "}\n"
+        "// Local memory store\n"
+        "reductionCOU[get_local_id(0)] = counter0;\n"
+        "reductionMEA[get_local_id(0)] = mean0;\n"
+        "reductionVAR[get_local_id(0)] = variance0;\n"
+        "<%STORE_LOCAL%>"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "// Reduce phase\n"
+        "unsigned int threshold = " + std::to_string(conf.getNrThreadsD0() / 2) + ";\n"
+        "for ( unsigned int sample = get_local_id(0); threshold > 0; threshold /= 2 ) {\n"
+            "if ( sample < threshold ) {\n"
+                "delta = reductionMEA[sample + threshold] - mean0;\n"
+                "counter0 += reductionCOU[sample + threshold];\n"
+                "mean0 = ((reductionCOU[sample] * mean0) + (reductionCOU[sample + threshold] * reductionMEA[sample + threshold])) / counter0;\n"
+                "variance0 += reductionVAR[sample + threshold] + ((delta * delta) * ((reductionCOU[sample] * reductionCOU[sample + threshold]) / counter0));\n"
+                "// The list of the other work-item is sorted, so the merge stops at the first peak that is not high enough\n"
+                "for ( unsigned int peak = 0; peak < " + std::to_string(nrPeaks) + "; peak++ ) {\n"
+                    "candidate = reductionTOP[((sample + threshold) * " + std::to_string(nrPeaks) + ") + peak];\n"
+                    "candidateSample = reductionSAM[((sample + threshold) * " + std::to_string(nrPeaks) + ") + peak];\n"
+                    "if ( candidate <= peak" + std::to_string(nrPeaks - 1) + " ) {\n"
+                        "break;\n"
+                    "}\n"
+                    "<%INSERT%>"
+                "}\n"
+                "reductionCOU[sample] = counter0;\n"
+                "reductionMEA[sample] = mean0;\n"
+                "reductionVAR[sample] = variance0;\n"
+                "<%STORE_LOCAL%>"
+            "}\n"
+            "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "}\n"
+        "// Store\n"
+        "if ( get_local_id(0) == 0 ) {\n"
+        "float stdev = native_sqrt(variance0 * " + std::to_string(1.0f / (nrSamples - 1)) + "f);\n"
+        "<%STORE%>"
+        "}\n"
+        "}\n";
+    std::string def_sTemplate = "float peak<%NUM%> = -FLT_MAX;\n"
+        "unsigned int peakSample<%NUM%> = 0;\n";
+    std::string insert_sTemplate = "if ( candidate > peak<%NUM%> ) {\n"
+        "swapValue = peak<%NUM%>;\n"
+        "swapSample = peakSample<%NUM%>;\n"
+        "peak<%NUM%> = candidate;\n"
+        "peakSample<%NUM%> = candidateSample;\n"
+        "candidate = swapValue;\n"
+        "candidateSample = swapSample;\n"
+        "}\n";
+    std::string storeLocal_sTemplate = "reductionTOP[(get_local_id(0) * " + std::to_string(nrPeaks) + ") + <%NUM%>] = peak<%NUM%>;\n"
+        "reductionSAM[(get_local_id(0) * " + std::to_string(nrPeaks) + ") + <%NUM%>] = peakSample<%NUM%>;\n";
+    std::string store_sTemplate = "outputSNR[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs * nrPeaks, padding / sizeof(float))) + ") + (get_group_id(1) * " + std::to_string(nrPeaks) + ") + <%NUM%>] = (peak<%NUM%> - mean0) / stdev;\n"
+        "outputSample[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs * nrPeaks, padding / sizeof(unsigned int))) + ") + (get_group_id(1) * " + std::to_string(nrPeaks) + ") + <%NUM%>] = peakSample<%NUM%>;\n";
+    std::string compute_sTemplate;
+    if ((nrSamples % (conf.getNrThreadsD0() * conf.getNrItemsD0())) != 0)
+    {
+        compute_sTemplate += "if ( (sample + <%OFFSET%>) < " + std::to_string(nrSamples) + " ) {\n";
+    }
+    compute_sTemplate += "item = input[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (sample + <%OFFSET%>)];\n"
+        "counter0 += 1.0f;\n"
+        "delta = item - mean0;\n"
+        "mean0 += delta / counter0;\n"
+        "variance0 += delta * (item - mean0);\n"
+        "if ( item > peak" + std::to_string(nrPeaks - 1) + " ) {\n"
+        "candidate = item;\n"
+        "candidateSample = sample + <%OFFSET%>;\n"
+        "<%INSERT%>"
+        "}\n";
+    if ((nrSamples % (conf.getNrThreadsD0() * conf.getNrItemsD0())) != 0)
     {
-        code = getAbsoluteDeviationDMsSamplesOpenCL<DataType>(conf, dataName, observation, downsampling, padding);
+        compute_sTemplate += "}\n";
     }
-    return code;
-}
 
-template <typename DataType>
-std::string * getAbsoluteDeviationDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding)
-{
-    std::string *code = new std::string();
-    unsigned int nrSamples = 0;
-    unsigned int nrDMs = 0;
+    std::string *def_s = new std::string();
+    std::string *compute_s = new std::string();
+    std::string *insert_s = new std::string();
+    std::string *storeLocal_s = new std::string();
+    std::string *store_s = new std::string();
 
-    if (conf.getSubbandDedispersion())
-    {
-        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
-    }
-    else
+    for (unsigned int peak = 0; peak < nrPeaks; peak++)
     {
-        nrDMs = observation.getNrDMs();
+        std::string peak_s = std::to_string(peak);
+        std::string *temp = 0;
+
+        temp = isa::utils::replace(&def_sTemplate, "<%NUM%>", peak_s);
+        def_s->append(*temp);
+        delete temp;
+        temp = isa::utils::replace(&insert_sTemplate, "<%NUM%>", peak_s);
+        insert_s->append(*temp);
+        delete temp;
+        temp = isa::utils::replace(&storeLocal_sTemplate, "<%NUM%>", peak_s);
+        storeLocal_s->append(*temp);
+        delete temp;
+        temp = isa::utils::replace(&store_sTemplate, "<%NUM%>", peak_s);
+        store_s->append(*temp);
+        delete temp;
     }
-    nrSamples = observation.getNrSamplesPerBatch() / downsampling;
-    // Generate source code
-    *code = "__kernel void absolute_deviation_DMsSamples_" + std::to_string(nrSamples) + "(__global const " + dataName + " * const restrict baselines, __global const " + dataName + " * const restrict input_data, __global " + dataName + " * const restrict output_data) {\n"
-        "unsigned int item = (get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (get_group_id(0) * " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + ") + get_local_id(0);\n"
-        "<%COMPUTE_STORE%>"
-        "}\n";
-    std::string computeStoreTemplate = "output_data[item + <%ITEM_OFFSET%>] = fabs(input_data[item + <%ITEM_OFFSET%>] - baselines[(get_group_id(2) * " + std::to_string(nrDMs * (padding / sizeof(DataType))) + ") + get_group_id(1)]);\n";
-    std::string computeStore;
-    for (unsigned int item = 0; item < conf.getNrItemsD0(); item++)
+    for (unsigned int sample = 0; sample < conf.getNrItemsD0(); sample++)
     {
-        std::string *temp;
-        std::string itemOffsetString = std::to_string(item * conf.getNrThreadsD0());
-        if (item == 0)
+        std::string offset_s = std::to_string(conf.getNrThreadsD0() * sample);
+        std::string *temp = 0;
+
+        temp = isa::utils::replace(&compute_sTemplate, "<%INSERT%>", *insert_s);
+        if (sample == 0)
         {
-            temp = isa::utils::replace(&computeStoreTemplate, " + <%ITEM_OFFSET%>", std::string());
+            std::string empty_s("");
+            temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
         }
         else
         {
-            temp = isa::utils::replace(&computeStoreTemplate, "<%ITEM_OFFSET%>", itemOffsetString);
+            temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
         }
-        computeStore.append(*temp);
+        compute_s->append(*temp);
         delete temp;
     }
-    code = isa::utils::replace(code, "<%COMPUTE_STORE%>", computeStore, true);
+
+    code = isa::utils::replace(code, "<%DEF%>", *def_s, true);
+    code = isa::utils::replace(code, "<%COMPUTE%>", *compute_s, true);
+    code = isa::utils::replace(code, "<%INSERT%>", *insert_s, true);
+    code = isa::utils::replace(code, "<%STORE_LOCAL%>", *storeLocal_s, true);
+    code = isa::utils::replace(code, "<%STORE%>", *store_s, true);
+    delete def_s;
+    delete compute_s;
+    delete insert_s;
+    delete storeLocal_s;
+    delete store_s;
+
     return code;
 }
 
 template <typename DataType>
-void absoluteDeviation(const std::vector<DataType> &baselines, const std::vector<DataType> &timeSeries, std::vector<DataType> &absoluteDeviations, const AstroData::Observation &observation, const unsigned int padding)
+void snrTopKCPU(const std::vector<DataType> &input, std::vector<float> &outputSNR, std::vector<unsigned int> &outputSample, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int nrPeaks, const unsigned int padding)
 {
-    for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+    const unsigned int nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    const uint64_t nrSamplesPadded = isa::utils::pad(nrSamples, padding / sizeof(DataType));
+
+#pragma omp parallel
     {
-        for (unsigned int subbandingDM = 0; subbandingDM < observation.getNrDMs(true); subbandingDM++)
+        std::vector<unsigned int> peaks(nrPeaks);
+
+#pragma omp for collapse(2) schedule(static)
+        for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
         {
-            for (unsigned int dm = 0; dm < observation.getNrDMs(); dm++)
+            for (unsigned int dm = 0; dm < nrDMs; dm++)
             {
-                for (unsigned int sample = 0; sample < observation.getNrSamplesPerBatch() / observation.getDownsampling(); sample++)
+                const DataType *items = input.data() + (((beam * nrDMs) + dm) * nrSamplesPadded);
+                TimeSeriesStatistics<DataType> statistics = timeSeriesStatistics(items, nrSamples);
+                float stdev = std::sqrt(statistics.variance / (nrSamples - 1));
+                unsigned int nrFound = 0;
+
+                // Sorted insertion, the list is short and most samples are discarded by the first comparison
+                for (unsigned int sample = 0; sample < nrSamples; sample++)
+                {
+                    if ((nrFound == nrPeaks) && (items[sample] <= items[peaks[nrPeaks - 1]]))
+                    {
+                        continue;
+                    }
+                    unsigned int position = std::min(nrFound, nrPeaks - 1);
+                    while ((position > 0) && (items[peaks[position - 1]] < items[sample]))
+                    {
+                        peaks[position] = peaks[position - 1];
+                        position--;
+                    }
+                    peaks[position] = sample;
+                    nrFound = std::min(nrFound + 1, nrPeaks);
+                }
+                for (unsigned int peak = 0; peak < nrPeaks; peak++)
                 {
-                    absoluteDeviations.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + sample) = std::abs(timeSeries.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(DataType))) + sample) - baselines.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * (padding / sizeof(DataType))) + (subbandingDM * observation.getNrDMs()) + dm));
+                    outputSNR[(beam * isa::utils::pad(nrDMs * nrPeaks, padding / sizeof(float))) + (dm * nrPeaks) + peak] = (items[peaks[peak]] - statistics.mean) / stdev;
+                    outputSample[(beam * isa::utils::pad(nrDMs * nrPeaks, padding / sizeof(unsigned int))) + (dm * nrPeaks) + peak] = peaks[peak];
                 }
             }
         }
@@ -879,7 +5653,7 @@ void absoluteDeviation(const std::vector<DataType> &baselines, const std::vector
 }
 
 template <typename T>
-std::string *getSNRDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int padding)
+std::string *getSNRCandidatesDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int nrSamples, const float threshold, const unsigned int maxCandidates, const unsigned int padding)
 {
     std::string *code = new std::string();
     unsigned int nrDMs = 0;
@@ -892,7 +5666,7 @@ std::string *getSNRDMsSamplesOpenCL(const snrConf &conf, const std::string &data
     {
         nrDMs = observation.getNrDMs();
     }
-    *code = "__kernel void snrDMsSamples" + std::to_string(nrSamples) + "(__global const " + dataName + " * const restrict input, __global float * const restrict outputSNR, __global unsigned int * const restrict outputSample) {\n"
+    *code = "__kernel void snrCandidates_DMsSamples_" + std::to_string(nrSamples) + "(__global const " + dataName + " * const restrict input, __global unsigned int * const restrict nrCandidates, __global float * const restrict candidateSNR, __global unsigned int * const restrict candidates) {\n"
         "float delta = 0.0f;\n"
         "<%DEF%>"
         "__local float reductionCOU[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
@@ -935,10 +5709,18 @@ std::string *getSNRDMsSamplesOpenCL(const snrConf &conf, const std::string &data
             "}\n"
             "barrier(CLK_LOCAL_MEM_FENCE);\n"
         "}\n"
-        "// Store\n"
+        "// Append the candidate\n"
         "if ( get_local_id(0) == 0 ) {\n"
-        "outputSNR[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(float))) + ") + get_group_id(1)] = (max0 - mean0) / native_sqrt(variance0 * " + std::to_string(1.0f / (nrSamples - 1)) + "f);\n"
-        "outputSample[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + ") + get_group_id(1)] = maxSample0;\n"
+        "float snr = (max0 - mean0) / native_sqrt(variance0 * " + std::to_string(1.0f / (nrSamples - 1)) + "f);\n"
+        "if ( snr >= " + std::to_string(threshold) + "f ) {\n"
+        "unsigned int candidate = atomic_inc(nrCandidates);\n"
+        "if ( candidate < " + std::to_string(maxCandidates) + " ) {\n"
+        "candidateSNR[candidate] = snr;\n"
+        "candidates[(candidate * 3)] = get_group_id(2);\n"
+        "candidates[(candidate * 3) + 1] = get_group_id(1);\n"
+        "candidates[(candidate * 3) + 2] = maxSample0;\n"
+        "}\n"
+        "}\n"
         "}\n"
         "}\n";
     std::string def_sTemplate = dataName + " max<%NUM%> = input[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (get_local_id(0) + <%OFFSET%>)];\n"
@@ -1026,271 +5808,166 @@ std::string *getSNRDMsSamplesOpenCL(const snrConf &conf, const std::string &data
     return code;
 }
 
-template <typename T>
-std::string *getSNRSamplesDMsOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int padding)
+template <typename DataType>
+void snrCandidatesCPU(const std::vector<DataType> &input, std::vector<float> &candidateSNR, std::vector<unsigned int> &candidates, const AstroData::Observation &observation, const unsigned int nrSamples, const float threshold, const unsigned int padding)
 {
-    unsigned int nrDMs = 0;
-    std::string *code = new std::string();
-
-    if (conf.getSubbandDedispersion())
-    {
-        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
-    }
-    else
-    {
-        nrDMs = observation.getNrDMs();
-    }
-    // Begin kernel's template
-    *code = "__kernel void snrSamplesDMs" + std::to_string(nrDMs) + "(__global const " + dataName + " * const restrict input, __global float * const restrict outputSNR, __global unsigned int * const restrict outputSample) {\n"
-        "unsigned int dm = (get_group_id(0) * " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + ") + get_local_id(0);\n"
-        "float delta = 0.0f;\n"
-        "<%DEF%>"
-        "\n"
-        "for ( unsigned int sample = 1; sample < " + std::to_string(nrSamples) + "; sample++ ) {\n"
-            + dataName + " item = 0;\n"
-            "<%COMPUTE%>"
-        "}\n"
-        "<%STORE%>"
-    "}\n";
-
-    std::string def_sTemplate = "float counter<%NUM%> = 1.0f;\n"
-    + dataName + " max<%NUM%> = input[get_group_id(1) + <%OFFSET%>];\n"
-    "unsigned int maxSample<%NUM%> = 0;\n"
-    "float variance<%NUM%> = 0.0f;\n"
-    "float mean<%NUM%> = max<%NUM%>;\n";
-
-    std::string compute_sTemplate = "item = input[(beam * " + std::to_string(nrSamples * isa::utils::pad(nrDMs, padding / sizeof(T))) + ") + (sample * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(T))) + ")  + (dm + <%OFFSET%>)];\n"
-    "counter<%NUM%> += 1.0f;\n"
-    "delta = item - mean<%NUM%>;\n"
-    "mean<%NUM%> += delta / counter<%NUM%>;\n"
-    "variance<%NUM%> += delta * (item - mean<%NUM%>);\n"
-    "if ( item > max<%NUM%> ) {\n"
-        "max<%NUM%> = item;\n"
-        "maxSample<%NUM%> = sample;\n"
-    "}\n";
-
-    std::string store_sTemplate = "outputSNR[(beam * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(float))) + ") + dm + <%OFFSET%>] = (max<%NUM%> - mean<%NUM%>) / native_sqrt(variance<%NUM%> * " + std::to_string(1.0f / (observation.getNrSamplesPerBatch() - 1)) + "f);\n";
-    // End kernel's template
-
-    std::string *def_s = new std::string();
-    std::string *compute_s = new std::string();
-    std::string *store_s = new std::string();
+    const unsigned int nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    const uint64_t nrSamplesPadded = isa::utils::pad(nrSamples, padding / sizeof(DataType));
+    std::vector<float> snr(observation.getNrSynthesizedBeams() * nrDMs);
+    std::vector<unsigned int> maxSample(observation.getNrSynthesizedBeams() * nrDMs);
 
-    for (unsigned int dm = 0; dm < conf.getNrItemsD0(); dm++)
+#pragma omp parallel for collapse(2) schedule(static)
+    for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
     {
-        std::string dm_s = std::to_string(dm);
-        std::string offset_s = std::to_string(conf.getNrThreadsD0() * dm);
-        std::string *temp = 0;
-
-        temp = isa::utils::replace(&def_sTemplate, "<%NUM%>", dm_s);
-        if (dm == 0)
-        {
-            std::string empty_s("");
-            temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
-        }
-        else
-        {
-            temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
-        }
-        def_s->append(*temp);
-        delete temp;
-        temp = isa::utils::replace(&compute_sTemplate, "<%NUM%>", dm_s);
-        if (dm == 0)
-        {
-            std::string empty_s("");
-            temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
-        }
-        else
-        {
-            temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
-        }
-        compute_s->append(*temp);
-        delete temp;
-        temp = isa::utils::replace(&store_sTemplate, "<%NUM%>", dm_s);
-        if (dm == 0)
+        for (unsigned int dm = 0; dm < nrDMs; dm++)
         {
-            std::string empty_s("");
-            temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
+            TimeSeriesStatistics<DataType> statistics = timeSeriesStatistics(input.data() + (((beam * nrDMs) + dm) * nrSamplesPadded), nrSamples);
+
+            snr[(beam * nrDMs) + dm] = (statistics.max - statistics.mean) / std::sqrt(statistics.variance / (nrSamples - 1));
+            maxSample[(beam * nrDMs) + dm] = statistics.maxSample;
         }
-        else
+    }
+    // The candidates are appended in order, so the output does not depend on the number of threads
+    candidateSNR.clear();
+    candidates.clear();
+    for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+    {
+        for (unsigned int dm = 0; dm < nrDMs; dm++)
         {
-            temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
+            if (snr[(beam * nrDMs) + dm] >= threshold)
+            {
+                candidateSNR.push_back(snr[(beam * nrDMs) + dm]);
+                candidates.push_back(beam);
+                candidates.push_back(dm);
+                candidates.push_back(maxSample[(beam * nrDMs) + dm]);
+            }
         }
-        store_s->append(*temp);
-        delete temp;
     }
-
-    code = isa::utils::replace(code, "<%DEF%>", *def_s, true);
-    code = isa::utils::replace(code, "<%COMPUTE%>", *compute_s, true);
-    code = isa::utils::replace(code, "<%STORE%>", *store_s, true);
-    delete def_s;
-    delete compute_s;
-    delete store_s;
-
-    return code;
 }
 
 template <typename T>
-std::string *getSNRSigmaCutDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int nrSamples, const unsigned int padding, const float nSigma, const float correctionFactor)
+std::string *getSNRBeamMaxOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int padding)
 {
     std::string *code = new std::string();
     unsigned int nrDMs = 0;
-
-    if (conf.getSubbandDedispersion())
-    {
-        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
-    }
-    else
-    {
-        nrDMs = observation.getNrDMs();
-    }
-    *code = "__kernel void snrSigmaCutDMsSamples" + std::to_string(nrSamples) + "(__global const " + dataName + " * const restrict input, __global float * const restrict outputSNR, __global unsigned int * const restrict outputSample) {\n"
-        "float delta = 0.0f;\n"
-        "float mean = 0.0f;\n"
-        "float sigma_threshold = 0.0f;\n"
-        "<%DEF%>"
-        "__local float reductionCOU[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
-        "__local " + dataName + " reductionMAX[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
-        "__local unsigned int reductionSAM[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
-        "__local float reductionMEA[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
-        "__local float reductionVAR[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
-        "\n"
-        "// Compute statistics for sigma\n"
-        "// Compute phase\n"
-        "for ( unsigned int sample = get_local_id(0) + " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + "; sample < " + std::to_string(nrSamples) + "; sample += " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + " ) {\n"
-        + dataName + " item = 0;\n"
-        "<%COMPUTE%>"
-        "}\n"
-        "// In-thread reduce (optional)\n"
-        "<%REDUCE%>"
-        "// Local memory store\n"
-        "reductionCOU[get_local_id(0)] = counter0;\n"
-        "reductionMAX[get_local_id(0)] = max0;\n"
-        "reductionSAM[get_local_id(0)] = maxSample0;\n"
-        "reductionMEA[get_local_id(0)] = mean0;\n"
-        "reductionVAR[get_local_id(0)] = variance0;\n"
-        "barrier(CLK_LOCAL_MEM_FENCE);\n"
-        "// Reduce phase\n"
-        "unsigned int threshold = " + std::to_string(conf.getNrThreadsD0() / 2) + ";\n"
-        "for ( unsigned int sample = get_local_id(0); threshold > 0; threshold /= 2 ) {\n"
-            "if ( sample < threshold ) {\n"
-                "delta = reductionMEA[sample + threshold] - mean0;\n"
-                "counter0 += reductionCOU[sample + threshold];\n"
-                "mean0 = ((reductionCOU[sample] * mean0) + (reductionCOU[sample + threshold] * reductionMEA[sample + threshold])) / counter0;\n"
-                "variance0 += reductionVAR[sample + threshold] + ((delta * delta) * ((reductionCOU[sample] * reductionCOU[sample + threshold]) / counter0));\n"
-                "if ( reductionMAX[sample + threshold] > max0 ) {\n"
-                    "max0 = reductionMAX[sample + threshold];\n"
-                    "maxSample0 = reductionSAM[sample + threshold];\n"
-                "}\n"
-                "reductionCOU[sample] = counter0;\n"
-                "reductionMAX[sample] = max0;\n"
-                "reductionSAM[sample] = maxSample0;\n"
-                "reductionMEA[sample] = mean0;\n"
-                "reductionVAR[sample] = variance0;\n"
-            "}\n"
-            "barrier(CLK_LOCAL_MEM_FENCE);\n"
-        "}\n"
-        "mean = reductionMEA[0];\n"
-        "sigma_threshold = (" + std::to_string(nSigma) + " * native_sqrt(reductionVAR[0] * " + std::to_string(1.0f/(nrSamples - 1)) + "f));\n"
-        "// Compute SNR with sigma cut\n"
-        "<%CLEAN%>"
-        "// Compute phase\n"
-        "for ( unsigned int sample = get_local_id(0); sample < " + std::to_string(nrSamples) + "; sample += " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + " ) {\n"
+
+    if (conf.getSubbandDedispersion())
+    {
+        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    }
+    else
+    {
+        nrDMs = observation.getNrDMs();
+    }
+    const unsigned int nrTiles = isa::utils::pad(nrDMs, conf.getNrThreadsD0() * conf.getNrItemsD0()) / (conf.getNrThreadsD0() * conf.getNrItemsD0());
+
+    *code = "__kernel void snrBeamMax_" + std::to_string(nrDMs) + "(__global const " + dataName + " * const restrict snr, __global " + dataName + " * const restrict beamSNR, __global unsigned int * const restrict beamDM, __global " + dataName + " * const restrict dmSNR, __global unsigned int * const restrict dmBeam, volatile __global " + dataName + " * const restrict partialSNR, volatile __global unsigned int * const restrict partialDM, volatile __global unsigned int * const restrict counter) {\n"
         + dataName + " item = 0;\n"
-        "<%COMPUTE_CUT%>"
-        "}\n"
-        "// In-thread reduce (optional)\n"
-        "<%REDUCE%>"
+        + dataName + " beamMax = 0;\n"
+        "unsigned int beamMaxDM = 0;\n"
+        "<%DEF%>"
+        "__local " + dataName + " reductionMAX[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "__local unsigned int reductionDM[" + std::to_string(conf.getNrThreadsD0()) + "];\n"
+        "__local unsigned int lastTile;\n"
+        "\n"
+        "// Compute phase\n"
+        "for ( unsigned int beam = 0; beam < " + std::to_string(observation.getNrSynthesizedBeams()) + "; beam++ ) {\n"
+        "beamMax = -FLT_MAX;\n"
+        "beamMaxDM = 0;\n"
+        "<%COMPUTE%>"
         "// Local memory store\n"
-        "reductionCOU[get_local_id(0)] = counter0;\n"
-        "reductionMEA[get_local_id(0)] = mean0;\n"
-        "reductionVAR[get_local_id(0)] = variance0;\n"
+        "reductionMAX[get_local_id(0)] = beamMax;\n"
+        "reductionDM[get_local_id(0)] = beamMaxDM;\n"
         "barrier(CLK_LOCAL_MEM_FENCE);\n"
         "// Reduce phase\n"
-        "threshold = " + std::to_string(conf.getNrThreadsD0() / 2) + ";\n"
-        "for ( unsigned int sample = get_local_id(0); threshold > 0; threshold /= 2 ) {\n"
-            "if ( sample < threshold ) {\n"
-                "delta = reductionMEA[sample + threshold] - mean0;\n"
-                "counter0 += reductionCOU[sample + threshold];\n"
-                "mean0 = ((reductionCOU[sample] * mean0) + (reductionCOU[sample + threshold] * reductionMEA[sample + threshold])) / counter0;\n"
-                "variance0 += reductionVAR[sample + threshold] + ((delta * delta) * ((reductionCOU[sample] * reductionCOU[sample + threshold]) / counter0));\n"
-                "reductionCOU[sample] = counter0;\n"
-                "reductionMEA[sample] = mean0;\n"
-                "reductionVAR[sample] = variance0;\n"
+        "unsigned int threshold = " + std::to_string(conf.getNrThreadsD0() / 2) + ";\n"
+        "for ( unsigned int dm = get_local_id(0); threshold > 0; threshold /= 2 ) {\n"
+            "if ( dm < threshold ) {\n"
+                "if ( (reductionMAX[dm + threshold] > beamMax) || ((reductionMAX[dm + threshold] == beamMax) && (reductionDM[dm + threshold] < beamMaxDM)) ) {\n"
+                    "beamMax = reductionMAX[dm + threshold];\n"
+                    "beamMaxDM = reductionDM[dm + threshold];\n"
+                "}\n"
+                "reductionMAX[dm] = beamMax;\n"
+                "reductionDM[dm] = beamMaxDM;\n"
             "}\n"
             "barrier(CLK_LOCAL_MEM_FENCE);\n"
         "}\n"
+        "if ( get_local_id(0) == 0 ) {\n"
+        "partialSNR[(beam * " + std::to_string(nrTiles) + ") + get_group_id(0)] = beamMax;\n"
+        "partialDM[(beam * " + std::to_string(nrTiles) + ") + get_group_id(0)] = beamMaxDM;\n"
+        "}\n"
+        "}\n"
         "// Store\n"
+        "<%STORE%>"
+        "// The last work-group to finish merges the partial maxima of every beam\n"
         "if ( get_local_id(0) == 0 ) {\n"
-        "outputSNR[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(float))) + ") + get_group_id(1)] = (max0 - mean0) / (native_sqrt(variance0 / (counter0 - 1)) * " + std::to_string(correctionFactor) + ");\n"
-        "outputSample[(get_group_id(2) * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(unsigned int))) + ") + get_group_id(1)] = maxSample0;\n"
+        "mem_fence(CLK_GLOBAL_MEM_FENCE);\n"
+        "lastTile = (atomic_inc(counter) == " + std::to_string(nrTiles - 1) + ");\n"
+        "}\n"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "if ( lastTile ) {\n"
+        "for ( unsigned int beam = get_local_id(0); beam < " + std::to_string(observation.getNrSynthesizedBeams()) + "; beam += " + std::to_string(conf.getNrThreadsD0()) + " ) {\n"
+        "beamMax = partialSNR[beam * " + std::to_string(nrTiles) + "];\n"
+        "beamMaxDM = partialDM[beam * " + std::to_string(nrTiles) + "];\n"
+        "for ( unsigned int tile = 1; tile < " + std::to_string(nrTiles) + "; tile++ ) {\n"
+        "if ( partialSNR[(beam * " + std::to_string(nrTiles) + ") + tile] > beamMax ) {\n"
+        "beamMax = partialSNR[(beam * " + std::to_string(nrTiles) + ") + tile];\n"
+        "beamMaxDM = partialDM[(beam * " + std::to_string(nrTiles) + ") + tile];\n"
+        "}\n"
+        "}\n"
+        "beamSNR[beam] = beamMax;\n"
+        "beamDM[beam] = beamMaxDM;\n"
+        "}\n"
+        "if ( get_local_id(0) == 0 ) {\n"
+        "*counter = 0;\n"
+        "}\n"
         "}\n"
         "}\n";
-    std::string def_sTemplate = dataName + " max<%NUM%> = input[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (get_local_id(0) + <%OFFSET%>)];\n"
-        "unsigned int maxSample<%NUM%> = get_local_id(0) + <%OFFSET%>;\n"
-        "float counter<%NUM%> = 1.0f;\n"
-        "float variance<%NUM%> = 0.0f;\n"
-        "float mean<%NUM%> = max<%NUM%>;\n";
-    std::string clean_sTemplate = "counter<%NUM%> = 0.0f;\n"
-        "variance<%NUM%> = 0.0f;\n"
-        "mean<%NUM%> = 0.0f;\n";
+    std::string def_sTemplate = "const unsigned int dm<%NUM%> = (get_group_id(0) * " + std::to_string(conf.getNrThreadsD0() * conf.getNrItemsD0()) + ") + get_local_id(0) + <%OFFSET%>;\n"
+        + dataName + " dmMax<%NUM%> = -FLT_MAX;\n"
+        "unsigned int dmMaxBeam<%NUM%> = 0;\n";
     std::string compute_sTemplate;
-    if ((nrSamples % (conf.getNrThreadsD0() * conf.getNrItemsD0())) != 0)
+    if ((nrDMs % (conf.getNrThreadsD0() * conf.getNrItemsD0())) != 0)
     {
-        compute_sTemplate += "if ( (sample + <%OFFSET%>) < " + std::to_string(nrSamples) + " ) {\n";
+        compute_sTemplate += "if ( dm<%NUM%> < " + std::to_string(nrDMs) + " ) {\n";
     }
-    compute_sTemplate += "item = input[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (sample + <%OFFSET%>)];\n"
-        "counter<%NUM%> += 1.0f;\n"
-        "delta = item - mean<%NUM%>;\n"
-        "mean<%NUM%> += delta / counter<%NUM%>;\n"
-        "variance<%NUM%> += delta * (item - mean<%NUM%>);\n"
-        "if ( item > max<%NUM%> ) {\n"
-        "max<%NUM%> = item;\n"
-        "maxSample<%NUM%> = sample + <%OFFSET%>;\n"
+    compute_sTemplate += "item = snr[(beam * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(T))) + ") + dm<%NUM%>];\n"
+        "if ( item > dmMax<%NUM%> ) {\n"
+        "dmMax<%NUM%> = item;\n"
+        "dmMaxBeam<%NUM%> = beam;\n"
+        "}\n"
+        "if ( item > beamMax ) {\n"
+        "beamMax = item;\n"
+        "beamMaxDM = dm<%NUM%>;\n"
         "}\n";
-    if ((nrSamples % (conf.getNrThreadsD0() * conf.getNrItemsD0())) != 0)
+    if ((nrDMs % (conf.getNrThreadsD0() * conf.getNrItemsD0())) != 0)
     {
         compute_sTemplate += "}\n";
     }
-    std::string computeCut_sTemplate;
-    if ((nrSamples % (conf.getNrThreadsD0() * conf.getNrItemsD0())) != 0)
+    std::string store_sTemplate;
+    if ((nrDMs % (conf.getNrThreadsD0() * conf.getNrItemsD0())) != 0)
     {
-        computeCut_sTemplate += "if ( (sample + <%OFFSET%>) < " + std::to_string(nrSamples) + " ) {\n";
+        store_sTemplate += "if ( dm<%NUM%> < " + std::to_string(nrDMs) + " ) {\n";
     }
-    computeCut_sTemplate += "item = input[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (get_group_id(1) * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(T))) + ") + (sample + <%OFFSET%>)];\n"
-        "if ( fabs(item - mean) < sigma_threshold ) {\n"
-        "counter<%NUM%> += 1.0f;\n"
-        "delta = item - mean<%NUM%>;\n"
-        "mean<%NUM%> += delta / counter<%NUM%>;\n"
-        "variance<%NUM%> += delta * (item - mean<%NUM%>);\n"
-        "}\n";
-    if ((nrSamples % (conf.getNrThreadsD0() * conf.getNrItemsD0())) != 0)
+    store_sTemplate += "dmSNR[dm<%NUM%>] = dmMax<%NUM%>;\n"
+        "dmBeam[dm<%NUM%>] = dmMaxBeam<%NUM%>;\n";
+    if ((nrDMs % (conf.getNrThreadsD0() * conf.getNrItemsD0())) != 0)
     {
-        computeCut_sTemplate += "}\n";
+        store_sTemplate += "}\n";
     }
-    std::string reduce_sTemplate = "delta = mean<%NUM%> - mean0;\n"
-        "counter0 += counter<%NUM%>;\n"
-        "mean0 = (((counter0 - counter<%NUM%>) * mean0) + (counter<%NUM%> * mean<%NUM%>)) / counter0;\n"
-        "variance0 += variance<%NUM%> + ((delta * delta) * (((counter0 - counter<%NUM%>) * counter<%NUM%>) / counter0));\n"
-        "if ( max<%NUM%> > max0 ) {\n"
-        "max0 = max<%NUM%>;\n"
-        "maxSample0 = maxSample<%NUM%>;\n"
-        "}\n";
 
-    std::string * def_s = new std::string();
-    std::string * compute_s = new std::string();
-    std::string * clean_s = new std::string();
-    std::string * computeCut_s = new std::string();
-    std::string * reduce_s = new std::string();
+    std::string *def_s = new std::string();
+    std::string *compute_s = new std::string();
+    std::string *store_s = new std::string();
 
-    for (unsigned int sample = 0; sample < conf.getNrItemsD0(); sample++)
+    for (unsigned int dm = 0; dm < conf.getNrItemsD0(); dm++)
     {
-        std::string sample_s = std::to_string(sample);
-        std::string offset_s = std::to_string(conf.getNrThreadsD0() * sample);
-        std::string * temp = nullptr;
+        std::string dm_s = std::to_string(dm);
+        std::string offset_s = std::to_string(conf.getNrThreadsD0() * dm);
+        std::string *temp = 0;
 
-        temp = isa::utils::replace(&def_sTemplate, "<%NUM%>", sample_s);
-        if (sample == 0)
+        temp = isa::utils::replace(&def_sTemplate, "<%NUM%>", dm_s);
+        if (dm == 0)
         {
             std::string empty_s("");
             temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
@@ -1301,92 +5978,215 @@ std::string *getSNRSigmaCutDMsSamplesOpenCL(const snrConf &conf, const std::stri
         }
         def_s->append(*temp);
         delete temp;
-        temp = isa::utils::replace(&clean_sTemplate, "<%NUM%>", sample_s);
-        if (sample == 0)
+        temp = isa::utils::replace(&compute_sTemplate, "<%NUM%>", dm_s);
+        compute_s->append(*temp);
+        delete temp;
+        temp = isa::utils::replace(&store_sTemplate, "<%NUM%>", dm_s);
+        store_s->append(*temp);
+        delete temp;
+    }
+
+    code = isa::utils::replace(code, "<%DEF%>", *def_s, true);
+    code = isa::utils::replace(code, "<%COMPUTE%>", *compute_s, true);
+    code = isa::utils::replace(code, "<%STORE%>", *store_s, true);
+    delete def_s;
+    delete compute_s;
+    delete store_s;
+
+    return code;
+}
+
+template <typename DataType>
+std::string *getTransposeOpenCL(const snrConf &conf, const DataOrdering ordering, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding)
+{
+    std::string *code = 0;
+
+    if (ordering == DataOrdering::DMsSamples)
+    {
+        code = getTransposeDMsSamplesOpenCL<DataType>(conf, dataName, observation, downsampling, padding);
+    }
+    else if (ordering == DataOrdering::SamplesDMs)
+    {
+        code = getTransposeSamplesDMsOpenCL<DataType>(conf, dataName, observation, downsampling, padding);
+    }
+    return code;
+}
+
+template <typename DataType>
+std::string *getTransposeDMsSamplesOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding)
+{
+    std::string *code = new std::string();
+    unsigned int nrSamples = 0;
+    unsigned int nrDMs = 0;
+
+    if (conf.getSubbandDedispersion())
+    {
+        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    }
+    else
+    {
+        nrDMs = observation.getNrDMs();
+    }
+    nrSamples = observation.getNrSamplesPerBatch() / downsampling;
+    // Generate source code
+    *code = "__kernel void transpose_DMsSamples_" + std::to_string(nrSamples) + "(__global const " + dataName + " * const restrict input_data, __global " + dataName + " * const restrict output_data) {\n"
+        "unsigned int dm = 0;\n"
+        "unsigned int sample = 0;\n"
+        "__local " + dataName + " tile[" + std::to_string(conf.getNrThreadsD0() * (conf.getNrThreadsD0() + 1)) + "];\n"
+        "\n"
+        "// Load the tile\n"
+        "<%LOAD%>"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "// Store the transposed tile\n"
+        "<%STORE%>"
+        "}\n";
+    std::string loadTemplate = "dm = (get_group_id(1) * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(1) + <%ITEM_OFFSET%>;\n"
+        "sample = (get_group_id(0) * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(0);\n"
+        "if ( (dm < " + std::to_string(nrDMs) + ") && (sample < " + std::to_string(nrSamples) + ") ) {\n"
+        "tile[((get_local_id(1) + <%ITEM_OFFSET%>) * " + std::to_string(conf.getNrThreadsD0() + 1) + ") + get_local_id(0)] = input_data[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (dm * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + sample];\n"
+        "}\n";
+    std::string storeTemplate = "sample = (get_group_id(0) * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(1) + <%ITEM_OFFSET%>;\n"
+        "dm = (get_group_id(1) * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(0);\n"
+        "if ( (sample < " + std::to_string(nrSamples) + ") && (dm < " + std::to_string(nrDMs) + ") ) {\n"
+        "output_data[(get_group_id(2) * " + std::to_string(nrSamples * isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + (sample * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + dm] = tile[(get_local_id(0) * " + std::to_string(conf.getNrThreadsD0() + 1) + ") + get_local_id(1) + <%ITEM_OFFSET%>];\n"
+        "}\n";
+    std::string load;
+    std::string store;
+    for (unsigned int item = 0; item < conf.getNrItemsD1(); item++)
+    {
+        std::string *temp;
+        std::string itemOffsetString = std::to_string(item * conf.getNrThreadsD1());
+        if (item == 0)
         {
-            std::string empty_s("");
-            temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
+            temp = isa::utils::replace(&loadTemplate, " + <%ITEM_OFFSET%>", std::string());
         }
         else
         {
-            temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
+            temp = isa::utils::replace(&loadTemplate, "<%ITEM_OFFSET%>", itemOffsetString);
         }
-        clean_s->append(*temp);
+        load.append(*temp);
         delete temp;
-        temp = isa::utils::replace(&compute_sTemplate, "<%NUM%>", sample_s);
-        if (sample == 0)
+        if (item == 0)
         {
-            std::string empty_s("");
-            temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
+            temp = isa::utils::replace(&storeTemplate, " + <%ITEM_OFFSET%>", std::string());
         }
         else
         {
-            temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
+            temp = isa::utils::replace(&storeTemplate, "<%ITEM_OFFSET%>", itemOffsetString);
         }
-        compute_s->append(*temp);
+        store.append(*temp);
         delete temp;
-        temp = isa::utils::replace(&computeCut_sTemplate, "<%NUM%>", sample_s);
-        if (sample == 0)
+    }
+    code = isa::utils::replace(code, "<%LOAD%>", load, true);
+    code = isa::utils::replace(code, "<%STORE%>", store, true);
+    return code;
+}
+
+template <typename DataType>
+std::string *getTransposeSamplesDMsOpenCL(const snrConf &conf, const std::string &dataName, const AstroData::Observation &observation, const unsigned int downsampling, const unsigned int padding)
+{
+    std::string *code = new std::string();
+    unsigned int nrSamples = 0;
+    unsigned int nrDMs = 0;
+
+    if (conf.getSubbandDedispersion())
+    {
+        nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    }
+    else
+    {
+        nrDMs = observation.getNrDMs();
+    }
+    nrSamples = observation.getNrSamplesPerBatch() / downsampling;
+    // Generate source code
+    *code = "__kernel void transpose_SamplesDMs_" + std::to_string(nrDMs) + "(__global const " + dataName + " * const restrict input_data, __global " + dataName + " * const restrict output_data) {\n"
+        "unsigned int dm = 0;\n"
+        "unsigned int sample = 0;\n"
+        "__local " + dataName + " tile[" + std::to_string(conf.getNrThreadsD0() * (conf.getNrThreadsD0() + 1)) + "];\n"
+        "\n"
+        "// Load the tile\n"
+        "<%LOAD%>"
+        "barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "// Store the transposed tile\n"
+        "<%STORE%>"
+        "}\n";
+    std::string loadTemplate = "sample = (get_group_id(1) * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(1) + <%ITEM_OFFSET%>;\n"
+        "dm = (get_group_id(0) * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(0);\n"
+        "if ( (sample < " + std::to_string(nrSamples) + ") && (dm < " + std::to_string(nrDMs) + ") ) {\n"
+        "tile[((get_local_id(1) + <%ITEM_OFFSET%>) * " + std::to_string(conf.getNrThreadsD0() + 1) + ") + get_local_id(0)] = input_data[(get_group_id(2) * " + std::to_string(nrSamples * isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + (sample * " + std::to_string(isa::utils::pad(nrDMs, padding / sizeof(DataType))) + ") + dm];\n"
+        "}\n";
+    std::string storeTemplate = "dm = (get_group_id(0) * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(1) + <%ITEM_OFFSET%>;\n"
+        "sample = (get_group_id(1) * " + std::to_string(conf.getNrThreadsD0()) + ") + get_local_id(0);\n"
+        "if ( (dm < " + std::to_string(nrDMs) + ") && (sample < " + std::to_string(nrSamples) + ") ) {\n"
+        "output_data[(get_group_id(2) * " + std::to_string(nrDMs * isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + (dm * " + std::to_string(isa::utils::pad(nrSamples, padding / sizeof(DataType))) + ") + sample] = tile[(get_local_id(0) * " + std::to_string(conf.getNrThreadsD0() + 1) + ") + get_local_id(1) + <%ITEM_OFFSET%>];\n"
+        "}\n";
+    std::string load;
+    std::string store;
+    for (unsigned int item = 0; item < conf.getNrItemsD1(); item++)
+    {
+        std::string *temp;
+        std::string itemOffsetString = std::to_string(item * conf.getNrThreadsD1());
+        if (item == 0)
         {
-            std::string empty_s("");
-            temp = isa::utils::replace(temp, " + <%OFFSET%>", empty_s, true);
+            temp = isa::utils::replace(&loadTemplate, " + <%ITEM_OFFSET%>", std::string());
         }
         else
         {
-            temp = isa::utils::replace(temp, "<%OFFSET%>", offset_s, true);
+            temp = isa::utils::replace(&loadTemplate, "<%ITEM_OFFSET%>", itemOffsetString);
         }
-        computeCut_s->append(*temp);
+        load.append(*temp);
         delete temp;
-        if (sample == 0)
+        if (item == 0)
         {
-            continue;
+            temp = isa::utils::replace(&storeTemplate, " + <%ITEM_OFFSET%>", std::string());
         }
-        temp = isa::utils::replace(&reduce_sTemplate, "<%NUM%>", sample_s);
-        reduce_s->append(*temp);
+        else
+        {
+            temp = isa::utils::replace(&storeTemplate, "<%ITEM_OFFSET%>", itemOffsetString);
+        }
+        store.append(*temp);
         delete temp;
     }
-
-    code = isa::utils::replace(code, "<%DEF%>", *def_s, true);
-    code = isa::utils::replace(code, "<%COMPUTE%>", *compute_s, true);
-    code = isa::utils::replace(code, "<%CLEAN%>", *clean_s, true);
-    code = isa::utils::replace(code, "<%COMPUTE_CUT%>", *computeCut_s, true);
-    code = isa::utils::replace(code, "<%REDUCE%>", *reduce_s, true);
-    delete def_s;
-    delete compute_s;
-    delete clean_s;
-    delete reduce_s;
-
+    code = isa::utils::replace(code, "<%LOAD%>", load, true);
+    code = isa::utils::replace(code, "<%STORE%>", store, true);
     return code;
 }
 
-template<typename NumericType>
-void snrSigmaCut(const std::vector<NumericType> & timeSeries, std::vector<NumericType> & snr, const AstroData::Observation & observation, const unsigned int padding, const float nSigma, const float correctionFactor)
+template <typename DataType>
+void transpose(const std::vector<DataType> &input, std::vector<DataType> &output, const DataOrdering ordering, const unsigned int nrBeams, const unsigned int nrDMs, const unsigned int nrSamples, const unsigned int padding)
 {
-    for ( unsigned int sBeam = 0; sBeam < observation.getNrSynthesizedBeams(); sBeam++ )
+    // Blocks are small enough that both the rows read and the rows written stay in cache
+    const unsigned int blockSize = 32;
+    unsigned int nrRows = 0;
+    unsigned int nrColumns = 0;
+
+    if (ordering == DataOrdering::DMsSamples)
     {
-        for ( unsigned int subbandingDM = 0; subbandingDM < observation.getNrDMs(true); subbandingDM++ )
+        nrRows = nrDMs;
+        nrColumns = nrSamples;
+    }
+    else
+    {
+        nrRows = nrSamples;
+        nrColumns = nrDMs;
+    }
+    const unsigned int inputStride = isa::utils::pad(nrColumns, padding / sizeof(DataType));
+    const unsigned int outputStride = isa::utils::pad(nrRows, padding / sizeof(DataType));
+    output.resize(nrBeams * nrColumns * outputStride);
+#pragma omp parallel for collapse(2) schedule(static)
+    for (unsigned int beam = 0; beam < nrBeams; beam++)
+    {
+        for (unsigned int rowBlock = 0; rowBlock < nrRows; rowBlock += blockSize)
         {
-            for ( unsigned int DM = 0; DM < observation.getNrDMs(); DM++ )
+            for (unsigned int columnBlock = 0; columnBlock < nrColumns; columnBlock += blockSize)
             {
-                // Phase one, compute statistics to determine sigma cut
-                isa::utils::Statistics<float> statistics;
-                for ( unsigned int sample = 0; sample < observation.getNrSamplesPerBatch(); sample++ )
-                {
-                    statistics.addElement(timeSeries.at((sBeam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(NumericType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(NumericType))) + (DM * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(NumericType))) + sample));
-                }
-                // Phase two, compute SNR excluding outliers
-                isa::utils::Statistics<float> cleanStatistics;
-                for ( unsigned int sample = 0; sample < observation.getNrSamplesPerBatch(); sample++ )
+                for (unsigned int row = rowBlock; row < std::min(rowBlock + blockSize, nrRows); row++)
                 {
-                    NumericType value = timeSeries.at((sBeam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(NumericType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(NumericType))) + (DM * isa::utils::pad(observation.getNrSamplesPerBatch() / observation.getDownsampling(), padding / sizeof(NumericType))) + sample);
-
-                    if ( std::fabs(value - statistics.getMean()) < (nSigma * statistics.getStandardDeviation()) )
+                    for (unsigned int column = columnBlock; column < std::min(columnBlock + blockSize, nrColumns); column++)
                     {
-                        cleanStatistics.addElement(value);
+                        output[(beam * nrColumns * outputStride) + (column * outputStride) + row] = input[(beam * nrRows * inputStride) + (row * inputStride) + column];
                     }
                 }
-                // Store results
-                snr.at((sBeam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float))) + (subbandingDM * observation.getNrDMs()) + DM) = (statistics.getMax() - cleanStatistics.getMean()) / (cleanStatistics.getStandardDeviation() * correctionFactor);
             }
         }
     }
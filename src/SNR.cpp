@@ -18,13 +18,60 @@
 namespace SNR
 {
 
-snrConf::snrConf() : KernelConf(), subbandDedispersion(false) {}
+snrConf::snrConf() : KernelConf(), subbandDedispersion(false), subgroupReduction(false), vectorWidth(1), nrWorkGroups(0), medianStrategy(MedianStrategy::OddEvenSort) {}
 
 snrConf::~snrConf() {}
 
 std::string snrConf::print() const
 {
-    return std::to_string(subbandDedispersion) + " " + isa::OpenCL::KernelConf::print();
+    return std::to_string(subbandDedispersion) + " " + std::to_string(subgroupReduction) + " " + std::to_string(vectorWidth) + " " + std::to_string(nrWorkGroups) + " " + std::to_string(medianStrategy) + " " + isa::OpenCL::KernelConf::print();
+}
+
+std::vector<std::pair<unsigned int, unsigned int>> getMedianSortingNetwork(const unsigned int stepSize)
+{
+    unsigned int nrElements = 1;
+    std::vector<std::pair<unsigned int, unsigned int>> network;
+    std::vector<std::pair<unsigned int, unsigned int>> medianNetwork;
+    std::vector<bool> needed(stepSize, false);
+
+    if (stepSize == 0)
+    {
+        throw std::invalid_argument("The step of the median sorting network must be larger than zero.");
+    }
+    while (nrElements < stepSize)
+    {
+        nrElements *= 2;
+    }
+    // Batcher's odd-even merge sort; comparators touching the elements past stepSize are dropped, as if those elements were larger than any other
+    for (unsigned int p = 1; p < nrElements; p *= 2)
+    {
+        for (unsigned int k = p; k >= 1; k /= 2)
+        {
+            for (unsigned int j = k % p; (j + k) < nrElements; j += 2 * k)
+            {
+                for (unsigned int i = 0; i < k; i++)
+                {
+                    if ((((i + j) / (2 * p)) == ((i + j + k) / (2 * p))) && ((i + j + k) < stepSize))
+                    {
+                        network.push_back(std::make_pair(i + j, i + j + k));
+                    }
+                }
+            }
+        }
+    }
+    // Only the comparators that can move an element towards the median are kept
+    needed.at(stepSize / 2) = true;
+    for (auto comparator = network.rbegin(); comparator != network.rend(); ++comparator)
+    {
+        if (needed.at(comparator->first) || needed.at(comparator->second))
+        {
+            needed.at(comparator->first) = true;
+            needed.at(comparator->second) = true;
+            medianNetwork.push_back(*comparator);
+        }
+    }
+    std::reverse(medianNetwork.begin(), medianNetwork.end());
+    return medianNetwork;
 }
 
 void readTunedSNRConf(tunedSNRConf &tunedSNR, const std::string &snrFilename)
@@ -65,6 +112,18 @@ void readTunedSNRConf(tunedSNRConf &tunedSNR, const std::string &snrFilename)
         parameters->setSubbandDedispersion(isa::utils::castToType<std::string, bool>(temp.substr(0, splitPoint)));
         temp = temp.substr(splitPoint + 1);
         splitPoint = temp.find(" ");
+        parameters->setSubgroupReduction(isa::utils::castToType<std::string, bool>(temp.substr(0, splitPoint)));
+        temp = temp.substr(splitPoint + 1);
+        splitPoint = temp.find(" ");
+        parameters->setVectorWidth(isa::utils::castToType<std::string, unsigned int>(temp.substr(0, splitPoint)));
+        temp = temp.substr(splitPoint + 1);
+        splitPoint = temp.find(" ");
+        parameters->setNrWorkGroups(isa::utils::castToType<std::string, unsigned int>(temp.substr(0, splitPoint)));
+        temp = temp.substr(splitPoint + 1);
+        splitPoint = temp.find(" ");
+        parameters->setMedianStrategy(static_cast<SNR::MedianStrategy>(isa::utils::castToType<std::string, unsigned int>(temp.substr(0, splitPoint))));
+        temp = temp.substr(splitPoint + 1);
+        splitPoint = temp.find(" ");
         parameters->setNrThreadsD0(isa::utils::castToType<std::string, unsigned int>(temp.substr(0, splitPoint)));
         temp = temp.substr(splitPoint + 1);
         splitPoint = temp.find(" ");
@@ -105,4 +164,196 @@ void readTunedSNRConf(tunedSNRConf &tunedSNR, const std::string &snrFilename)
     snrFile.close();
 }
 
+void selectCandidates(const std::vector<float> &outputSNR, const std::vector<unsigned int> &outputSample, const std::vector<unsigned int> &outputWidth, std::vector<Candidate> &candidates, const AstroData::Observation &observation, const float threshold, const unsigned int padding)
+{
+    const unsigned int nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    const unsigned int nrDMsPadded = isa::utils::pad(nrDMs, padding / sizeof(float));
+
+    candidates.clear();
+    for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+    {
+        for (unsigned int dm = 0; dm < nrDMs; dm++)
+        {
+            if (outputSNR[(beam * nrDMsPadded) + dm] >= threshold)
+            {
+                Candidate candidate;
+
+                candidate.beam = beam;
+                candidate.dm = dm;
+                candidate.sample = outputSample[(beam * nrDMsPadded) + dm];
+                candidate.width = outputWidth.empty() ? 1 : outputWidth[(beam * nrDMsPadded) + dm];
+                candidate.snr = outputSNR[(beam * nrDMsPadded) + dm];
+                candidate.nrMembers = 1;
+                candidates.push_back(candidate);
+            }
+        }
+    }
+}
+
+void selectCandidates(const std::vector<float> &candidateSNR, const std::vector<unsigned int> &candidateIndices, std::vector<Candidate> &candidates)
+{
+    candidates.resize(candidateSNR.size());
+    for (unsigned int candidate = 0; candidate < candidateSNR.size(); candidate++)
+    {
+        candidates[candidate].beam = candidateIndices[(candidate * 3)];
+        candidates[candidate].dm = candidateIndices[(candidate * 3) + 1];
+        candidates[candidate].sample = candidateIndices[(candidate * 3) + 2];
+        candidates[candidate].width = 1;
+        candidates[candidate].snr = candidateSNR[candidate];
+        candidates[candidate].nrMembers = 1;
+    }
+}
+
+/**
+ ** @brief Find the root of a cluster in the union-find forest, halving the path on the way.
+ */
+static unsigned int findCluster(std::vector<unsigned int> &parent, unsigned int member)
+{
+    while (parent[member] != member)
+    {
+        parent[member] = parent[parent[member]];
+        member = parent[member];
+    }
+    return member;
+}
+
+void clusterCandidates(const std::vector<Candidate> &candidates, std::vector<Candidate> &clusters, const AstroData::Observation &observation, const unsigned int dmDistance, const unsigned int sampleDistance, const unsigned int widthDistance)
+{
+    const unsigned int nrBeams = observation.getNrSynthesizedBeams();
+    std::vector<std::vector<unsigned int>> beamCandidates(nrBeams);
+    std::vector<std::vector<Candidate>> beamClusters(nrBeams);
+
+    for (unsigned int candidate = 0; candidate < candidates.size(); candidate++)
+    {
+        if (candidates[candidate].beam >= nrBeams)
+        {
+            throw std::out_of_range("Candidate " + std::to_string(candidate) + " belongs to beam " + std::to_string(candidates[candidate].beam) + ", but the observation has " + std::to_string(nrBeams) + " beams.");
+        }
+        beamCandidates[candidates[candidate].beam].push_back(candidate);
+    }
+#pragma omp parallel for schedule(dynamic)
+    for (unsigned int beam = 0; beam < nrBeams; beam++)
+    {
+        const std::vector<unsigned int> &members = beamCandidates[beam];
+        std::vector<unsigned int> parent(members.size());
+        std::vector<unsigned int> clusterIndex(members.size(), std::numeric_limits<unsigned int>::max());
+        std::unordered_map<uint64_t, std::vector<unsigned int>> grid;
+
+        // Friends are at most one cell apart, because cells are one unit larger than the distances
+        grid.reserve(members.size());
+        for (unsigned int member = 0; member < members.size(); member++)
+        {
+            const Candidate &candidate = candidates[members[member]];
+            const uint64_t dmCell = candidate.dm / (static_cast<uint64_t>(dmDistance) + 1);
+            const uint64_t sampleCell = candidate.sample / (static_cast<uint64_t>(sampleDistance) + 1);
+
+            parent[member] = member;
+            grid[(dmCell << 32) | sampleCell].push_back(member);
+        }
+        for (unsigned int member = 0; member < members.size(); member++)
+        {
+            const Candidate &candidate = candidates[members[member]];
+            const uint64_t dmCell = candidate.dm / (static_cast<uint64_t>(dmDistance) + 1);
+            const uint64_t sampleCell = candidate.sample / (static_cast<uint64_t>(sampleDistance) + 1);
+
+            for (uint64_t neighbourDM = (dmCell > 0 ? dmCell - 1 : 0); neighbourDM <= dmCell + 1; neighbourDM++)
+            {
+                for (uint64_t neighbourSample = (sampleCell > 0 ? sampleCell - 1 : 0); neighbourSample <= sampleCell + 1; neighbourSample++)
+                {
+                    auto cell = grid.find((neighbourDM << 32) | neighbourSample);
+
+                    if (cell == grid.end())
+                    {
+                        continue;
+                    }
+                    for (auto other : cell->second)
+                    {
+                        const Candidate &friendCandidate = candidates[members[other]];
+
+                        if (other <= member)
+                        {
+                            continue;
+                        }
+                        if ((std::max(candidate.dm, friendCandidate.dm) - std::min(candidate.dm, friendCandidate.dm) <= dmDistance) && (std::max(candidate.sample, friendCandidate.sample) - std::min(candidate.sample, friendCandidate.sample) <= sampleDistance) && (std::max(candidate.width, friendCandidate.width) - std::min(candidate.width, friendCandidate.width) <= widthDistance))
+                        {
+                            unsigned int memberRoot = findCluster(parent, member);
+                            unsigned int otherRoot = findCluster(parent, other);
+
+                            if (memberRoot < otherRoot)
+                            {
+                                parent[otherRoot] = memberRoot;
+                            }
+                            else if (otherRoot < memberRoot)
+                            {
+                                parent[memberRoot] = otherRoot;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        // Every cluster is represented by its brightest member
+        for (unsigned int member = 0; member < members.size(); member++)
+        {
+            const Candidate &candidate = candidates[members[member]];
+            unsigned int root = findCluster(parent, member);
+
+            if (clusterIndex[root] == std::numeric_limits<unsigned int>::max())
+            {
+                clusterIndex[root] = beamClusters[beam].size();
+                beamClusters[beam].push_back(candidate);
+                beamClusters[beam].back().nrMembers = 0;
+            }
+            Candidate &cluster = beamClusters[beam][clusterIndex[root]];
+            unsigned int nrMembers = cluster.nrMembers;
+
+            if (candidate.snr > cluster.snr)
+            {
+                cluster = candidate;
+            }
+            cluster.nrMembers = nrMembers + candidate.nrMembers;
+        }
+    }
+    clusters.clear();
+    for (unsigned int beam = 0; beam < nrBeams; beam++)
+    {
+        clusters.insert(clusters.end(), beamClusters[beam].begin(), beamClusters[beam].end());
+    }
+}
+
+void snrBeamMaxCPU(const std::vector<float> &snr, std::vector<float> &beamSNR, std::vector<unsigned int> &beamDM, std::vector<float> &dmSNR, std::vector<unsigned int> &dmBeam, const AstroData::Observation &observation, const unsigned int padding)
+{
+    const unsigned int nrDMs = observation.getNrDMs(true) * observation.getNrDMs();
+    const unsigned int nrDMsPadded = isa::utils::pad(nrDMs, padding / sizeof(float));
+
+#pragma omp parallel for schedule(static)
+    for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+    {
+        beamSNR[beam] = snr[beam * nrDMsPadded];
+        beamDM[beam] = 0;
+        for (unsigned int dm = 1; dm < nrDMs; dm++)
+        {
+            if (snr[(beam * nrDMsPadded) + dm] > beamSNR[beam])
+            {
+                beamSNR[beam] = snr[(beam * nrDMsPadded) + dm];
+                beamDM[beam] = dm;
+            }
+        }
+    }
+#pragma omp parallel for schedule(static)
+    for (unsigned int dm = 0; dm < nrDMs; dm++)
+    {
+        dmSNR[dm] = snr[dm];
+        dmBeam[dm] = 0;
+        for (unsigned int beam = 1; beam < observation.getNrSynthesizedBeams(); beam++)
+        {
+            if (snr[(beam * nrDMsPadded) + dm] > dmSNR[dm])
+            {
+                dmSNR[dm] = snr[(beam * nrDMsPadded) + dm];
+                dmBeam[dm] = beam;
+            }
+        }
+    }
+}
+
 } // SNR
@@ -21,6 +21,11 @@
 #include <iomanip>
 #include <limits>
 #include <ctime>
+#include <algorithm>
+#include <functional>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include <configuration.hpp>
 
@@ -32,26 +37,33 @@
 #include <SNR.hpp>
 #include <Statistics.hpp>
 
-int test(const bool printResults, const bool printCode, const unsigned int clPlatformID, const unsigned int clDeviceID, const SNR::DataOrdering ordering, const SNR::Kernel kernelUnderTest, const unsigned int padding, const AstroData::Observation &observation, const SNR::snrConf &conf, const unsigned int medianStep = 0, const float nSigma = 3.0f);
+int test(const bool printResults, const bool printCode, const bool cpuEngine, const unsigned int clPlatformID, const unsigned int clDeviceID, const SNR::DataOrdering ordering, const SNR::Kernel kernelUnderTest, const unsigned int padding, const AstroData::Observation &observation, const SNR::snrConf &conf, const SNR::KernelOptions &options);
+int testClustering();
+template <typename DataType>
+void transposeToDMsSamples(std::vector<DataType> &data, const unsigned int nrBeams, const unsigned int nrDMs, const unsigned int nrSamples, const unsigned int padding);
 
 int main(int argc, char *argv[])
 {
     bool printCode = false;
     bool printResults = false;
+    bool cpuEngine = false;
     int returnCode = 0;
     unsigned int padding = 0;
     unsigned int clPlatformID = 0;
     unsigned int clDeviceID = 0;
-    unsigned int stepSize = 0;
-    float nSigma;
     SNR::Kernel kernel;
     SNR::DataOrdering ordering;
     AstroData::Observation observation;
     SNR::snrConf conf;
+    SNR::KernelOptions options;
 
     try
     {
         isa::utils::ArgumentList args(argc, argv);
+        if (args.getSwitch("-cluster"))
+        {
+            return testClustering();
+        }
         if (args.getSwitch("-snr"))
         {
             kernel = SNR::Kernel::SNR;
@@ -80,8 +92,49 @@ int main(int argc, char *argv[])
         {
             kernel = SNR::Kernel::AbsoluteDeviation;
         }
-        else{
-            std::cerr << "One switch between -snr -snr_sc -max -max_std -median -momad and -absolute_deviation is required." << std::endl;
+        else if (args.getSwitch("-transpose"))
+        {
+            kernel = SNR::Kernel::Transpose;
+        }
+        else if (args.getSwitch("-snr_momad"))
+        {
+            kernel = SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation;
+        }
+        else if (args.getSwitch("-boxcar"))
+        {
+            kernel = SNR::Kernel::SNRBoxcar;
+        }
+        else if (args.getSwitch("-snr_downsampling"))
+        {
+            kernel = SNR::Kernel::SNRDownsampling;
+        }
+        else if (args.getSwitch("-snr_topk"))
+        {
+            kernel = SNR::Kernel::SNRTopK;
+        }
+        else if (args.getSwitch("-snr_candidates"))
+        {
+            kernel = SNR::Kernel::SNRCandidates;
+        }
+        else if (args.getSwitch("-snr_beam_max"))
+        {
+            kernel = SNR::Kernel::SNRBeamMax;
+        }
+        else if (args.getSwitch("-median_two_level"))
+        {
+            kernel = SNR::Kernel::MedianOfMediansTwoLevel;
+        }
+        else if (args.getSwitch("-streaming_mad"))
+        {
+            kernel = SNR::Kernel::StreamingMedianAbsoluteDeviation;
+        }
+        else if (args.getSwitch("-snr_running"))
+        {
+            kernel = SNR::Kernel::SNRRunningStatistics;
+        }
+        else
+        {
+            std::cerr << "One switch between -cluster -snr -snr_sc -max -max_std -median -momad -absolute_deviation -transpose -snr_momad -boxcar -snr_downsampling -snr_topk -snr_candidates -snr_beam_max -median_two_level -streaming_mad and -snr_running is required." << std::endl;
             return 1;
         }
         if (args.getSwitch("-dms_samples"))
@@ -97,23 +150,151 @@ int main(int argc, char *argv[])
             std::cerr << "One switch between -dms_samples and -samples_dms is required." << std::endl;
             return 1;
         }
+        if ((kernel == SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation) && (ordering != SNR::DataOrdering::DMsSamples))
+        {
+            std::cerr << "The -snr_momad kernel is only available for -dms_samples." << std::endl;
+            return 1;
+        }
+        if ((kernel == SNR::Kernel::MedianOfMediansTwoLevel) && (ordering != SNR::DataOrdering::DMsSamples))
+        {
+            std::cerr << "The -median_two_level kernel is only available for -dms_samples." << std::endl;
+            return 1;
+        }
+        if ((kernel == SNR::Kernel::StreamingMedianAbsoluteDeviation) && (ordering != SNR::DataOrdering::DMsSamples))
+        {
+            std::cerr << "The -streaming_mad kernel is only available for -dms_samples." << std::endl;
+            return 1;
+        }
+        if ((kernel == SNR::Kernel::SNRRunningStatistics) && (ordering != SNR::DataOrdering::DMsSamples))
+        {
+            std::cerr << "The -snr_running kernel is only available for -dms_samples." << std::endl;
+            return 1;
+        }
+        if ((kernel == SNR::Kernel::SNRBoxcar) && (ordering != SNR::DataOrdering::DMsSamples))
+        {
+            std::cerr << "The -boxcar kernel is only available for -dms_samples." << std::endl;
+            return 1;
+        }
+        if ((kernel == SNR::Kernel::SNRDownsampling) && (ordering != SNR::DataOrdering::DMsSamples))
+        {
+            std::cerr << "The -snr_downsampling kernel is only available for -dms_samples." << std::endl;
+            return 1;
+        }
+        if ((kernel == SNR::Kernel::SNRTopK) && (ordering != SNR::DataOrdering::DMsSamples))
+        {
+            std::cerr << "The -snr_topk kernel is only available for -dms_samples." << std::endl;
+            return 1;
+        }
+        if ((kernel == SNR::Kernel::SNRCandidates) && (ordering != SNR::DataOrdering::DMsSamples))
+        {
+            std::cerr << "The -snr_candidates kernel is only available for -dms_samples." << std::endl;
+            return 1;
+        }
+        if ((kernel == SNR::Kernel::SNRBeamMax) && (ordering != SNR::DataOrdering::DMsSamples))
+        {
+            std::cerr << "The -snr_beam_max kernel is only available for -dms_samples." << std::endl;
+            return 1;
+        }
+        conf.setSubgroupReduction(args.getSwitch("-subgroup"));
+        if (conf.getSubgroupReduction() && ((ordering != SNR::DataOrdering::DMsSamples) || !((kernel == SNR::Kernel::SNR) || (kernel == SNR::Kernel::SNRSigmaCut) || (kernel == SNR::Kernel::Max) || (kernel == SNR::Kernel::MaxStdSigmaCut))))
+        {
+            std::cerr << "The -subgroup reduction is only available for -snr, -snr_sc, -max and -max_std with -dms_samples." << std::endl;
+            return 1;
+        }
+        if (args.getSwitch("-vector"))
+        {
+            conf.setVectorWidth(args.getSwitchArgument<unsigned int>("-vector_width"));
+        }
+        if ((conf.getVectorWidth() != 1) && ((ordering != SNR::DataOrdering::DMsSamples) || !((kernel == SNR::Kernel::SNR) || (kernel == SNR::Kernel::Max))))
+        {
+            std::cerr << "The -vector loads are only available for -snr and -max with -dms_samples." << std::endl;
+            return 1;
+        }
+        if ((conf.getVectorWidth() != 1) && (conf.getVectorWidth() != 2) && (conf.getVectorWidth() != 4) && (conf.getVectorWidth() != 8) && (conf.getVectorWidth() != 16))
+        {
+            std::cerr << "The vector width must be 1, 2, 4, 8 or 16." << std::endl;
+            return 1;
+        }
         printCode = args.getSwitch("-print_code");
         printResults = args.getSwitch("-print_results");
-        clPlatformID = args.getSwitchArgument<unsigned int>("-opencl_platform");
-        clDeviceID = args.getSwitchArgument<unsigned int>("-opencl_device");
+        cpuEngine = args.getSwitch("-cpu");
+        if (!cpuEngine)
+        {
+            clPlatformID = args.getSwitchArgument<unsigned int>("-opencl_platform");
+            clDeviceID = args.getSwitchArgument<unsigned int>("-opencl_device");
+        }
         padding = args.getSwitchArgument<unsigned int>("-padding");
         conf.setNrThreadsD0(args.getSwitchArgument<unsigned int>("-threadsD0"));
-        if ((kernel == SNR::Kernel::SNR) || (kernel == SNR::Kernel::Max) || (kernel == SNR::Kernel::MaxStdSigmaCut) || (kernel == SNR::Kernel::AbsoluteDeviation))
+        if ((kernel == SNR::Kernel::SNR) || (kernel == SNR::Kernel::Max) || (kernel == SNR::Kernel::MaxStdSigmaCut) || (kernel == SNR::Kernel::AbsoluteDeviation) || (kernel == SNR::Kernel::SNRTopK) || (kernel == SNR::Kernel::SNRCandidates) || (kernel == SNR::Kernel::SNRBeamMax) || (kernel == SNR::Kernel::MedianOfMediansTwoLevel) || (kernel == SNR::Kernel::SNRRunningStatistics))
         {
             conf.setNrItemsD0(args.getSwitchArgument<unsigned int>("-itemsD0"));
         }
+        if (args.getSwitch("-multiple_dms"))
+        {
+            // Every work-group processes threadsD1 DMs
+            conf.setNrThreadsD1(args.getSwitchArgument<unsigned int>("-threadsD1"));
+            if ((ordering != SNR::DataOrdering::DMsSamples) || !((kernel == SNR::Kernel::SNR) || (kernel == SNR::Kernel::Max)))
+            {
+                std::cerr << "The -multiple_dms work-groups are only available for -snr and -max with -dms_samples." << std::endl;
+                return 1;
+            }
+            if (conf.getSubgroupReduction())
+            {
+                std::cerr << "The -multiple_dms work-groups are not available with -subgroup." << std::endl;
+                return 1;
+            }
+        }
+        if (args.getSwitch("-split_samples"))
+        {
+            // The samples are split among threadsD1 rows of the work-group
+            conf.setNrThreadsD1(args.getSwitchArgument<unsigned int>("-threadsD1"));
+            if ((ordering != SNR::DataOrdering::SamplesDMs) || (kernel != SNR::Kernel::SNR))
+            {
+                std::cerr << "The -split_samples work-groups are only available for -snr with -samples_dms." << std::endl;
+                return 1;
+            }
+        }
+        if (args.getSwitch("-persistent"))
+        {
+            conf.setNrWorkGroups(args.getSwitchArgument<unsigned int>("-work_groups"));
+            if ((ordering != SNR::DataOrdering::DMsSamples) || !((kernel == SNR::Kernel::SNR) || (kernel == SNR::Kernel::Max)))
+            {
+                std::cerr << "The -persistent kernels are only available for -snr and -max with -dms_samples." << std::endl;
+                return 1;
+            }
+        }
+        if (kernel == SNR::Kernel::Transpose)
+        {
+            conf.setNrThreadsD1(args.getSwitchArgument<unsigned int>("-threadsD1"));
+            conf.setNrItemsD1(conf.getNrThreadsD0() / conf.getNrThreadsD1());
+        }
         if ( kernel == SNR::Kernel::SNRSigmaCut || kernel == SNR::Kernel::MaxStdSigmaCut )
         {
-            nSigma = args.getSwitchArgument<float>("-nsigma");
+            options.nSigma = args.getSwitchArgument<float>("-nsigma");
+        }
+        else if (kernel == SNR::Kernel::SNRCandidates)
+        {
+            // The threshold is expressed in standard deviations, like the sigma cut
+            options.nSigma = args.getSwitchArgument<float>("-threshold");
+        }
+        if (args.getSwitch("-iterative"))
+        {
+            // The sigma cut is repeated until the number of kept samples does not change, or for at most this number of iterations
+            options.maxIterations = args.getSwitchArgument<unsigned int>("-cuts");
+            if ((ordering != SNR::DataOrdering::DMsSamples) || !((kernel == SNR::Kernel::SNRSigmaCut) || (kernel == SNR::Kernel::MaxStdSigmaCut)) || (options.maxIterations == 0))
+            {
+                std::cerr << "The -iterative sigma cut is only available for -snr_sc and -max_std with -dms_samples, and needs at least one cut." << std::endl;
+                return 1;
+            }
         }
         conf.setSubbandDedispersion(args.getSwitch("-subband"));
         observation.setNrSynthesizedBeams(args.getSwitchArgument<unsigned int>("-beams"));
         observation.setNrSamplesPerBatch(args.getSwitchArgument<unsigned int>("-samples"));
+        if ((observation.getNrSamplesPerBatch() % conf.getVectorWidth()) != 0)
+        {
+            std::cerr << "The number of samples must be a multiple of the vector width." << std::endl;
+            return 1;
+        }
         if (conf.getSubbandDedispersion())
         {
             observation.setDMRange(args.getSwitchArgument<unsigned int>("-subbanding_dms"), 0.0f, 0.0f, true);
@@ -123,9 +304,135 @@ int main(int argc, char *argv[])
             observation.setDMRange(1, 0.0f, 0.0f, true);
         }
         observation.setDMRange(args.getSwitchArgument<unsigned int>("-dms"), 0.0, 0.0);
-        if (kernel == SNR::Kernel::MedianOfMedians || kernel == SNR::Kernel::MedianOfMediansAbsoluteDeviation)
+        if ((ordering == SNR::DataOrdering::DMsSamples) && (kernel != SNR::Kernel::Transpose) && (((observation.getNrDMs(true) * observation.getNrDMs()) % conf.getNrThreadsD1()) != 0))
+        {
+            std::cerr << "The number of DMs must be a multiple of threadsD1." << std::endl;
+            return 1;
+        }
+        if ((ordering == SNR::DataOrdering::SamplesDMs) && (conf.getNrThreadsD1() > observation.getNrSamplesPerBatch()))
+        {
+            std::cerr << "The number of samples must not be smaller than threadsD1." << std::endl;
+            return 1;
+        }
+        if (kernel == SNR::Kernel::MedianOfMedians || kernel == SNR::Kernel::MedianOfMediansAbsoluteDeviation || kernel == SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation || kernel == SNR::Kernel::MedianOfMediansTwoLevel)
+        {
+            options.medianStep = args.getSwitchArgument<unsigned int>("-median_step");
+            if ((options.medianStep == 0) || (options.medianStep > observation.getNrSamplesPerBatch()))
+            {
+                std::cerr << "The median step must be larger than zero and not larger than the number of samples." << std::endl;
+                return 1;
+            }
+        }
+        if ((kernel == SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation) && !cpuEngine && (SNR::getSNRMedianOfMediansAbsoluteDeviationLocalMemory<inputDataType>(conf, observation.getNrSamplesPerBatch(), options.medianStep) > SNR::minLocalMemorySize))
+        {
+            std::cerr << "The -snr_momad kernel needs the time series to fit in " << SNR::minLocalMemorySize << " bytes of local memory; use the -median and -momad kernels instead." << std::endl;
+            return 1;
+        }
+        if ((kernel == SNR::Kernel::SNRBoxcar) && !cpuEngine && (SNR::getSNRBoxcarLocalMemory<inputDataType>(conf, observation.getNrSamplesPerBatch()) > SNR::minLocalMemorySize))
+        {
+            std::cerr << "The -boxcar kernel needs the time series to fit in " << SNR::minLocalMemorySize << " bytes of local memory." << std::endl;
+            return 1;
+        }
+        if ((kernel == SNR::Kernel::MedianOfMediansTwoLevel) && ((observation.getNrSamplesPerBatch() % options.medianStep) != 0))
+        {
+            std::cerr << "The -median_two_level kernel needs a number of samples multiple of median_step." << std::endl;
+            return 1;
+        }
+        if (kernel == SNR::Kernel::StreamingMedianAbsoluteDeviation)
+        {
+            options.nrBins = args.getSwitchArgument<unsigned int>("-bins");
+            options.smoothing = args.getSwitchArgument<float>("-smoothing");
+            options.nrBatches = args.getSwitchArgument<unsigned int>("-batches");
+            if ((options.nrBins < 2) || (conf.getNrThreadsD0() > observation.getNrSamplesPerBatch()) || (options.smoothing <= 0.0f) || (options.smoothing > 1.0f))
+            {
+                std::cerr << "The -streaming_mad kernel needs at least two bins, no more threadsD0 than samples, and a smoothing between 0 and 1." << std::endl;
+                return 1;
+            }
+        }
+        if (kernel == SNR::Kernel::SNRRunningStatistics)
+        {
+            options.decay = args.getSwitchArgument<float>("-decay");
+            options.nrBatches = args.getSwitchArgument<unsigned int>("-batches");
+            if ((options.decay <= 0.0f) || (options.decay > 1.0f) || (options.nrBatches == 0))
+            {
+                std::cerr << "The -snr_running kernel needs a decay between 0 and 1, and at least one batch." << std::endl;
+                return 1;
+            }
+        }
+        if (args.getSwitch("-sorting_network"))
+        {
+            conf.setMedianStrategy(SNR::MedianStrategy::SortingNetwork);
+        }
+        else if (args.getSwitch("-radix_select"))
+        {
+            conf.setMedianStrategy(SNR::MedianStrategy::RadixSelect);
+        }
+        if ((conf.getMedianStrategy() != SNR::MedianStrategy::OddEvenSort) && ((ordering != SNR::DataOrdering::DMsSamples) || (kernel != SNR::Kernel::MedianOfMedians)))
+        {
+            std::cerr << "The -sorting_network and -radix_select medians are only available for -median with -dms_samples." << std::endl;
+            return 1;
+        }
+        if (conf.getMedianStrategy() == SNR::MedianStrategy::SortingNetwork)
+        {
+            conf.setNrItemsD0(args.getSwitchArgument<unsigned int>("-itemsD0"));
+            if ((options.medianStep > SNR::maxSortingNetworkStep) || ((options.medianStep * conf.getNrItemsD0()) > SNR::maxSortingNetworkSamples) || (((observation.getNrSamplesPerBatch() / options.medianStep) % (conf.getNrThreadsD0() * conf.getNrItemsD0())) != 0))
+            {
+                std::cerr << "The -sorting_network median needs steps of at most " << SNR::maxSortingNetworkStep << " samples, at most " << SNR::maxSortingNetworkSamples << " samples (median_step * itemsD0) per work-item, and a number of steps multiple of threadsD0 * itemsD0." << std::endl;
+                return 1;
+            }
+        }
+        else if ((conf.getMedianStrategy() == SNR::MedianStrategy::RadixSelect) && (sizeof(inputDataType) != 4))
+        {
+            std::cerr << "The -radix_select median is only available for 32 bits data types." << std::endl;
+            return 1;
+        }
+        if (kernel == SNR::Kernel::SNRBoxcar)
+        {
+            // Comma separated list of boxcar widths
+            std::string widthsList = args.getSwitchArgument<std::string>("-widths");
+            std::string::size_type first = 0;
+
+            while (first < widthsList.size())
+            {
+                std::string::size_type last = widthsList.find(",", first);
+                if (last == std::string::npos)
+                {
+                    last = widthsList.size();
+                }
+                options.widths.push_back(isa::utils::castToType<std::string, unsigned int>(widthsList.substr(first, last - first)));
+                first = last + 1;
+            }
+            if (options.widths.empty())
+            {
+                std::cerr << "At least one boxcar width is required." << std::endl;
+                return 1;
+            }
+            for (auto width = options.widths.begin(); width != options.widths.end(); ++width)
+            {
+                if ((*width == 0) || (*width > observation.getNrSamplesPerBatch()))
+                {
+                    std::cerr << "Boxcar widths must be between 1 and the number of samples." << std::endl;
+                    return 1;
+                }
+            }
+        }
+        if (kernel == SNR::Kernel::SNRDownsampling)
+        {
+            options.nrLevels = args.getSwitchArgument<unsigned int>("-levels");
+            if ((options.nrLevels == 0) || ((conf.getNrThreadsD0() * 2) > (observation.getNrSamplesPerBatch() >> (options.nrLevels - 1))))
+            {
+                std::cerr << "Every level must have at least two samples per work-item." << std::endl;
+                return 1;
+            }
+        }
+        if (kernel == SNR::Kernel::SNRTopK)
         {
-            stepSize = args.getSwitchArgument<unsigned int>("-median_step");
+            options.nrPeaks = args.getSwitchArgument<unsigned int>("-peaks");
+            if ((options.nrPeaks == 0) || (options.nrPeaks > observation.getNrSamplesPerBatch()))
+            {
+                std::cerr << "The number of peaks must be between 1 and the number of samples." << std::endl;
+                return 1;
+            }
         }
     }
     catch (isa::utils::SwitchNotFound &err)
@@ -135,31 +442,36 @@ int main(int argc, char *argv[])
     }
     catch (std::exception &err)
     {
-        std::cerr << "Usage: " << argv[0] << " [-snr | -snr_sc | -max | -max_std | -median | -momad | -absolute_deviation] [-dms_samples | -samples_dms] [-print_code] [-print_results] -opencl_platform <int> -opencl_device <int> -padding <int> -threadsD0 <int> -itemsD0 <int> [-subband] -beams <int> -dms <int> -samples <int>" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " [-cluster | -snr | -snr_sc | -max | -max_std | -median | -momad | -absolute_deviation | -transpose | -snr_momad | -boxcar | -snr_downsampling | -snr_topk | -snr_candidates | -snr_beam_max | -median_two_level | -streaming_mad | -snr_running] [-dms_samples | -samples_dms] [-print_code] [-print_results] [-cpu] -opencl_platform <int> -opencl_device <int> -padding <int> -threadsD0 <int> -itemsD0 <int> [-subgroup] [-vector] [-multiple_dms] [-split_samples] [-persistent] [-sorting_network | -radix_select] [-iterative] [-subband] -beams <int> -dms <int> -samples <int>" << std::endl;
         std::cerr << "\t -subband -subbanding_dms <int>" << std::endl;
+        std::cerr << "\t -vector -vector_width <int>" << std::endl;
+        std::cerr << "\t -multiple_dms -threadsD1 <int>" << std::endl;
+        std::cerr << "\t -split_samples -threadsD1 <int>" << std::endl;
+        std::cerr << "\t -persistent -work_groups <int>" << std::endl;
         std::cerr << "\t -snr_sc -nsigma <float>" << std::endl;
+        std::cerr << "\t -iterative -cuts <int>" << std::endl;
         std::cerr << "\t -median -median_step <int>" << std::endl;
+        std::cerr << "\t -median -sorting_network -itemsD0 <int>" << std::endl;
+        std::cerr << "\t -median_two_level -median_step <int>" << std::endl;
+        std::cerr << "\t -streaming_mad -bins <int> -smoothing <float> -batches <int>" << std::endl;
+        std::cerr << "\t -snr_running -decay <float> -batches <int>" << std::endl;
         std::cerr << "\t -momad -median_step <int>" << std::endl;
         std::cerr << "\t -max_std -nsigma <float>" << std::endl;
+        std::cerr << "\t -transpose -threadsD1 <int>" << std::endl;
+        std::cerr << "\t -snr_momad -median_step <int>" << std::endl;
+        std::cerr << "\t -boxcar -widths <int,int,...>" << std::endl;
+        std::cerr << "\t -snr_downsampling -levels <int>" << std::endl;
+        std::cerr << "\t -snr_topk -itemsD0 <int> -peaks <int>" << std::endl;
+        std::cerr << "\t -snr_candidates -threshold <float>" << std::endl;
+        std::cerr << "\t -cluster does not need any other switch" << std::endl;
         return 1;
     }
-    if (kernel == SNR::Kernel::SNR || kernel == SNR::Kernel::Max || kernel == SNR::Kernel::MaxStdSigmaCut || kernel == SNR::Kernel::AbsoluteDeviation)
-    {
-        returnCode = test(printResults, printCode, clPlatformID, clDeviceID, ordering, kernel, padding, observation, conf);
-    }
-    else if (kernel == SNR::Kernel::MedianOfMedians || kernel == SNR::Kernel::MedianOfMediansAbsoluteDeviation)
-    {
-        returnCode = test(printResults, printCode, clPlatformID, clDeviceID, ordering, kernel, padding, observation, conf, stepSize);
-    }
-    else if ( kernel == SNR::Kernel::SNRSigmaCut || kernel == SNR::Kernel::MaxStdSigmaCut )
-    {
-        returnCode = test(printResults, printCode, clPlatformID, clDeviceID, ordering, kernel, padding, observation, conf, 0, nSigma);
-    }
+    returnCode = test(printResults, printCode, cpuEngine, clPlatformID, clDeviceID, ordering, kernel, padding, observation, conf, options);
 
     return returnCode;
 }
 
-int test(const bool printResults, const bool printCode, const unsigned int clPlatformID, const unsigned int clDeviceID, const SNR::DataOrdering ordering, const SNR::Kernel kernelUnderTest, const unsigned int padding, const AstroData::Observation &observation, const SNR::snrConf &conf, const unsigned int medianStep, const float nSigma)
+int test(const bool printResults, const bool printCode, const bool cpuEngine, const unsigned int clPlatformID, const unsigned int clDeviceID, const SNR::DataOrdering ordering, const SNR::Kernel kernelUnderTest, const unsigned int padding, const AstroData::Observation &observation, const SNR::snrConf &conf, const SNR::KernelOptions &options)
 {
     uint64_t wrongSamples = 0;
     uint64_t wrongPositions = 0;
@@ -167,15 +479,35 @@ int test(const bool printResults, const bool printCode, const unsigned int clPla
 
     // Initialize OpenCL
     isa::OpenCL::OpenCLRunTime openCLRunTime;
-    isa::OpenCL::initializeOpenCL(clPlatformID, 1, openCLRunTime);
+    if (!cpuEngine)
+    {
+        isa::OpenCL::initializeOpenCL(clPlatformID, 1, openCLRunTime);
+    }
 
     // Allocate memory
     std::vector<inputDataType> input;
     std::vector<outputDataType> output;
     std::vector<unsigned int> outputIndex;
+    std::vector<unsigned int> outputWidth;
+    std::vector<unsigned int> outputDownsampling;
+    std::vector<float> candidateSNR;
+    std::vector<unsigned int> candidates;
+    std::vector<float> beamSNR;
+    std::vector<unsigned int> beamDM;
+    std::vector<float> dmSNR;
+    std::vector<unsigned int> dmBeam;
     std::vector<outputDataType> baselines;
     std::vector<outputDataType> stdevs;
-    cl::Buffer input_d, output_d, outputIndex_d, baselines_d, stdevs_d;
+    std::vector<float> mads;
+    std::vector<float> counters;
+    std::vector<float> means;
+    std::vector<float> variances;
+    cl::Buffer input_d, output_d, outputIndex_d, outputWidth_d, outputDownsampling_d, nrCandidates_d, candidateSNR_d, candidates_d, baselines_d, stdevs_d;
+    cl::Buffer snr_d, beamSNR_d, beamDM_d, dmSNR_d, dmBeam_d, partialSNR_d, partialDM_d, counter_d;
+    cl::Buffer mads_d;
+    cl::Buffer counters_d, means_d, variances_d;
+    // Ping-pong buffers for the levels of the downsampling tree
+    cl::Buffer downsampled_d[2];
 
     if (ordering == SNR::DataOrdering::DMsSamples)
     {
@@ -183,12 +515,49 @@ int test(const bool printResults, const bool printCode, const unsigned int clPla
     }
     else
     {
-        input.resize(observation.getNrSynthesizedBeams() * observation.getNrSamplesPerBatch() * observation.getNrDMs(true) * observation.getNrDMs(false, padding / sizeof(inputDataType)));
+        input.resize(observation.getNrSynthesizedBeams() * observation.getNrSamplesPerBatch() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(inputDataType)));
+    }
+    if ( kernelUnderTest == SNR::Kernel::SNR || kernelUnderTest == SNR::Kernel::SNRSigmaCut || kernelUnderTest == SNR::Kernel::Max || kernelUnderTest == SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation || kernelUnderTest == SNR::Kernel::SNRCandidates || kernelUnderTest == SNR::Kernel::SNRBeamMax || kernelUnderTest == SNR::Kernel::SNRRunningStatistics )
+    {
+        output.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float)));
+        outputIndex.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int)));
+    }
+    else if (kernelUnderTest == SNR::Kernel::SNRBoxcar)
+    {
+        output.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float)));
+        outputIndex.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int)));
+        outputWidth.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int)));
     }
-    if ( kernelUnderTest == SNR::Kernel::SNR || kernelUnderTest == SNR::Kernel::SNRSigmaCut || kernelUnderTest == SNR::Kernel::Max )
+    else if (kernelUnderTest == SNR::Kernel::SNRDownsampling)
     {
         output.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float)));
         outputIndex.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int)));
+        outputDownsampling.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int)));
+    }
+    else if (kernelUnderTest == SNR::Kernel::SNRTopK)
+    {
+        output.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs() * options.nrPeaks, padding / sizeof(float)));
+        outputIndex.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs() * options.nrPeaks, padding / sizeof(unsigned int)));
+    }
+    if (kernelUnderTest == SNR::Kernel::SNRRunningStatistics)
+    {
+        // The state starts empty
+        counters.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float)));
+        means.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float)));
+        variances.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float)));
+    }
+    if (kernelUnderTest == SNR::Kernel::SNRCandidates)
+    {
+        // There is at most one candidate per DM
+        candidateSNR.resize(observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs());
+        candidates.resize(observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * 3);
+    }
+    if (kernelUnderTest == SNR::Kernel::SNRBeamMax)
+    {
+        beamSNR.resize(observation.getNrSynthesizedBeams());
+        beamDM.resize(observation.getNrSynthesizedBeams());
+        dmSNR.resize(observation.getNrDMs(true) * observation.getNrDMs());
+        dmBeam.resize(observation.getNrDMs(true) * observation.getNrDMs());
     }
     if (kernelUnderTest == SNR::Kernel::MaxStdSigmaCut)
     {
@@ -198,42 +567,122 @@ int test(const bool printResults, const bool printCode, const unsigned int clPla
     }
     else if (kernelUnderTest == SNR::Kernel::MedianOfMedians)
     {
-        if (medianStep != observation.getNrSamplesPerBatch())
+        if ((options.medianStep != observation.getNrSamplesPerBatch()) && (ordering == SNR::DataOrdering::DMsSamples))
+        {
+            output.resize(observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / options.medianStep, padding / sizeof(outputDataType)));
+        }
+        else if (options.medianStep != observation.getNrSamplesPerBatch())
         {
-            output.resize(observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / medianStep, padding / sizeof(outputDataType)));
+            output.resize(observation.getNrSynthesizedBeams() * (observation.getNrSamplesPerBatch() / options.medianStep) * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType)));
         }
         else{
             output.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType)));
         }
     }
+    else if (kernelUnderTest == SNR::Kernel::MedianOfMediansTwoLevel)
+    {
+        output.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType)));
+    }
+    else if (kernelUnderTest == SNR::Kernel::StreamingMedianAbsoluteDeviation)
+    {
+        // The output contains the baselines of the state, and starts empty
+        output.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float)));
+        mads.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float)));
+    }
     else if (kernelUnderTest == SNR::Kernel::MedianOfMediansAbsoluteDeviation)
     {
-        output.resize(observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / medianStep, padding / sizeof(outputDataType)));
+        if (ordering == SNR::DataOrdering::DMsSamples)
+        {
+            output.resize(observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / options.medianStep, padding / sizeof(outputDataType)));
+        }
+        else
+        {
+            output.resize(observation.getNrSynthesizedBeams() * (observation.getNrSamplesPerBatch() / options.medianStep) * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType)));
+        }
         baselines.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType)));
     }
     else if (kernelUnderTest == SNR::Kernel::AbsoluteDeviation)
     {
-        output.resize(observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType)));
+        output.resize(input.size());
         baselines.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType)));
     }
-    try
+    else if (kernelUnderTest == SNR::Kernel::Transpose)
     {
-        input_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_WRITE, input.size() * sizeof(inputDataType), 0, 0);
-        output_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_WRITE_ONLY, output.size() * sizeof(outputDataType), 0, 0);
-        stdevs_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_WRITE_ONLY, output.size() * sizeof(outputDataType), 0, 0);
-        if ( kernelUnderTest == SNR::Kernel::SNR || kernelUnderTest == SNR::Kernel::SNRSigmaCut || kernelUnderTest == SNR::Kernel::Max || kernelUnderTest == SNR::Kernel::MaxStdSigmaCut )
+        if (ordering == SNR::DataOrdering::DMsSamples)
         {
-            outputIndex_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_WRITE_ONLY, outputIndex.size() * sizeof(unsigned int), 0, 0);
+            output.resize(observation.getNrSynthesizedBeams() * observation.getNrSamplesPerBatch() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType)));
         }
-        if (kernelUnderTest == SNR::Kernel::MedianOfMediansAbsoluteDeviation || kernelUnderTest == SNR::Kernel::AbsoluteDeviation)
+        else
         {
-            baselines_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_ONLY, baselines.size() * sizeof(outputDataType), 0, 0);
+            output.resize(observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(outputDataType)));
         }
     }
-    catch (cl::Error &err)
+    if (!cpuEngine)
     {
-        std::cerr << "OpenCL error allocating memory: " << std::to_string(err.err()) << "." << std::endl;
-        return 1;
+        try
+        {
+            input_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_WRITE, input.size() * sizeof(inputDataType), 0, 0);
+            output_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_WRITE_ONLY, output.size() * sizeof(outputDataType), 0, 0);
+            stdevs_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_WRITE_ONLY, output.size() * sizeof(outputDataType), 0, 0);
+            if ( kernelUnderTest == SNR::Kernel::SNR || kernelUnderTest == SNR::Kernel::SNRSigmaCut || kernelUnderTest == SNR::Kernel::Max || kernelUnderTest == SNR::Kernel::MaxStdSigmaCut || kernelUnderTest == SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation || kernelUnderTest == SNR::Kernel::SNRTopK || kernelUnderTest == SNR::Kernel::SNRRunningStatistics )
+            {
+                outputIndex_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_WRITE_ONLY, outputIndex.size() * sizeof(unsigned int), 0, 0);
+            }
+            if (kernelUnderTest == SNR::Kernel::SNRCandidates)
+            {
+                nrCandidates_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_WRITE, sizeof(unsigned int), 0, 0);
+                candidateSNR_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_WRITE_ONLY, candidateSNR.size() * sizeof(float), 0, 0);
+                candidates_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_WRITE_ONLY, candidates.size() * sizeof(unsigned int), 0, 0);
+            }
+            if (kernelUnderTest == SNR::Kernel::SNRBeamMax)
+            {
+                // One partial maximum per beam for every tile of DMs
+                unsigned int nrTiles = isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), conf.getNrThreadsD0() * conf.getNrItemsD0()) / (conf.getNrThreadsD0() * conf.getNrItemsD0());
+
+                snr_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_ONLY, output.size() * sizeof(float), 0, 0);
+                beamSNR_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_WRITE_ONLY, beamSNR.size() * sizeof(float), 0, 0);
+                beamDM_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_WRITE_ONLY, beamDM.size() * sizeof(unsigned int), 0, 0);
+                dmSNR_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_WRITE_ONLY, dmSNR.size() * sizeof(float), 0, 0);
+                dmBeam_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_WRITE_ONLY, dmBeam.size() * sizeof(unsigned int), 0, 0);
+                partialSNR_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_WRITE, observation.getNrSynthesizedBeams() * nrTiles * sizeof(float), 0, 0);
+                partialDM_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_WRITE, observation.getNrSynthesizedBeams() * nrTiles * sizeof(unsigned int), 0, 0);
+                counter_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_WRITE, sizeof(unsigned int), 0, 0);
+            }
+            if (kernelUnderTest == SNR::Kernel::SNRBoxcar)
+            {
+                outputIndex_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_WRITE_ONLY, outputIndex.size() * sizeof(unsigned int), 0, 0);
+                outputWidth_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_WRITE_ONLY, outputWidth.size() * sizeof(unsigned int), 0, 0);
+            }
+            if (kernelUnderTest == SNR::Kernel::SNRDownsampling)
+            {
+                outputIndex_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_WRITE, outputIndex.size() * sizeof(unsigned int), 0, 0);
+                outputDownsampling_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_WRITE, outputDownsampling.size() * sizeof(unsigned int), 0, 0);
+                downsampled_d[0] = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_WRITE, observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / 2, padding / sizeof(inputDataType)) * sizeof(inputDataType), 0, 0);
+                downsampled_d[1] = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_WRITE, observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / 4, padding / sizeof(inputDataType)) * sizeof(inputDataType), 0, 0);
+            }
+            if (kernelUnderTest == SNR::Kernel::MedianOfMediansAbsoluteDeviation || kernelUnderTest == SNR::Kernel::AbsoluteDeviation)
+            {
+                baselines_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_ONLY, baselines.size() * sizeof(outputDataType), 0, 0);
+            }
+            if (kernelUnderTest == SNR::Kernel::StreamingMedianAbsoluteDeviation)
+            {
+                // The state is read and written by every batch
+                output_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_WRITE, output.size() * sizeof(float), 0, 0);
+                mads_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_WRITE, mads.size() * sizeof(float), 0, 0);
+            }
+            if (kernelUnderTest == SNR::Kernel::SNRRunningStatistics)
+            {
+                // The state is read and written by every batch
+                counters_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_WRITE, counters.size() * sizeof(float), 0, 0);
+                means_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_WRITE, means.size() * sizeof(float), 0, 0);
+                variances_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_WRITE, variances.size() * sizeof(float), 0, 0);
+            }
+        }
+        catch (cl::Error &err)
+        {
+            std::cerr << "OpenCL error allocating memory: " << std::to_string(err.err()) << "." << std::endl;
+            return 1;
+        }
     }
 
     // Generate test data
@@ -296,15 +745,15 @@ int test(const bool printResults, const bool printCode, const unsigned int clPla
                     {
                         if (sample == maxSample.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm))
                         {
-                            input[(beam * observation.getNrSamplesPerBatch() * observation.getNrDMs(true) * observation.getNrDMs(false, padding / sizeof(inputDataType))) + (sample * observation.getNrDMs(true) * observation.getNrDMs(false, padding / sizeof(inputDataType))) + (subbandingDM * observation.getNrDMs(false, padding / sizeof(inputDataType))) + dm] = static_cast<inputDataType>(10 + (rand() % 10));
+                            input[(beam * observation.getNrSamplesPerBatch() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(inputDataType))) + (sample * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(inputDataType))) + (subbandingDM * observation.getNrDMs()) + dm] = static_cast<inputDataType>(10 + (rand() % 10));
                         }
                         else
                         {
-                            input[(beam * observation.getNrSamplesPerBatch() * observation.getNrDMs(true) * observation.getNrDMs(false, padding / sizeof(inputDataType))) + (sample * observation.getNrDMs(true) * observation.getNrDMs(false, padding / sizeof(inputDataType))) + (subbandingDM * observation.getNrDMs(false, padding / sizeof(inputDataType))) + dm] = static_cast<inputDataType>(rand() % 10);
+                            input[(beam * observation.getNrSamplesPerBatch() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(inputDataType))) + (sample * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(inputDataType))) + (subbandingDM * observation.getNrDMs()) + dm] = static_cast<inputDataType>(rand() % 10);
                         }
                         if (printResults)
                         {
-                            std::cout << input[(beam * observation.getNrSamplesPerBatch() * observation.getNrDMs(true) * observation.getNrDMs(false, padding / sizeof(inputDataType))) + (sample * observation.getNrDMs(true) * observation.getNrDMs(false, padding / sizeof(inputDataType))) + (subbandingDM * observation.getNrDMs(false, padding / sizeof(inputDataType))) + dm] << " ";
+                            std::cout << input[(beam * observation.getNrSamplesPerBatch() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(inputDataType))) + (sample * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(inputDataType))) + (subbandingDM * observation.getNrDMs()) + dm] << " ";
                         }
                     }
                     if (printResults)
@@ -349,121 +798,296 @@ int test(const bool printResults, const bool printCode, const unsigned int clPla
         }
     }
 
-    // Copy data structures to device
-    try
-    {
-        openCLRunTime.queues->at(clDeviceID)[0].enqueueWriteBuffer(input_d, CL_FALSE, 0, input.size() * sizeof(inputDataType), reinterpret_cast<void *>(input.data()));
-        if (kernelUnderTest == SNR::Kernel::MedianOfMediansAbsoluteDeviation || kernelUnderTest == SNR::Kernel::AbsoluteDeviation)
-        {
-            openCLRunTime.queues->at(clDeviceID)[0].enqueueWriteBuffer(baselines_d, CL_FALSE, 0, baselines.size() * sizeof(outputDataType), reinterpret_cast<void *>(baselines.data()));
-        }
-    }
-    catch (cl::Error &err)
+    if (kernelUnderTest == SNR::Kernel::SNRBeamMax)
     {
-        std::cerr << "OpenCL error H2D transfer: " << std::to_string(err.err()) << "." << std::endl;
-        return 1;
+        // The input of the cross-beam max is the SNR of every DM
+        SNR::snrDMsSamplesCPU(input, output, outputIndex, observation, observation.getNrSamplesPerBatch(), padding);
     }
 
-    // Generate kernel
     cl::Kernel * kernel = nullptr;
+    std::vector<cl::Kernel *> levelKernels;
     std::string * code = nullptr;
-    if (kernelUnderTest == SNR::Kernel::SNR)
+    if (!cpuEngine)
     {
-        if (ordering == SNR::DataOrdering::DMsSamples)
+        // Copy data structures to device
+        try
         {
-            code = SNR::getSNRDMsSamplesOpenCL<inputDataType>(conf, inputDataName, observation, observation.getNrSamplesPerBatch(), padding);
+            openCLRunTime.queues->at(clDeviceID)[0].enqueueWriteBuffer(input_d, CL_FALSE, 0, input.size() * sizeof(inputDataType), reinterpret_cast<void *>(input.data()));
+            if (kernelUnderTest == SNR::Kernel::MedianOfMediansAbsoluteDeviation || kernelUnderTest == SNR::Kernel::AbsoluteDeviation)
+            {
+                openCLRunTime.queues->at(clDeviceID)[0].enqueueWriteBuffer(baselines_d, CL_FALSE, 0, baselines.size() * sizeof(outputDataType), reinterpret_cast<void *>(baselines.data()));
+            }
+            if (kernelUnderTest == SNR::Kernel::SNRBeamMax)
+            {
+                openCLRunTime.queues->at(clDeviceID)[0].enqueueWriteBuffer(snr_d, CL_FALSE, 0, output.size() * sizeof(float), reinterpret_cast<void *>(output.data()));
+            }
+            if (kernelUnderTest == SNR::Kernel::StreamingMedianAbsoluteDeviation)
+            {
+                openCLRunTime.queues->at(clDeviceID)[0].enqueueWriteBuffer(output_d, CL_FALSE, 0, output.size() * sizeof(float), reinterpret_cast<void *>(output.data()));
+                openCLRunTime.queues->at(clDeviceID)[0].enqueueWriteBuffer(mads_d, CL_FALSE, 0, mads.size() * sizeof(float), reinterpret_cast<void *>(mads.data()));
+            }
+            if (kernelUnderTest == SNR::Kernel::SNRRunningStatistics)
+            {
+                openCLRunTime.queues->at(clDeviceID)[0].enqueueWriteBuffer(counters_d, CL_FALSE, 0, counters.size() * sizeof(float), reinterpret_cast<void *>(counters.data()));
+                openCLRunTime.queues->at(clDeviceID)[0].enqueueWriteBuffer(means_d, CL_FALSE, 0, means.size() * sizeof(float), reinterpret_cast<void *>(means.data()));
+                openCLRunTime.queues->at(clDeviceID)[0].enqueueWriteBuffer(variances_d, CL_FALSE, 0, variances.size() * sizeof(float), reinterpret_cast<void *>(variances.data()));
+            }
         }
-        else
+        catch (cl::Error &err)
         {
-            code = SNR::getSNRSamplesDMsOpenCL<inputDataType>(conf, inputDataName, observation, observation.getNrSamplesPerBatch(), padding);
+            std::cerr << "OpenCL error H2D transfer: " << std::to_string(err.err()) << "." << std::endl;
+            return 1;
         }
-    }
-    else if ( kernelUnderTest == SNR::Kernel::SNRSigmaCut )
-    {
-        code = SNR::getSNRSigmaCutDMsSamplesOpenCL<inputDataType>(conf, inputDataName, observation, observation.getNrSamplesPerBatch(), padding, nSigma);
-    }
-    else if (kernelUnderTest == SNR::Kernel::Max)
-    {
-        code = SNR::getMaxOpenCL<inputDataType>(conf, ordering, inputDataName, observation, 1, padding);
-    }
-    else if (kernelUnderTest == SNR::Kernel::MaxStdSigmaCut)
-    {
-        code = SNR::getMaxStdSigmaCutOpenCL<inputDataType>(conf, ordering, inputDataName, observation, 1, padding, nSigma);
-    }
-    else if (kernelUnderTest == SNR::Kernel::MedianOfMedians)
-    {
-        code = SNR::getMedianOfMediansOpenCL<inputDataType>(conf, ordering, inputDataName, observation, 1, medianStep, padding);
-    }
-    else if (kernelUnderTest == SNR::Kernel::MedianOfMediansAbsoluteDeviation)
-    {
-        code = SNR::getMedianOfMediansAbsoluteDeviationOpenCL<inputDataType>(conf, ordering, inputDataName, observation, 1, medianStep, padding);
-    }
-    else if (kernelUnderTest == SNR::Kernel::AbsoluteDeviation)
-    {
-        code = SNR::getAbsoluteDeviationOpenCL<inputDataType>(conf, ordering, inputDataName, observation, 1, padding);
-    }
-    if (printCode)
-    {
-        std::cout << *code << std::endl;
-    }
 
-    try
-    {
+        // Generate kernel
         if (kernelUnderTest == SNR::Kernel::SNR)
         {
             if (ordering == SNR::DataOrdering::DMsSamples)
             {
-                kernel = isa::OpenCL::compile("snrDMsSamples" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                code = SNR::getSNRDMsSamplesOpenCL<inputDataType>(conf, inputDataName, observation, observation.getNrSamplesPerBatch(), padding);
             }
             else
             {
-                kernel = isa::OpenCL::compile("snrSamplesDMs" + std::to_string(observation.getNrDMs(true) * observation.getNrDMs()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                code = SNR::getSNRSamplesDMsOpenCL<inputDataType>(conf, inputDataName, observation, observation.getNrSamplesPerBatch(), padding);
             }
         }
         else if ( kernelUnderTest == SNR::Kernel::SNRSigmaCut )
         {
-            kernel = isa::OpenCL::compile("snrSigmaCutDMsSamples" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
-        }
-        else if (kernelUnderTest == SNR::Kernel::Max)
-        {
-            if (ordering == SNR::DataOrdering::DMsSamples)
+            if ((ordering == SNR::DataOrdering::DMsSamples) && (options.maxIterations > 0))
+            {
+                code = SNR::getSNRIterativeSigmaCutDMsSamplesOpenCL<inputDataType>(conf, inputDataName, observation, observation.getNrSamplesPerBatch(), padding, options.nSigma, options.maxIterations);
+            }
+            else if (ordering == SNR::DataOrdering::DMsSamples)
             {
-                kernel = isa::OpenCL::compile("max_DMsSamples_" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                code = SNR::getSNRSigmaCutDMsSamplesOpenCL<inputDataType>(conf, inputDataName, observation, observation.getNrSamplesPerBatch(), padding, options.nSigma);
+            }
+            else
+            {
+                code = SNR::getSNRSigmaCutSamplesDMsOpenCL<inputDataType>(conf, inputDataName, observation, observation.getNrSamplesPerBatch(), padding, options.nSigma);
             }
         }
+        else if (kernelUnderTest == SNR::Kernel::Max)
+        {
+            code = SNR::getMaxOpenCL<inputDataType>(conf, ordering, inputDataName, observation, 1, padding);
+        }
         else if (kernelUnderTest == SNR::Kernel::MaxStdSigmaCut)
         {
-            if (ordering == SNR::DataOrdering::DMsSamples)
+            if (options.maxIterations > 0)
+            {
+                code = SNR::getMaxStdIterativeSigmaCutDMsSamplesOpenCL<inputDataType>(conf, inputDataName, observation, 1, padding, options.nSigma, options.maxIterations);
+            }
+            else
             {
-                kernel = isa::OpenCL::compile("maxStdSigmaCut_DMsSamples_" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                code = SNR::getMaxStdSigmaCutOpenCL<inputDataType>(conf, ordering, inputDataName, observation, 1, padding, options.nSigma);
             }
         }
         else if (kernelUnderTest == SNR::Kernel::MedianOfMedians)
         {
-            if (ordering == SNR::DataOrdering::DMsSamples)
-            {
-                kernel = isa::OpenCL::compile("medianOfMedians_DMsSamples_" + std::to_string(medianStep), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
-            }
+            code = SNR::getMedianOfMediansOpenCL<inputDataType>(conf, ordering, inputDataName, observation, 1, options.medianStep, padding);
+        }
+        else if (kernelUnderTest == SNR::Kernel::MedianOfMediansTwoLevel)
+        {
+            code = SNR::getMedianOfMediansTwoLevelDMsSamplesOpenCL<inputDataType>(conf, inputDataName, observation, 1, options.medianStep, padding);
+        }
+        else if (kernelUnderTest == SNR::Kernel::StreamingMedianAbsoluteDeviation)
+        {
+            code = SNR::getStreamingMedianAbsoluteDeviationDMsSamplesOpenCL<inputDataType>(conf, inputDataName, observation, 1, options.nrBins, options.smoothing, padding);
+        }
+        else if (kernelUnderTest == SNR::Kernel::SNRRunningStatistics)
+        {
+            code = SNR::getSNRRunningStatisticsDMsSamplesOpenCL<inputDataType>(conf, inputDataName, observation, observation.getNrSamplesPerBatch(), options.decay, padding);
         }
         else if (kernelUnderTest == SNR::Kernel::MedianOfMediansAbsoluteDeviation)
         {
-            if (ordering == SNR::DataOrdering::DMsSamples)
+            code = SNR::getMedianOfMediansAbsoluteDeviationOpenCL<inputDataType>(conf, ordering, inputDataName, observation, 1, options.medianStep, padding);
+        }
+        else if (kernelUnderTest == SNR::Kernel::AbsoluteDeviation)
+        {
+            code = SNR::getAbsoluteDeviationOpenCL<inputDataType>(conf, ordering, inputDataName, observation, 1, padding);
+        }
+        else if (kernelUnderTest == SNR::Kernel::Transpose)
+        {
+            code = SNR::getTransposeOpenCL<inputDataType>(conf, ordering, inputDataName, observation, 1, padding);
+        }
+        else if (kernelUnderTest == SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation)
+        {
+            code = SNR::getSNRMedianOfMediansAbsoluteDeviationDMsSamplesOpenCL<inputDataType>(conf, inputDataName, observation, observation.getNrSamplesPerBatch(), options.medianStep, padding);
+        }
+        else if (kernelUnderTest == SNR::Kernel::SNRBoxcar)
+        {
+            code = SNR::getSNRBoxcarDMsSamplesOpenCL<inputDataType>(conf, inputDataName, observation, observation.getNrSamplesPerBatch(), options.widths, padding);
+        }
+        else if (kernelUnderTest == SNR::Kernel::SNRCandidates)
+        {
+            code = SNR::getSNRCandidatesDMsSamplesOpenCL<inputDataType>(conf, inputDataName, observation, observation.getNrSamplesPerBatch(), options.nSigma, candidateSNR.size(), padding);
+        }
+        else if (kernelUnderTest == SNR::Kernel::SNRBeamMax)
+        {
+            code = SNR::getSNRBeamMaxOpenCL<outputDataType>(conf, outputDataName, observation, padding);
+        }
+        else if (kernelUnderTest == SNR::Kernel::SNRTopK)
+        {
+            code = SNR::getSNRTopKDMsSamplesOpenCL<inputDataType>(conf, inputDataName, observation, observation.getNrSamplesPerBatch(), options.nrPeaks, padding);
+        }
+        else if (kernelUnderTest == SNR::Kernel::SNRDownsampling)
+        {
+            // All the levels are part of the same program
+            code = new std::string();
+            for (unsigned int level = 0; level < options.nrLevels; level++)
             {
-                kernel = isa::OpenCL::compile("medianOfMediansAbsoluteDeviation_DMsSamples_" + std::to_string(medianStep), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                std::string *levelCode = SNR::getSNRDownsamplingDMsSamplesOpenCL<inputDataType>(conf, inputDataName, observation, observation.getNrSamplesPerBatch() >> level, 1 << level, padding);
+                code->append(*levelCode);
+                delete levelCode;
             }
         }
-        else if (kernelUnderTest == SNR::Kernel::AbsoluteDeviation)
+        if (printCode)
         {
-            if (ordering == SNR::DataOrdering::DMsSamples)
+            std::cout << *code << std::endl;
+        }
+
+        try
+        {
+            if (kernelUnderTest == SNR::Kernel::SNR)
+            {
+                if (ordering == SNR::DataOrdering::DMsSamples)
+                {
+                    kernel = isa::OpenCL::compile("snrDMsSamples" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                }
+                else
+                {
+                    kernel = isa::OpenCL::compile("snrSamplesDMs" + std::to_string(observation.getNrDMs(true) * observation.getNrDMs()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                }
+            }
+            else if ( kernelUnderTest == SNR::Kernel::SNRSigmaCut )
+            {
+                if ((ordering == SNR::DataOrdering::DMsSamples) && (options.maxIterations > 0))
+                {
+                    kernel = isa::OpenCL::compile("snrIterativeSigmaCut_DMsSamples_" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                }
+                else if (ordering == SNR::DataOrdering::DMsSamples)
+                {
+                    kernel = isa::OpenCL::compile("snrSigmaCutDMsSamples" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                }
+                else
+                {
+                    kernel = isa::OpenCL::compile("snrSigmaCutSamplesDMs" + std::to_string(observation.getNrDMs(true) * observation.getNrDMs()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                }
+            }
+            else if (kernelUnderTest == SNR::Kernel::Max)
+            {
+                if (ordering == SNR::DataOrdering::DMsSamples)
+                {
+                    kernel = isa::OpenCL::compile("max_DMsSamples_" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                }
+                else
+                {
+                    kernel = isa::OpenCL::compile("max_SamplesDMs_" + std::to_string(observation.getNrDMs(true) * observation.getNrDMs()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                }
+            }
+            else if (kernelUnderTest == SNR::Kernel::MaxStdSigmaCut)
+            {
+                if ((ordering == SNR::DataOrdering::DMsSamples) && (options.maxIterations > 0))
+                {
+                    kernel = isa::OpenCL::compile("maxStdIterativeSigmaCut_DMsSamples_" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                }
+                else if (ordering == SNR::DataOrdering::DMsSamples)
+                {
+                    kernel = isa::OpenCL::compile("maxStdSigmaCut_DMsSamples_" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                }
+                else
+                {
+                    kernel = isa::OpenCL::compile("maxStdSigmaCut_SamplesDMs_" + std::to_string(observation.getNrDMs(true) * observation.getNrDMs()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                }
+            }
+            else if (kernelUnderTest == SNR::Kernel::MedianOfMedians)
+            {
+                if (ordering == SNR::DataOrdering::DMsSamples)
+                {
+                    kernel = isa::OpenCL::compile("medianOfMedians_DMsSamples_" + std::to_string(options.medianStep), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                }
+                else
+                {
+                    kernel = isa::OpenCL::compile("medianOfMedians_SamplesDMs_" + std::to_string(options.medianStep), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                }
+            }
+            else if (kernelUnderTest == SNR::Kernel::MedianOfMediansTwoLevel)
+            {
+                kernel = isa::OpenCL::compile("medianOfMediansTwoLevel_DMsSamples_" + std::to_string(options.medianStep), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+            }
+            else if (kernelUnderTest == SNR::Kernel::StreamingMedianAbsoluteDeviation)
+            {
+                kernel = isa::OpenCL::compile("streamingMedianAbsoluteDeviation_DMsSamples_" + std::to_string(options.nrBins), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+            }
+            else if (kernelUnderTest == SNR::Kernel::SNRRunningStatistics)
+            {
+                kernel = isa::OpenCL::compile("snrRunningStatistics_DMsSamples_" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+            }
+            else if (kernelUnderTest == SNR::Kernel::MedianOfMediansAbsoluteDeviation)
+            {
+                if (ordering == SNR::DataOrdering::DMsSamples)
+                {
+                    kernel = isa::OpenCL::compile("medianOfMediansAbsoluteDeviation_DMsSamples_" + std::to_string(options.medianStep), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                }
+                else
+                {
+                    kernel = isa::OpenCL::compile("medianOfMediansAbsoluteDeviation_SamplesDMs_" + std::to_string(options.medianStep), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                }
+            }
+            else if (kernelUnderTest == SNR::Kernel::AbsoluteDeviation)
+            {
+                if (ordering == SNR::DataOrdering::DMsSamples)
+                {
+                    kernel = isa::OpenCL::compile("absolute_deviation_DMsSamples_" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                }
+                else
+                {
+                    kernel = isa::OpenCL::compile("absolute_deviation_SamplesDMs_" + std::to_string(observation.getNrDMs(true) * observation.getNrDMs()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                }
+            }
+            else if (kernelUnderTest == SNR::Kernel::Transpose)
             {
-                kernel = isa::OpenCL::compile("absolute_deviation_DMsSamples_" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                if (ordering == SNR::DataOrdering::DMsSamples)
+                {
+                    kernel = isa::OpenCL::compile("transpose_DMsSamples_" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                }
+                else
+                {
+                    kernel = isa::OpenCL::compile("transpose_SamplesDMs_" + std::to_string(observation.getNrDMs(true) * observation.getNrDMs()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                }
+            }
+            else if (kernelUnderTest == SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation)
+            {
+                kernel = isa::OpenCL::compile("snrMedianOfMediansAbsoluteDeviation_DMsSamples_" + std::to_string(options.medianStep), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+            }
+            else if (kernelUnderTest == SNR::Kernel::SNRBoxcar)
+            {
+                kernel = isa::OpenCL::compile("snrBoxcar_DMsSamples_" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+            }
+            else if (kernelUnderTest == SNR::Kernel::SNRCandidates)
+            {
+                kernel = isa::OpenCL::compile("snrCandidates_DMsSamples_" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+            }
+            else if (kernelUnderTest == SNR::Kernel::SNRBeamMax)
+            {
+                kernel = isa::OpenCL::compile("snrBeamMax_" + std::to_string(observation.getNrDMs(true) * observation.getNrDMs()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+            }
+            else if (kernelUnderTest == SNR::Kernel::SNRTopK)
+            {
+                kernel = isa::OpenCL::compile("snrTopK_DMsSamples_" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+            }
+            else if (kernelUnderTest == SNR::Kernel::SNRDownsampling)
+            {
+                for (unsigned int level = 0; level < options.nrLevels; level++)
+                {
+                    levelKernels.push_back(isa::OpenCL::compile("snrDownsampling_DMsSamples_" + std::to_string(1 << level), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID)));
+                }
             }
         }
-    }
-    catch (isa::OpenCL::OpenCLError &err)
-    {
-        std::cerr << err.what() << std::endl;
-        return 1;
+        catch (isa::OpenCL::OpenCLError &err)
+        {
+            std::cerr << err.what() << std::endl;
+            return 1;
+        }
     }
 
     // Run OpenCL kernel and CPU control
@@ -472,9 +1096,46 @@ int test(const bool printResults, const bool printCode, const unsigned int clPla
     std::vector<outputDataType> medians_control;
     std::vector<outputDataType> absoluteDeviations_control;
     std::vector<outputDataType> stdevs_control;
+    std::vector<outputDataType> snrMomad_control;
+    std::vector<outputDataType> snrBoxcar_control;
+    std::vector<outputDataType> snrBoxcarPeak_control;
+    std::vector<outputDataType> snrDownsampling_control;
+    std::vector<outputDataType> snrDownsamplingPeak_control;
+    std::vector<outputDataType> snrTopK_control;
+    std::vector<outputDataType> snrTopKPeak_control;
+    std::vector<outputDataType> beamMax_control;
+    std::vector<outputDataType> dmMax_control;
+    std::vector<float> streamingBaselines_control;
+    std::vector<float> streamingMADs_control;
+    std::vector<float> runningSNR_control;
     if (kernelUnderTest == SNR::Kernel::MedianOfMedians || kernelUnderTest == SNR::Kernel::MedianOfMediansAbsoluteDeviation)
     {
-        medians_control.resize(observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / medianStep, padding / sizeof(outputDataType)));
+        medians_control.resize(observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / options.medianStep, padding / sizeof(outputDataType)));
+    }
+    else if (kernelUnderTest == SNR::Kernel::MedianOfMediansTwoLevel)
+    {
+        medians_control.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType)));
+    }
+    else if (kernelUnderTest == SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation)
+    {
+        medians_control.resize(observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / options.medianStep, padding / sizeof(outputDataType)));
+        baselines.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType)));
+        snrMomad_control.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType)));
+    }
+    else if (kernelUnderTest == SNR::Kernel::SNRBoxcar)
+    {
+        snrBoxcar_control.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType)));
+        snrBoxcarPeak_control.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType)));
+    }
+    else if (kernelUnderTest == SNR::Kernel::SNRDownsampling)
+    {
+        snrDownsampling_control.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType)));
+        snrDownsamplingPeak_control.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType)));
+    }
+    else if (kernelUnderTest == SNR::Kernel::SNRTopK)
+    {
+        snrTopK_control.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs() * options.nrPeaks, padding / sizeof(outputDataType)));
+        snrTopKPeak_control.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs() * options.nrPeaks, padding / sizeof(outputDataType)));
     }
     else if ( kernelUnderTest == SNR::Kernel::SNRSigmaCut )
     {
@@ -488,152 +1149,658 @@ int test(const bool printResults, const bool printCode, const unsigned int clPla
     {
         stdevs_control.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType)));
     }
-    try
+    if (cpuEngine)
     {
-        cl::NDRange global;
-        cl::NDRange local;
-
-        if ( kernelUnderTest == SNR::Kernel::SNR || kernelUnderTest == SNR::Kernel::SNRSigmaCut || kernelUnderTest == SNR::Kernel::Max || kernelUnderTest == SNR::Kernel::MaxStdSigmaCut )
+        if (kernelUnderTest == SNR::Kernel::SNR && ordering == SNR::DataOrdering::DMsSamples)
         {
-            if (ordering == SNR::DataOrdering::DMsSamples)
+            SNR::snrDMsSamplesCPU(input, output, outputIndex, observation, observation.getNrSamplesPerBatch(), padding);
+        }
+        else if (kernelUnderTest == SNR::Kernel::SNRSigmaCut && ordering == SNR::DataOrdering::DMsSamples && options.maxIterations > 0)
+        {
+            SNR::snrIterativeSigmaCutCPU(input, output, outputIndex, observation, observation.getNrSamplesPerBatch(), padding, options.nSigma, options.maxIterations);
+        }
+        else if (kernelUnderTest == SNR::Kernel::SNRSigmaCut && ordering == SNR::DataOrdering::DMsSamples)
+        {
+            SNR::snrSigmaCutCPU(input, output, outputIndex, observation, observation.getNrSamplesPerBatch(), padding, options.nSigma);
+        }
+        else if (kernelUnderTest == SNR::Kernel::MedianOfMedians && ordering == SNR::DataOrdering::DMsSamples)
+        {
+            SNR::medianOfMediansCPU(options.medianStep, input, output, observation, padding);
+        }
+        else if (kernelUnderTest == SNR::Kernel::MedianOfMediansTwoLevel)
+        {
+            SNR::medianOfMediansTwoLevelCPU(options.medianStep, input, output, observation, padding);
+        }
+        else if (kernelUnderTest == SNR::Kernel::StreamingMedianAbsoluteDeviation)
+        {
+            for (unsigned int batch = 0; batch < options.nrBatches; batch++)
+            {
+                SNR::streamingMedianAbsoluteDeviationCPU(options.nrBins, options.smoothing, input, output, mads, observation, padding);
+            }
+        }
+        else if (kernelUnderTest == SNR::Kernel::SNRRunningStatistics)
+        {
+            for (unsigned int batch = 0; batch < options.nrBatches; batch++)
+            {
+                SNR::snrRunningStatisticsDMsSamplesCPU(input, counters, means, variances, output, outputIndex, observation, observation.getNrSamplesPerBatch(), options.decay, padding);
+            }
+        }
+        else if (kernelUnderTest == SNR::Kernel::MedianOfMediansAbsoluteDeviation && ordering == SNR::DataOrdering::DMsSamples)
+        {
+            SNR::medianOfMediansAbsoluteDeviationCPU(options.medianStep, baselines, input, output, observation, padding);
+        }
+        else if (kernelUnderTest == SNR::Kernel::AbsoluteDeviation && ordering == SNR::DataOrdering::DMsSamples)
+        {
+            SNR::absoluteDeviationCPU(baselines, input, output, observation, padding);
+        }
+        else if (kernelUnderTest == SNR::Kernel::MaxStdSigmaCut && ordering == SNR::DataOrdering::DMsSamples && options.maxIterations > 0)
+        {
+            SNR::maxStdIterativeSigmaCutCPU(input, output, outputIndex, stdevs, observation, padding, options.nSigma, options.maxIterations);
+        }
+        else if (kernelUnderTest == SNR::Kernel::MaxStdSigmaCut && ordering == SNR::DataOrdering::DMsSamples)
+        {
+            SNR::maxStdSigmaCutCPU(input, output, outputIndex, stdevs, observation, padding, options.nSigma);
+        }
+        else if (kernelUnderTest == SNR::Kernel::SNRDownsampling)
+        {
+            SNR::snrDownsamplingCPU(input, output, outputIndex, outputDownsampling, observation, observation.getNrSamplesPerBatch(), options.nrLevels, padding);
+        }
+        else if (kernelUnderTest == SNR::Kernel::SNRCandidates)
+        {
+            SNR::snrCandidatesCPU(input, candidateSNR, candidates, observation, observation.getNrSamplesPerBatch(), options.nSigma, padding);
+        }
+        else if (kernelUnderTest == SNR::Kernel::SNRTopK)
+        {
+            SNR::snrTopKCPU(input, output, outputIndex, observation, observation.getNrSamplesPerBatch(), options.nrPeaks, padding);
+        }
+        else if (kernelUnderTest == SNR::Kernel::SNRBeamMax)
+        {
+            SNR::snrBeamMaxCPU(output, beamSNR, beamDM, dmSNR, dmBeam, observation, padding);
+        }
+        else if (kernelUnderTest == SNR::Kernel::SNRBoxcar)
+        {
+            SNR::snrBoxcarCPU(input, output, outputWidth, outputIndex, observation, observation.getNrSamplesPerBatch(), options.widths, padding);
+        }
+        else if (kernelUnderTest == SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation)
+        {
+            SNR::snrMedianOfMediansAbsoluteDeviationCPU(options.medianStep, input, output, outputIndex, observation, observation.getNrSamplesPerBatch(), padding);
+        }
+        else if (kernelUnderTest == SNR::Kernel::Transpose)
+        {
+            SNR::transpose(input, output, ordering, observation.getNrSynthesizedBeams(), observation.getNrDMs(true) * observation.getNrDMs(), observation.getNrSamplesPerBatch(), padding);
+        }
+        else
+        {
+            std::cerr << "No CPU version available for this kernel." << std::endl;
+            return 1;
+        }
+    }
+    else
+    {
+        try
+        {
+            cl::NDRange global;
+            cl::NDRange local;
+
+            if ( kernelUnderTest == SNR::Kernel::SNR || kernelUnderTest == SNR::Kernel::SNRSigmaCut || kernelUnderTest == SNR::Kernel::Max || kernelUnderTest == SNR::Kernel::MaxStdSigmaCut || kernelUnderTest == SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation || kernelUnderTest == SNR::Kernel::SNRBoxcar || kernelUnderTest == SNR::Kernel::SNRDownsampling || kernelUnderTest == SNR::Kernel::SNRTopK || kernelUnderTest == SNR::Kernel::SNRCandidates || kernelUnderTest == SNR::Kernel::SNRRunningStatistics )
+            {
+                if (ordering == SNR::DataOrdering::DMsSamples)
+                {
+                    if (conf.getNrWorkGroups() > 0)
+                    {
+                        global = cl::NDRange(conf.getNrThreadsD0(), conf.getNrThreadsD1() * conf.getNrWorkGroups(), 1);
+                    }
+                    else
+                    {
+                        global = cl::NDRange(conf.getNrThreadsD0(), observation.getNrDMs(true) * observation.getNrDMs(), observation.getNrSynthesizedBeams());
+                    }
+                    local = cl::NDRange(conf.getNrThreadsD0(), conf.getNrThreadsD1(), 1);
+                }
+                else
+                {
+                    global = cl::NDRange((observation.getNrDMs(true) * observation.getNrDMs()) / conf.getNrItemsD0(), observation.getNrSynthesizedBeams() * conf.getNrThreadsD1());
+                    local = cl::NDRange(conf.getNrThreadsD0(), conf.getNrThreadsD1());
+                }
+            }
+            else if (kernelUnderTest == SNR::Kernel::SNRBeamMax)
+            {
+                global = cl::NDRange(isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), conf.getNrThreadsD0() * conf.getNrItemsD0()) / conf.getNrItemsD0(), 1, 1);
+                local = cl::NDRange(conf.getNrThreadsD0(), 1, 1);
+            }
+            else if (kernelUnderTest == SNR::Kernel::MedianOfMediansTwoLevel || kernelUnderTest == SNR::Kernel::StreamingMedianAbsoluteDeviation)
             {
                 global = cl::NDRange(conf.getNrThreadsD0(), observation.getNrDMs(true) * observation.getNrDMs(), observation.getNrSynthesizedBeams());
                 local = cl::NDRange(conf.getNrThreadsD0(), 1, 1);
             }
+            else if (kernelUnderTest == SNR::Kernel::MedianOfMedians || kernelUnderTest == SNR::Kernel::MedianOfMediansAbsoluteDeviation)
+            {
+                if ((ordering == SNR::DataOrdering::DMsSamples) && (conf.getMedianStrategy() == SNR::MedianStrategy::SortingNetwork))
+                {
+                    global = cl::NDRange((observation.getNrSamplesPerBatch() / options.medianStep) / conf.getNrItemsD0(), observation.getNrDMs(true) * observation.getNrDMs(), observation.getNrSynthesizedBeams());
+                    local = cl::NDRange(conf.getNrThreadsD0(), 1, 1);
+                }
+                else if (ordering == SNR::DataOrdering::DMsSamples)
+                {
+                    global = cl::NDRange(conf.getNrThreadsD0() * (observation.getNrSamplesPerBatch() / options.medianStep), observation.getNrDMs(true) * observation.getNrDMs(), observation.getNrSynthesizedBeams());
+                    local = cl::NDRange(conf.getNrThreadsD0(), 1, 1);
+                }
+                else
+                {
+                    global = cl::NDRange(observation.getNrDMs(true) * observation.getNrDMs(), observation.getNrSamplesPerBatch() / options.medianStep, observation.getNrSynthesizedBeams());
+                    local = cl::NDRange(conf.getNrThreadsD0(), 1, 1);
+                }
+            }
+            else if (kernelUnderTest == SNR::Kernel::AbsoluteDeviation)
+            {
+                if (ordering == SNR::DataOrdering::DMsSamples)
+                {
+                    global = cl::NDRange(observation.getNrSamplesPerBatch() / conf.getNrItemsD0(), observation.getNrDMs(true) * observation.getNrDMs(), observation.getNrSynthesizedBeams());
+                    local = cl::NDRange(conf.getNrThreadsD0(), 1, 1);
+                }
+                else
+                {
+                    global = cl::NDRange((observation.getNrDMs(true) * observation.getNrDMs()) / conf.getNrItemsD0(), observation.getNrSamplesPerBatch(), observation.getNrSynthesizedBeams());
+                    local = cl::NDRange(conf.getNrThreadsD0(), 1, 1);
+                }
+            }
+            else if (kernelUnderTest == SNR::Kernel::Transpose)
+            {
+                if (ordering == SNR::DataOrdering::DMsSamples)
+                {
+                    global = cl::NDRange(isa::utils::pad(observation.getNrSamplesPerBatch(), conf.getNrThreadsD0()), (isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), conf.getNrThreadsD0()) / conf.getNrThreadsD0()) * conf.getNrThreadsD1(), observation.getNrSynthesizedBeams());
+                    local = cl::NDRange(conf.getNrThreadsD0(), conf.getNrThreadsD1(), 1);
+                }
+                else
+                {
+                    global = cl::NDRange(isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), conf.getNrThreadsD0()), (isa::utils::pad(observation.getNrSamplesPerBatch(), conf.getNrThreadsD0()) / conf.getNrThreadsD0()) * conf.getNrThreadsD1(), observation.getNrSynthesizedBeams());
+                    local = cl::NDRange(conf.getNrThreadsD0(), conf.getNrThreadsD1(), 1);
+                }
+            }
+            if ( kernelUnderTest == SNR::Kernel::SNR || kernelUnderTest == SNR::Kernel::SNRSigmaCut || kernelUnderTest == SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation || kernelUnderTest == SNR::Kernel::SNRTopK )
+            {
+                kernel->setArg(0, input_d);
+                kernel->setArg(1, output_d);
+                kernel->setArg(2, outputIndex_d);
+            }
+            else if (kernelUnderTest == SNR::Kernel::SNRRunningStatistics)
+            {
+                kernel->setArg(0, input_d);
+                kernel->setArg(1, output_d);
+                kernel->setArg(2, outputIndex_d);
+                kernel->setArg(3, counters_d);
+                kernel->setArg(4, means_d);
+                kernel->setArg(5, variances_d);
+            }
+            else if (kernelUnderTest == SNR::Kernel::SNRCandidates)
+            {
+                unsigned int nrCandidates = 0;
+
+                openCLRunTime.queues->at(clDeviceID)[0].enqueueWriteBuffer(nrCandidates_d, CL_TRUE, 0, sizeof(unsigned int), reinterpret_cast<void *>(&nrCandidates));
+                kernel->setArg(0, input_d);
+                kernel->setArg(1, nrCandidates_d);
+                kernel->setArg(2, candidateSNR_d);
+                kernel->setArg(3, candidates_d);
+            }
+            else if (kernelUnderTest == SNR::Kernel::SNRBeamMax)
+            {
+                unsigned int counter = 0;
+
+                openCLRunTime.queues->at(clDeviceID)[0].enqueueWriteBuffer(counter_d, CL_TRUE, 0, sizeof(unsigned int), reinterpret_cast<void *>(&counter));
+                kernel->setArg(0, snr_d);
+                kernel->setArg(1, beamSNR_d);
+                kernel->setArg(2, beamDM_d);
+                kernel->setArg(3, dmSNR_d);
+                kernel->setArg(4, dmBeam_d);
+                kernel->setArg(5, partialSNR_d);
+                kernel->setArg(6, partialDM_d);
+                kernel->setArg(7, counter_d);
+            }
+            else if (kernelUnderTest == SNR::Kernel::SNRBoxcar)
+            {
+                kernel->setArg(0, input_d);
+                kernel->setArg(1, output_d);
+                kernel->setArg(2, outputWidth_d);
+                kernel->setArg(3, outputIndex_d);
+            }
+            else if(kernelUnderTest == SNR::Kernel::Max)
+            {
+                kernel->setArg(0, input_d);
+                kernel->setArg(1, output_d);
+                kernel->setArg(2, outputIndex_d);
+            }
+            else if(kernelUnderTest == SNR::Kernel::MaxStdSigmaCut)
+            {
+                kernel->setArg(0, input_d);
+                kernel->setArg(1, output_d);
+                kernel->setArg(2, outputIndex_d);
+                kernel->setArg(3, stdevs_d);
+            }
+            else if (kernelUnderTest == SNR::Kernel::MedianOfMedians || kernelUnderTest == SNR::Kernel::MedianOfMediansTwoLevel)
+            {
+                kernel->setArg(0, input_d);
+                kernel->setArg(1, output_d);
+            }
+            else if (kernelUnderTest == SNR::Kernel::StreamingMedianAbsoluteDeviation)
+            {
+                kernel->setArg(0, input_d);
+                kernel->setArg(1, output_d);
+                kernel->setArg(2, mads_d);
+            }
+            else if (kernelUnderTest == SNR::Kernel::MedianOfMediansAbsoluteDeviation)
+            {
+                kernel->setArg(0, baselines_d);
+                kernel->setArg(1, input_d);
+                kernel->setArg(2, output_d);
+            }
+            else if (kernelUnderTest == SNR::Kernel::AbsoluteDeviation)
+            {
+                kernel->setArg(0, baselines_d);
+                kernel->setArg(1, input_d);
+                kernel->setArg(2, output_d);
+            }
+            else if (kernelUnderTest == SNR::Kernel::Transpose)
+            {
+                kernel->setArg(0, input_d);
+                kernel->setArg(1, output_d);
+            }
+            else if (kernelUnderTest == SNR::Kernel::SNRDownsampling)
+            {
+                // Every level reads the output of the previous one
+                for (unsigned int level = 0; level < options.nrLevels; level++)
+                {
+                    if (level == 0)
+                    {
+                        levelKernels.at(level)->setArg(0, input_d);
+                    }
+                    else
+                    {
+                        levelKernels.at(level)->setArg(0, downsampled_d[(level - 1) % 2]);
+                    }
+                    levelKernels.at(level)->setArg(1, downsampled_d[level % 2]);
+                    levelKernels.at(level)->setArg(2, output_d);
+                    levelKernels.at(level)->setArg(3, outputIndex_d);
+                    levelKernels.at(level)->setArg(4, outputDownsampling_d);
+                    openCLRunTime.queues->at(clDeviceID)[0].enqueueNDRangeKernel(*(levelKernels.at(level)), cl::NullRange, global, local, 0, 0);
+                }
+            }
+            if (kernelUnderTest == SNR::Kernel::StreamingMedianAbsoluteDeviation || kernelUnderTest == SNR::Kernel::SNRRunningStatistics)
+            {
+                // The state in device memory is carried from one batch to the next
+                for (unsigned int batch = 0; batch < options.nrBatches; batch++)
+                {
+                    openCLRunTime.queues->at(clDeviceID)[0].enqueueNDRangeKernel(*kernel, cl::NullRange, global, local, 0, 0);
+                }
+            }
+            else if (kernelUnderTest != SNR::Kernel::SNRDownsampling)
+            {
+                openCLRunTime.queues->at(clDeviceID)[0].enqueueNDRangeKernel(*kernel, cl::NullRange, global, local, 0, 0);
+            }
+            if (kernelUnderTest == SNR::Kernel::SNRCandidates)
+            {
+                // Only the candidates that were found are copied back
+                unsigned int nrCandidates = 0;
+
+                openCLRunTime.queues->at(clDeviceID)[0].enqueueReadBuffer(nrCandidates_d, CL_TRUE, 0, sizeof(unsigned int), reinterpret_cast<void *>(&nrCandidates));
+                candidateSNR.resize(std::min(nrCandidates, static_cast<unsigned int>(candidateSNR.size())));
+                candidates.resize(candidateSNR.size() * 3);
+                if (candidateSNR.size() > 0)
+                {
+                    openCLRunTime.queues->at(clDeviceID)[0].enqueueReadBuffer(candidateSNR_d, CL_TRUE, 0, candidateSNR.size() * sizeof(float), reinterpret_cast<void *>(candidateSNR.data()));
+                    openCLRunTime.queues->at(clDeviceID)[0].enqueueReadBuffer(candidates_d, CL_TRUE, 0, candidates.size() * sizeof(unsigned int), reinterpret_cast<void *>(candidates.data()));
+                }
+            }
+            else if (kernelUnderTest == SNR::Kernel::SNRBeamMax)
+            {
+                openCLRunTime.queues->at(clDeviceID)[0].enqueueReadBuffer(beamSNR_d, CL_TRUE, 0, beamSNR.size() * sizeof(float), reinterpret_cast<void *>(beamSNR.data()));
+                openCLRunTime.queues->at(clDeviceID)[0].enqueueReadBuffer(beamDM_d, CL_TRUE, 0, beamDM.size() * sizeof(unsigned int), reinterpret_cast<void *>(beamDM.data()));
+                openCLRunTime.queues->at(clDeviceID)[0].enqueueReadBuffer(dmSNR_d, CL_TRUE, 0, dmSNR.size() * sizeof(float), reinterpret_cast<void *>(dmSNR.data()));
+                openCLRunTime.queues->at(clDeviceID)[0].enqueueReadBuffer(dmBeam_d, CL_TRUE, 0, dmBeam.size() * sizeof(unsigned int), reinterpret_cast<void *>(dmBeam.data()));
+            }
             else
             {
-                global = cl::NDRange((observation.getNrDMs(true) * observation.getNrDMs()) / conf.getNrItemsD0(), observation.getNrSynthesizedBeams());
-                local = cl::NDRange(conf.getNrThreadsD0(), 1);
+                openCLRunTime.queues->at(clDeviceID)[0].enqueueReadBuffer(output_d, CL_TRUE, 0, output.size() * sizeof(outputDataType), reinterpret_cast<void *>(output.data()));
+            }
+            if (kernelUnderTest == SNR::Kernel::SNR || kernelUnderTest == SNR::Kernel::SNRSigmaCut || kernelUnderTest == SNR::Kernel::Max || kernelUnderTest == SNR::Kernel::MaxStdSigmaCut || kernelUnderTest == SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation || kernelUnderTest == SNR::Kernel::SNRBoxcar || kernelUnderTest == SNR::Kernel::SNRDownsampling || kernelUnderTest == SNR::Kernel::SNRTopK || kernelUnderTest == SNR::Kernel::SNRRunningStatistics)
+            {
+                openCLRunTime.queues->at(clDeviceID)[0].enqueueReadBuffer(outputIndex_d, CL_TRUE, 0, outputIndex.size() * sizeof(unsigned int), reinterpret_cast<void *>(outputIndex.data()));
+            }
+            if (kernelUnderTest == SNR::Kernel::SNRBoxcar)
+            {
+                openCLRunTime.queues->at(clDeviceID)[0].enqueueReadBuffer(outputWidth_d, CL_TRUE, 0, outputWidth.size() * sizeof(unsigned int), reinterpret_cast<void *>(outputWidth.data()));
+            }
+            if (kernelUnderTest == SNR::Kernel::SNRDownsampling)
+            {
+                openCLRunTime.queues->at(clDeviceID)[0].enqueueReadBuffer(outputDownsampling_d, CL_TRUE, 0, outputDownsampling.size() * sizeof(unsigned int), reinterpret_cast<void *>(outputDownsampling.data()));
+            }
+            if (kernelUnderTest == SNR::Kernel::StreamingMedianAbsoluteDeviation)
+            {
+                openCLRunTime.queues->at(clDeviceID)[0].enqueueReadBuffer(mads_d, CL_TRUE, 0, mads.size() * sizeof(float), reinterpret_cast<void *>(mads.data()));
+            }
+            if (kernelUnderTest == SNR::Kernel::MaxStdSigmaCut)
+            {
+                openCLRunTime.queues->at(clDeviceID)[0].enqueueReadBuffer(stdevs_d, CL_TRUE, 0, stdevs.size() * sizeof(outputDataType), reinterpret_cast<void *>(stdevs.data()));
             }
+
         }
-        else if (kernelUnderTest == SNR::Kernel::MedianOfMedians || kernelUnderTest == SNR::Kernel::MedianOfMediansAbsoluteDeviation)
+        catch (cl::Error &err)
         {
-            if (ordering == SNR::DataOrdering::DMsSamples)
+            std::cerr << "OpenCL error: " << std::to_string(err.err()) << "." << std::endl;
+            return 1;
+        }
+    }
+    if (kernelUnderTest == SNR::Kernel::SNRCandidates)
+    {
+        // The candidates are scattered in the dense outputs, DMs without a candidate have an invalid sample
+        std::fill(output.begin(), output.end(), static_cast<outputDataType>(0));
+        std::fill(outputIndex.begin(), outputIndex.end(), observation.getNrSamplesPerBatch());
+        for (unsigned int candidate = 0; candidate < candidateSNR.size(); candidate++)
+        {
+            output.at((candidates.at(candidate * 3) * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + candidates.at((candidate * 3) + 1)) = candidateSNR.at(candidate);
+            outputIndex.at((candidates.at(candidate * 3) * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + candidates.at((candidate * 3) + 1)) = candidates.at((candidate * 3) + 2);
+        }
+    }
+    // The CPU controls work on data in DMs-samples order
+    if (ordering == SNR::DataOrdering::SamplesDMs)
+    {
+        transposeToDMsSamples(input, observation.getNrSynthesizedBeams(), observation.getNrDMs(true) * observation.getNrDMs(), observation.getNrSamplesPerBatch(), padding);
+        if (((kernelUnderTest == SNR::Kernel::MedianOfMedians) && (options.medianStep != observation.getNrSamplesPerBatch())) || (kernelUnderTest == SNR::Kernel::MedianOfMediansAbsoluteDeviation))
+        {
+            transposeToDMsSamples(output, observation.getNrSynthesizedBeams(), observation.getNrDMs(true) * observation.getNrDMs(), observation.getNrSamplesPerBatch() / options.medianStep, padding);
+        }
+        else if (kernelUnderTest == SNR::Kernel::AbsoluteDeviation)
+        {
+            transposeToDMsSamples(output, observation.getNrSynthesizedBeams(), observation.getNrDMs(true) * observation.getNrDMs(), observation.getNrSamplesPerBatch(), padding);
+        }
+    }
+    else if (kernelUnderTest == SNR::Kernel::Transpose)
+    {
+        // The transposed output is brought back to the input order, and compared with the input
+        transposeToDMsSamples(output, observation.getNrSynthesizedBeams(), observation.getNrDMs(true) * observation.getNrDMs(), observation.getNrSamplesPerBatch(), padding);
+    }
+    if (kernelUnderTest == SNR::Kernel::SNR || kernelUnderTest == SNR::Kernel::SNRCandidates)
+    {
+        for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+        {
+            for (unsigned int subbandingDM = 0; subbandingDM < observation.getNrDMs(true); subbandingDM++)
             {
-                global = cl::NDRange(conf.getNrThreadsD0() * (observation.getNrSamplesPerBatch() / medianStep), observation.getNrDMs(true) * observation.getNrDMs(), observation.getNrSynthesizedBeams());
-                local = cl::NDRange(conf.getNrThreadsD0(), 1, 1);
+                for (unsigned int dm = 0; dm < observation.getNrDMs(); dm++)
+                {
+                    control[(beam * observation.getNrDMs(true) * observation.getNrDMs()) + (subbandingDM * observation.getNrDMs()) + dm] = isa::utils::Statistics<inputDataType>();
+                }
+            }
+            for (unsigned int subbandingDM = 0; subbandingDM < observation.getNrDMs(true); subbandingDM++)
+            {
+                for (unsigned int dm = 0; dm < observation.getNrDMs(); dm++)
+                {
+                    for (unsigned int sample = 0; sample < observation.getNrSamplesPerBatch(); sample++)
+                    {
+                        control[(beam * observation.getNrDMs(true) * observation.getNrDMs()) + (subbandingDM * observation.getNrDMs()) + dm].addElement(input[(beam * observation.getNrDMs(true) * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + (subbandingDM * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + (dm * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + sample]);
+                    }
+                }
+            }
+        }
+    }
+    else if ((kernelUnderTest == SNR::Kernel::SNRSigmaCut) && (options.maxIterations > 0))
+    {
+        SNR::snrIterativeSigmaCut<outputDataType>(input, snrSigmaCut_control, observation, padding, options.nSigma, options.maxIterations);
+    }
+    else if ( kernelUnderTest == SNR::Kernel::SNRSigmaCut )
+    {
+        SNR::snrSigmaCut<outputDataType>(input, snrSigmaCut_control, observation, padding, options.nSigma);
+    }
+    else if (kernelUnderTest == SNR::Kernel::MedianOfMedians)
+    {
+        SNR::medianOfMedians(options.medianStep, input, medians_control, observation, padding);
+    }
+    else if (kernelUnderTest == SNR::Kernel::MedianOfMediansTwoLevel)
+    {
+        SNR::medianOfMediansTwoLevel(options.medianStep, input, medians_control, observation, padding);
+    }
+    else if (kernelUnderTest == SNR::Kernel::StreamingMedianAbsoluteDeviation)
+    {
+        // The approximated estimators are compared with exact medians and the same state update
+        streamingBaselines_control.resize(output.size());
+        streamingMADs_control.resize(mads.size());
+        for (unsigned int batch = 0; batch < options.nrBatches; batch++)
+        {
+            SNR::streamingMedianAbsoluteDeviation(options.smoothing, input, streamingBaselines_control, streamingMADs_control, observation, padding);
+        }
+    }
+    else if (kernelUnderTest == SNR::Kernel::SNRRunningStatistics)
+    {
+        // The control has its own state, that receives the same batches
+        std::vector<float> counters_control(counters.size());
+        std::vector<float> means_control(means.size());
+        std::vector<float> variances_control(variances.size());
+
+        runningSNR_control.resize(output.size());
+        for (unsigned int batch = 0; batch < options.nrBatches; batch++)
+        {
+            SNR::snrRunningStatistics(options.decay, input, counters_control, means_control, variances_control, runningSNR_control, observation, padding);
+        }
+    }
+    else if (kernelUnderTest == SNR::Kernel::MedianOfMediansAbsoluteDeviation)
+    {
+        SNR::medianOfMediansAbsoluteDeviation(options.medianStep, baselines, input, medians_control, observation, padding);
+    }
+    else if (kernelUnderTest == SNR::Kernel::AbsoluteDeviation)
+    {
+        SNR::absoluteDeviation(baselines, input, absoluteDeviations_control, observation, padding);
+    }
+    else if ((kernelUnderTest == SNR::Kernel::MaxStdSigmaCut) && (options.maxIterations > 0))
+    {
+        SNR::stdIterativeSigmaCut(input, stdevs_control, observation, padding, options.nSigma, options.maxIterations);
+    }
+    else if (kernelUnderTest == SNR::Kernel::MaxStdSigmaCut)
+    {
+        SNR::stdSigmaCut(input, stdevs_control, observation, padding, options.nSigma);
+    }
+    else if (kernelUnderTest == SNR::Kernel::SNRDownsampling)
+    {
+        // Every level is computed from the input, and the peak found by the kernel must be a maximum of the level with the highest SNR
+        for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+        {
+            for (unsigned int subbandingDM = 0; subbandingDM < observation.getNrDMs(true); subbandingDM++)
+            {
+                for (unsigned int dm = 0; dm < observation.getNrDMs(); dm++)
+                {
+                    double maxSNR = -std::numeric_limits<double>::max();
+                    double peakSNR = -std::numeric_limits<double>::max();
+
+                    for (unsigned int level = 0; level < options.nrLevels; level++)
+                    {
+                        unsigned int downsampling = 1 << level;
+                        unsigned int levelSamples = observation.getNrSamplesPerBatch() >> level;
+                        std::vector<double> levelSeries(levelSamples, 0.0);
+                        double mean = 0.0;
+                        double variance = 0.0;
+                        double levelSNR = 0.0;
+
+                        for (unsigned int sample = 0; sample < levelSamples; sample++)
+                        {
+                            for (unsigned int item = sample * downsampling; item < (sample + 1) * downsampling; item++)
+                            {
+                                levelSeries.at(sample) += input.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + (subbandingDM * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + (dm * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + item);
+                            }
+                            mean += levelSeries.at(sample);
+                        }
+                        mean /= levelSamples;
+                        for (unsigned int sample = 0; sample < levelSamples; sample++)
+                        {
+                            variance += (levelSeries.at(sample) - mean) * (levelSeries.at(sample) - mean);
+                        }
+                        levelSNR = (*std::max_element(levelSeries.begin(), levelSeries.end()) - mean) / std::sqrt(variance / (levelSamples - 1));
+                        if (levelSNR > maxSNR)
+                        {
+                            maxSNR = levelSNR;
+                        }
+                        if ((downsampling == outputDownsampling.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm)) && ((outputIndex.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm) % downsampling) == 0) && ((outputIndex.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm) / downsampling) < levelSamples))
+                        {
+                            if (levelSeries.at(outputIndex.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm) / downsampling) == *std::max_element(levelSeries.begin(), levelSeries.end()))
+                            {
+                                peakSNR = levelSNR;
+                            }
+                        }
+                    }
+                    snrDownsampling_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm) = maxSNR;
+                    snrDownsamplingPeak_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm) = peakSNR;
+                }
+            }
+        }
+    }
+    else if (kernelUnderTest == SNR::Kernel::SNRTopK)
+    {
+        // The peaks are the highest samples of the sorted time series, and the samples found by the kernel must have the same SNR
+        std::vector<double> sortedSeries(observation.getNrSamplesPerBatch());
+
+        for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+        {
+            for (unsigned int subbandingDM = 0; subbandingDM < observation.getNrDMs(true); subbandingDM++)
+            {
+                for (unsigned int dm = 0; dm < observation.getNrDMs(); dm++)
+                {
+                    double mean = 0.0;
+                    double variance = 0.0;
+
+                    for (unsigned int sample = 0; sample < observation.getNrSamplesPerBatch(); sample++)
+                    {
+                        sortedSeries.at(sample) = input.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + (subbandingDM * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + (dm * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + sample);
+                        mean += sortedSeries.at(sample);
+                    }
+                    mean /= observation.getNrSamplesPerBatch();
+                    for (unsigned int sample = 0; sample < observation.getNrSamplesPerBatch(); sample++)
+                    {
+                        variance += (sortedSeries.at(sample) - mean) * (sortedSeries.at(sample) - mean);
+                    }
+                    std::sort(sortedSeries.begin(), sortedSeries.end(), std::greater<double>());
+                    for (unsigned int peak = 0; peak < options.nrPeaks; peak++)
+                    {
+                        snrTopK_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs() * options.nrPeaks, padding / sizeof(outputDataType))) + (((subbandingDM * observation.getNrDMs()) + dm) * options.nrPeaks) + peak) = (sortedSeries.at(peak) - mean) / std::sqrt(variance / (observation.getNrSamplesPerBatch() - 1));
+                        if (outputIndex.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs() * options.nrPeaks, padding / sizeof(unsigned int))) + (((subbandingDM * observation.getNrDMs()) + dm) * options.nrPeaks) + peak) < observation.getNrSamplesPerBatch())
+                        {
+                            snrTopKPeak_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs() * options.nrPeaks, padding / sizeof(outputDataType))) + (((subbandingDM * observation.getNrDMs()) + dm) * options.nrPeaks) + peak) = (input.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + (subbandingDM * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + (dm * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + outputIndex.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs() * options.nrPeaks, padding / sizeof(unsigned int))) + (((subbandingDM * observation.getNrDMs()) + dm) * options.nrPeaks) + peak)) - mean) / std::sqrt(variance / (observation.getNrSamplesPerBatch() - 1));
+                        }
+                        else
+                        {
+                            snrTopKPeak_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs() * options.nrPeaks, padding / sizeof(outputDataType))) + (((subbandingDM * observation.getNrDMs()) + dm) * options.nrPeaks) + peak) = -std::numeric_limits<outputDataType>::max();
+                        }
+                    }
+                }
             }
         }
-        else if (kernelUnderTest == SNR::Kernel::AbsoluteDeviation)
+    }
+    else if (kernelUnderTest == SNR::Kernel::SNRBeamMax)
+    {
+        // The maxima are found directly in the SNR map
+        beamMax_control.resize(observation.getNrSynthesizedBeams(), -std::numeric_limits<outputDataType>::max());
+        dmMax_control.resize(observation.getNrDMs(true) * observation.getNrDMs(), -std::numeric_limits<outputDataType>::max());
+        for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
         {
-            if (ordering == SNR::DataOrdering::DMsSamples)
+            for (unsigned int dm = 0; dm < observation.getNrDMs(true) * observation.getNrDMs(); dm++)
             {
-                global = cl::NDRange(observation.getNrSamplesPerBatch() / conf.getNrItemsD0(), observation.getNrDMs(true) * observation.getNrDMs(), observation.getNrSynthesizedBeams());
-                local = cl::NDRange(conf.getNrThreadsD0(), 1, 1);
+                beamMax_control.at(beam) = std::max(beamMax_control.at(beam), output.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + dm));
+                dmMax_control.at(dm) = std::max(dmMax_control.at(dm), output.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + dm));
             }
         }
-        if ( kernelUnderTest == SNR::Kernel::SNR || kernelUnderTest == SNR::Kernel::SNRSigmaCut )
-        {
-            kernel->setArg(0, input_d);
-            kernel->setArg(1, output_d);
-            kernel->setArg(2, outputIndex_d);
-        }
-        else if(kernelUnderTest == SNR::Kernel::Max)
-        {
-            kernel->setArg(0, input_d);
-            kernel->setArg(1, output_d);
-            kernel->setArg(2, outputIndex_d);
-        }
-        else if(kernelUnderTest == SNR::Kernel::MaxStdSigmaCut)
-        {
-            kernel->setArg(0, input_d);
-            kernel->setArg(1, output_d);
-            kernel->setArg(2, outputIndex_d);
-            kernel->setArg(3, stdevs_d);
-        }
-        else if (kernelUnderTest == SNR::Kernel::MedianOfMedians)
-        {
-            kernel->setArg(0, input_d);
-            kernel->setArg(1, output_d);
-        }
-        else if (kernelUnderTest == SNR::Kernel::MedianOfMediansAbsoluteDeviation)
-        {
-            kernel->setArg(0, baselines_d);
-            kernel->setArg(1, input_d);
-            kernel->setArg(2, output_d);
-        }
-        else if (kernelUnderTest == SNR::Kernel::AbsoluteDeviation)
-        {
-            kernel->setArg(0, baselines_d);
-            kernel->setArg(1, input_d);
-            kernel->setArg(2, output_d);
-        }
-        openCLRunTime.queues->at(clDeviceID)[0].enqueueNDRangeKernel(*kernel, cl::NullRange, global, local, 0, 0);
-        openCLRunTime.queues->at(clDeviceID)[0].enqueueReadBuffer(output_d, CL_TRUE, 0, output.size() * sizeof(outputDataType), reinterpret_cast<void *>(output.data()));
-        if (kernelUnderTest == SNR::Kernel::SNR || kernelUnderTest == SNR::Kernel::SNRSigmaCut || kernelUnderTest == SNR::Kernel::Max || kernelUnderTest == SNR::Kernel::MaxStdSigmaCut)
-        {
-            openCLRunTime.queues->at(clDeviceID)[0].enqueueReadBuffer(outputIndex_d, CL_TRUE, 0, outputIndex.size() * sizeof(unsigned int), reinterpret_cast<void *>(outputIndex.data()));
-        }
-        if (kernelUnderTest == SNR::Kernel::MaxStdSigmaCut)
-        {
-            openCLRunTime.queues->at(clDeviceID)[0].enqueueReadBuffer(stdevs_d, CL_TRUE, 0, stdevs.size() * sizeof(outputDataType), reinterpret_cast<void *>(stdevs.data()));
-        }
-
-    }
-    catch (cl::Error &err)
-    {
-        std::cerr << "OpenCL error: " << std::to_string(err.err()) << "." << std::endl;
-        return 1;
     }
-    if (kernelUnderTest == SNR::Kernel::SNR)
+    else if (kernelUnderTest == SNR::Kernel::SNRBoxcar)
     {
+        // Every boxcar is summed directly, and the boxcar found by the kernel must have the highest SNR
         for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
         {
             for (unsigned int subbandingDM = 0; subbandingDM < observation.getNrDMs(true); subbandingDM++)
             {
                 for (unsigned int dm = 0; dm < observation.getNrDMs(); dm++)
                 {
-                    control[(beam * observation.getNrDMs(true) * observation.getNrDMs()) + (subbandingDM * observation.getNrDMs()) + dm] = isa::utils::Statistics<inputDataType>();
+                    uint64_t timeSeries = (beam * observation.getNrDMs(true) * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + (subbandingDM * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + (dm * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType)));
+                    double mean = 0.0;
+                    double variance = 0.0;
+                    double standardDeviation = 0.0;
+                    double maxSNR = -std::numeric_limits<double>::max();
+                    double peakSNR = -std::numeric_limits<double>::max();
+
+                    for (unsigned int sample = 0; sample < observation.getNrSamplesPerBatch(); sample++)
+                    {
+                        mean += input.at(timeSeries + sample);
+                    }
+                    mean /= observation.getNrSamplesPerBatch();
+                    for (unsigned int sample = 0; sample < observation.getNrSamplesPerBatch(); sample++)
+                    {
+                        variance += (input.at(timeSeries + sample) - mean) * (input.at(timeSeries + sample) - mean);
+                    }
+                    standardDeviation = std::sqrt(variance / (observation.getNrSamplesPerBatch() - 1));
+                    for (auto width = options.widths.begin(); width != options.widths.end(); ++width)
+                    {
+                        for (unsigned int sample = 0; sample + *width <= observation.getNrSamplesPerBatch(); sample++)
+                        {
+                            double boxcar = 0.0;
+
+                            for (unsigned int item = sample; item < sample + *width; item++)
+                            {
+                                boxcar += input.at(timeSeries + item) - mean;
+                            }
+                            boxcar /= standardDeviation * std::sqrt(*width);
+                            if (boxcar > maxSNR)
+                            {
+                                maxSNR = boxcar;
+                            }
+                            if ((*width == outputWidth.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm)) && (sample == outputIndex.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm)))
+                            {
+                                peakSNR = boxcar;
+                            }
+                        }
+                    }
+                    snrBoxcar_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm) = maxSNR;
+                    snrBoxcarPeak_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm) = peakSNR;
                 }
             }
-            if (ordering == SNR::DataOrdering::DMsSamples)
+        }
+    }
+    else if (kernelUnderTest == SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation)
+    {
+        // The fused kernel is compared with the median of medians and the median of medians absolute deviation computed one after the other
+        std::vector<outputDataType> stepMedians(observation.getNrSamplesPerBatch() / options.medianStep);
+
+        SNR::medianOfMedians(options.medianStep, input, medians_control, observation, padding);
+        for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+        {
+            for (unsigned int subbandingDM = 0; subbandingDM < observation.getNrDMs(true); subbandingDM++)
             {
-                for (unsigned int subbandingDM = 0; subbandingDM < observation.getNrDMs(true); subbandingDM++)
+                for (unsigned int dm = 0; dm < observation.getNrDMs(); dm++)
                 {
-                    for (unsigned int dm = 0; dm < observation.getNrDMs(); dm++)
+                    for (unsigned int step = 0; step < observation.getNrSamplesPerBatch() / options.medianStep; step++)
                     {
-                        for (unsigned int sample = 0; sample < observation.getNrSamplesPerBatch(); sample++)
+                        if (options.medianStep == observation.getNrSamplesPerBatch())
+                        {
+                            stepMedians.at(step) = medians_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm);
+                        }
+                        else
                         {
-                            control[(beam * observation.getNrDMs(true) * observation.getNrDMs()) + (subbandingDM * observation.getNrDMs()) + dm].addElement(input[(beam * observation.getNrDMs(true) * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + (subbandingDM * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + (dm * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + sample]);
+                            stepMedians.at(step) = medians_control.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / options.medianStep, padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / options.medianStep, padding / sizeof(outputDataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / options.medianStep, padding / sizeof(outputDataType))) + step);
                         }
                     }
+                    std::sort(stepMedians.begin(), stepMedians.end());
+                    baselines.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm) = stepMedians.at(stepMedians.size() / 2);
                 }
             }
-            else
+        }
+        SNR::medianOfMediansAbsoluteDeviation(options.medianStep, baselines, input, medians_control, observation, padding);
+        for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
+        {
+            for (unsigned int subbandingDM = 0; subbandingDM < observation.getNrDMs(true); subbandingDM++)
             {
-                for (unsigned int sample = 0; sample < observation.getNrSamplesPerBatch(); sample++)
+                for (unsigned int dm = 0; dm < observation.getNrDMs(); dm++)
                 {
-                    for (unsigned int subbandingDM = 0; subbandingDM < observation.getNrDMs(true); subbandingDM++)
+                    for (unsigned int step = 0; step < observation.getNrSamplesPerBatch() / options.medianStep; step++)
                     {
-                        for (unsigned int dm = 0; dm < observation.getNrDMs(); dm++)
-                        {
-                            control[(beam * observation.getNrDMs(true) * observation.getNrDMs()) + (subbandingDM * observation.getNrDMs()) + dm].addElement(input[(beam * observation.getNrSamplesPerBatch() * observation.getNrDMs(true) * observation.getNrDMs(false, padding / sizeof(inputDataType))) + (sample * observation.getNrDMs(true) * observation.getNrDMs(false, padding / sizeof(inputDataType))) + (subbandingDM * observation.getNrDMs(false, padding / sizeof(inputDataType))) + dm]);
-                        }
+                        stepMedians.at(step) = medians_control.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / options.medianStep, padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / options.medianStep, padding / sizeof(outputDataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / options.medianStep, padding / sizeof(outputDataType))) + step);
                     }
+                    std::sort(stepMedians.begin(), stepMedians.end());
+                    snrMomad_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm) = (input.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + (subbandingDM * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + (dm * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + maxSample.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm)) - baselines.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm)) / (stepMedians.at(stepMedians.size() / 2) * 1.4826f);
                 }
             }
         }
     }
-    else if ( kernelUnderTest == SNR::Kernel::SNRSigmaCut )
-    {
-        SNR::snrSigmaCut<outputDataType>(input, snrSigmaCut_control, observation, padding, nSigma);
-    }
-    else if (kernelUnderTest == SNR::Kernel::MedianOfMedians)
-    {
-        SNR::medianOfMedians(medianStep, input, medians_control, observation, padding);
-    }
-    else if (kernelUnderTest == SNR::Kernel::MedianOfMediansAbsoluteDeviation)
-    {
-        SNR::medianOfMediansAbsoluteDeviation(medianStep, baselines, input, medians_control, observation, padding);
-    }
-    else if (kernelUnderTest == SNR::Kernel::AbsoluteDeviation)
-    {
-        SNR::absoluteDeviation(baselines, input, absoluteDeviations_control, observation, padding);
-    }
-    else if (kernelUnderTest == SNR::Kernel::MaxStdSigmaCut)
-    {
-        SNR::stdSigmaCut(input, stdevs_control, observation, padding, nSigma);
-    }
 
     for (unsigned int beam = 0; beam < observation.getNrSynthesizedBeams(); beam++)
     {
@@ -652,6 +1819,25 @@ int test(const bool printResults, const bool printCode, const unsigned int clPla
                         wrongPositions++;
                     }
                 }
+                else if (kernelUnderTest == SNR::Kernel::SNRCandidates)
+                {
+                    if ((control[(beam * observation.getNrDMs(true) * observation.getNrDMs()) + (subbandingDM * observation.getNrDMs()) + dm].getMax() - control[(beam * observation.getNrDMs(true) * observation.getNrDMs()) + (subbandingDM * observation.getNrDMs()) + dm].getMean()) / control[(beam * observation.getNrDMs(true) * observation.getNrDMs()) + (subbandingDM * observation.getNrDMs()) + dm].getStandardDeviation() >= options.nSigma)
+                    {
+                        if (!isa::utils::same(output[(beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm], static_cast<outputDataType>((control[(beam * observation.getNrDMs(true) * observation.getNrDMs()) + (subbandingDM * observation.getNrDMs()) + dm].getMax() - control[(beam * observation.getNrDMs(true) * observation.getNrDMs()) + (subbandingDM * observation.getNrDMs()) + dm].getMean()) / control[(beam * observation.getNrDMs(true) * observation.getNrDMs()) + (subbandingDM * observation.getNrDMs()) + dm].getStandardDeviation()), static_cast<outputDataType>(1e-2)))
+                        {
+                            wrongSamples++;
+                        }
+                        if (outputIndex.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm) != maxSample.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm))
+                        {
+                            wrongPositions++;
+                        }
+                    }
+                    else if (outputIndex.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm) != observation.getNrSamplesPerBatch())
+                    {
+                        // A candidate below the threshold
+                        wrongSamples++;
+                    }
+                }
                 else if ( kernelUnderTest == SNR::Kernel::SNRSigmaCut )
                 {
                     if (!isa::utils::same(output[(beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm], snrSigmaCut_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm), static_cast<outputDataType>(1e-2)))
@@ -663,6 +1849,113 @@ int test(const bool printResults, const bool printCode, const unsigned int clPla
                         wrongPositions++;
                     }
                 }
+                else if (kernelUnderTest == SNR::Kernel::SNRDownsampling)
+                {
+                    if (!isa::utils::same(output[(beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm], snrDownsampling_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm), static_cast<outputDataType>(1e-2)))
+                    {
+                        wrongSamples++;
+                    }
+                    if (!isa::utils::same(snrDownsamplingPeak_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm), snrDownsampling_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm), static_cast<outputDataType>(1e-2)))
+                    {
+                        wrongPositions++;
+                    }
+                }
+                else if (kernelUnderTest == SNR::Kernel::SNRTopK)
+                {
+                    bool wrongSNR = false;
+                    bool wrongPeak = false;
+
+                    for (unsigned int peak = 0; peak < options.nrPeaks; peak++)
+                    {
+                        if (!isa::utils::same(output[(beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs() * options.nrPeaks, padding / sizeof(outputDataType))) + (((subbandingDM * observation.getNrDMs()) + dm) * options.nrPeaks) + peak], snrTopK_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs() * options.nrPeaks, padding / sizeof(outputDataType))) + (((subbandingDM * observation.getNrDMs()) + dm) * options.nrPeaks) + peak), static_cast<outputDataType>(1e-2)))
+                        {
+                            wrongSNR = true;
+                        }
+                        // Samples with the same value are all correct positions
+                        if (!isa::utils::same(snrTopKPeak_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs() * options.nrPeaks, padding / sizeof(outputDataType))) + (((subbandingDM * observation.getNrDMs()) + dm) * options.nrPeaks) + peak), snrTopK_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs() * options.nrPeaks, padding / sizeof(outputDataType))) + (((subbandingDM * observation.getNrDMs()) + dm) * options.nrPeaks) + peak), static_cast<outputDataType>(1e-2)))
+                        {
+                            wrongPeak = true;
+                        }
+                    }
+                    if (wrongSNR)
+                    {
+                        wrongSamples++;
+                    }
+                    if (wrongPeak)
+                    {
+                        wrongPositions++;
+                    }
+                }
+                else if (kernelUnderTest == SNR::Kernel::StreamingMedianAbsoluteDeviation)
+                {
+                    // The histograms are accurate to about one bin, that is eight median absolute deviations divided by the number of bins
+                    const float tolerance = (16.0f * streamingMADs_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float))) + (subbandingDM * observation.getNrDMs()) + dm)) / options.nrBins;
+
+                    if (!isa::utils::same(output[(beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float))) + (subbandingDM * observation.getNrDMs()) + dm], streamingBaselines_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float))) + (subbandingDM * observation.getNrDMs()) + dm), tolerance) || !isa::utils::same(mads.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float))) + (subbandingDM * observation.getNrDMs()) + dm), streamingMADs_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float))) + (subbandingDM * observation.getNrDMs()) + dm), tolerance))
+                    {
+                        wrongSamples++;
+                    }
+                }
+                else if (kernelUnderTest == SNR::Kernel::SNRRunningStatistics)
+                {
+                    if (!isa::utils::same(output[(beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float))) + (subbandingDM * observation.getNrDMs()) + dm], runningSNR_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float))) + (subbandingDM * observation.getNrDMs()) + dm), 1e-2f))
+                    {
+                        wrongSamples++;
+                    }
+                    if (outputIndex.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm) != maxSample.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm))
+                    {
+                        wrongPositions++;
+                    }
+                }
+                else if (kernelUnderTest == SNR::Kernel::SNRBeamMax)
+                {
+                    // Every beam is checked at its first DM, and every DM at the first beam
+                    if ((subbandingDM == 0) && (dm == 0))
+                    {
+                        if (!isa::utils::same(beamSNR.at(beam), beamMax_control.at(beam), static_cast<outputDataType>(1e-2)))
+                        {
+                            wrongSamples++;
+                        }
+                        if ((beamDM.at(beam) >= observation.getNrDMs(true) * observation.getNrDMs()) || (output.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + beamDM.at(beam)) != beamSNR.at(beam)))
+                        {
+                            wrongPositions++;
+                        }
+                    }
+                    if (beam == 0)
+                    {
+                        if (!isa::utils::same(dmSNR.at((subbandingDM * observation.getNrDMs()) + dm), dmMax_control.at((subbandingDM * observation.getNrDMs()) + dm), static_cast<outputDataType>(1e-2)))
+                        {
+                            wrongSamples++;
+                        }
+                        if ((dmBeam.at((subbandingDM * observation.getNrDMs()) + dm) >= observation.getNrSynthesizedBeams()) || (output.at((dmBeam.at((subbandingDM * observation.getNrDMs()) + dm) * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm) != dmSNR.at((subbandingDM * observation.getNrDMs()) + dm)))
+                        {
+                            wrongPositions++;
+                        }
+                    }
+                }
+                else if (kernelUnderTest == SNR::Kernel::SNRBoxcar)
+                {
+                    if (!isa::utils::same(output[(beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm], snrBoxcar_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm), static_cast<outputDataType>(1e-2)))
+                    {
+                        wrongSamples++;
+                    }
+                    // Boxcars with the same SNR are all correct positions
+                    if (!isa::utils::same(snrBoxcarPeak_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm), snrBoxcar_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm), static_cast<outputDataType>(1e-2)))
+                    {
+                        wrongPositions++;
+                    }
+                }
+                else if (kernelUnderTest == SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation)
+                {
+                    if (!isa::utils::same(output[(beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm], snrMomad_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm), static_cast<outputDataType>(1e-2)))
+                    {
+                        wrongSamples++;
+                    }
+                    if (outputIndex.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm) != maxSample.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm))
+                    {
+                        wrongPositions++;
+                    }
+                }
                 else if (kernelUnderTest == SNR::Kernel::Max)
                 {
                     if (!isa::utils::same(output[(beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm], static_cast<outputDataType>(input[(beam * observation.getNrDMs(true) * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + (subbandingDM * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + (dm * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + maxSample.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm)]), static_cast<outputDataType>(1e-2)))
@@ -689,9 +1982,9 @@ int test(const bool printResults, const bool printCode, const unsigned int clPla
                       wrongSamples_stdev++;
                     }
                 }
-                else if (kernelUnderTest == SNR::Kernel::MedianOfMedians || kernelUnderTest == SNR::Kernel::MedianOfMediansAbsoluteDeviation)
+                else if (kernelUnderTest == SNR::Kernel::MedianOfMedians || kernelUnderTest == SNR::Kernel::MedianOfMediansAbsoluteDeviation || kernelUnderTest == SNR::Kernel::MedianOfMediansTwoLevel)
                 {
-                    if (medianStep == observation.getNrSamplesPerBatch())
+                    if ((options.medianStep == observation.getNrSamplesPerBatch()) || (kernelUnderTest == SNR::Kernel::MedianOfMediansTwoLevel))
                     {
                         if (!isa::utils::same(output[(beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm], medians_control[(beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm], static_cast<outputDataType>(1e-2)))
                         {
@@ -700,9 +1993,9 @@ int test(const bool printResults, const bool printCode, const unsigned int clPla
                     }
                     else
                     {
-                        for (unsigned int step = 0; step < observation.getNrSamplesPerBatch() / medianStep; step++)
+                        for (unsigned int step = 0; step < observation.getNrSamplesPerBatch() / options.medianStep; step++)
                         {
-                            if (!isa::utils::same(output[(beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / medianStep, padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / medianStep, padding / sizeof(outputDataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / medianStep, padding / sizeof(outputDataType))) + step], medians_control[(beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / medianStep, padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / medianStep, padding / sizeof(outputDataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / medianStep, padding / sizeof(outputDataType))) + step], static_cast<outputDataType>(1e-2)))
+                            if (!isa::utils::same(output[(beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / options.medianStep, padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / options.medianStep, padding / sizeof(outputDataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / options.medianStep, padding / sizeof(outputDataType))) + step], medians_control[(beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / options.medianStep, padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / options.medianStep, padding / sizeof(outputDataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / options.medianStep, padding / sizeof(outputDataType))) + step], static_cast<outputDataType>(1e-2)))
                             {
                                 wrongSamples++;
                             }
@@ -719,6 +2012,16 @@ int test(const bool printResults, const bool printCode, const unsigned int clPla
                         }
                     }
                 }
+                else if (kernelUnderTest == SNR::Kernel::Transpose)
+                {
+                    for (unsigned int sample = 0; sample < observation.getNrSamplesPerBatch(); sample++)
+                    {
+                        if (output.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(outputDataType))) + (dm * observation.getNrSamplesPerBatch(false, padding / sizeof(outputDataType))) + sample) != static_cast<outputDataType>(input.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + (subbandingDM * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + (dm * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + sample)))
+                        {
+                            wrongSamples++;
+                        }
+                    }
+                }
             }
         }
     }
@@ -732,11 +2035,49 @@ int test(const bool printResults, const bool printCode, const unsigned int clPla
             {
                 for (unsigned int dm = 0; dm < observation.getNrDMs(); dm++)
                 {
-                    if ( kernelUnderTest == SNR::Kernel::SNR || kernelUnderTest == SNR::Kernel::SNRSigmaCut )
+                    if ( kernelUnderTest == SNR::Kernel::SNR || kernelUnderTest == SNR::Kernel::SNRSigmaCut || kernelUnderTest == SNR::Kernel::SNRCandidates )
                     {
                         std::cout << output[(beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float))) + (subbandingDM * observation.getNrDMs()) + dm] << "," << (control[(beam * observation.getNrDMs(true) * observation.getNrDMs()) + (subbandingDM * observation.getNrDMs()) + dm].getMax() - control[(beam * observation.getNrDMs(true) * observation.getNrDMs()) + (subbandingDM * observation.getNrDMs()) + dm].getMean()) / control[(beam * observation.getNrDMs(true) * observation.getNrDMs()) + (subbandingDM * observation.getNrDMs()) + dm].getStandardDeviation() << " ; ";
                         std::cout << outputIndex.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm) << "," << maxSample.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm) << "  ";
                     }
+                    else if (kernelUnderTest == SNR::Kernel::SNRDownsampling)
+                    {
+                        std::cout << output[(beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm] << "," << snrDownsampling_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm) << " ; ";
+                        std::cout << outputDownsampling.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm) << "," << outputIndex.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm) << "  ";
+                    }
+                    else if (kernelUnderTest == SNR::Kernel::SNRTopK)
+                    {
+                        for (unsigned int peak = 0; peak < options.nrPeaks; peak++)
+                        {
+                            std::cout << output[(beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs() * options.nrPeaks, padding / sizeof(outputDataType))) + (((subbandingDM * observation.getNrDMs()) + dm) * options.nrPeaks) + peak] << "," << snrTopK_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs() * options.nrPeaks, padding / sizeof(outputDataType))) + (((subbandingDM * observation.getNrDMs()) + dm) * options.nrPeaks) + peak) << " ; ";
+                            std::cout << outputIndex.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs() * options.nrPeaks, padding / sizeof(unsigned int))) + (((subbandingDM * observation.getNrDMs()) + dm) * options.nrPeaks) + peak) << "  ";
+                        }
+                    }
+                    else if (kernelUnderTest == SNR::Kernel::StreamingMedianAbsoluteDeviation)
+                    {
+                        std::cout << output[(beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float))) + (subbandingDM * observation.getNrDMs()) + dm] << "," << streamingBaselines_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float))) + (subbandingDM * observation.getNrDMs()) + dm) << " ; ";
+                        std::cout << mads.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float))) + (subbandingDM * observation.getNrDMs()) + dm) << "," << streamingMADs_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float))) + (subbandingDM * observation.getNrDMs()) + dm) << "  ";
+                    }
+                    else if (kernelUnderTest == SNR::Kernel::SNRRunningStatistics)
+                    {
+                        std::cout << output[(beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float))) + (subbandingDM * observation.getNrDMs()) + dm] << "," << runningSNR_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float))) + (subbandingDM * observation.getNrDMs()) + dm) << " ; ";
+                        std::cout << outputIndex.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm) << "," << maxSample.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm) << "  ";
+                    }
+                    else if (kernelUnderTest == SNR::Kernel::SNRBeamMax)
+                    {
+                        std::cout << output[(beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm] << " ; ";
+                        std::cout << dmSNR.at((subbandingDM * observation.getNrDMs()) + dm) << "," << dmBeam.at((subbandingDM * observation.getNrDMs()) + dm) << "  ";
+                    }
+                    else if (kernelUnderTest == SNR::Kernel::SNRBoxcar)
+                    {
+                        std::cout << output[(beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm] << "," << snrBoxcar_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm) << " ; ";
+                        std::cout << outputWidth.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm) << "," << outputIndex.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm) << "  ";
+                    }
+                    else if (kernelUnderTest == SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation)
+                    {
+                        std::cout << output[(beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm] << "," << snrMomad_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm) << " ; ";
+                        std::cout << outputIndex.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm) << "," << maxSample.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm) << "  ";
+                    }
                     else if (kernelUnderTest == SNR::Kernel::Max)
                     {
                         std::cout << output[(beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float))) + (subbandingDM * observation.getNrDMs()) + dm] << "," << input[(beam * observation.getNrDMs(true) * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + (subbandingDM * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + (dm * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + maxSample.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm)] << " ; ";
@@ -748,17 +2089,17 @@ int test(const bool printResults, const bool printCode, const unsigned int clPla
                         std::cout << outputIndex.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm) << "," << maxSample.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm) << " ; ";
                         std::cout << stdevs.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm) << "," << stdevs_control.at((beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int))) + (subbandingDM * observation.getNrDMs()) + dm) << " ";
                     }
-                    else if (kernelUnderTest == SNR::Kernel::MedianOfMedians || kernelUnderTest == SNR::Kernel::MedianOfMediansAbsoluteDeviation)
+                    else if (kernelUnderTest == SNR::Kernel::MedianOfMedians || kernelUnderTest == SNR::Kernel::MedianOfMediansAbsoluteDeviation || kernelUnderTest == SNR::Kernel::MedianOfMediansTwoLevel)
                     {
-                        if (medianStep == observation.getNrSamplesPerBatch())
+                        if ((options.medianStep == observation.getNrSamplesPerBatch()) || (kernelUnderTest == SNR::Kernel::MedianOfMediansTwoLevel))
                         {
                             std::cout << output[(beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm] << "," << medians_control[(beam * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs()) + dm] << " ";
                         }
                         else
                         {
-                            for (unsigned int step = 0; step < observation.getNrSamplesPerBatch() / medianStep; step++)
+                            for (unsigned int step = 0; step < observation.getNrSamplesPerBatch() / options.medianStep; step++)
                             {
-                                std::cout << output[(beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / medianStep, padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / medianStep, padding / sizeof(outputDataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / medianStep, padding / sizeof(outputDataType))) + step] << "," << medians_control[(beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / medianStep, padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / medianStep, padding / sizeof(outputDataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / medianStep, padding / sizeof(outputDataType))) + step] << " ";
+                                std::cout << output[(beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / options.medianStep, padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / options.medianStep, padding / sizeof(outputDataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / options.medianStep, padding / sizeof(outputDataType))) + step] << "," << medians_control[(beam * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / options.medianStep, padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / options.medianStep, padding / sizeof(outputDataType))) + (dm * isa::utils::pad(observation.getNrSamplesPerBatch() / options.medianStep, padding / sizeof(outputDataType))) + step] << " ";
                             }
                             std::cout << std::endl;
                         }
@@ -771,24 +2112,36 @@ int test(const bool printResults, const bool printCode, const unsigned int clPla
                         }
                         std::cout << std::endl;
                     }
+                    else if (kernelUnderTest == SNR::Kernel::Transpose)
+                    {
+                        for (unsigned int sample = 0; sample < observation.getNrSamplesPerBatch(); sample++)
+                        {
+                            std::cout << output.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(outputDataType))) + (subbandingDM * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(outputDataType))) + (dm * observation.getNrSamplesPerBatch(false, padding / sizeof(outputDataType))) + sample) << "," << input.at((beam * observation.getNrDMs(true) * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + (subbandingDM * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + (dm * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType))) + sample) << " ";
+                        }
+                        std::cout << std::endl;
+                    }
                 }
                 std::cout << std::endl;
             }
+            if (kernelUnderTest == SNR::Kernel::SNRBeamMax)
+            {
+                std::cout << "Beam max: " << beamSNR.at(beam) << "," << beamMax_control.at(beam) << " ; " << beamDM.at(beam) << std::endl;
+            }
         }
         std::cout << std::endl;
     }
 
     if (wrongSamples > 0)
     {
-        if ( kernelUnderTest == SNR::Kernel::SNR || kernelUnderTest == SNR::Kernel::SNRSigmaCut || kernelUnderTest == SNR::Kernel::Max || kernelUnderTest == SNR::Kernel::MaxStdSigmaCut )
+        if ( kernelUnderTest == SNR::Kernel::SNR || kernelUnderTest == SNR::Kernel::SNRSigmaCut || kernelUnderTest == SNR::Kernel::Max || kernelUnderTest == SNR::Kernel::MaxStdSigmaCut || kernelUnderTest == SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation || kernelUnderTest == SNR::Kernel::SNRBoxcar || kernelUnderTest == SNR::Kernel::SNRDownsampling || kernelUnderTest == SNR::Kernel::SNRTopK || kernelUnderTest == SNR::Kernel::SNRCandidates || kernelUnderTest == SNR::Kernel::SNRBeamMax || kernelUnderTest == SNR::Kernel::MedianOfMediansTwoLevel || kernelUnderTest == SNR::Kernel::StreamingMedianAbsoluteDeviation || kernelUnderTest == SNR::Kernel::SNRRunningStatistics )
         {
             std::cout << "Wrong samples: " << wrongSamples << " (" << (wrongSamples * 100.0) / static_cast<uint64_t>(observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs()) << "%)." << std::endl;
         }
         else if (kernelUnderTest == SNR::Kernel::MedianOfMedians || kernelUnderTest == SNR::Kernel::MedianOfMediansAbsoluteDeviation)
         {
-            std::cout << "Wrong samples: " << wrongSamples << " (" << (wrongSamples * 100.0) / static_cast<uint64_t>(observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * (observation.getNrSamplesPerBatch() / medianStep)) << "%)." << std::endl;
+            std::cout << "Wrong samples: " << wrongSamples << " (" << (wrongSamples * 100.0) / static_cast<uint64_t>(observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * (observation.getNrSamplesPerBatch() / options.medianStep)) << "%)." << std::endl;
         }
-        else if (kernelUnderTest == SNR::Kernel::AbsoluteDeviation)
+        else if (kernelUnderTest == SNR::Kernel::AbsoluteDeviation || kernelUnderTest == SNR::Kernel::Transpose)
         {
             std::cout << "Wrong samples: " << wrongSamples << " (" << (wrongSamples * 100.0) / static_cast<uint64_t>(observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * observation.getNrSamplesPerBatch()) << "%)." << std::endl;
         }
@@ -807,3 +2160,123 @@ int test(const bool printResults, const bool printCode, const unsigned int clPla
     }
     return 0;
 }
+
+int testClustering()
+{
+    uint64_t wrongClusters = 0;
+    const unsigned int dmDistance = 2;
+    const unsigned int sampleDistance = 4;
+    const unsigned int widthDistance = 1;
+    AstroData::Observation observation;
+    std::vector<SNR::Candidate> candidates;
+    std::vector<SNR::Candidate> clusters;
+    std::vector<SNR::Candidate> expected;
+    auto makeCandidate = [](const unsigned int beam, const unsigned int dm, const unsigned int sample, const unsigned int width, const float snr, const unsigned int nrMembers) {
+        SNR::Candidate candidate;
+
+        candidate.beam = beam;
+        candidate.dm = dm;
+        candidate.sample = sample;
+        candidate.width = width;
+        candidate.snr = snr;
+        candidate.nrMembers = nrMembers;
+        return candidate;
+    };
+    auto sameCandidate = [](const SNR::Candidate &first, const SNR::Candidate &second) {
+        return (first.beam == second.beam) && (first.dm == second.dm) && (first.sample == second.sample) && (first.width == second.width) && (first.snr == second.snr) && (first.nrMembers == second.nrMembers);
+    };
+
+    observation.setNrSynthesizedBeams(3);
+    // Beam 0: a chain of friends crossing DM and sample cells, whose ends are not friends, and an isolated candidate
+    // Beam 1: two candidates too far apart in width, the first with a friend that already represents three detections
+    // Beam 2: no candidates
+    candidates.push_back(makeCandidate(1, 10, 50, 1, 6.0f, 1));
+    candidates.push_back(makeCandidate(0, 2, 4, 1, 5.0f, 1));
+    candidates.push_back(makeCandidate(1, 10, 51, 4, 8.0f, 1));
+    candidates.push_back(makeCandidate(0, 40, 100, 1, 7.0f, 1));
+    candidates.push_back(makeCandidate(0, 4, 8, 1, 6.0f, 1));
+    candidates.push_back(makeCandidate(1, 11, 52, 2, 7.0f, 3));
+    candidates.push_back(makeCandidate(0, 6, 12, 1, 9.0f, 1));
+    candidates.push_back(makeCandidate(0, 8, 16, 1, 5.0f, 1));
+    // Clusters are sorted by beam, then by the position of their first member, and represented by their brightest member
+    expected.push_back(makeCandidate(0, 6, 12, 1, 9.0f, 4));
+    expected.push_back(makeCandidate(0, 40, 100, 1, 7.0f, 1));
+    expected.push_back(makeCandidate(1, 11, 52, 2, 7.0f, 4));
+    expected.push_back(makeCandidate(1, 10, 51, 4, 8.0f, 1));
+    SNR::clusterCandidates(candidates, clusters, observation, dmDistance, sampleDistance, widthDistance);
+    if (clusters.size() != expected.size())
+    {
+        std::cout << "Wrong number of clusters: " << clusters.size() << " instead of " << expected.size() << "." << std::endl;
+        return 1;
+    }
+    for (unsigned int cluster = 0; cluster < clusters.size(); cluster++)
+    {
+        if (!sameCandidate(clusters[cluster], expected[cluster]))
+        {
+            std::cout << "Wrong cluster " << cluster << " -- Beam: " << clusters[cluster].beam << " DM: " << clusters[cluster].dm << " Sample: " << clusters[cluster].sample << " Width: " << clusters[cluster].width << " SNR: " << clusters[cluster].snr << " Members: " << clusters[cluster].nrMembers << std::endl;
+            wrongClusters++;
+        }
+    }
+    // Candidates outside of the observation are rejected
+    candidates.push_back(makeCandidate(3, 0, 0, 1, 5.0f, 1));
+    try
+    {
+        SNR::clusterCandidates(candidates, clusters, observation, dmDistance, sampleDistance, widthDistance);
+        std::cout << "A candidate of a beam outside of the observation was not rejected." << std::endl;
+        wrongClusters++;
+    }
+    catch (std::out_of_range &err)
+    {
+    }
+    // The result does not depend on the number of threads
+    std::vector<SNR::Candidate> singleThreadClusters;
+
+    observation.setNrSynthesizedBeams(8);
+    candidates.clear();
+    srand(time(0));
+    for (unsigned int candidate = 0; candidate < 100000; candidate++)
+    {
+        candidates.push_back(makeCandidate(rand() % observation.getNrSynthesizedBeams(), rand() % 2048, rand() % 65536, 1 + (rand() % 8), static_cast<float>(rand() % 1000) / 10.0f, 1));
+    }
+#ifdef _OPENMP
+    const int nrThreads = omp_get_max_threads();
+
+    omp_set_num_threads(1);
+#endif
+    SNR::clusterCandidates(candidates, singleThreadClusters, observation, dmDistance, sampleDistance, widthDistance);
+#ifdef _OPENMP
+    omp_set_num_threads(nrThreads);
+#endif
+    SNR::clusterCandidates(candidates, clusters, observation, dmDistance, sampleDistance, widthDistance);
+    if (clusters.size() != singleThreadClusters.size())
+    {
+        std::cout << "Wrong number of clusters with multiple threads: " << clusters.size() << " instead of " << singleThreadClusters.size() << "." << std::endl;
+        return 1;
+    }
+    for (unsigned int cluster = 0; cluster < clusters.size(); cluster++)
+    {
+        if (!sameCandidate(clusters[cluster], singleThreadClusters[cluster]))
+        {
+            wrongClusters++;
+        }
+    }
+
+    if (wrongClusters > 0)
+    {
+        std::cout << "Wrong clusters: " << wrongClusters << "." << std::endl;
+    }
+    else
+    {
+        std::cout << "TEST PASSED." << std::endl;
+    }
+    return 0;
+}
+
+template <typename DataType>
+void transposeToDMsSamples(std::vector<DataType> &data, const unsigned int nrBeams, const unsigned int nrDMs, const unsigned int nrSamples, const unsigned int padding)
+{
+    std::vector<DataType> transposed;
+
+    SNR::transpose(data, transposed, SNR::DataOrdering::SamplesDMs, nrBeams, nrDMs, nrSamples, padding);
+    data.swap(transposed);
+}
@@ -35,8 +35,10 @@
 void initializeDeviceMemoryD(cl::Context &clContext, cl::CommandQueue *clQueue, std::vector<inputDataType> *input, cl::Buffer *input_d, cl::Buffer *outputValue_d, const uint64_t output_size);
 void initializeDeviceMemoryD(cl::Context &clContext, cl::CommandQueue *clQueue, std::vector<inputDataType> *input, cl::Buffer *input_d, cl::Buffer *outputValue_d, const uint64_t output_size, cl::Buffer *outputSample_d, const uint64_t outputSample_size);
 void initializeDeviceMemoryD(cl::Context &clContext, cl::CommandQueue *clQueue, std::vector<inputDataType> *input, cl::Buffer *input_d, cl::Buffer *outputValue_d, cl::Buffer *outputStd_d, const uint64_t output_size, cl::Buffer *outputSample_d, const uint64_t outputSample_size);
+void initializeDeviceMemoryD(cl::Context &clContext, cl::CommandQueue *clQueue, std::vector<inputDataType> *input, cl::Buffer *input_d, cl::Buffer *outputValue_d, const uint64_t output_size, cl::Buffer *outputFilter_d, cl::Buffer *outputSample_d, const uint64_t outputSample_size);
 void initializeDeviceMemoryD(cl::Context &clContext, cl::CommandQueue *clQueue, std::vector<inputDataType> *input, cl::Buffer *input_d, cl::Buffer *outputValue_d, const uint64_t outputSNR_size, cl::Buffer *baselines_d, std::vector<outputDataType> *baselines);
-int tune(const bool bestMode, const unsigned int nrIterations, const unsigned int minThreads, const unsigned int maxThreads, const unsigned int maxItems, const unsigned int clPlatformID, const unsigned int clDeviceID, const SNR::DataOrdering ordering, const SNR::Kernel kernelTuned, const unsigned int padding, const AstroData::Observation &observation, SNR::snrConf &conf, const unsigned int medianStep = 0, const float nSigma = 3.0f);
+bool nextSweep(SNR::snrConf &conf, const SNR::MedianStrategy maxMedianStrategy, const unsigned int maxThreadsD1, const unsigned int maxWorkGroups, const unsigned int maxVectorWidth, const bool subgroupSweep);
+int tune(const bool bestMode, const unsigned int nrIterations, const unsigned int minThreads, const unsigned int maxThreads, const unsigned int maxItems, const unsigned int clPlatformID, const unsigned int clDeviceID, const SNR::DataOrdering ordering, const SNR::Kernel kernelTuned, const unsigned int padding, const AstroData::Observation &observation, SNR::snrConf &conf, const SNR::KernelOptions &options);
 
 int main(int argc, char *argv[])
 {
@@ -49,11 +51,10 @@ int main(int argc, char *argv[])
     unsigned int minThreads = 0;
     unsigned int maxItems = 0;
     unsigned int maxThreads = 0;
-    unsigned int stepSize = 0;
-    float nSigma = 3.0f;
     SNR::Kernel kernel;
     SNR::DataOrdering ordering;
     SNR::snrConf conf;
+    SNR::KernelOptions options;
     AstroData::Observation observation;
 
     try
@@ -87,9 +88,49 @@ int main(int argc, char *argv[])
         {
             kernel = SNR::Kernel::AbsoluteDeviation;
         }
+        else if (args.getSwitch("-transpose"))
+        {
+            kernel = SNR::Kernel::Transpose;
+        }
+        else if (args.getSwitch("-snr_momad"))
+        {
+            kernel = SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation;
+        }
+        else if (args.getSwitch("-boxcar"))
+        {
+            kernel = SNR::Kernel::SNRBoxcar;
+        }
+        else if (args.getSwitch("-snr_downsampling"))
+        {
+            kernel = SNR::Kernel::SNRDownsampling;
+        }
+        else if (args.getSwitch("-snr_topk"))
+        {
+            kernel = SNR::Kernel::SNRTopK;
+        }
+        else if (args.getSwitch("-snr_candidates"))
+        {
+            kernel = SNR::Kernel::SNRCandidates;
+        }
+        else if (args.getSwitch("-snr_beam_max"))
+        {
+            kernel = SNR::Kernel::SNRBeamMax;
+        }
+        else if (args.getSwitch("-median_two_level"))
+        {
+            kernel = SNR::Kernel::MedianOfMediansTwoLevel;
+        }
+        else if (args.getSwitch("-streaming_mad"))
+        {
+            kernel = SNR::Kernel::StreamingMedianAbsoluteDeviation;
+        }
+        else if (args.getSwitch("-snr_running"))
+        {
+            kernel = SNR::Kernel::SNRRunningStatistics;
+        }
         else
         {
-            std::cerr << "One switch between -snr -snr_sc -max -max_std -median -momad and -absolute_deviation is required." << std::endl;
+            std::cerr << "One switch between -snr -snr_sc -max -max_std -median -momad -absolute_deviation -transpose -snr_momad -boxcar -snr_downsampling -snr_topk -snr_candidates -snr_beam_max -median_two_level -streaming_mad and -snr_running is required." << std::endl;
             return 1;
         }
         if (args.getSwitch("-dms_samples"))
@@ -105,13 +146,118 @@ int main(int argc, char *argv[])
             std::cerr << "One switch between -dms_samples and -samples_dms is required." << std::endl;
             return 1;
         }
+        if ((kernel == SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation) && (ordering != SNR::DataOrdering::DMsSamples))
+        {
+            std::cerr << "The -snr_momad kernel is only available for -dms_samples." << std::endl;
+            return 1;
+        }
+        if ((kernel == SNR::Kernel::SNRBoxcar) && (ordering != SNR::DataOrdering::DMsSamples))
+        {
+            std::cerr << "The -boxcar kernel is only available for -dms_samples." << std::endl;
+            return 1;
+        }
+        if ((kernel == SNR::Kernel::SNRDownsampling) && (ordering != SNR::DataOrdering::DMsSamples))
+        {
+            std::cerr << "The -snr_downsampling kernel is only available for -dms_samples." << std::endl;
+            return 1;
+        }
+        if ((kernel == SNR::Kernel::SNRTopK) && (ordering != SNR::DataOrdering::DMsSamples))
+        {
+            std::cerr << "The -snr_topk kernel is only available for -dms_samples." << std::endl;
+            return 1;
+        }
+        if ((kernel == SNR::Kernel::SNRCandidates) && (ordering != SNR::DataOrdering::DMsSamples))
+        {
+            std::cerr << "The -snr_candidates kernel is only available for -dms_samples." << std::endl;
+            return 1;
+        }
+        if ((kernel == SNR::Kernel::SNRBeamMax) && (ordering != SNR::DataOrdering::DMsSamples))
+        {
+            std::cerr << "The -snr_beam_max kernel is only available for -dms_samples." << std::endl;
+            return 1;
+        }
+        if ((kernel == SNR::Kernel::MedianOfMediansTwoLevel) && (ordering != SNR::DataOrdering::DMsSamples))
+        {
+            std::cerr << "The -median_two_level kernel is only available for -dms_samples." << std::endl;
+            return 1;
+        }
+        if ((kernel == SNR::Kernel::StreamingMedianAbsoluteDeviation) && (ordering != SNR::DataOrdering::DMsSamples))
+        {
+            std::cerr << "The -streaming_mad kernel is only available for -dms_samples." << std::endl;
+            return 1;
+        }
+        if ((kernel == SNR::Kernel::SNRRunningStatistics) && (ordering != SNR::DataOrdering::DMsSamples))
+        {
+            std::cerr << "The -snr_running kernel is only available for -dms_samples." << std::endl;
+            return 1;
+        }
+        conf.setSubgroupReduction(args.getSwitch("-subgroup"));
+        if (conf.getSubgroupReduction() && ((ordering != SNR::DataOrdering::DMsSamples) || !((kernel == SNR::Kernel::SNR) || (kernel == SNR::Kernel::SNRSigmaCut) || (kernel == SNR::Kernel::Max) || (kernel == SNR::Kernel::MaxStdSigmaCut))))
+        {
+            std::cerr << "The -subgroup reduction is only available for -snr, -snr_sc, -max and -max_std with -dms_samples." << std::endl;
+            return 1;
+        }
+        if (args.getSwitch("-vector"))
+        {
+            conf.setVectorWidth(args.getSwitchArgument<unsigned int>("-vector_width"));
+        }
+        if ((conf.getVectorWidth() != 1) && ((ordering != SNR::DataOrdering::DMsSamples) || !((kernel == SNR::Kernel::SNR) || (kernel == SNR::Kernel::Max))))
+        {
+            std::cerr << "The -vector loads are only available for -snr and -max with -dms_samples." << std::endl;
+            return 1;
+        }
+        if ((conf.getVectorWidth() != 1) && (conf.getVectorWidth() != 2) && (conf.getVectorWidth() != 4) && (conf.getVectorWidth() != 8) && (conf.getVectorWidth() != 16))
+        {
+            std::cerr << "The maximum vector width must be 1, 2, 4, 8 or 16." << std::endl;
+            return 1;
+        }
+        if (args.getSwitch("-multiple_dms"))
+        {
+            // The number of DMs per work-group is swept in powers of two up to threadsD1
+            conf.setNrThreadsD1(args.getSwitchArgument<unsigned int>("-max_threadsD1"));
+        }
+        if ((conf.getNrThreadsD1() != 1) && ((ordering != SNR::DataOrdering::DMsSamples) || !((kernel == SNR::Kernel::SNR) || (kernel == SNR::Kernel::Max))))
+        {
+            std::cerr << "The -multiple_dms work-groups are only available for -snr and -max with -dms_samples." << std::endl;
+            return 1;
+        }
+        if (args.getSwitch("-split_samples"))
+        {
+            // The number of rows sharing the samples is swept in powers of two up to max_threadsD1
+            conf.setNrThreadsD1(args.getSwitchArgument<unsigned int>("-max_threadsD1"));
+            if ((ordering != SNR::DataOrdering::SamplesDMs) || (kernel != SNR::Kernel::SNR))
+            {
+                std::cerr << "The -split_samples work-groups are only available for -snr with -samples_dms." << std::endl;
+                return 1;
+            }
+        }
+        if (args.getSwitch("-persistent"))
+        {
+            // The number of persistent work-groups is swept in powers of two up to max_work_groups
+            conf.setNrWorkGroups(args.getSwitchArgument<unsigned int>("-max_work_groups"));
+        }
+        if ((conf.getNrWorkGroups() != 0) && ((ordering != SNR::DataOrdering::DMsSamples) || !((kernel == SNR::Kernel::SNR) || (kernel == SNR::Kernel::Max))))
+        {
+            std::cerr << "The -persistent kernels are only available for -snr and -max with -dms_samples." << std::endl;
+            return 1;
+        }
+        if (args.getSwitch("-median_strategies"))
+        {
+            // Every median strategy is tuned
+            conf.setMedianStrategy(SNR::MedianStrategy::RadixSelect);
+            if ((ordering != SNR::DataOrdering::DMsSamples) || (kernel != SNR::Kernel::MedianOfMedians))
+            {
+                std::cerr << "The -median_strategies are only available for -median with -dms_samples." << std::endl;
+                return 1;
+            }
+        }
         nrIterations = args.getSwitchArgument<unsigned int>("-iterations");
         clPlatformID = args.getSwitchArgument<unsigned int>("-opencl_platform");
         clDeviceID = args.getSwitchArgument<unsigned int>("-opencl_device");
         bestMode = args.getSwitch("-best");
         padding = args.getSwitchArgument<unsigned int>("-padding");
         minThreads = args.getSwitchArgument<unsigned int>("-min_threads");
-        if (kernel == SNR::Kernel::SNR || kernel == SNR::Kernel::SNRSigmaCut || kernel == SNR::Kernel::Max || kernel == SNR::Kernel::MaxStdSigmaCut || kernel == SNR::Kernel::AbsoluteDeviation)
+        if (kernel == SNR::Kernel::SNR || kernel == SNR::Kernel::SNRSigmaCut || kernel == SNR::Kernel::Max || kernel == SNR::Kernel::MaxStdSigmaCut || kernel == SNR::Kernel::AbsoluteDeviation || kernel == SNR::Kernel::Transpose || kernel == SNR::Kernel::SNRTopK || kernel == SNR::Kernel::SNRCandidates || kernel == SNR::Kernel::SNRBeamMax || kernel == SNR::Kernel::MedianOfMediansTwoLevel || kernel == SNR::Kernel::SNRRunningStatistics || (conf.getMedianStrategy() != SNR::MedianStrategy::OddEvenSort))
         {
             maxItems = args.getSwitchArgument<unsigned int>("-max_items");
         }
@@ -123,6 +269,11 @@ int main(int argc, char *argv[])
         conf.setSubbandDedispersion(args.getSwitch("-subband"));
         observation.setNrSynthesizedBeams(args.getSwitchArgument<unsigned int>("-beams"));
         observation.setNrSamplesPerBatch(args.getSwitchArgument<unsigned int>("-samples"));
+        if ((observation.getNrSamplesPerBatch() % conf.getVectorWidth()) != 0)
+        {
+            std::cerr << "The number of samples must be a multiple of the vector width." << std::endl;
+            return 1;
+        }
         if (conf.getSubbandDedispersion())
         {
             observation.setDMRange(args.getSwitchArgument<unsigned int>("-subbanding_dms"), 0.0f, 0.0f, true);
@@ -132,23 +283,112 @@ int main(int argc, char *argv[])
             observation.setDMRange(1, 0.0f, 0.0f, true);
         }
         observation.setDMRange(args.getSwitchArgument<unsigned int>("-dms"), 0.0, 0.0);
-        if (kernel == SNR::Kernel::MedianOfMedians || kernel == SNR::Kernel::MedianOfMediansAbsoluteDeviation)
+        if (kernel == SNR::Kernel::MedianOfMedians || kernel == SNR::Kernel::MedianOfMediansAbsoluteDeviation || kernel == SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation || kernel == SNR::Kernel::MedianOfMediansTwoLevel)
         {
-            stepSize = args.getSwitchArgument<unsigned int>("-median_step");
+            options.medianStep = args.getSwitchArgument<unsigned int>("-median_step");
+            if ((options.medianStep == 0) || (options.medianStep > observation.getNrSamplesPerBatch()))
+            {
+                std::cerr << "The median step must be larger than zero and not larger than the number of samples." << std::endl;
+                return 1;
+            }
         }
         else if ( kernel == SNR::Kernel::SNRSigmaCut || kernel == SNR::Kernel::MaxStdSigmaCut )
         {
-          nSigma = args.getSwitchArgument<float>("-nsigma");
+          options.nSigma = args.getSwitchArgument<float>("-nsigma");
+          if (args.getSwitch("-iterative"))
+          {
+              options.maxIterations = args.getSwitchArgument<unsigned int>("-cuts");
+              if ((ordering != SNR::DataOrdering::DMsSamples) || (options.maxIterations == 0))
+              {
+                  std::cerr << "The -iterative sigma cut is only available with -dms_samples, and needs at least one cut." << std::endl;
+                  return 1;
+              }
+          }
+        }
+        else if (kernel == SNR::Kernel::SNRCandidates)
+        {
+            options.nSigma = args.getSwitchArgument<float>("-threshold");
+        }
+        else if (kernel == SNR::Kernel::StreamingMedianAbsoluteDeviation)
+        {
+            options.nrBins = args.getSwitchArgument<unsigned int>("-bins");
+            options.smoothing = args.getSwitchArgument<float>("-smoothing");
+            if ((options.nrBins < 2) || (options.smoothing <= 0.0f) || (options.smoothing > 1.0f))
+            {
+                std::cerr << "The -streaming_mad kernel needs at least two bins, and a smoothing between 0 and 1." << std::endl;
+                return 1;
+            }
+        }
+        else if (kernel == SNR::Kernel::SNRRunningStatistics)
+        {
+            options.decay = args.getSwitchArgument<float>("-decay");
+            if ((options.decay <= 0.0f) || (options.decay > 1.0f))
+            {
+                std::cerr << "The -snr_running kernel needs a decay between 0 and 1." << std::endl;
+                return 1;
+            }
+        }
+        else if (kernel == SNR::Kernel::SNRTopK)
+        {
+            options.nrPeaks = args.getSwitchArgument<unsigned int>("-peaks");
+            if ((options.nrPeaks == 0) || (options.nrPeaks > observation.getNrSamplesPerBatch()))
+            {
+                std::cerr << "The number of peaks must be between 1 and the number of samples." << std::endl;
+                return 1;
+            }
+        }
+        else if (kernel == SNR::Kernel::SNRBoxcar)
+        {
+            // Comma separated list of boxcar widths
+            std::string widthsList = args.getSwitchArgument<std::string>("-widths");
+            std::string::size_type first = 0;
+
+            while (first < widthsList.size())
+            {
+                std::string::size_type last = widthsList.find(",", first);
+                if (last == std::string::npos)
+                {
+                    last = widthsList.size();
+                }
+                options.widths.push_back(isa::utils::castToType<std::string, unsigned int>(widthsList.substr(first, last - first)));
+                first = last + 1;
+            }
+            if (options.widths.empty())
+            {
+                std::cerr << "At least one boxcar width is required." << std::endl;
+                return 1;
+            }
+            for (auto width = options.widths.begin(); width != options.widths.end(); ++width)
+            {
+                if ((*width == 0) || (*width > observation.getNrSamplesPerBatch()))
+                {
+                    std::cerr << "Boxcar widths must be between 1 and the number of samples." << std::endl;
+                    return 1;
+                }
+            }
         }
     }
     catch (isa::utils::EmptyCommandLine &err)
     {
-        std::cerr << "Usage: " << argv[0] << " [-snr | -snr_sc | -max | -max_std | -median | -momad | -absolute_deviation] [-dms_samples | -samples_dms] [-best] -iterations <int> -opencl_platform <int> -opencl_device <int> -padding <int> -min_threads <int> -max_threads <int> -max_items <int> [-subband] -beams <int> -dms <int> -samples <int>" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " [-snr | -snr_sc | -max | -max_std | -median | -momad | -absolute_deviation | -transpose | -snr_momad | -boxcar | -snr_downsampling | -snr_topk | -snr_candidates | -snr_beam_max | -median_two_level | -streaming_mad | -snr_running] [-dms_samples | -samples_dms] [-best] -iterations <int> -opencl_platform <int> -opencl_device <int> -padding <int> -min_threads <int> -max_threads <int> -max_items <int> [-subgroup] [-vector] [-multiple_dms] [-split_samples] [-persistent] [-median_strategies] [-iterative] [-subband] -beams <int> -dms <int> -samples <int>" << std::endl;
         std::cerr << "\t -subband -subbanding_dms <int>" << std::endl;
+        std::cerr << "\t -vector -vector_width <int>" << std::endl;
+        std::cerr << "\t -multiple_dms -max_threadsD1 <int>" << std::endl;
+        std::cerr << "\t -split_samples -max_threadsD1 <int>" << std::endl;
+        std::cerr << "\t -persistent -max_work_groups <int>" << std::endl;
         std::cerr << "\t -snr_sc -nsigma <float>" << std::endl;
+        std::cerr << "\t -iterative -cuts <int>" << std::endl;
         std::cerr << "\t -median -median_step <int>" << std::endl;
+        std::cerr << "\t -median_strategies -max_items <int>" << std::endl;
+        std::cerr << "\t -median_two_level -median_step <int>" << std::endl;
+        std::cerr << "\t -streaming_mad -bins <int> -smoothing <float>" << std::endl;
+        std::cerr << "\t -snr_running -decay <float>" << std::endl;
         std::cerr << "\t -momad -median_step <int" << std::endl;
         std::cerr << "\t -max_std -nsigma <float>" << std::endl;
+        std::cerr << "\t -snr_momad -median_step <int>" << std::endl;
+        std::cerr << "\t -boxcar -widths <int,int,...>" << std::endl;
+        std::cerr << "\t -snr_topk -peaks <int>" << std::endl;
+        std::cerr << "\t -snr_candidates -threshold <float>" << std::endl;
         return 1;
     }
     catch (std::exception &err)
@@ -156,20 +396,44 @@ int main(int argc, char *argv[])
         std::cerr << err.what() << std::endl;
         return 1;
     }
-    if (kernel == SNR::Kernel::SNR || kernel == SNR::Kernel::Max || kernel == SNR::Kernel::AbsoluteDeviation)
+    returnCode = tune(bestMode, nrIterations, minThreads, maxThreads, maxItems, clPlatformID, clDeviceID, ordering, kernel, padding, observation, conf, options);
+
+    return returnCode;
+}
+
+bool nextSweep(SNR::snrConf &conf, const SNR::MedianStrategy maxMedianStrategy, const unsigned int maxThreadsD1, const unsigned int maxWorkGroups, const unsigned int maxVectorWidth, const bool subgroupSweep)
+{
+    // Move to the next pass of the work-group size sweep; false when every pass is done
+    if (conf.getMedianStrategy() < maxMedianStrategy)
+    {
+        conf.setMedianStrategy(static_cast<SNR::MedianStrategy>(conf.getMedianStrategy() + 1));
+        return true;
+    }
+    conf.setMedianStrategy(SNR::MedianStrategy::OddEvenSort);
+    if (!conf.getSubgroupReduction() && (conf.getNrThreadsD1() < maxThreadsD1))
     {
-        returnCode = tune(bestMode, nrIterations, minThreads, maxThreads, maxItems, clPlatformID, clDeviceID, ordering, kernel, padding, observation, conf);
+        conf.setNrThreadsD1(conf.getNrThreadsD1() * 2);
+        return true;
     }
-    else if (kernel == SNR::Kernel::MedianOfMedians || kernel == SNR::Kernel::MedianOfMediansAbsoluteDeviation)
+    conf.setNrThreadsD1(1);
+    if ((maxWorkGroups > 0) && ((conf.getNrWorkGroups() * 2) <= maxWorkGroups))
     {
-        returnCode = tune(bestMode, nrIterations, minThreads, maxThreads, maxItems, clPlatformID, clDeviceID, ordering, kernel, padding, observation, conf, stepSize);
+        conf.setNrWorkGroups(std::max(conf.getNrWorkGroups() * 2, 1u));
+        return true;
     }
-    else if ( kernel == SNR::Kernel::SNRSigmaCut || kernel == SNR::Kernel::MaxStdSigmaCut )
+    conf.setNrWorkGroups(0);
+    if (conf.getVectorWidth() < maxVectorWidth)
     {
-        returnCode = tune(bestMode, nrIterations, minThreads, maxThreads, maxItems, clPlatformID, clDeviceID, ordering, kernel, padding, observation, conf, 0, nSigma);
+        conf.setVectorWidth(conf.getVectorWidth() * 2);
+        return true;
     }
-
-    return returnCode;
+    conf.setVectorWidth(1);
+    if (subgroupSweep && !conf.getSubgroupReduction())
+    {
+        conf.setSubgroupReduction(true);
+        return true;
+    }
+    return false;
 }
 
 void initializeDeviceMemoryD(cl::Context &clContext, cl::CommandQueue *clQueue, std::vector<inputDataType> *input, cl::Buffer *input_d, cl::Buffer *outputValue_d, const uint64_t output_size)
@@ -223,6 +487,24 @@ void initializeDeviceMemoryD(cl::Context &clContext, cl::CommandQueue *clQueue,
   }
 }
 
+void initializeDeviceMemoryD(cl::Context &clContext, cl::CommandQueue *clQueue, std::vector<inputDataType> *input, cl::Buffer *input_d, cl::Buffer *outputValue_d, const uint64_t output_size, cl::Buffer *outputFilter_d, cl::Buffer *outputSample_d, const uint64_t outputSample_size)
+{
+    try
+    {
+        *input_d = cl::Buffer(clContext, CL_MEM_READ_WRITE, input->size() * sizeof(inputDataType), 0, 0);
+        *outputValue_d = cl::Buffer(clContext, CL_MEM_WRITE_ONLY, output_size * sizeof(outputDataType), 0, 0);
+        *outputFilter_d = cl::Buffer(clContext, CL_MEM_WRITE_ONLY, outputSample_size * sizeof(unsigned int), 0, 0);
+        *outputSample_d = cl::Buffer(clContext, CL_MEM_WRITE_ONLY, outputSample_size * sizeof(unsigned int), 0, 0);
+        clQueue->enqueueWriteBuffer(*input_d, CL_FALSE, 0, input->size() * sizeof(inputDataType), reinterpret_cast<void *>(input->data()));
+        clQueue->finish();
+    }
+    catch (cl::Error &err)
+    {
+        std::cerr << "OpenCL error: " << std::to_string(err.err()) << "." << std::endl;
+        throw;
+    }
+}
+
 void initializeDeviceMemoryD(cl::Context &clContext, cl::CommandQueue *clQueue, std::vector<inputDataType> *input, cl::Buffer *input_d, cl::Buffer *outputValue_d, const uint64_t outputSNR_size, cl::Buffer *baselines_d, std::vector<outputDataType> *baselines)
 {
     try
@@ -241,7 +523,7 @@ void initializeDeviceMemoryD(cl::Context &clContext, cl::CommandQueue *clQueue,
     }
 }
 
-int tune(const bool bestMode, const unsigned int nrIterations, const unsigned int minThreads, const unsigned int maxThreads, const unsigned int maxItems, const unsigned int clPlatformID, const unsigned int clDeviceID, const SNR::DataOrdering ordering, const SNR::Kernel kernelTuned, const unsigned int padding, const AstroData::Observation &observation, SNR::snrConf &conf, const unsigned int medianStep, const float nSigma)
+int tune(const bool bestMode, const unsigned int nrIterations, const unsigned int minThreads, const unsigned int maxThreads, const unsigned int maxItems, const unsigned int clPlatformID, const unsigned int clDeviceID, const SNR::DataOrdering ordering, const SNR::Kernel kernelTuned, const unsigned int padding, const AstroData::Observation &observation, SNR::snrConf &conf, const SNR::KernelOptions &options)
 {
     bool reinitializeDeviceMemory = true;
     double bestGBs = 0.0;
@@ -254,19 +536,22 @@ int tune(const bool bestMode, const unsigned int nrIterations, const unsigned in
     // Allocate memory
     std::vector<inputDataType> input;
     std::vector<outputDataType> baselines;
-    cl::Buffer input_d, outputValue_d, outputSample_d, baselines_d, stdevs_d;
+    cl::Buffer input_d, outputValue_d, outputSample_d, outputWidth_d, outputDownsampling_d, downsampled_d, nrCandidates_d, candidates_d, baselines_d, stdevs_d;
+    cl::Buffer dmSNR_d, dmBeam_d, partialSNR_d, partialDM_d, counter_d;
+    cl::Buffer mads_d;
+    cl::Buffer counters_d, means_d, variances_d;
 
     if (ordering == SNR::DataOrdering::DMsSamples)
     {
         input.resize(observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(inputDataType)));
-        if (kernelTuned == SNR::Kernel::MedianOfMediansAbsoluteDeviation || kernelTuned == SNR::Kernel::AbsoluteDeviation)
-        {
-            baselines.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType)));
-        }
     }
     else
     {
-        input.resize(observation.getNrSynthesizedBeams() * observation.getNrSamplesPerBatch() * observation.getNrDMs(true) * observation.getNrDMs(false, padding / sizeof(inputDataType)));
+        input.resize(observation.getNrSynthesizedBeams() * observation.getNrSamplesPerBatch() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(inputDataType)));
+    }
+    if (kernelTuned == SNR::Kernel::MedianOfMediansAbsoluteDeviation || kernelTuned == SNR::Kernel::AbsoluteDeviation)
+    {
+        baselines.resize(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType)));
     }
 
     srand(time(0));
@@ -293,7 +578,7 @@ int tune(const bool bestMode, const unsigned int nrIterations, const unsigned in
                 {
                     for (unsigned int dm = 0; dm < observation.getNrDMs(); dm++)
                     {
-                        input[(beam * observation.getNrSamplesPerBatch() * observation.getNrDMs(true) * observation.getNrDMs(false, padding / sizeof(inputDataType))) + (sample * observation.getNrDMs(true) * observation.getNrDMs(false, padding / sizeof(inputDataType))) + (subbandDM * observation.getNrDMs(false, padding / sizeof(inputDataType))) + dm] = static_cast<inputDataType>(std::rand() % 10);
+                        input[(beam * observation.getNrSamplesPerBatch() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(inputDataType))) + (sample * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(inputDataType))) + (subbandDM * observation.getNrDMs()) + dm] = static_cast<inputDataType>(std::rand() % 10);
                     }
                 }
             }
@@ -320,10 +605,25 @@ int tune(const bool bestMode, const unsigned int nrIterations, const unsigned in
                   << std::endl;
     }
 
-    for (unsigned int threads = minThreads; threads <= maxThreads;)
+    // The work-group sizes are swept once for every median strategy with -median_strategies, every number of rows per work-group up to -max_threadsD1, every number of persistent work-groups up to -max_work_groups, and every vector width up to -vector_width, first with local memory and then, with -subgroup, with sub-group reductions
+    const bool subgroupSweep = conf.getSubgroupReduction();
+    const SNR::MedianStrategy maxMedianStrategy = conf.getMedianStrategy();
+    const unsigned int maxVectorWidth = conf.getVectorWidth();
+    const unsigned int maxThreadsD1 = conf.getNrThreadsD1();
+    const unsigned int maxWorkGroups = conf.getNrWorkGroups();
+    conf.setSubgroupReduction(false);
+    conf.setMedianStrategy(SNR::MedianStrategy::OddEvenSort);
+    conf.setVectorWidth(1);
+    conf.setNrThreadsD1(1);
+    conf.setNrWorkGroups(0);
+    for (unsigned int threads = minThreads; (threads <= maxThreads) || ((minThreads <= maxThreads) && nextSweep(conf, maxMedianStrategy, maxThreadsD1, maxWorkGroups, maxVectorWidth, subgroupSweep));)
     {
+        if (threads > maxThreads)
+        {
+            threads = minThreads;
+        }
         conf.setNrThreadsD0(threads);
-        if (ordering == SNR::DataOrdering::DMsSamples)
+        if ((ordering == SNR::DataOrdering::DMsSamples) || (kernelTuned == SNR::Kernel::Transpose))
         {
             threads *= 2;
         }
@@ -341,6 +641,14 @@ int tune(const bool bestMode, const unsigned int nrIterations, const unsigned in
                     {
                         break;
                     }
+                    if ((((observation.getNrDMs(true) * observation.getNrDMs()) % conf.getNrThreadsD1()) != 0) || ((conf.getNrThreadsD0() * conf.getNrThreadsD1()) > maxThreads))
+                    {
+                        break;
+                    }
+                    if ((conf.getNrWorkGroups() * conf.getNrThreadsD1()) > (observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs()))
+                    {
+                        break;
+                    }
                     if ((observation.getNrSamplesPerBatch() % itemsPerThread) != 0)
                     {
                         continue;
@@ -352,7 +660,11 @@ int tune(const bool bestMode, const unsigned int nrIterations, const unsigned in
                     {
                         break;
                     }
-                    if (observation.getNrDMs() % (itemsPerThread * conf.getNrThreadsD0()) != 0)
+                    if (((conf.getNrThreadsD0() * conf.getNrThreadsD1()) > maxThreads) || (conf.getNrThreadsD1() > observation.getNrSamplesPerBatch()))
+                    {
+                        break;
+                    }
+                    if ((observation.getNrDMs(true) * observation.getNrDMs()) % (itemsPerThread * conf.getNrThreadsD0()) != 0)
                     {
                         continue;
                     }
@@ -360,7 +672,7 @@ int tune(const bool bestMode, const unsigned int nrIterations, const unsigned in
                 conf.setNrItemsD0(itemsPerThread);
                 if (ordering == SNR::DataOrdering::DMsSamples)
                 {
-                    if ((conf.getNrThreadsD0() * conf.getNrItemsD0()) > observation.getNrSamplesPerBatch())
+                    if ((conf.getNrThreadsD0() * conf.getNrItemsD0() * conf.getVectorWidth()) > observation.getNrSamplesPerBatch())
                     {
                         continue;
                     }
@@ -368,18 +680,35 @@ int tune(const bool bestMode, const unsigned int nrIterations, const unsigned in
             }
             else if ( kernelTuned == SNR::Kernel::SNRSigmaCut )
             {
-                if (((itemsPerThread * 5) + 9) > maxItems)
+                if (ordering == SNR::DataOrdering::DMsSamples)
                 {
-                    break;
+                    if (((itemsPerThread * 5) + 9) > maxItems)
+                    {
+                        break;
+                    }
+                    if ((observation.getNrSamplesPerBatch() % itemsPerThread) != 0)
+                    {
+                        continue;
+                    }
                 }
-                if ((observation.getNrSamplesPerBatch() % itemsPerThread) != 0)
+                else
                 {
-                    continue;
+                    if (((itemsPerThread * 7) + 3) > maxItems)
+                    {
+                        break;
+                    }
+                    if ((observation.getNrDMs(true) * observation.getNrDMs()) % (itemsPerThread * conf.getNrThreadsD0()) != 0)
+                    {
+                        continue;
+                    }
                 }
                 conf.setNrItemsD0(itemsPerThread);
-                if ((conf.getNrThreadsD0() * conf.getNrItemsD0()) > observation.getNrSamplesPerBatch())
+                if (ordering == SNR::DataOrdering::DMsSamples)
                 {
-                    continue;
+                    if ((conf.getNrThreadsD0() * conf.getNrItemsD0()) > observation.getNrSamplesPerBatch())
+                    {
+                        continue;
+                    }
                 }
             }
             else if (kernelTuned == SNR::Kernel::Max)
@@ -390,15 +719,37 @@ int tune(const bool bestMode, const unsigned int nrIterations, const unsigned in
                     {
                         break;
                     }
+                    if ((((observation.getNrDMs(true) * observation.getNrDMs()) % conf.getNrThreadsD1()) != 0) || ((conf.getNrThreadsD0() * conf.getNrThreadsD1()) > maxThreads))
+                    {
+                        break;
+                    }
+                    if ((conf.getNrWorkGroups() * conf.getNrThreadsD1()) > (observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs()))
+                    {
+                        break;
+                    }
                     if ((observation.getNrSamplesPerBatch() % itemsPerThread) != 0)
                     {
                         continue;
                     }
                 }
+                else
+                {
+                    if (((itemsPerThread * 2) + 2) > maxItems)
+                    {
+                        break;
+                    }
+                    if ((observation.getNrDMs(true) * observation.getNrDMs()) % (itemsPerThread * conf.getNrThreadsD0()) != 0)
+                    {
+                        continue;
+                    }
+                }
                 conf.setNrItemsD0(itemsPerThread);
-                if ((conf.getNrThreadsD0() * conf.getNrItemsD0()) > observation.getNrSamplesPerBatch())
+                if (ordering == SNR::DataOrdering::DMsSamples)
                 {
-                    continue;
+                    if ((conf.getNrThreadsD0() * conf.getNrItemsD0() * conf.getVectorWidth()) > observation.getNrSamplesPerBatch())
+                    {
+                        continue;
+                    }
                 }
             }
             else if (kernelTuned == SNR::Kernel::MaxStdSigmaCut)
@@ -414,54 +765,247 @@ int tune(const bool bestMode, const unsigned int nrIterations, const unsigned in
                         continue;
                     }
                 }
+                else
+                {
+                    if (((itemsPerThread * 6) + 3) > maxItems)
+                    {
+                        break;
+                    }
+                    if ((observation.getNrDMs(true) * observation.getNrDMs()) % (itemsPerThread * conf.getNrThreadsD0()) != 0)
+                    {
+                        continue;
+                    }
+                }
                 conf.setNrItemsD0(itemsPerThread);
-                if ((conf.getNrThreadsD0() * conf.getNrItemsD0()) > observation.getNrSamplesPerBatch())
+                if (ordering == SNR::DataOrdering::DMsSamples)
                 {
-                    continue;
+                    if ((conf.getNrThreadsD0() * conf.getNrItemsD0()) > observation.getNrSamplesPerBatch())
+                    {
+                        continue;
+                    }
                 }
             }
             else if (kernelTuned == SNR::Kernel::AbsoluteDeviation)
             {
-                if ((observation.getNrSamplesPerBatch() % itemsPerThread) != 0)
+                if (ordering == SNR::DataOrdering::DMsSamples)
                 {
-                    continue;
+                    if ((observation.getNrSamplesPerBatch() % itemsPerThread) != 0)
+                    {
+                        continue;
+                    }
+                }
+                else
+                {
+                    if ((observation.getNrDMs(true) * observation.getNrDMs()) % (itemsPerThread * conf.getNrThreadsD0()) != 0)
+                    {
+                        continue;
+                    }
                 }
                 conf.setNrItemsD0(itemsPerThread);
-                if ((conf.getNrThreadsD0() * conf.getNrItemsD0()) > observation.getNrSamplesPerBatch())
+                if (ordering == SNR::DataOrdering::DMsSamples)
                 {
-                    continue;
+                    if ((conf.getNrThreadsD0() * conf.getNrItemsD0()) > observation.getNrSamplesPerBatch())
+                    {
+                        continue;
+                    }
                 }
             }
-
-            // Generate kernel
-            double gbs = 0.0;
-            cl::Kernel *kernel;
-            isa::utils::Timer timer;
-            std::string *code;
-            if (kernelTuned == SNR::Kernel::SNR || kernelTuned == SNR::Kernel::Max)
-            {
-                gbs = isa::utils::giga((observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * observation.getNrSamplesPerBatch() * sizeof(inputDataType)) + (observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * sizeof(outputDataType)) + (observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * sizeof(unsigned int)));
-            }
-            if ( kernelTuned == SNR::Kernel::SNRSigmaCut )
-            {
-                gbs = isa::utils::giga((2 * observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * observation.getNrSamplesPerBatch() * sizeof(inputDataType)) + (observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * sizeof(outputDataType)) + (observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * sizeof(unsigned int)));
-            }
-            if (kernelTuned == SNR::Kernel::MaxStdSigmaCut)
-            {
-                gbs = isa::utils::giga((observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * observation.getNrSamplesPerBatch() * sizeof(inputDataType) * 2.0) + (observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * sizeof(outputDataType) * 2.0) + (observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * sizeof(unsigned int)));
-            }
-            else if (kernelTuned == SNR::Kernel::MedianOfMedians)
+            else if ((kernelTuned == SNR::Kernel::MedianOfMedians) || (kernelTuned == SNR::Kernel::MedianOfMediansAbsoluteDeviation))
             {
-                gbs = isa::utils::giga((observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * observation.getNrSamplesPerBatch() * sizeof(inputDataType)) + (observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * (observation.getNrSamplesPerBatch() / medianStep) * sizeof(outputDataType)));
+                if (ordering == SNR::DataOrdering::SamplesDMs)
+                {
+                    if ((observation.getNrDMs(true) * observation.getNrDMs()) % conf.getNrThreadsD0() != 0)
+                    {
+                        continue;
+                    }
+                }
+                else if (conf.getMedianStrategy() == SNR::MedianStrategy::SortingNetwork)
+                {
+                    // Every work-item sorts itemsPerThread small steps in registers
+                    if ((options.medianStep > SNR::maxSortingNetworkStep) || ((options.medianStep * itemsPerThread) > SNR::maxSortingNetworkSamples))
+                    {
+                        break;
+                    }
+                    if (((observation.getNrSamplesPerBatch() / options.medianStep) % (conf.getNrThreadsD0() * itemsPerThread)) != 0)
+                    {
+                        continue;
+                    }
+                }
+                else if ((itemsPerThread > 1) || ((conf.getMedianStrategy() == SNR::MedianStrategy::RadixSelect) && (sizeof(inputDataType) != 4)))
+                {
+                    break;
+                }
+                conf.setNrItemsD0(itemsPerThread);
+            }
+            else if (kernelTuned == SNR::Kernel::MedianOfMediansTwoLevel)
+            {
+                // Every work-group sorts itemsPerThread steps at a time in local memory
+                if ((options.medianStep * itemsPerThread) > observation.getNrSamplesPerBatch())
+                {
+                    break;
+                }
+                conf.setNrItemsD0(itemsPerThread);
+            }
+            else if ((kernelTuned == SNR::Kernel::SNRCandidates) || (kernelTuned == SNR::Kernel::SNRRunningStatistics))
+            {
+                if (((itemsPerThread * 5) + 7) > maxItems)
+                {
+                    break;
+                }
+                if ((observation.getNrSamplesPerBatch() % itemsPerThread) != 0)
+                {
+                    continue;
+                }
+                conf.setNrItemsD0(itemsPerThread);
+                if ((conf.getNrThreadsD0() * conf.getNrItemsD0()) > observation.getNrSamplesPerBatch())
+                {
+                    continue;
+                }
+            }
+            else if (kernelTuned == SNR::Kernel::SNRTopK)
+            {
+                // The list of peaks is kept in registers
+                if ((itemsPerThread + (options.nrPeaks * 2) + 9) > maxItems)
+                {
+                    break;
+                }
+                if ((observation.getNrSamplesPerBatch() % itemsPerThread) != 0)
+                {
+                    continue;
+                }
+                conf.setNrItemsD0(itemsPerThread);
+                if ((conf.getNrThreadsD0() * conf.getNrItemsD0()) > observation.getNrSamplesPerBatch())
+                {
+                    continue;
+                }
+            }
+            else if (kernelTuned == SNR::Kernel::SNRBeamMax)
+            {
+                // The per-DM maxima are kept in registers
+                if (((itemsPerThread * 3) + 6) > maxItems)
+                {
+                    break;
+                }
+                // Every item must contain at least one DM
+                if ((conf.getNrThreadsD0() * (itemsPerThread - 1)) >= (observation.getNrDMs(true) * observation.getNrDMs()))
+                {
+                    break;
+                }
+                conf.setNrItemsD0(itemsPerThread);
+            }
+            else if (kernelTuned == SNR::Kernel::SNRDownsampling)
+            {
+                // Every work-item needs at least a pair of samples
+                if ((conf.getNrThreadsD0() * 2) > observation.getNrSamplesPerBatch())
+                {
+                    continue;
+                }
+            }
+            else if ((kernelTuned == SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation) || (kernelTuned == SNR::Kernel::StreamingMedianAbsoluteDeviation))
+            {
+                // Every work-item needs at least one sample of the time series
+                if (conf.getNrThreadsD0() > observation.getNrSamplesPerBatch())
+                {
+                    continue;
+                }
+            }
+            if ((kernelTuned == SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation) && (SNR::getSNRMedianOfMediansAbsoluteDeviationLocalMemory<inputDataType>(conf, observation.getNrSamplesPerBatch(), options.medianStep) > SNR::minLocalMemorySize))
+            {
+                // The time series and the reduction buffers do not fit in local memory, for any itemsPerThread
+                break;
+            }
+            if ((kernelTuned == SNR::Kernel::SNRBoxcar) && (SNR::getSNRBoxcarLocalMemory<inputDataType>(conf, observation.getNrSamplesPerBatch()) > SNR::minLocalMemorySize))
+            {
+                // The prefix sum and the reduction buffers do not fit in local memory, for any itemsPerThread
+                break;
+            }
+            else if (kernelTuned == SNR::Kernel::Transpose)
+            {
+                // Every work-item moves itemsPerThread rows of a square tile
+                if (itemsPerThread > conf.getNrThreadsD0())
+                {
+                    break;
+                }
+                if ((conf.getNrThreadsD0() % itemsPerThread) != 0)
+                {
+                    continue;
+                }
+                conf.setNrThreadsD1(conf.getNrThreadsD0() / itemsPerThread);
+                conf.setNrItemsD1(itemsPerThread);
+            }
+
+            // Generate kernel
+            double gbs = 0.0;
+            cl::Kernel *kernel;
+            isa::utils::Timer timer;
+            std::string *code;
+            if (kernelTuned == SNR::Kernel::SNR || kernelTuned == SNR::Kernel::Max)
+            {
+                gbs = isa::utils::giga((observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * observation.getNrSamplesPerBatch() * sizeof(inputDataType)) + (observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * sizeof(outputDataType)) + (observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * sizeof(unsigned int)));
+            }
+            if ( kernelTuned == SNR::Kernel::SNRSigmaCut )
+            {
+                gbs = isa::utils::giga((2 * observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * observation.getNrSamplesPerBatch() * sizeof(inputDataType)) + (observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * sizeof(outputDataType)) + (observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * sizeof(unsigned int)));
+            }
+            if (kernelTuned == SNR::Kernel::MaxStdSigmaCut)
+            {
+                gbs = isa::utils::giga((observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * observation.getNrSamplesPerBatch() * sizeof(inputDataType) * 2.0) + (observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * sizeof(outputDataType) * 2.0) + (observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * sizeof(unsigned int)));
+            }
+            else if (kernelTuned == SNR::Kernel::MedianOfMedians)
+            {
+                gbs = isa::utils::giga((observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * observation.getNrSamplesPerBatch() * sizeof(inputDataType)) + (observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * (observation.getNrSamplesPerBatch() / options.medianStep) * sizeof(outputDataType)));
+            }
+            else if (kernelTuned == SNR::Kernel::StreamingMedianAbsoluteDeviation)
+            {
+                // The samples are read twice, once per histogram, and the state is read and written
+                gbs = isa::utils::giga((2 * observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * observation.getNrSamplesPerBatch() * sizeof(inputDataType)) + (4 * observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * sizeof(float)));
+            }
+            else if (kernelTuned == SNR::Kernel::SNRRunningStatistics)
+            {
+                // The state is read and written, in addition to the input and the outputs of the SNR
+                gbs = isa::utils::giga((observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * observation.getNrSamplesPerBatch() * sizeof(inputDataType)) + (observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * (sizeof(outputDataType) + sizeof(unsigned int))) + (6 * observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * sizeof(float)));
+            }
+            else if (kernelTuned == SNR::Kernel::MedianOfMediansTwoLevel)
+            {
+                gbs = isa::utils::giga((observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * observation.getNrSamplesPerBatch() * sizeof(inputDataType)) + (observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * sizeof(outputDataType)));
             }
             else if (kernelTuned == SNR::Kernel::MedianOfMediansAbsoluteDeviation)
             {
-                gbs = isa::utils::giga((observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * observation.getNrSamplesPerBatch() * sizeof(inputDataType)) + (observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * (observation.getNrSamplesPerBatch() / medianStep) * sizeof(outputDataType)) + (observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * sizeof(outputDataType)));
+                gbs = isa::utils::giga((observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * observation.getNrSamplesPerBatch() * sizeof(inputDataType)) + (observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * (observation.getNrSamplesPerBatch() / options.medianStep) * sizeof(outputDataType)) + (observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * sizeof(outputDataType)));
             }
             else if (kernelTuned == SNR::Kernel::AbsoluteDeviation)
             {
                 gbs = isa::utils::giga((observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * observation.getNrSamplesPerBatch() * sizeof(inputDataType)) + (observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * sizeof(outputDataType)) + (observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * sizeof(outputDataType)));
             }
+            else if (kernelTuned == SNR::Kernel::SNRDownsampling)
+            {
+                gbs = isa::utils::giga((observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * observation.getNrSamplesPerBatch() * sizeof(inputDataType) * 1.5) + (observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * sizeof(outputDataType)) + (2 * observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * sizeof(unsigned int)));
+            }
+            else if (kernelTuned == SNR::Kernel::SNRCandidates)
+            {
+                // The number of candidates depends on the data, so only the input is counted
+                gbs = isa::utils::giga(observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * observation.getNrSamplesPerBatch() * sizeof(inputDataType));
+            }
+            else if (kernelTuned == SNR::Kernel::SNRBeamMax)
+            {
+                gbs = isa::utils::giga((observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * sizeof(float)) + ((observation.getNrSynthesizedBeams() + static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs())) * (sizeof(float) + sizeof(unsigned int))));
+            }
+            else if (kernelTuned == SNR::Kernel::SNRTopK)
+            {
+                gbs = isa::utils::giga((observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * observation.getNrSamplesPerBatch() * sizeof(inputDataType)) + (observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * options.nrPeaks * sizeof(outputDataType)) + (observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * options.nrPeaks * sizeof(unsigned int)));
+            }
+            else if (kernelTuned == SNR::Kernel::SNRBoxcar)
+            {
+                gbs = isa::utils::giga((observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * observation.getNrSamplesPerBatch() * sizeof(inputDataType)) + (observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * sizeof(outputDataType)) + (2 * observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * sizeof(unsigned int)));
+            }
+            else if (kernelTuned == SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation)
+            {
+                gbs = isa::utils::giga((observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * observation.getNrSamplesPerBatch() * sizeof(inputDataType)) + (observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * sizeof(outputDataType)) + (observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * sizeof(unsigned int)));
+            }
+            else if (kernelTuned == SNR::Kernel::Transpose)
+            {
+                gbs = isa::utils::giga(observation.getNrSynthesizedBeams() * static_cast<uint64_t>(observation.getNrDMs(true) * observation.getNrDMs()) * observation.getNrSamplesPerBatch() * sizeof(inputDataType) * 2.0);
+            }
 
             if (kernelTuned == SNR::Kernel::SNR)
             {
@@ -476,42 +1020,85 @@ int tune(const bool bestMode, const unsigned int nrIterations, const unsigned in
             }
             else if ( kernelTuned == SNR::Kernel::SNRSigmaCut )
             {
-                code = SNR::getSNRSigmaCutDMsSamplesOpenCL<inputDataType>(conf, inputDataName, observation, observation.getNrSamplesPerBatch(), padding, nSigma);
+                if ((ordering == SNR::DataOrdering::DMsSamples) && (options.maxIterations > 0))
+                {
+                    code = SNR::getSNRIterativeSigmaCutDMsSamplesOpenCL<inputDataType>(conf, inputDataName, observation, observation.getNrSamplesPerBatch(), padding, options.nSigma, options.maxIterations);
+                }
+                else if (ordering == SNR::DataOrdering::DMsSamples)
+                {
+                    code = SNR::getSNRSigmaCutDMsSamplesOpenCL<inputDataType>(conf, inputDataName, observation, observation.getNrSamplesPerBatch(), padding, options.nSigma);
+                }
+                else
+                {
+                    code = SNR::getSNRSigmaCutSamplesDMsOpenCL<inputDataType>(conf, inputDataName, observation, observation.getNrSamplesPerBatch(), padding, options.nSigma);
+                }
             }
             else if (kernelTuned == SNR::Kernel::Max)
             {
-                if (ordering == SNR::DataOrdering::DMsSamples)
-                {
-                    code = SNR::getMaxOpenCL<inputDataType>(conf, ordering, inputDataName, observation, 1, padding);
-                }
+                code = SNR::getMaxOpenCL<inputDataType>(conf, ordering, inputDataName, observation, 1, padding);
             }
             else if (kernelTuned == SNR::Kernel::MaxStdSigmaCut)
             {
-                if (ordering == SNR::DataOrdering::DMsSamples)
+                if (options.maxIterations > 0)
                 {
-                    code = SNR::getMaxStdSigmaCutOpenCL<inputDataType>(conf, ordering, inputDataName, observation, 1, padding, nSigma);
+                    code = SNR::getMaxStdIterativeSigmaCutDMsSamplesOpenCL<inputDataType>(conf, inputDataName, observation, 1, padding, options.nSigma, options.maxIterations);
+                }
+                else
+                {
+                    code = SNR::getMaxStdSigmaCutOpenCL<inputDataType>(conf, ordering, inputDataName, observation, 1, padding, options.nSigma);
                 }
             }
             else if (kernelTuned == SNR::Kernel::MedianOfMedians)
             {
-                if (ordering == SNR::DataOrdering::DMsSamples)
-                {
-                    code = SNR::getMedianOfMediansOpenCL<inputDataType>(conf, ordering, inputDataName, observation, 1, medianStep, padding);
-                }
+                code = SNR::getMedianOfMediansOpenCL<inputDataType>(conf, ordering, inputDataName, observation, 1, options.medianStep, padding);
+            }
+            else if (kernelTuned == SNR::Kernel::MedianOfMediansTwoLevel)
+            {
+                code = SNR::getMedianOfMediansTwoLevelDMsSamplesOpenCL<inputDataType>(conf, inputDataName, observation, 1, options.medianStep, padding);
+            }
+            else if (kernelTuned == SNR::Kernel::StreamingMedianAbsoluteDeviation)
+            {
+                code = SNR::getStreamingMedianAbsoluteDeviationDMsSamplesOpenCL<inputDataType>(conf, inputDataName, observation, 1, options.nrBins, options.smoothing, padding);
+            }
+            else if (kernelTuned == SNR::Kernel::SNRRunningStatistics)
+            {
+                code = SNR::getSNRRunningStatisticsDMsSamplesOpenCL<inputDataType>(conf, inputDataName, observation, observation.getNrSamplesPerBatch(), options.decay, padding);
             }
             else if (kernelTuned == SNR::Kernel::MedianOfMediansAbsoluteDeviation)
             {
-                if (ordering == SNR::DataOrdering::DMsSamples)
-                {
-                    code = SNR::getMedianOfMediansAbsoluteDeviationOpenCL<inputDataType>(conf, ordering, inputDataName, observation, 1, medianStep, padding);
-                }
+                code = SNR::getMedianOfMediansAbsoluteDeviationOpenCL<inputDataType>(conf, ordering, inputDataName, observation, 1, options.medianStep, padding);
             }
             else if (kernelTuned == SNR::Kernel::AbsoluteDeviation)
             {
-                if (ordering == SNR::DataOrdering::DMsSamples)
-                {
-                    code = SNR::getAbsoluteDeviationOpenCL<inputDataType>(conf, ordering, inputDataName, observation, 1, padding);
-                }
+                code = SNR::getAbsoluteDeviationOpenCL<inputDataType>(conf, ordering, inputDataName, observation, 1, padding);
+            }
+            else if (kernelTuned == SNR::Kernel::SNRDownsampling)
+            {
+                code = SNR::getSNRDownsamplingDMsSamplesOpenCL<inputDataType>(conf, inputDataName, observation, observation.getNrSamplesPerBatch(), 1, padding);
+            }
+            else if (kernelTuned == SNR::Kernel::SNRCandidates)
+            {
+                code = SNR::getSNRCandidatesDMsSamplesOpenCL<inputDataType>(conf, inputDataName, observation, observation.getNrSamplesPerBatch(), options.nSigma, observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs(), padding);
+            }
+            else if (kernelTuned == SNR::Kernel::SNRBeamMax)
+            {
+                code = SNR::getSNRBeamMaxOpenCL<outputDataType>(conf, outputDataName, observation, padding);
+            }
+            else if (kernelTuned == SNR::Kernel::SNRTopK)
+            {
+                code = SNR::getSNRTopKDMsSamplesOpenCL<inputDataType>(conf, inputDataName, observation, observation.getNrSamplesPerBatch(), options.nrPeaks, padding);
+            }
+            else if (kernelTuned == SNR::Kernel::SNRBoxcar)
+            {
+                code = SNR::getSNRBoxcarDMsSamplesOpenCL<inputDataType>(conf, inputDataName, observation, observation.getNrSamplesPerBatch(), options.widths, padding);
+            }
+            else if (kernelTuned == SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation)
+            {
+                code = SNR::getSNRMedianOfMediansAbsoluteDeviationDMsSamplesOpenCL<inputDataType>(conf, inputDataName, observation, observation.getNrSamplesPerBatch(), options.medianStep, padding);
+            }
+            else if (kernelTuned == SNR::Kernel::Transpose)
+            {
+                code = SNR::getTransposeOpenCL<inputDataType>(conf, ordering, inputDataName, observation, 1, padding);
             }
 
             if (reinitializeDeviceMemory)
@@ -519,25 +1106,101 @@ int tune(const bool bestMode, const unsigned int nrIterations, const unsigned in
                 isa::OpenCL::initializeOpenCL(clPlatformID, 1, openCLRunTime);
                 try
                 {
-                    if ( kernelTuned == SNR::Kernel::SNR || kernelTuned == SNR::Kernel::SNRSigmaCut || kernelTuned == SNR::Kernel::Max )
+                    if ( kernelTuned == SNR::Kernel::SNR || kernelTuned == SNR::Kernel::SNRSigmaCut || kernelTuned == SNR::Kernel::Max || kernelTuned == SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation )
+                    {
+                        initializeDeviceMemoryD(*(openCLRunTime.context), &(openCLRunTime.queues->at(clDeviceID)[0]), &input, &input_d, &outputValue_d, observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType)), &outputSample_d, observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int)));
+                    }
+                    else if (kernelTuned == SNR::Kernel::SNRRunningStatistics)
                     {
+                        // The state starts empty, and every run updates it
+                        std::vector<float> state(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float)));
+
                         initializeDeviceMemoryD(*(openCLRunTime.context), &(openCLRunTime.queues->at(clDeviceID)[0]), &input, &input_d, &outputValue_d, observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType)), &outputSample_d, observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int)));
+                        counters_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_WRITE, state.size() * sizeof(float), 0, 0);
+                        means_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_WRITE, state.size() * sizeof(float), 0, 0);
+                        variances_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_WRITE, state.size() * sizeof(float), 0, 0);
+                        openCLRunTime.queues->at(clDeviceID)[0].enqueueWriteBuffer(counters_d, CL_FALSE, 0, state.size() * sizeof(float), reinterpret_cast<void *>(state.data()));
+                        openCLRunTime.queues->at(clDeviceID)[0].enqueueWriteBuffer(means_d, CL_FALSE, 0, state.size() * sizeof(float), reinterpret_cast<void *>(state.data()));
+                        openCLRunTime.queues->at(clDeviceID)[0].enqueueWriteBuffer(variances_d, CL_TRUE, 0, state.size() * sizeof(float), reinterpret_cast<void *>(state.data()));
+                    }
+                    else if (kernelTuned == SNR::Kernel::SNRCandidates)
+                    {
+                        initializeDeviceMemoryD(*(openCLRunTime.context), &(openCLRunTime.queues->at(clDeviceID)[0]), &input, &input_d, &outputValue_d, observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs());
+                        nrCandidates_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_WRITE, sizeof(unsigned int), 0, 0);
+                        candidates_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_WRITE_ONLY, observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * 3 * sizeof(unsigned int), 0, 0);
+                    }
+                    else if (kernelTuned == SNR::Kernel::SNRBeamMax)
+                    {
+                        // The random input is used as the SNR map, and there are never more tiles than DMs
+                        unsigned int counter = 0;
+
+                        initializeDeviceMemoryD(*(openCLRunTime.context), &(openCLRunTime.queues->at(clDeviceID)[0]), &input, &input_d, &outputValue_d, observation.getNrSynthesizedBeams(), &outputSample_d, observation.getNrSynthesizedBeams());
+                        dmSNR_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_WRITE_ONLY, observation.getNrDMs(true) * observation.getNrDMs() * sizeof(float), 0, 0);
+                        dmBeam_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_WRITE_ONLY, observation.getNrDMs(true) * observation.getNrDMs() * sizeof(unsigned int), 0, 0);
+                        partialSNR_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_WRITE, observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * sizeof(float), 0, 0);
+                        partialDM_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_WRITE, observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * sizeof(unsigned int), 0, 0);
+                        counter_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_WRITE, sizeof(unsigned int), 0, 0);
+                        openCLRunTime.queues->at(clDeviceID)[0].enqueueWriteBuffer(counter_d, CL_TRUE, 0, sizeof(unsigned int), reinterpret_cast<void *>(&counter));
+                    }
+                    else if (kernelTuned == SNR::Kernel::SNRTopK)
+                    {
+                        initializeDeviceMemoryD(*(openCLRunTime.context), &(openCLRunTime.queues->at(clDeviceID)[0]), &input, &input_d, &outputValue_d, observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs() * options.nrPeaks, padding / sizeof(outputDataType)), &outputSample_d, observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs() * options.nrPeaks, padding / sizeof(unsigned int)));
+                    }
+                    else if (kernelTuned == SNR::Kernel::SNRDownsampling)
+                    {
+                        initializeDeviceMemoryD(*(openCLRunTime.context), &(openCLRunTime.queues->at(clDeviceID)[0]), &input, &input_d, &outputValue_d, observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType)), &outputDownsampling_d, &outputSample_d, observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int)));
+                        downsampled_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_WRITE, observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / 2, padding / sizeof(inputDataType)) * sizeof(inputDataType), 0, 0);
+                    }
+                    else if (kernelTuned == SNR::Kernel::SNRBoxcar)
+                    {
+                        initializeDeviceMemoryD(*(openCLRunTime.context), &(openCLRunTime.queues->at(clDeviceID)[0]), &input, &input_d, &outputValue_d, observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType)), &outputWidth_d, &outputSample_d, observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int)));
                     }
                     else if (kernelTuned == SNR::Kernel::MaxStdSigmaCut)
                     {
                       initializeDeviceMemoryD(*(openCLRunTime.context), &(openCLRunTime.queues->at(clDeviceID)[0]), &input, &input_d, &outputValue_d, &stdevs_d, observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType)), &outputSample_d, observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(unsigned int)));
                     }
+                    else if ((kernelTuned == SNR::Kernel::MedianOfMedians) && (ordering == SNR::DataOrdering::DMsSamples))
+                    {
+                        initializeDeviceMemoryD(*(openCLRunTime.context), &(openCLRunTime.queues->at(clDeviceID)[0]), &input, &input_d, &outputValue_d, observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / options.medianStep, padding / sizeof(outputDataType)));
+                    }
                     else if (kernelTuned == SNR::Kernel::MedianOfMedians)
                     {
-                        initializeDeviceMemoryD(*(openCLRunTime.context), &(openCLRunTime.queues->at(clDeviceID)[0]), &input, &input_d, &outputValue_d, observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / medianStep, padding / sizeof(outputDataType)));
+                        initializeDeviceMemoryD(*(openCLRunTime.context), &(openCLRunTime.queues->at(clDeviceID)[0]), &input, &input_d, &outputValue_d, observation.getNrSynthesizedBeams() * (observation.getNrSamplesPerBatch() / options.medianStep) * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType)));
+                    }
+                    else if (kernelTuned == SNR::Kernel::MedianOfMediansTwoLevel)
+                    {
+                        initializeDeviceMemoryD(*(openCLRunTime.context), &(openCLRunTime.queues->at(clDeviceID)[0]), &input, &input_d, &outputValue_d, observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType)));
+                    }
+                    else if (kernelTuned == SNR::Kernel::StreamingMedianAbsoluteDeviation)
+                    {
+                        // The state starts empty, and every run updates it
+                        std::vector<float> state(observation.getNrSynthesizedBeams() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(float)));
+
+                        initializeDeviceMemoryD(*(openCLRunTime.context), &(openCLRunTime.queues->at(clDeviceID)[0]), &input, &input_d, &outputValue_d, state.size());
+                        outputValue_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_WRITE, state.size() * sizeof(float), 0, 0);
+                        mads_d = cl::Buffer(*(openCLRunTime.context), CL_MEM_READ_WRITE, state.size() * sizeof(float), 0, 0);
+                        openCLRunTime.queues->at(clDeviceID)[0].enqueueWriteBuffer(outputValue_d, CL_FALSE, 0, state.size() * sizeof(float), reinterpret_cast<void *>(state.data()));
+                        openCLRunTime.queues->at(clDeviceID)[0].enqueueWriteBuffer(mads_d, CL_TRUE, 0, state.size() * sizeof(float), reinterpret_cast<void *>(state.data()));
+                    }
+                    else if ((kernelTuned == SNR::Kernel::MedianOfMediansAbsoluteDeviation) && (ordering == SNR::DataOrdering::DMsSamples))
+                    {
+                        initializeDeviceMemoryD(*(openCLRunTime.context), &(openCLRunTime.queues->at(clDeviceID)[0]), &input, &input_d, &outputValue_d, observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / options.medianStep, padding / sizeof(outputDataType)), &baselines_d, &baselines);
                     }
                     else if (kernelTuned == SNR::Kernel::MedianOfMediansAbsoluteDeviation)
                     {
-                        initializeDeviceMemoryD(*(openCLRunTime.context), &(openCLRunTime.queues->at(clDeviceID)[0]), &input, &input_d, &outputValue_d, observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch() / medianStep, padding / sizeof(outputDataType)), &baselines_d, &baselines);
+                        initializeDeviceMemoryD(*(openCLRunTime.context), &(openCLRunTime.queues->at(clDeviceID)[0]), &input, &input_d, &outputValue_d, observation.getNrSynthesizedBeams() * (observation.getNrSamplesPerBatch() / options.medianStep) * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType)), &baselines_d, &baselines);
                     }
                     else if (kernelTuned == SNR::Kernel::AbsoluteDeviation)
                     {
-                        initializeDeviceMemoryD(*(openCLRunTime.context), &(openCLRunTime.queues->at(clDeviceID)[0]), &input, &input_d, &outputValue_d, observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * isa::utils::pad(observation.getNrSamplesPerBatch(), padding / sizeof(outputDataType)), &baselines_d, &baselines);
+                        initializeDeviceMemoryD(*(openCLRunTime.context), &(openCLRunTime.queues->at(clDeviceID)[0]), &input, &input_d, &outputValue_d, input.size(), &baselines_d, &baselines);
+                    }
+                    else if ((kernelTuned == SNR::Kernel::Transpose) && (ordering == SNR::DataOrdering::DMsSamples))
+                    {
+                        initializeDeviceMemoryD(*(openCLRunTime.context), &(openCLRunTime.queues->at(clDeviceID)[0]), &input, &input_d, &outputValue_d, observation.getNrSynthesizedBeams() * observation.getNrSamplesPerBatch() * isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), padding / sizeof(outputDataType)));
+                    }
+                    else if (kernelTuned == SNR::Kernel::Transpose)
+                    {
+                        initializeDeviceMemoryD(*(openCLRunTime.context), &(openCLRunTime.queues->at(clDeviceID)[0]), &input, &input_d, &outputValue_d, observation.getNrSynthesizedBeams() * observation.getNrDMs(true) * observation.getNrDMs() * observation.getNrSamplesPerBatch(false, padding / sizeof(outputDataType)));
                     }
                 }
                 catch (cl::Error &err)
@@ -561,7 +1224,18 @@ int tune(const bool bestMode, const unsigned int nrIterations, const unsigned in
                 }
                 else if ( kernelTuned == SNR::Kernel::SNRSigmaCut )
                 {
+                    if ((ordering == SNR::DataOrdering::DMsSamples) && (options.maxIterations > 0))
+                    {
+                        kernel = isa::OpenCL::compile("snrIterativeSigmaCut_DMsSamples_" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                    }
+                    else if (ordering == SNR::DataOrdering::DMsSamples)
+                    {
                         kernel = isa::OpenCL::compile("snrSigmaCutDMsSamples" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                    }
+                    else
+                    {
+                        kernel = isa::OpenCL::compile("snrSigmaCutSamplesDMs" + std::to_string(observation.getNrDMs(true) * observation.getNrDMs()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                    }
                 }
                 else if (kernelTuned == SNR::Kernel::Max)
                 {
@@ -569,26 +1243,54 @@ int tune(const bool bestMode, const unsigned int nrIterations, const unsigned in
                     {
                         kernel = isa::OpenCL::compile("max_DMsSamples_" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
                     }
+                    else
+                    {
+                        kernel = isa::OpenCL::compile("max_SamplesDMs_" + std::to_string(observation.getNrDMs(true) * observation.getNrDMs()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                    }
                 }
                 else if (kernelTuned == SNR::Kernel::MaxStdSigmaCut)
                 {
-                    if (ordering == SNR::DataOrdering::DMsSamples)
+                    if ((ordering == SNR::DataOrdering::DMsSamples) && (options.maxIterations > 0))
+                    {
+                        kernel = isa::OpenCL::compile("maxStdIterativeSigmaCut_DMsSamples_" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                    }
+                    else if (ordering == SNR::DataOrdering::DMsSamples)
                     {
                         kernel = isa::OpenCL::compile("maxStdSigmaCut_DMsSamples_" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
                     }
+                    else
+                    {
+                        kernel = isa::OpenCL::compile("maxStdSigmaCut_SamplesDMs_" + std::to_string(observation.getNrDMs(true) * observation.getNrDMs()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                    }
                 }
                 else if (kernelTuned == SNR::Kernel::MedianOfMedians)
                 {
                     if (ordering == SNR::DataOrdering::DMsSamples)
                     {
-                        kernel = isa::OpenCL::compile("medianOfMedians_DMsSamples_" + std::to_string(medianStep), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                        kernel = isa::OpenCL::compile("medianOfMedians_DMsSamples_" + std::to_string(options.medianStep), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
                     }
+                    else
+                    {
+                        kernel = isa::OpenCL::compile("medianOfMedians_SamplesDMs_" + std::to_string(options.medianStep), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                    }
+                }
+                else if (kernelTuned == SNR::Kernel::MedianOfMediansTwoLevel)
+                {
+                    kernel = isa::OpenCL::compile("medianOfMediansTwoLevel_DMsSamples_" + std::to_string(options.medianStep), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                }
+                else if (kernelTuned == SNR::Kernel::StreamingMedianAbsoluteDeviation)
+                {
+                    kernel = isa::OpenCL::compile("streamingMedianAbsoluteDeviation_DMsSamples_" + std::to_string(options.nrBins), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
                 }
                 else if (kernelTuned == SNR::Kernel::MedianOfMediansAbsoluteDeviation)
                 {
                     if (ordering == SNR::DataOrdering::DMsSamples)
                     {
-                        kernel = isa::OpenCL::compile("medianOfMediansAbsoluteDeviation_DMsSamples_" + std::to_string(medianStep), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                        kernel = isa::OpenCL::compile("medianOfMediansAbsoluteDeviation_DMsSamples_" + std::to_string(options.medianStep), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                    }
+                    else
+                    {
+                        kernel = isa::OpenCL::compile("medianOfMediansAbsoluteDeviation_SamplesDMs_" + std::to_string(options.medianStep), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
                     }
                 }
                 else if (kernelTuned == SNR::Kernel::AbsoluteDeviation)
@@ -597,6 +1299,49 @@ int tune(const bool bestMode, const unsigned int nrIterations, const unsigned in
                     {
                         kernel = isa::OpenCL::compile("absolute_deviation_DMsSamples_" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
                     }
+                    else
+                    {
+                        kernel = isa::OpenCL::compile("absolute_deviation_SamplesDMs_" + std::to_string(observation.getNrDMs(true) * observation.getNrDMs()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                    }
+                }
+                else if (kernelTuned == SNR::Kernel::SNRRunningStatistics)
+                {
+                    kernel = isa::OpenCL::compile("snrRunningStatistics_DMsSamples_" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                }
+                else if (kernelTuned == SNR::Kernel::SNRCandidates)
+                {
+                    kernel = isa::OpenCL::compile("snrCandidates_DMsSamples_" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                }
+                else if (kernelTuned == SNR::Kernel::SNRBeamMax)
+                {
+                    kernel = isa::OpenCL::compile("snrBeamMax_" + std::to_string(observation.getNrDMs(true) * observation.getNrDMs()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                }
+                else if (kernelTuned == SNR::Kernel::SNRTopK)
+                {
+                    kernel = isa::OpenCL::compile("snrTopK_DMsSamples_" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                }
+                else if (kernelTuned == SNR::Kernel::SNRDownsampling)
+                {
+                    kernel = isa::OpenCL::compile("snrDownsampling_DMsSamples_1", *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                }
+                else if (kernelTuned == SNR::Kernel::SNRBoxcar)
+                {
+                    kernel = isa::OpenCL::compile("snrBoxcar_DMsSamples_" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                }
+                else if (kernelTuned == SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation)
+                {
+                    kernel = isa::OpenCL::compile("snrMedianOfMediansAbsoluteDeviation_DMsSamples_" + std::to_string(options.medianStep), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                }
+                else if (kernelTuned == SNR::Kernel::Transpose)
+                {
+                    if (ordering == SNR::DataOrdering::DMsSamples)
+                    {
+                        kernel = isa::OpenCL::compile("transpose_DMsSamples_" + std::to_string(observation.getNrSamplesPerBatch()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                    }
+                    else
+                    {
+                        kernel = isa::OpenCL::compile("transpose_SamplesDMs_" + std::to_string(observation.getNrDMs(true) * observation.getNrDMs()), *code, "-cl-mad-enable -Werror", *(openCLRunTime.context), openCLRunTime.devices->at(clDeviceID));
+                    }
                 }
             }
             catch (isa::OpenCL::OpenCLError &err)
@@ -608,24 +1353,51 @@ int tune(const bool bestMode, const unsigned int nrIterations, const unsigned in
             delete code;
 
             cl::NDRange global, local;
-            if (kernelTuned == SNR::Kernel::SNR || kernelTuned == SNR::Kernel::SNRSigmaCut || kernelTuned == SNR::Kernel::Max || kernelTuned == SNR::Kernel::MaxStdSigmaCut)
+            if (kernelTuned == SNR::Kernel::SNR || kernelTuned == SNR::Kernel::SNRSigmaCut || kernelTuned == SNR::Kernel::Max || kernelTuned == SNR::Kernel::MaxStdSigmaCut || kernelTuned == SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation || kernelTuned == SNR::Kernel::SNRBoxcar || kernelTuned == SNR::Kernel::SNRDownsampling || kernelTuned == SNR::Kernel::SNRTopK || kernelTuned == SNR::Kernel::SNRCandidates || kernelTuned == SNR::Kernel::SNRRunningStatistics)
             {
                 if (ordering == SNR::DataOrdering::DMsSamples)
                 {
-                    global = cl::NDRange(conf.getNrThreadsD0(), observation.getNrDMs(true) * observation.getNrDMs(), observation.getNrSynthesizedBeams());
-                    local = cl::NDRange(conf.getNrThreadsD0(), 1, 1);
+                    if (conf.getNrWorkGroups() > 0)
+                    {
+                        global = cl::NDRange(conf.getNrThreadsD0(), conf.getNrThreadsD1() * conf.getNrWorkGroups(), 1);
+                    }
+                    else
+                    {
+                        global = cl::NDRange(conf.getNrThreadsD0(), observation.getNrDMs(true) * observation.getNrDMs(), observation.getNrSynthesizedBeams());
+                    }
+                    local = cl::NDRange(conf.getNrThreadsD0(), conf.getNrThreadsD1(), 1);
                 }
                 else
                 {
-                    global = cl::NDRange((observation.getNrDMs(true) * observation.getNrDMs()) / conf.getNrItemsD0(), observation.getNrSynthesizedBeams());
-                    local = cl::NDRange(conf.getNrThreadsD0(), 1);
+                    global = cl::NDRange((observation.getNrDMs(true) * observation.getNrDMs()) / conf.getNrItemsD0(), observation.getNrSynthesizedBeams() * conf.getNrThreadsD1());
+                    local = cl::NDRange(conf.getNrThreadsD0(), conf.getNrThreadsD1());
                 }
             }
+            else if (kernelTuned == SNR::Kernel::SNRBeamMax)
+            {
+                global = cl::NDRange(isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), conf.getNrThreadsD0() * conf.getNrItemsD0()) / conf.getNrItemsD0(), 1, 1);
+                local = cl::NDRange(conf.getNrThreadsD0(), 1, 1);
+            }
+            else if (kernelTuned == SNR::Kernel::MedianOfMediansTwoLevel || kernelTuned == SNR::Kernel::StreamingMedianAbsoluteDeviation)
+            {
+                global = cl::NDRange(conf.getNrThreadsD0(), observation.getNrDMs(true) * observation.getNrDMs(), observation.getNrSynthesizedBeams());
+                local = cl::NDRange(conf.getNrThreadsD0(), 1, 1);
+            }
             else if (kernelTuned == SNR::Kernel::MedianOfMedians || kernelTuned == SNR::Kernel::MedianOfMediansAbsoluteDeviation)
             {
-                if (ordering == SNR::DataOrdering::DMsSamples)
+                if ((ordering == SNR::DataOrdering::DMsSamples) && (conf.getMedianStrategy() == SNR::MedianStrategy::SortingNetwork))
                 {
-                    global = cl::NDRange(conf.getNrThreadsD0() * (observation.getNrSamplesPerBatch() / medianStep), observation.getNrDMs(true) * observation.getNrDMs(), observation.getNrSynthesizedBeams());
+                    global = cl::NDRange((observation.getNrSamplesPerBatch() / options.medianStep) / conf.getNrItemsD0(), observation.getNrDMs(true) * observation.getNrDMs(), observation.getNrSynthesizedBeams());
+                    local = cl::NDRange(conf.getNrThreadsD0(), 1, 1);
+                }
+                else if (ordering == SNR::DataOrdering::DMsSamples)
+                {
+                    global = cl::NDRange(conf.getNrThreadsD0() * (observation.getNrSamplesPerBatch() / options.medianStep), observation.getNrDMs(true) * observation.getNrDMs(), observation.getNrSynthesizedBeams());
+                    local = cl::NDRange(conf.getNrThreadsD0(), 1, 1);
+                }
+                else
+                {
+                    global = cl::NDRange(observation.getNrDMs(true) * observation.getNrDMs(), observation.getNrSamplesPerBatch() / options.medianStep, observation.getNrSynthesizedBeams());
                     local = cl::NDRange(conf.getNrThreadsD0(), 1, 1);
                 }
             }
@@ -636,12 +1408,73 @@ int tune(const bool bestMode, const unsigned int nrIterations, const unsigned in
                     global = cl::NDRange(observation.getNrSamplesPerBatch() / conf.getNrItemsD0(), observation.getNrDMs(true) * observation.getNrDMs(), observation.getNrSynthesizedBeams());
                     local = cl::NDRange(conf.getNrThreadsD0(), 1, 1);
                 }
+                else
+                {
+                    global = cl::NDRange((observation.getNrDMs(true) * observation.getNrDMs()) / conf.getNrItemsD0(), observation.getNrSamplesPerBatch(), observation.getNrSynthesizedBeams());
+                    local = cl::NDRange(conf.getNrThreadsD0(), 1, 1);
+                }
+            }
+            else if (kernelTuned == SNR::Kernel::Transpose)
+            {
+                if (ordering == SNR::DataOrdering::DMsSamples)
+                {
+                    global = cl::NDRange(isa::utils::pad(observation.getNrSamplesPerBatch(), conf.getNrThreadsD0()), (isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), conf.getNrThreadsD0()) / conf.getNrThreadsD0()) * conf.getNrThreadsD1(), observation.getNrSynthesizedBeams());
+                    local = cl::NDRange(conf.getNrThreadsD0(), conf.getNrThreadsD1(), 1);
+                }
+                else
+                {
+                    global = cl::NDRange(isa::utils::pad(observation.getNrDMs(true) * observation.getNrDMs(), conf.getNrThreadsD0()), (isa::utils::pad(observation.getNrSamplesPerBatch(), conf.getNrThreadsD0()) / conf.getNrThreadsD0()) * conf.getNrThreadsD1(), observation.getNrSynthesizedBeams());
+                    local = cl::NDRange(conf.getNrThreadsD0(), conf.getNrThreadsD1(), 1);
+                }
+            }
+            if ( kernelTuned == SNR::Kernel::SNR || kernelTuned == SNR::Kernel::SNRSigmaCut || kernelTuned == SNR::Kernel::SNRMedianOfMediansAbsoluteDeviation || kernelTuned == SNR::Kernel::SNRTopK )
+            {
+                kernel->setArg(0, input_d);
+                kernel->setArg(1, outputValue_d);
+                kernel->setArg(2, outputSample_d);
             }
-            if ( kernelTuned == SNR::Kernel::SNR || kernelTuned == SNR::Kernel::SNRSigmaCut )
+            else if (kernelTuned == SNR::Kernel::SNRRunningStatistics)
             {
                 kernel->setArg(0, input_d);
                 kernel->setArg(1, outputValue_d);
                 kernel->setArg(2, outputSample_d);
+                kernel->setArg(3, counters_d);
+                kernel->setArg(4, means_d);
+                kernel->setArg(5, variances_d);
+            }
+            else if (kernelTuned == SNR::Kernel::SNRCandidates)
+            {
+                kernel->setArg(0, input_d);
+                kernel->setArg(1, nrCandidates_d);
+                kernel->setArg(2, outputValue_d);
+                kernel->setArg(3, candidates_d);
+            }
+            else if (kernelTuned == SNR::Kernel::SNRBeamMax)
+            {
+                // The kernel resets the counter, so it does not need to be cleared between runs
+                kernel->setArg(0, input_d);
+                kernel->setArg(1, outputValue_d);
+                kernel->setArg(2, outputSample_d);
+                kernel->setArg(3, dmSNR_d);
+                kernel->setArg(4, dmBeam_d);
+                kernel->setArg(5, partialSNR_d);
+                kernel->setArg(6, partialDM_d);
+                kernel->setArg(7, counter_d);
+            }
+            else if (kernelTuned == SNR::Kernel::SNRDownsampling)
+            {
+                kernel->setArg(0, input_d);
+                kernel->setArg(1, downsampled_d);
+                kernel->setArg(2, outputValue_d);
+                kernel->setArg(3, outputSample_d);
+                kernel->setArg(4, outputDownsampling_d);
+            }
+            else if (kernelTuned == SNR::Kernel::SNRBoxcar)
+            {
+                kernel->setArg(0, input_d);
+                kernel->setArg(1, outputValue_d);
+                kernel->setArg(2, outputWidth_d);
+                kernel->setArg(3, outputSample_d);
             }
             else if (kernelTuned == SNR::Kernel::Max)
             {
@@ -656,11 +1489,17 @@ int tune(const bool bestMode, const unsigned int nrIterations, const unsigned in
                 kernel->setArg(2, outputSample_d);
                 kernel->setArg(3, stdevs_d);
             }
-            else if (kernelTuned == SNR::Kernel::MedianOfMedians)
+            else if (kernelTuned == SNR::Kernel::MedianOfMedians || kernelTuned == SNR::Kernel::MedianOfMediansTwoLevel)
             {
                 kernel->setArg(0, input_d);
                 kernel->setArg(1, outputValue_d);
             }
+            else if (kernelTuned == SNR::Kernel::StreamingMedianAbsoluteDeviation)
+            {
+                kernel->setArg(0, input_d);
+                kernel->setArg(1, outputValue_d);
+                kernel->setArg(2, mads_d);
+            }
             else if (kernelTuned == SNR::Kernel::MedianOfMediansAbsoluteDeviation)
             {
                 kernel->setArg(0, baselines_d);
@@ -673,6 +1512,11 @@ int tune(const bool bestMode, const unsigned int nrIterations, const unsigned in
                 kernel->setArg(1, input_d);
                 kernel->setArg(2, outputValue_d);
             }
+            else if (kernelTuned == SNR::Kernel::Transpose)
+            {
+                kernel->setArg(0, input_d);
+                kernel->setArg(1, outputValue_d);
+            }
             try
             {
                 // Warm-up run
@@ -682,6 +1526,13 @@ int tune(const bool bestMode, const unsigned int nrIterations, const unsigned in
                 // Tuning runs
                 for (unsigned int iteration = 0; iteration < nrIterations; iteration++)
                 {
+                    if (kernelTuned == SNR::Kernel::SNRCandidates)
+                    {
+                        // Every run starts with an empty list of candidates
+                        unsigned int nrCandidates = 0;
+
+                        openCLRunTime.queues->at(clDeviceID)[0].enqueueWriteBuffer(nrCandidates_d, CL_TRUE, 0, sizeof(unsigned int), reinterpret_cast<void *>(&nrCandidates));
+                    }
                     timer.start();
                     openCLRunTime.queues->at(clDeviceID)[0].enqueueNDRangeKernel(*kernel, cl::NullRange, global, local, 0, &event);
                     event.wait();